@@ -1,6 +1,9 @@
 #include "application.hpp"
 
+#include <chrono>
+
 #include "renderer/context.hpp"
+#include "frame_profiler.hpp"
 
 void Application::mouse_callback(daxa_f64 x, daxa_f64 y)
 {
@@ -36,8 +39,9 @@ void Application::window_resize_callback(daxa_i32 width, daxa_i32 height)
         renderer.resize(); 
         if(std::holds_alternative<PerspectiveInfo>(active_camera->proj_info))
         {
-            auto & projection_info = std::get<PerspectiveInfo>(active_camera->proj_info);
+            auto projection_info = std::get<PerspectiveInfo>(active_camera->proj_info);
             projection_info.aspect_ratio = daxa_f32(width) / daxa_f32(height);
+            active_camera->set_projection_info(projection_info);
         }
     }
 }
@@ -98,27 +102,10 @@ Application::Application() :
             {this->window_resize_callback(width, height);},
     }),
     state{ .minimized = false },
-    main_camera{{
-        .front = {0.0, 1.0, 0.0},
-        .up = {0.0, 0.0, 1.0}, 
-        .projection_info = PerspectiveInfo{
-            .aspect_ratio = daxa_f32(INIT_WINDOW_DIMENSIONS.x)/daxa_f32(INIT_WINDOW_DIMENSIONS.y),
-            .fov = glm::radians(70.0f),
-            .near_plane = 0.01f,
-        }
-    }},
-    debug_camera{{
-        .position = {5000.0, 5000.0, 200.0},
-        .front = {0.0, 1.0, 0.0},
-        .up = {0.0, 0.0, 1.0}, 
-        .projection_info = PerspectiveInfo{
-            .aspect_ratio = daxa_f32(INIT_WINDOW_DIMENSIONS.x)/daxa_f32(INIT_WINDOW_DIMENSIONS.y),
-            .fov = glm::radians(70.0f),
-            .near_plane = 10.0f,
-        }
-    }},
+    main_camera{get_default_main_camera_info()},
+    debug_camera{get_default_debug_camera_info()},
     active_camera{&main_camera},
-    gui{{ &active_camera, &renderer }},
+    gui{{ &active_camera, &renderer, &camera_path }},
     renderer{window, &gui.globals},
     geometry{generate_planet()}
 {
@@ -131,6 +118,13 @@ void Application::process_input()
     state.delta_time =  this_frame_time - state.last_frame_time;
     state.last_frame_time = this_frame_time;
 
+    // Cameras are driven by the recorded track, the user input would make the playback non deterministic
+    if(camera_path.get_mode() == CameraPathMode::PLAYBACK)
+    {
+        state.delta_time = camera_path.get_fixed_timestep();
+        return;
+    }
+
     if(state.key_table.data > 0 && state.fly_cam)
     {
         bool camera_sped_up = state.key_table.bits.LEFT_SHIFT;
@@ -145,19 +139,60 @@ void Application::process_input()
     }
 }
 
+void Application::play_camera_path(std::string const & path, bool exit_after_playback)
+{
+    camera_path.start_playback(path);
+    state.exit_after_playback = exit_after_playback;
+}
+
 void Application::main_loop()
 {
+    using namespace std::chrono;
     while (!window.get_window_should_close())
     {
+        FrameProfiler::get().begin_frame();
+        PROFILE_SCOPE("frame");
+        const auto frame_start = steady_clock::now();
         bool control_main_camera = !gui.globals.use_debug_camera || gui.globals.control_main_camera;
         active_camera = control_main_camera ? &main_camera : &debug_camera;
-        glfwPollEvents();
-        process_input();
-        gui.on_update();
+        {
+            PROFILE_SCOPE("poll events");
+            glfwPollEvents();
+        }
+        {
+            PROFILE_SCOPE("process input");
+            process_input();
+        }
+        {
+            PROFILE_SCOPE("gui update");
+            gui.on_update();
+        }
+
+        {
+            PROFILE_SCOPE("camera path");
+            if(camera_path.get_mode() == CameraPathMode::PLAYBACK)
+            {
+                const bool playing = camera_path.playback_frame(main_camera, debug_camera, gui.globals);
+                if(!playing && state.exit_after_playback) { window.set_window_should_close(true); }
+            }
+            camera_path.record_frame(main_camera, debug_camera, gui.globals);
+        }
 
         active_camera = gui.globals.use_debug_camera ? &debug_camera : &main_camera;
         if (state.minimized) { continue; } 
     
-        renderer.draw({main_camera, debug_camera});
+        const auto draw_start = steady_clock::now();
+        {
+            PROFILE_SCOPE("draw");
+            renderer.draw({main_camera, debug_camera});
+        }
+        const auto frame_end = steady_clock::now();
+
+        camera_path.record_frame_timing({
+            .frame_cpu_ms = duration<daxa_f64, std::milli>(frame_end - frame_start).count(),
+            .draw_cpu_ms = duration<daxa_f64, std::milli>(frame_end - draw_start).count(),
+            .vsm_statistics = renderer.context.frame.vsm_statistics,
+            .vsm_draw_ms = renderer.context.frame.vsm_draw_ms
+        });
     }
 }
@@ -8,9 +8,37 @@ using namespace daxa::types;
 #include "gui_manager.hpp"
 #include "window.hpp"
 #include "camera.hpp"
+#include "camera_path.hpp"
 
 static constexpr daxa_i32vec2 INIT_WINDOW_DIMENSIONS = {1920, 1080};
 
+inline auto get_default_main_camera_info() -> CameraInfo
+{
+    return {
+        .front = {0.0, 1.0, 0.0},
+        .up = {0.0, 0.0, 1.0}, 
+        .projection_info = PerspectiveInfo{
+            .aspect_ratio = daxa_f32(INIT_WINDOW_DIMENSIONS.x)/daxa_f32(INIT_WINDOW_DIMENSIONS.y),
+            .fov = glm::radians(70.0f),
+            .near_plane = 0.01f,
+        }
+    };
+}
+
+inline auto get_default_debug_camera_info() -> CameraInfo
+{
+    return {
+        .position = {5000.0, 5000.0, 200.0},
+        .front = {0.0, 1.0, 0.0},
+        .up = {0.0, 0.0, 1.0}, 
+        .projection_info = PerspectiveInfo{
+            .aspect_ratio = daxa_f32(INIT_WINDOW_DIMENSIONS.x)/daxa_f32(INIT_WINDOW_DIMENSIONS.y),
+            .fov = glm::radians(70.0f),
+            .near_plane = 10.0f,
+        }
+    };
+}
+
 union KeyTable
 {
     unsigned int data;
@@ -37,6 +65,7 @@ struct Application
         bool minimized = false;
         bool fly_cam = false;
         bool first_input = true;
+        bool exit_after_playback = false;
         daxa_f32vec2 last_mouse_pos;
 
         KeyTable key_table;
@@ -47,6 +76,9 @@ struct Application
         ~Application() = default;
 
         void main_loop();
+        // Plays the camera path track from the first frame, the application closes after
+        // the last frame when exit_after_playback is set
+        void play_camera_path(std::string const & path, bool exit_after_playback);
 
     private:
         AppWindow window;
@@ -54,6 +86,7 @@ struct Application
         Camera main_camera;
         Camera debug_camera;
         Camera * active_camera;
+        CameraPath camera_path;
         GuiManager gui;
         Renderer renderer;
         PlanetGeometry geometry;
@@ -2,7 +2,21 @@
 
 #include <fstream>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define CAMERA_USE_SSE
+#include <immintrin.h>
+#endif
+
 auto constexpr static inline daxa_vec3_to_glm(daxa_f32vec3 vec) -> glm::vec3 { return glm::vec3(vec.x, vec.y, vec.z); }
+auto static inline glm_mat_to_daxa(glm::mat4x4 const & mat) -> daxa_f32mat4x4
+{
+    return daxa_f32mat4x4(
+        daxa_f32vec4{mat[0][0], mat[0][1], mat[0][2], mat[0][3]},
+        daxa_f32vec4{mat[1][0], mat[1][1], mat[1][2], mat[1][3]},
+        daxa_f32vec4{mat[2][0], mat[2][1], mat[2][2], mat[2][3]},
+        daxa_f32vec4{mat[3][0], mat[3][1], mat[3][2], mat[3][3]}
+    );
+}
 
 Camera::Camera(const CameraInfo & info) : 
     offset{daxa_i32vec3{0, 0, 0}},
@@ -32,6 +46,31 @@ void Camera::set_front(daxa_f32vec3 new_front)
     matrix_dirty = true;
 }
 
+void Camera::set_projection_info(ProjectionInfo const & new_proj_info)
+{
+    proj_info = new_proj_info;
+    matrix_dirty = true;
+}
+
+void Camera::set_state(CameraState const & state)
+{
+    offset = state.offset;
+    position = daxa_vec3_to_glm(state.position);
+    front = daxa_vec3_to_glm(state.front);
+    up = daxa_vec3_to_glm(state.up);
+    matrix_dirty = true;
+}
+
+auto Camera::get_state() const -> CameraState
+{
+    return CameraState{
+        .offset = offset,
+        .position = daxa_f32vec3{position.x, position.y, position.z},
+        .front = daxa_f32vec3{front.x, front.y, front.z},
+        .up = daxa_f32vec3{up.x, up.y, up.z}
+    };
+}
+
 void Camera::move_camera(daxa_f32 delta_time, Direction direction, bool sped_up)
 {
     if(sped_up) { speed *= 10.0; }
@@ -114,6 +153,14 @@ void Camera::recalculate_matrices()
         );
         /* GLM is using OpenGL standard where Y coordinate of the clip coordinates is inverted */
         projection[1][1] *= -1.0;
+
+        // Orthographic projection is only a per axis scale followed by a translation
+        inv_projection = glm::mat4x4(1.0f);
+        for(daxa_i32 axis = 0; axis < 3; axis++)
+        {
+            inv_projection[axis][axis] = 1.0f / projection[axis][axis];
+            inv_projection[3][axis] = -projection[3][axis] / projection[axis][axis];
+        }
     } 
     else 
     {
@@ -128,70 +175,56 @@ void Camera::recalculate_matrices()
         projection[2][2] =  0.0f;
         projection[2][3] = -1.0f;
         projection[3][2] =  persp_info.near_plane;
+
+        // clip = (a * x, b * y, near * w, -z) -> view = (clip.x / a, clip.y / b, -clip.w, clip.z / near)
+        inv_projection = glm::mat4x4(0.0f);
+        inv_projection[0][0] =  1.0f / projection[0][0];
+        inv_projection[1][1] =  1.0f / projection[1][1];
+        inv_projection[3][2] = -1.0f;
+        inv_projection[2][3] =  1.0f / persp_info.near_plane;
     }
 
     view = glm::lookAt(position, position + front, up);
 
+    // View matrix is rigid so the inverse is the transposed rotation and the rotated negative translation
+    const auto inv_rotation = glm::transpose(glm::mat3x3(view));
+    inv_view = glm::mat4x4(inv_rotation);
+    inv_view[3] = glm::vec4(-(inv_rotation * glm::vec3(view[3])), 1.0f);
+
+    projection_view = projection * view;
+    inv_projection_view = inv_view * inv_projection;
+
     matrix_dirty = false;
 }
 
 auto Camera::get_view_matrix() -> daxa_f32mat4x4
 {
     if(matrix_dirty) { recalculate_matrices(); }
-    return daxa_f32mat4x4(
-        daxa_f32vec4{view[0][0], view[0][1], view[0][2], view[0][3]},
-        daxa_f32vec4{view[1][0], view[1][1], view[1][2], view[1][3]},
-        daxa_f32vec4{view[2][0], view[2][1], view[2][2], view[2][3]},
-        daxa_f32vec4{view[3][0], view[3][1], view[3][2], view[3][3]}
-    );
+    return glm_mat_to_daxa(view);
 }
 
 auto Camera::get_projection_matrix() -> daxa_f32mat4x4
 {
     if(matrix_dirty) { recalculate_matrices(); }
-    return daxa_f32mat4x4(
-        daxa_f32vec4{projection[0][0], projection[0][1], projection[0][2], projection[0][3]},
-        daxa_f32vec4{projection[1][0], projection[1][1], projection[1][2], projection[1][3]},
-        daxa_f32vec4{projection[2][0], projection[2][1], projection[2][2], projection[2][3]},
-        daxa_f32vec4{projection[3][0], projection[3][1], projection[3][2], projection[3][3]}
-    );
+    return glm_mat_to_daxa(projection);
 }
 
 auto Camera::get_projection_view_matrix() -> daxa_f32mat4x4
 {
     if(matrix_dirty) { recalculate_matrices(); }
-    glm::mat4x4 projection_view = projection * view;
-    return daxa_f32mat4x4(
-        daxa_f32vec4{projection_view[0][0], projection_view[0][1], projection_view[0][2], projection_view[0][3]},
-        daxa_f32vec4{projection_view[1][0], projection_view[1][1], projection_view[1][2], projection_view[1][3]},
-        daxa_f32vec4{projection_view[2][0], projection_view[2][1], projection_view[2][2], projection_view[2][3]},
-        daxa_f32vec4{projection_view[3][0], projection_view[3][1], projection_view[3][2], projection_view[3][3]}
-    );
+    return glm_mat_to_daxa(projection_view);
 }
 
 auto Camera::get_inv_projection_matrix() -> daxa_f32mat4x4
 {
     if(matrix_dirty) { recalculate_matrices(); }
-    auto inv_projection = glm::inverse(projection);
-    return daxa_f32mat4x4(
-        daxa_f32vec4{inv_projection[0][0], inv_projection[0][1], inv_projection[0][2], inv_projection[0][3]},
-        daxa_f32vec4{inv_projection[1][0], inv_projection[1][1], inv_projection[1][2], inv_projection[1][3]},
-        daxa_f32vec4{inv_projection[2][0], inv_projection[2][1], inv_projection[2][2], inv_projection[2][3]},
-        daxa_f32vec4{inv_projection[3][0], inv_projection[3][1], inv_projection[3][2], inv_projection[3][3]}
-    );
+    return glm_mat_to_daxa(inv_projection);
 }
 
 auto Camera::get_inv_view_proj_matrix() -> daxa_f32mat4x4
 {
     if(matrix_dirty) { recalculate_matrices(); }
-    auto inv_projection_view = glm::inverse(projection * view);
-
-    return daxa_f32mat4x4(
-        daxa_f32vec4{inv_projection_view[0][0], inv_projection_view[0][1], inv_projection_view[0][2], inv_projection_view[0][3]},
-        daxa_f32vec4{inv_projection_view[1][0], inv_projection_view[1][1], inv_projection_view[1][2], inv_projection_view[1][3]},
-        daxa_f32vec4{inv_projection_view[2][0], inv_projection_view[2][1], inv_projection_view[2][2], inv_projection_view[2][3]},
-        daxa_f32vec4{inv_projection_view[3][0], inv_projection_view[3][1], inv_projection_view[3][2], inv_projection_view[3][3]}
-    );
+    return glm_mat_to_daxa(inv_projection_view);
 }
 
 auto Camera::get_frustum_info() -> CameraFrustumInfo
@@ -228,6 +261,45 @@ auto Camera::get_frustum_info() -> CameraFrustumInfo
     };
 }
 
+auto Camera::get_frustum_planes() -> FrustumPlanes
+{
+    if(matrix_dirty) { recalculate_matrices(); }
+
+    // Gribb-Hartmann, both projections map the visible volume to -w <= x, y <= w and 0 <= z <= w
+    const auto row = [&](daxa_i32 idx) -> glm::vec4
+    {
+        return glm::vec4(projection_view[0][idx], projection_view[1][idx], projection_view[2][idx], projection_view[3][idx]);
+    };
+    // Clip space Y is inverted so y = -w is the top plane, perspective uses reverse depth so z = w is the near plane
+    const bool reverse_depth = std::holds_alternative<PerspectiveInfo>(proj_info);
+    const std::array<glm::vec4, PLANE_COUNT> clip_planes = {
+        row(3) + row(0),
+        row(3) - row(0),
+        row(3) - row(1),
+        row(3) + row(1),
+        reverse_depth ? row(3) - row(2) : row(2),
+        reverse_depth ? row(2) : row(3) - row(2)
+    };
+
+    FrustumPlanes frustum_planes;
+    for(daxa_i32 plane_idx = 0; plane_idx < PLANE_COUNT; plane_idx++)
+    {
+        const auto & plane = clip_planes.at(plane_idx);
+        const daxa_f32 normal_length = glm::length(glm::vec3(plane));
+        // Reverse depth infinite perspective has no far plane, its equation degenerates to a constant
+        if(normal_length < 1e-6f)
+        {
+            frustum_planes.planes.at(plane_idx) = daxa_f32vec4{0.0f, 0.0f, 0.0f, 1.0f};
+            continue;
+        }
+        const auto normalized = plane / normal_length;
+        // Matrices are built relative to the camera offset, world space position p is at p + offset
+        const daxa_f32 world_distance = normalized.w + glm::dot(glm::vec3(normalized), glm::vec3(offset.x, offset.y, offset.z));
+        frustum_planes.planes.at(plane_idx) = daxa_f32vec4{normalized.x, normalized.y, normalized.z, world_distance};
+    }
+    return frustum_planes;
+}
+
 void Camera::write_frustum_vertices(WriteVerticesInfo const & info)
 {
 
@@ -247,7 +319,7 @@ void Camera::write_frustum_vertices(WriteVerticesInfo const & info)
         for(int i = 0; i < 8; i++)
         {
             const auto ndc_pos = glm::vec4(offsets[i], i < 4 ? 0.0f : 1.0f, 1.0);
-            const glm::vec4 unproj_world_space =  glm::inverse(projection * view) * ndc_pos;
+            const glm::vec4 unproj_world_space = inv_projection_view * ndc_pos;
             const glm::vec3 world_space = glm::vec3(
                 unproj_world_space.x / unproj_world_space.w,
                 unproj_world_space.y / unproj_world_space.w,
@@ -283,13 +355,12 @@ auto Camera::get_camera_position() const -> daxa_f32vec3
     return daxa_f32vec3{position.x, position.y, position.z};
 }
 
-auto Camera::align_clip_to_player(
+auto Camera::get_clip_alignment(
         Camera const * player_camera,
         daxa_f32vec3 sun_offset,
-        std::span<FrustumVertex, VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION * 8> vertices_space,
-        bool view_page_frusti,
+        OrthographicInfo const & clip_projection,
         daxa_i32 sun_offset_factor
-    ) -> ClipAlignInfo
+    ) const -> ClipAlignment
 {
     const daxa_f32vec3 foffset_player_position = player_camera->get_camera_position(); 
 
@@ -300,37 +371,64 @@ auto Camera::align_clip_to_player(
         static_cast<daxa_f32>(iplayer_offset.z) 
     };
 
-    set_position(daxa_f32vec3{0.0f, 0.0f, 0.0f});
-    recalculate_matrices();
-
     const glm::vec4 glm_player_position = glm::vec4(
-        foffset_player_position.x - fplayer_offset.x - offset.x,
-        foffset_player_position.y - fplayer_offset.y - offset.y,
-        foffset_player_position.z - fplayer_offset.z - offset.z,
+        foffset_player_position.x - fplayer_offset.x,
+        foffset_player_position.y - fplayer_offset.y,
+        foffset_player_position.z - fplayer_offset.z,
         1.0
     );
 
-    const auto projected_player_position = projection * view * glm_player_position;
-    const auto ndc_player_position = glm::vec3(
-        projected_player_position.x / glm_player_position.w,
-        projected_player_position.y / glm_player_position.w,
-        projected_player_position.z / glm_player_position.w
+    // Same matrices recalculate_matrices() produces for this camera placed at the origin
+    auto origin_projection = glm::ortho(
+        clip_projection.left, 
+        clip_projection.right,
+        clip_projection.bottom,
+        clip_projection.top,
+        clip_projection.near,
+        clip_projection.far
     );
+    origin_projection[1][1] *= -1.0;
+    const auto origin_view = glm::lookAt(glm::vec3(0.0f), front, up);
+
+    const auto projected_player_position = (origin_projection * origin_view) * glm_player_position;
     // NOTE(msakmary) We need to multiply by two because we were converting from NDC space which is [-1, 1] and not uv spcae
     const daxa_f32 ndc_page_size = static_cast<daxa_f32>(VSM_PAGE_SIZE * 2) / static_cast<daxa_f32>(VSM_TEXTURE_RESOLUTION);
-    const auto ndc_page_scaled_player_position = glm::vec2(
-        ndc_player_position.x / ndc_page_size,
-        ndc_player_position.y / ndc_page_size
+    const auto ndc_page_scaled_aligned_player_position = glm::vec2(
+        std::ceil(projected_player_position.x / ndc_page_size), 
+        std::ceil(projected_player_position.y / ndc_page_size)
     );
+
+    return ClipAlignment{
+        .page_offset = daxa_i32vec2{
+            -static_cast<daxa_i32>(ndc_page_scaled_aligned_player_position.x),
+            -static_cast<daxa_i32>(ndc_page_scaled_aligned_player_position.y)
+        },
+        .sun_height_offset = static_cast<daxa_i32>(glm::floor(glm_player_position.z / (sun_offset.z)) + sun_offset_factor)
+    };
+}
+
+auto Camera::align_clip_to_player(
+        Camera const * player_camera,
+        daxa_f32vec3 sun_offset,
+        std::span<FrustumVertex> vertices_space,
+        bool view_page_frusti,
+        daxa_i32 sun_offset_factor
+    ) -> ClipAlignInfo
+{
+    set_position(daxa_f32vec3{0.0f, 0.0f, 0.0f});
+    recalculate_matrices();
+
+    const auto alignment = get_clip_alignment(player_camera, sun_offset, std::get<OrthographicInfo>(proj_info), sun_offset_factor);
+    const daxa_f32 ndc_page_size = static_cast<daxa_f32>(VSM_PAGE_SIZE * 2) / static_cast<daxa_f32>(VSM_TEXTURE_RESOLUTION);
     const auto ndc_page_scaled_aligned_player_position = glm::vec2(
-        std::ceil(ndc_page_scaled_player_position.x), 
-        std::ceil(ndc_page_scaled_player_position.y)
+        static_cast<daxa_f32>(-alignment.page_offset.x),
+        static_cast<daxa_f32>(-alignment.page_offset.y)
     );
 
-    /*const*/ auto ortho_info = std::get<OrthographicInfo>(proj_info);
+    const auto ortho_info = std::get<OrthographicInfo>(proj_info);
 
-    const auto near_offset_ndc_u_in_world = glm::inverse(projection * view) * glm::vec4(ndc_page_size, 0.0, 0.0, 1.0);
-    const auto near_offset_ndc_v_in_world = glm::inverse(projection * view) * glm::vec4(0.0, ndc_page_size, 0.0, 1.0);
+    const auto near_offset_ndc_u_in_world = inv_projection_view * glm::vec4(ndc_page_size, 0.0, 0.0, 1.0);
+    const auto near_offset_ndc_v_in_world = inv_projection_view * glm::vec4(0.0, ndc_page_size, 0.0, 1.0);
 
     const auto ndc_u_in_world = glm::vec3(
         near_offset_ndc_u_in_world.x + ortho_info.near * sun_offset.x,
@@ -358,8 +456,7 @@ auto Camera::align_clip_to_player(
         ndc_page_scaled_aligned_player_position.y * on_plane_ndc_v_in_world
     );
 
-    
-    const auto sun_height_offset = static_cast<daxa_i32>(glm::floor(glm_player_position.z / (sun_offset.z)) + sun_offset_factor);
+    const auto sun_height_offset = alignment.sun_height_offset;
     const auto scaled_sun_offset = static_cast<daxa_f32>(sun_height_offset) * glm::vec3(sun_offset.x, sun_offset.y, sun_offset.z);
     const auto new_position = new_on_plane_position + scaled_sun_offset;
 
@@ -375,56 +472,116 @@ auto Camera::align_clip_to_player(
     set_position(daxa_f32vec3{new_position.x, new_position.y, new_position.z});
     recalculate_matrices();
 
-    const auto origin_shift = (projection * view * glm::vec4(0.0, 0.0, 0.0, 1.0)).z;
-    const auto page_x_depth_offset = ((projection * view) * glm::vec4(x_offset_vector, 1.0)).z - origin_shift;
-    const auto page_y_depth_offset = ((projection * view) * glm::vec4(y_offset_vector, 1.0)).z - origin_shift;
+    const auto origin_shift = (projection_view * glm::vec4(0.0, 0.0, 0.0, 1.0)).z;
+    const auto page_x_depth_offset = (projection_view * glm::vec4(x_offset_vector, 1.0)).z - origin_shift;
+    const auto page_y_depth_offset = (projection_view * glm::vec4(y_offset_vector, 1.0)).z - origin_shift;
 
-    const daxa_f32 page_uv_size = ndc_page_size / 2.0;
     if(view_page_frusti)
     {
-        for(daxa_i32 page_tex_u = 0; page_tex_u < VSM_PAGE_TABLE_RESOLUTION; page_tex_u++)
-        {
-            for(int page_tex_v = 0; page_tex_v < VSM_PAGE_TABLE_RESOLUTION; page_tex_v++)
-            {
-                const auto corner_virtual_uv = page_uv_size * glm::vec2(page_tex_u, page_tex_v);
-                const auto page_center_virtual_uv_offset = glm::vec2(page_uv_size * 0.5f);
-                const auto virtual_uv = corner_virtual_uv + page_center_virtual_uv_offset;
-
-                const auto page_index = glm::ivec2(virtual_uv * daxa_f32(VSM_PAGE_TABLE_RESOLUTION));
-
-                const daxa_f32 depth = 
-                    ((VSM_PAGE_TABLE_RESOLUTION - 1) - page_index.x) * page_x_depth_offset +
-                    ((VSM_PAGE_TABLE_RESOLUTION - 1) - page_index.y) * page_y_depth_offset;
-                const auto virtual_page_ndc = (virtual_uv * 2.0f) - glm::vec2(1.0f);
-
-                const auto page_ndc_position = glm::vec4(virtual_page_ndc, -depth, 1.0); 
-                const auto offset_new_position = inverse(projection * view) * page_ndc_position;
-                const auto _new_position = glm::vec3(
-                    offset_new_position.x - offset.x + ortho_info.near * sun_offset.x,
-                    offset_new_position.y - offset.y + ortho_info.near * sun_offset.y,
-                    offset_new_position.z - offset.z + ortho_info.near * sun_offset.z);
-
-                proj_info = modified_info;
-                set_position(daxa_f32vec3{_new_position.x, _new_position.y, _new_position.z});
-                write_frustum_vertices({
-                    .vertices_dst = std::span<FrustumVertex, 8>{&vertices_space[(page_tex_u * VSM_PAGE_TABLE_RESOLUTION + page_tex_v) * 8], 8}
-                });
-
-                proj_info = ortho_info;
-                set_position(daxa_f32vec3{new_position.x, new_position.y, new_position.z});
-                recalculate_matrices();
-            }
-        }
+        // Page frusti only differ in their position, corners are taken from a single page sized camera
+        auto page_camera = *this;
+        page_camera.set_projection_info(modified_info);
+        page_camera.set_position(daxa_f32vec3{0.0f, 0.0f, 0.0f});
+        std::array<FrustumVertex, 8> page_corners;
+        page_camera.write_frustum_vertices({ .vertices_dst = page_corners });
+
+        // Center of page (0, 0) and the per page steps in NDC, depth offsets grow towards page (0, 0)
+        const daxa_f32 first_page_ndc = ndc_page_size * 0.5f - 1.0f;
+        const daxa_f32 first_page_depth = (VSM_PAGE_TABLE_RESOLUTION - 1) * (page_x_depth_offset + page_y_depth_offset);
+        const auto first_page_world = glm::vec3(inv_projection_view * glm::vec4(first_page_ndc, first_page_ndc, -first_page_depth, 1.0)) -
+            glm::vec3(offset.x, offset.y, offset.z) + ortho_info.near * glm::vec3(sun_offset.x, sun_offset.y, sun_offset.z);
+        const auto page_u_step = glm::vec3(inv_projection_view[0]) * ndc_page_size + glm::vec3(inv_projection_view[2]) * page_x_depth_offset;
+        const auto page_v_step = glm::vec3(inv_projection_view[1]) * ndc_page_size + glm::vec3(inv_projection_view[2]) * page_y_depth_offset;
+
+        auto glm_vec_to_daxa = [](glm::vec3 v) -> daxa_f32vec3 { return {v.x, v.y, v.z}; };
+        auto batch = PageFrustiBatch{
+            .first_page_position = glm_vec_to_daxa(first_page_world),
+            .page_u_step = glm_vec_to_daxa(page_u_step),
+            .page_v_step = glm_vec_to_daxa(page_v_step),
+        };
+        for(daxa_i32 i = 0; i < 8; i++) { batch.corner_offsets.at(i) = page_corners.at(i).vertex; }
+
+        write_page_frusti_vertices({
+            .batch = batch,
+            .vertices_dst = vertices_space.first<VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION * 8>()
+        });
     }
 
-    proj_info = ortho_info;
-    set_position(daxa_f32vec3{new_position.x, new_position.y, new_position.z});
     return ClipAlignInfo{
         .per_page_depth_offset = daxa_f32vec2{page_x_depth_offset, page_y_depth_offset},
-        .page_offset = daxa_i32vec2{
-            -static_cast<daxa_i32>(ndc_page_scaled_aligned_player_position.x),
-            -static_cast<daxa_i32>(ndc_page_scaled_aligned_player_position.y)
-        },
+        .page_offset = alignment.page_offset,
         .sun_height_offset = sun_height_offset,
     };
-}
\ No newline at end of file
+}
+void write_page_frusti_vertices(WritePageFrustiInfo const & info)
+{
+    static_assert(sizeof(FrustumVertex) == 3 * sizeof(daxa_f32), "Page frusti are written as tightly packed floats");
+    static constexpr daxa_u32 PAGE_FLOAT_COUNT = 8 * 3;
+
+    DBG_ASSERT_TRUE_M(
+        info.first_row + info.row_count <= VSM_PAGE_TABLE_RESOLUTION,
+        "[write_page_frusti_vertices()] Row range out of the page table bounds"
+    );
+
+    auto const & batch = info.batch;
+    daxa_f32 * const dst = reinterpret_cast<daxa_f32 *>(info.vertices_dst.data());
+
+    std::array<daxa_f32, PAGE_FLOAT_COUNT> corners;
+    for(daxa_u32 i = 0; i < 8; i++)
+    {
+        corners[i * 3 + 0] = batch.corner_offsets[i].x;
+        corners[i * 3 + 1] = batch.corner_offsets[i].y;
+        corners[i * 3 + 2] = batch.corner_offsets[i].z;
+    }
+
+#ifdef CAMERA_USE_SSE
+    // A page is 24 floats (six SSE registers), the xyz position pattern repeats every three registers
+    auto position_pattern = [](daxa_f32vec3 v, __m128 (&dst)[3])
+    {
+        dst[0] = _mm_setr_ps(v.x, v.y, v.z, v.x);
+        dst[1] = _mm_setr_ps(v.y, v.z, v.x, v.y);
+        dst[2] = _mm_setr_ps(v.z, v.x, v.y, v.z);
+    };
+    __m128 first_page[3], u_step[3], v_step[3];
+    position_pattern(batch.first_page_position, first_page);
+    position_pattern(batch.page_u_step, u_step);
+    position_pattern(batch.page_v_step, v_step);
+
+    __m128 corner_registers[6];
+    for(daxa_u32 i = 0; i < 6; i++) { corner_registers[i] = _mm_loadu_ps(&corners[i * 4]); }
+
+    for(daxa_u32 u = info.first_row; u < info.first_row + info.row_count; u++)
+    {
+        const __m128 u_scale = _mm_set1_ps(static_cast<daxa_f32>(u));
+        __m128 row_position[3];
+        for(daxa_u32 i = 0; i < 3; i++) { row_position[i] = _mm_add_ps(first_page[i], _mm_mul_ps(u_scale, u_step[i])); }
+
+        for(daxa_u32 v = 0; v < VSM_PAGE_TABLE_RESOLUTION; v++)
+        {
+            const __m128 v_scale = _mm_set1_ps(static_cast<daxa_f32>(v));
+            __m128 page_position[3];
+            for(daxa_u32 i = 0; i < 3; i++) { page_position[i] = _mm_add_ps(row_position[i], _mm_mul_ps(v_scale, v_step[i])); }
+
+            daxa_f32 * const page_dst = dst + (u * VSM_PAGE_TABLE_RESOLUTION + v) * PAGE_FLOAT_COUNT;
+            for(daxa_u32 i = 0; i < 6; i++)
+            {
+                _mm_storeu_ps(page_dst + i * 4, _mm_add_ps(page_position[i % 3], corner_registers[i]));
+            }
+        }
+    }
+#else
+    for(daxa_u32 u = info.first_row; u < info.first_row + info.row_count; u++)
+    {
+        for(daxa_u32 v = 0; v < VSM_PAGE_TABLE_RESOLUTION; v++)
+        {
+            const std::array<daxa_f32, 3> page_position = {
+                batch.first_page_position.x + u * batch.page_u_step.x + v * batch.page_v_step.x,
+                batch.first_page_position.y + u * batch.page_u_step.y + v * batch.page_v_step.y,
+                batch.first_page_position.z + u * batch.page_u_step.z + v * batch.page_v_step.z
+            };
+            daxa_f32 * const page_dst = dst + (u * VSM_PAGE_TABLE_RESOLUTION + v) * PAGE_FLOAT_COUNT;
+            for(daxa_u32 i = 0; i < PAGE_FLOAT_COUNT; i++) { page_dst[i] = page_position[i % 3] + corners[i]; }
+        }
+    }
+#endif
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <span>
 #include <string>
 #include <variant>
 
@@ -16,6 +18,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "utils.hpp"
+#include "culling.hpp"
 #include "renderer/shared/shared.inl"
 
 using namespace daxa::types;
@@ -59,6 +62,15 @@ struct CameraInfo
     ProjectionInfo projection_info;
 };
 
+// Everything that camera movement changes, restoring a state reproduces the exact same matrices
+struct CameraState
+{
+    daxa_i32vec3 offset;
+    daxa_f32vec3 position;
+    daxa_f32vec3 front;
+    daxa_f32vec3 up;
+};
+
 struct CameraFrustumInfo
 {
     daxa_f32vec3 forward;
@@ -71,6 +83,36 @@ struct WriteVerticesInfo
     std::span<FrustumVertex, 8> vertices_dst;
 };
 
+// All page frusti of a clip level are translated copies of a single frustum,
+// page (u, v) is placed at first_page_position + u * page_u_step + v * page_v_step
+struct PageFrustiBatch
+{
+    daxa_f32vec3 first_page_position;
+    daxa_f32vec3 page_u_step;
+    daxa_f32vec3 page_v_step;
+    std::array<daxa_f32vec3, 8> corner_offsets;
+};
+
+struct WritePageFrustiInfo
+{
+    PageFrustiBatch const & batch;
+    // Rows (u page coordinate) are independent, disjoint row ranges can be written from multiple threads
+    daxa_u32 first_row = 0;
+    daxa_u32 row_count = VSM_PAGE_TABLE_RESOLUTION;
+    std::span<FrustumVertex, VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION * 8> vertices_dst;
+};
+
+// Does not touch any camera state, vertices of page (u, v) are written at (u * VSM_PAGE_TABLE_RESOLUTION + v) * 8
+void write_page_frusti_vertices(WritePageFrustiInfo const & info);
+
+// Page aligned placement of a clip level, together with the sun direction
+// it fully determines the output of align_clip_to_player()
+struct ClipAlignment
+{
+    daxa_i32vec2 page_offset;
+    daxa_i32 sun_height_offset;
+};
+
 struct ClipAlignInfo
 {
     daxa_f32vec2 per_page_depth_offset;
@@ -90,6 +132,9 @@ struct Camera
     void update_front_vector(daxa_f32 x_offset, daxa_f32 y_offset);
     void set_position(daxa_f32vec3 new_position);
     void set_front(daxa_f32vec3 new_front);
+    void set_projection_info(ProjectionInfo const & new_proj_info);
+    void set_state(CameraState const & state);
+    [[nodiscard]] auto get_state() const -> CameraState;
     [[nodiscard]] auto get_camera_position() const -> daxa_f32vec3;
     [[nodiscard]] auto get_view_matrix() -> daxa_f32mat4x4;
     [[nodiscard]] auto get_projection_matrix() -> daxa_f32mat4x4;
@@ -99,10 +144,18 @@ struct Camera
 
     [[nodiscard]] auto get_shadowmap_view_matrix(daxa_f32vec3 const & sun_direction, daxa_i32vec3 const & offset) -> daxa_f32mat4x4;
     [[nodiscard]] auto get_frustum_info() -> CameraFrustumInfo;
+    [[nodiscard]] auto get_frustum_planes() -> FrustumPlanes;
+    [[nodiscard]] auto get_clip_alignment(
+        Camera const * player_camera,
+        daxa_f32vec3 sun_offset,
+        OrthographicInfo const & clip_projection,
+        daxa_i32 sun_offset_factor
+    ) const -> ClipAlignment;
     auto align_clip_to_player(
         Camera const * player_camera,
         daxa_f32vec3 sun_offset,
-        std::span<FrustumVertex, VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION * 8> vertices_space,
+        // Only written when view_page_frusti is set, needs to hold all the page table frusti
+        std::span<FrustumVertex> vertices_space,
         bool view_page_frusti,
         daxa_i32 sun_offset_factor
     ) -> ClipAlignInfo;
@@ -114,6 +167,12 @@ struct Camera
         bool matrix_dirty;
         glm::mat4x4 projection;
         glm::mat4x4 view;
+        // Products and inverses are cached together with the matrices above and
+        // recalculated only when matrix_dirty is set
+        glm::mat4x4 projection_view;
+        glm::mat4x4 inv_projection;
+        glm::mat4x4 inv_view;
+        glm::mat4x4 inv_projection_view;
 
         glm::vec3 position;
         glm::vec3 front;
@@ -0,0 +1,287 @@
+#include "camera_path.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "utils.hpp"
+
+static constexpr daxa_u32 CAMERA_PATH_MAGIC = 0x54504354; // "TCPT"
+static constexpr daxa_u32 CAMERA_PATH_VERSION = 2;
+
+struct CameraPathHeader
+{
+    daxa_u32 magic;
+    daxa_u32 version;
+    daxa_u32 globals_size;
+    daxa_u32 frame_size;
+    daxa_u32 globals_count;
+    daxa_u32 frame_count;
+    daxa_f32 fixed_timestep;
+};
+
+// Fields the renderer overwrites every frame are not part of the recorded state,
+// clearing them lets consecutive frames share a single Globals entry
+static auto strip_per_frame_fields(Globals const & globals) -> Globals
+{
+    auto stripped = globals;
+    stripped.time = 0.0f;
+    stripped.frame_index = 0;
+    stripped.camera_position = {};
+    stripped.offset = {};
+    stripped.view = {};
+    stripped.projection = {};
+    stripped.inv_projection = {};
+    stripped.inv_view_projection = {};
+    stripped.secondary_camera_position = {};
+    stripped.secondary_offset = {};
+    stripped.secondary_view = {};
+    stripped.secondary_projection = {};
+    stripped.secondary_inv_view_projection = {};
+    stripped.camera_front = {};
+    stripped.camera_frust_top_offset = {};
+    stripped.camera_frust_right_offset = {};
+    stripped.vsm_sun_offset = {};
+    stripped.vsm_clip0_texel_world_size = 0.0f;
+    stripped.vsm_page_budget = 0;
+    return stripped;
+}
+
+// World space distance between the two camera states, the position is kept relative to the integer offset
+static auto get_camera_travel(CameraState const & from, CameraState const & to) -> daxa_f64
+{
+    const daxa_f64 x = static_cast<daxa_f64>(to.position.x - from.position.x) - static_cast<daxa_f64>(to.offset.x - from.offset.x);
+    const daxa_f64 y = static_cast<daxa_f64>(to.position.y - from.position.y) - static_cast<daxa_f64>(to.offset.y - from.offset.y);
+    const daxa_f64 z = static_cast<daxa_f64>(to.position.z - from.position.z) - static_cast<daxa_f64>(to.offset.z - from.offset.z);
+    return std::sqrt(x * x + y * y + z * z);
+}
+
+// Angle between the front vectors of the two camera states in degrees
+static auto get_camera_turn_degrees(CameraState const & from, CameraState const & to) -> daxa_f64
+{
+    const daxa_f64 cos_angle =
+        static_cast<daxa_f64>(from.front.x) * static_cast<daxa_f64>(to.front.x) +
+        static_cast<daxa_f64>(from.front.y) * static_cast<daxa_f64>(to.front.y) +
+        static_cast<daxa_f64>(from.front.z) * static_cast<daxa_f64>(to.front.z);
+    return std::acos(std::clamp(cos_angle, -1.0, 1.0)) * 180.0 / 3.14159265358979323846;
+}
+
+void CameraPath::start_recording(daxa_f32 new_fixed_timestep)
+{
+    DBG_ASSERT_TRUE_M(mode == CameraPathMode::IDLE, "[CameraPath::start_recording()] Camera path is already in use");
+    mode = CameraPathMode::RECORDING;
+    fixed_timestep = new_fixed_timestep;
+    frames.clear();
+    globals.clear();
+    timings.clear();
+}
+
+void CameraPath::record_frame(Camera const & main_camera, Camera const & debug_camera, Globals const & frame_globals)
+{
+    if(mode != CameraPathMode::RECORDING) { return; }
+
+    const auto stripped = strip_per_frame_fields(frame_globals);
+    if(globals.empty() || std::memcmp(&globals.back(), &stripped, sizeof(Globals)) != 0)
+    {
+        globals.push_back(stripped);
+    }
+
+    frames.push_back(CameraPathFrame{
+        .main_camera = main_camera.get_state(),
+        .debug_camera = debug_camera.get_state(),
+        .globals_index = static_cast<daxa_u32>(globals.size() - 1)
+    });
+}
+
+void CameraPath::stop_recording(std::string const & path)
+{
+    DBG_ASSERT_TRUE_M(mode == CameraPathMode::RECORDING, "[CameraPath::stop_recording()] Camera path is not recording");
+    mode = CameraPathMode::IDLE;
+
+    auto const parent_path = std::filesystem::path(path).parent_path();
+    if(!parent_path.empty()) { std::filesystem::create_directories(parent_path); }
+
+    auto file = std::ofstream(path, std::ios::binary);
+    if(!file.is_open())
+    {
+        throw std::runtime_error("[CameraPath::stop_recording()] Failed to open " + path + " for writing");
+    }
+
+    const CameraPathHeader header = {
+        .magic = CAMERA_PATH_MAGIC,
+        .version = CAMERA_PATH_VERSION,
+        .globals_size = static_cast<daxa_u32>(sizeof(Globals)),
+        .frame_size = static_cast<daxa_u32>(sizeof(CameraPathFrame)),
+        .globals_count = static_cast<daxa_u32>(globals.size()),
+        .frame_count = static_cast<daxa_u32>(frames.size()),
+        .fixed_timestep = fixed_timestep
+    };
+    file.write(reinterpret_cast<char const *>(&header), sizeof(CameraPathHeader));
+    file.write(reinterpret_cast<char const *>(globals.data()), sizeof(Globals) * globals.size());
+    file.write(reinterpret_cast<char const *>(frames.data()), sizeof(CameraPathFrame) * frames.size());
+
+    DEBUG_OUT("[CameraPath::stop_recording()] Recorded " << frames.size() << " frames with " << globals.size() <<
+              " distinct settings into " << path);
+}
+
+void CameraPath::start_playback(std::string const & path)
+{
+    DBG_ASSERT_TRUE_M(mode == CameraPathMode::IDLE, "[CameraPath::start_playback()] Camera path is already in use");
+
+    auto file = std::ifstream(path, std::ios::binary);
+    if(!file.is_open())
+    {
+        throw std::runtime_error("[CameraPath::start_playback()] Failed to open " + path);
+    }
+
+    CameraPathHeader header = {};
+    file.read(reinterpret_cast<char *>(&header), sizeof(CameraPathHeader));
+    if(!file || header.magic != CAMERA_PATH_MAGIC || header.version != CAMERA_PATH_VERSION)
+    {
+        throw std::runtime_error("[CameraPath::start_playback()] " + path + " is not a camera path track");
+    }
+    if(header.globals_size != sizeof(Globals))
+    {
+        throw std::runtime_error("[CameraPath::start_playback()] " + path + " was recorded with a different Globals layout");
+    }
+    if(header.frame_size != sizeof(CameraPathFrame))
+    {
+        throw std::runtime_error("[CameraPath::start_playback()] " + path + " was recorded with a different CameraPathFrame layout");
+    }
+
+    globals.resize(header.globals_count);
+    frames.resize(header.frame_count);
+    file.read(reinterpret_cast<char *>(globals.data()), sizeof(Globals) * globals.size());
+    file.read(reinterpret_cast<char *>(frames.data()), sizeof(CameraPathFrame) * frames.size());
+    const bool indices_valid = std::all_of(frames.begin(), frames.end(),
+        [&](CameraPathFrame const & frame) { return frame.globals_index < globals.size(); });
+    if(!file || !indices_valid)
+    {
+        throw std::runtime_error("[CameraPath::start_playback()] " + path + " is truncated or corrupted");
+    }
+
+    mode = CameraPathMode::PLAYBACK;
+    fixed_timestep = header.fixed_timestep;
+    playback_path = path;
+    current_frame = 0;
+    timings.clear();
+    timings.reserve(frames.size());
+}
+
+auto CameraPath::playback_frame(Camera & main_camera, Camera & debug_camera, Globals & frame_globals) -> bool
+{
+    if(mode != CameraPathMode::PLAYBACK) { return false; }
+    if(current_frame >= frames.size())
+    {
+        stop_playback();
+        return false;
+    }
+
+    auto const & frame = frames.at(current_frame);
+    main_camera.set_state(frame.main_camera);
+    debug_camera.set_state(frame.debug_camera);
+
+    // Changing the LUT dimensions requires the renderer to recreate its resources, these are kept as they are
+    const auto frame_index = frame_globals.frame_index;
+    const auto trans_lut_dim = frame_globals.trans_lut_dim;
+    const auto mult_lut_dim = frame_globals.mult_lut_dim;
+    const auto sky_lut_dim = frame_globals.sky_lut_dim;
+    frame_globals = globals.at(frame.globals_index);
+    frame_globals.frame_index = frame_index;
+    frame_globals.trans_lut_dim = trans_lut_dim;
+    frame_globals.mult_lut_dim = mult_lut_dim;
+    frame_globals.sky_lut_dim = sky_lut_dim;
+    frame_globals.time = static_cast<daxa_f32>(current_frame) * fixed_timestep;
+
+    current_frame++;
+    return true;
+}
+
+void CameraPath::record_frame_timing(CameraPathFrameTiming const & timing)
+{
+    if(mode != CameraPathMode::PLAYBACK) { return; }
+    timings.push_back(timing);
+}
+
+void CameraPath::stop_playback()
+{
+    if(mode != CameraPathMode::PLAYBACK) { return; }
+    mode = CameraPathMode::IDLE;
+    write_timings_csv();
+}
+
+void CameraPath::write_timings_csv() const
+{
+    if(timings.empty()) { return; }
+
+    const auto csv_path = playback_path + ".timings.csv";
+    auto file = std::ofstream(csv_path);
+    if(!file.is_open())
+    {
+        DEBUG_OUT("[CameraPath::write_timings_csv()] Failed to open " << csv_path << " for writing");
+        return;
+    }
+
+    file << "frame,frame_cpu_ms,draw_cpu_ms,camera_travel,camera_turn_deg,"
+            "vsm_requested_pages,vsm_allocated_pages,vsm_free_allocations,vsm_evicted_pages,"
+            "vsm_failed_allocations,vsm_cleared_pages,vsm_redrawn_pages,vsm_drawn_patches,vsm_invalidated_pages,vsm_resident_pages,vsm_draw_ms";
+    for(daxa_u32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++) { file << ",vsm_resident_clip_" << clip_level; }
+    file << "\n";
+    daxa_f64 total_frame_ms = 0.0;
+    daxa_f64 max_frame_ms = 0.0;
+    for(daxa_u32 frame = 0; frame < timings.size(); frame++)
+    {
+        auto const & timing = timings.at(frame);
+        file << frame << "," << timing.frame_cpu_ms << "," << timing.draw_cpu_ms;
+        total_frame_ms += timing.frame_cpu_ms;
+        max_frame_ms = std::max(max_frame_ms, timing.frame_cpu_ms);
+
+        const bool has_previous_frame = frame > 0 && frame < frames.size();
+        file << "," << (has_previous_frame ? get_camera_travel(frames.at(frame - 1).main_camera, frames.at(frame).main_camera) : 0.0);
+        file << "," << (has_previous_frame ? get_camera_turn_degrees(frames.at(frame - 1).main_camera, frames.at(frame).main_camera) : 0.0);
+
+        // The statistics of a frame are read back by the frame after it, the last played frame has none
+        if(frame + 1 >= timings.size())
+        {
+            file << std::string(11 + VSM_CLIP_LEVELS, ',') << "\n";
+            continue;
+        }
+        auto const & vsm_statistics = timings.at(frame + 1).vsm_statistics;
+        daxa_u32 resident_pages = 0;
+        for(daxa_u32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++) { resident_pages += vsm_statistics.resident_pages[clip_level]; }
+        file << "," << vsm_statistics.requested_pages << "," << vsm_statistics.allocated_pages <<
+                "," << vsm_statistics.free_allocations << "," << vsm_statistics.evicted_pages <<
+                "," << vsm_statistics.failed_allocations << "," << vsm_statistics.cleared_pages <<
+                "," << vsm_statistics.redrawn_pages << "," << vsm_statistics.drawn_patches <<
+                "," << vsm_statistics.invalidated_pages << "," << resident_pages << "," << timings.at(frame + 1).vsm_draw_ms;
+        for(daxa_u32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++) { file << "," << vsm_statistics.resident_pages[clip_level]; }
+        file << "\n";
+    }
+
+    DEBUG_OUT("[CameraPath::write_timings_csv()] Played " << timings.size() << " frames, average CPU frame " <<
+              total_frame_ms / static_cast<daxa_f64>(timings.size()) << " ms, max " << max_frame_ms <<
+              " ms, timings written to " << csv_path);
+}
+
+auto CameraPath::get_mode() const -> CameraPathMode
+{
+    return mode;
+}
+
+auto CameraPath::get_frame_count() const -> daxa_u32
+{
+    return static_cast<daxa_u32>(frames.size());
+}
+
+auto CameraPath::get_current_frame() const -> daxa_u32
+{
+    return current_frame;
+}
+
+auto CameraPath::get_fixed_timestep() const -> daxa_f32
+{
+    return fixed_timestep;
+}
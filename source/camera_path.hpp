@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <daxa/types.hpp>
+
+#include "camera.hpp"
+#include "renderer/shared/shared.inl"
+
+using namespace daxa::types;
+
+enum struct CameraPathMode
+{
+    IDLE,
+    RECORDING,
+    PLAYBACK
+};
+
+struct CameraPathFrame
+{
+    CameraState main_camera;
+    CameraState debug_camera;
+    // Index into CameraPath::globals, consecutive frames with the same settings share one entry
+    daxa_u32 globals_index;
+};
+
+struct CameraPathFrameTiming
+{
+    daxa_f64 frame_cpu_ms;
+    daxa_f64 draw_cpu_ms;
+    // Read back at the end of the frame, so they describe the GPU work of the previous frame
+    VSMStatistics vsm_statistics;
+    daxa_f64 vsm_draw_ms;
+};
+
+// Records the cameras and Globals every frame into a binary track and plays them back frame by frame.
+// Playback does not depend on the speed of the machine, frame i of the track is always rendered with
+// the exact state recorded in frame i and Globals::time advancing by a fixed timestep
+struct CameraPath
+{
+    static constexpr daxa_f32 DEFAULT_FIXED_TIMESTEP = 1.0f / 60.0f;
+    static constexpr char const * DEFAULT_TRACK_PATH = "assets/camera_paths/default.tcp";
+
+    void start_recording(daxa_f32 fixed_timestep = DEFAULT_FIXED_TIMESTEP);
+    void record_frame(Camera const & main_camera, Camera const & debug_camera, Globals const & globals);
+    // Writes the recorded track into path
+    void stop_recording(std::string const & path);
+
+    // Throws when the file is not a camera path track or was recorded with a different Globals layout
+    void start_playback(std::string const & path);
+    // Overwrites the cameras and Globals with the next recorded frame, returns false
+    // and stops the playback once all the frames were played
+    auto playback_frame(Camera & main_camera, Camera & debug_camera, Globals & globals) -> bool;
+    // Timing of the frame last returned by playback_frame()
+    void record_frame_timing(CameraPathFrameTiming const & timing);
+    // Writes the collected timings into <track path>.timings.csv, together with the camera movement
+    // and the VSM statistics of every frame
+    void stop_playback();
+
+    [[nodiscard]] auto get_mode() const -> CameraPathMode;
+    [[nodiscard]] auto get_frame_count() const -> daxa_u32;
+    [[nodiscard]] auto get_current_frame() const -> daxa_u32;
+    [[nodiscard]] auto get_fixed_timestep() const -> daxa_f32;
+
+    private:
+        void write_timings_csv() const;
+
+        CameraPathMode mode = CameraPathMode::IDLE;
+        daxa_f32 fixed_timestep = DEFAULT_FIXED_TIMESTEP;
+        std::vector<CameraPathFrame> frames = {};
+        std::vector<Globals> globals = {};
+        std::vector<CameraPathFrameTiming> timings = {};
+        std::string playback_path = {};
+        daxa_u32 current_frame = 0;
+};
@@ -0,0 +1,196 @@
+#include "culling.hpp"
+
+#include <bit>
+
+#if defined(__AVX__)
+#define CULLING_USE_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#define CULLING_USE_SSE
+#include <immintrin.h>
+#endif
+
+#pragma region simd_wrappers
+#if defined(CULLING_USE_AVX)
+using simd_f32 = __m256;
+static constexpr daxa_u32 SIMD_WIDTH = 8;
+static inline auto simd_load(daxa_f32 const * src) -> simd_f32 { return _mm256_loadu_ps(src); }
+static inline auto simd_set(daxa_f32 value) -> simd_f32 { return _mm256_set1_ps(value); }
+static inline auto simd_add(simd_f32 a, simd_f32 b) -> simd_f32 { return _mm256_add_ps(a, b); }
+static inline auto simd_mul(simd_f32 a, simd_f32 b) -> simd_f32 { return _mm256_mul_ps(a, b); }
+static inline auto simd_ge_mask(simd_f32 a, simd_f32 b) -> daxa_u32 { return static_cast<daxa_u32>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GE_OQ))); }
+#elif defined(CULLING_USE_SSE)
+using simd_f32 = __m128;
+static constexpr daxa_u32 SIMD_WIDTH = 4;
+static inline auto simd_load(daxa_f32 const * src) -> simd_f32 { return _mm_loadu_ps(src); }
+static inline auto simd_set(daxa_f32 value) -> simd_f32 { return _mm_set1_ps(value); }
+static inline auto simd_add(simd_f32 a, simd_f32 b) -> simd_f32 { return _mm_add_ps(a, b); }
+static inline auto simd_mul(simd_f32 a, simd_f32 b) -> simd_f32 { return _mm_mul_ps(a, b); }
+static inline auto simd_ge_mask(simd_f32 a, simd_f32 b) -> daxa_u32 { return static_cast<daxa_u32>(_mm_movemask_ps(_mm_cmpge_ps(a, b))); }
+#else
+static constexpr daxa_u32 SIMD_WIDTH = 1;
+#endif
+#pragma endregion
+
+#if defined(CULLING_USE_AVX) || defined(CULLING_USE_SSE)
+// Appends base_index + i for every set bit i of the visibility mask
+static inline void append_visible(daxa_u32 mask, daxa_u32 base_index, std::vector<daxa_u32> & visible_indices)
+{
+    while(mask != 0)
+    {
+        visible_indices.push_back(base_index + static_cast<daxa_u32>(std::countr_zero(mask)));
+        mask &= mask - 1;
+    }
+}
+#endif
+
+void AABBBatch::push_back(daxa_f32vec3 min, daxa_f32vec3 max)
+{
+    min_x.push_back(min.x);
+    min_y.push_back(min.y);
+    min_z.push_back(min.z);
+    max_x.push_back(max.x);
+    max_y.push_back(max.y);
+    max_z.push_back(max.z);
+}
+
+void AABBBatch::clear()
+{
+    for(auto * component : {&min_x, &min_y, &min_z, &max_x, &max_y, &max_z}) { component->clear(); }
+}
+
+auto AABBBatch::size() const -> daxa_u32
+{
+    return static_cast<daxa_u32>(min_x.size());
+}
+
+void SphereBatch::push_back(daxa_f32vec3 center, daxa_f32 sphere_radius)
+{
+    center_x.push_back(center.x);
+    center_y.push_back(center.y);
+    center_z.push_back(center.z);
+    radius.push_back(sphere_radius);
+}
+
+void SphereBatch::clear()
+{
+    for(auto * component : {&center_x, &center_y, &center_z, &radius}) { component->clear(); }
+}
+
+auto SphereBatch::size() const -> daxa_u32
+{
+    return static_cast<daxa_u32>(center_x.size());
+}
+
+auto get_culling_simd_width() -> daxa_u32
+{
+    return SIMD_WIDTH;
+}
+
+auto cull_aabbs(FrustumPlanes const & frustum, AABBBatch const & batch, std::vector<daxa_u32> & visible_indices) -> daxa_u32
+{
+    const auto initial_size = visible_indices.size();
+    const daxa_u32 count = batch.size();
+
+    // The box corner furthest along the plane normal (positive vertex) is selected per plane
+    // by picking the min or max arrays, the box is outside when this corner is behind the plane
+    struct PlaneArrays
+    {
+        daxa_f32 const * x;
+        daxa_f32 const * y;
+        daxa_f32 const * z;
+    };
+    std::array<PlaneArrays, PLANE_COUNT> positive_vertices;
+    for(daxa_u32 plane_idx = 0; plane_idx < PLANE_COUNT; plane_idx++)
+    {
+        auto const & plane = frustum.planes.at(plane_idx);
+        positive_vertices.at(plane_idx) = {
+            .x = plane.x >= 0.0f ? batch.max_x.data() : batch.min_x.data(),
+            .y = plane.y >= 0.0f ? batch.max_y.data() : batch.min_y.data(),
+            .z = plane.z >= 0.0f ? batch.max_z.data() : batch.min_z.data()
+        };
+    }
+
+    daxa_u32 index = 0;
+#if defined(CULLING_USE_AVX) || defined(CULLING_USE_SSE)
+    static constexpr daxa_u32 FULL_MASK = (1u << SIMD_WIDTH) - 1u;
+    for(; index + SIMD_WIDTH <= count; index += SIMD_WIDTH)
+    {
+        daxa_u32 visible_mask = FULL_MASK;
+        for(daxa_u32 plane_idx = 0; plane_idx < PLANE_COUNT && visible_mask != 0; plane_idx++)
+        {
+            auto const & plane = frustum.planes[plane_idx];
+            auto const & vertex = positive_vertices[plane_idx];
+            const simd_f32 distance = simd_add(
+                simd_add(
+                    simd_mul(simd_load(vertex.x + index), simd_set(plane.x)),
+                    simd_mul(simd_load(vertex.y + index), simd_set(plane.y))
+                ),
+                simd_add(
+                    simd_mul(simd_load(vertex.z + index), simd_set(plane.z)),
+                    simd_set(plane.w)
+                )
+            );
+            visible_mask &= simd_ge_mask(distance, simd_set(0.0f));
+        }
+        append_visible(visible_mask, index, visible_indices);
+    }
+#endif
+    for(; index < count; index++)
+    {
+        bool visible = true;
+        for(daxa_u32 plane_idx = 0; plane_idx < PLANE_COUNT && visible; plane_idx++)
+        {
+            auto const & plane = frustum.planes[plane_idx];
+            auto const & vertex = positive_vertices[plane_idx];
+            const daxa_f32 distance = (vertex.x[index] * plane.x + vertex.y[index] * plane.y) + (vertex.z[index] * plane.z + plane.w);
+            visible = distance >= 0.0f;
+        }
+        if(visible) { visible_indices.push_back(index); }
+    }
+    return static_cast<daxa_u32>(visible_indices.size() - initial_size);
+}
+
+auto cull_spheres(FrustumPlanes const & frustum, SphereBatch const & batch, std::vector<daxa_u32> & visible_indices) -> daxa_u32
+{
+    const auto initial_size = visible_indices.size();
+    const daxa_u32 count = batch.size();
+
+    daxa_u32 index = 0;
+#if defined(CULLING_USE_AVX) || defined(CULLING_USE_SSE)
+    static constexpr daxa_u32 FULL_MASK = (1u << SIMD_WIDTH) - 1u;
+    for(; index + SIMD_WIDTH <= count; index += SIMD_WIDTH)
+    {
+        const simd_f32 center_x = simd_load(batch.center_x.data() + index);
+        const simd_f32 center_y = simd_load(batch.center_y.data() + index);
+        const simd_f32 center_z = simd_load(batch.center_z.data() + index);
+        const simd_f32 negative_radius = simd_mul(simd_load(batch.radius.data() + index), simd_set(-1.0f));
+
+        daxa_u32 visible_mask = FULL_MASK;
+        for(daxa_u32 plane_idx = 0; plane_idx < PLANE_COUNT && visible_mask != 0; plane_idx++)
+        {
+            auto const & plane = frustum.planes[plane_idx];
+            const simd_f32 distance = simd_add(
+                simd_add(simd_mul(center_x, simd_set(plane.x)), simd_mul(center_y, simd_set(plane.y))),
+                simd_add(simd_mul(center_z, simd_set(plane.z)), simd_set(plane.w))
+            );
+            visible_mask &= simd_ge_mask(distance, negative_radius);
+        }
+        append_visible(visible_mask, index, visible_indices);
+    }
+#endif
+    for(; index < count; index++)
+    {
+        bool visible = true;
+        for(daxa_u32 plane_idx = 0; plane_idx < PLANE_COUNT && visible; plane_idx++)
+        {
+            auto const & plane = frustum.planes[plane_idx];
+            const daxa_f32 distance =
+                (batch.center_x[index] * plane.x + batch.center_y[index] * plane.y) +
+                (batch.center_z[index] * plane.z + plane.w);
+            visible = distance >= -batch.radius[index];
+        }
+        if(visible) { visible_indices.push_back(index); }
+    }
+    return static_cast<daxa_u32>(visible_indices.size() - initial_size);
+}
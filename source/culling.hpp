@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <daxa/types.hpp>
+
+using namespace daxa::types;
+
+enum FrustumPlane
+{
+    LEFT_PLANE,
+    RIGHT_PLANE,
+    BOTTOM_PLANE,
+    TOP_PLANE,
+    NEAR_PLANE,
+    FAR_PLANE,
+    PLANE_COUNT
+};
+
+// World space planes with normals pointing inside of the frustum, point p is inside of a plane
+// when dot(plane.xyz, p) + plane.w >= 0. Missing planes (infinite far plane) always pass
+struct FrustumPlanes
+{
+    std::array<daxa_f32vec4, PLANE_COUNT> planes;
+};
+
+// Volumes are stored in SoA layout so that a single SIMD instruction tests multiple volumes against one plane
+struct AABBBatch
+{
+    std::vector<daxa_f32> min_x;
+    std::vector<daxa_f32> min_y;
+    std::vector<daxa_f32> min_z;
+    std::vector<daxa_f32> max_x;
+    std::vector<daxa_f32> max_y;
+    std::vector<daxa_f32> max_z;
+
+    void push_back(daxa_f32vec3 min, daxa_f32vec3 max);
+    void clear();
+    [[nodiscard]] auto size() const -> daxa_u32;
+};
+
+struct SphereBatch
+{
+    std::vector<daxa_f32> center_x;
+    std::vector<daxa_f32> center_y;
+    std::vector<daxa_f32> center_z;
+    std::vector<daxa_f32> radius;
+
+    void push_back(daxa_f32vec3 center, daxa_f32 sphere_radius);
+    void clear();
+    [[nodiscard]] auto size() const -> daxa_u32;
+};
+
+// Number of volumes tested by a single instruction, 8 with AVX, 4 with SSE and 1 for the scalar fallback
+[[nodiscard]] auto get_culling_simd_width() -> daxa_u32;
+
+// Indices of the volumes intersecting the frustum are appended in ascending order into visible_indices,
+// returns the number of appended indices. Conservative, volumes near the frustum corners can be reported visible
+auto cull_aabbs(FrustumPlanes const & frustum, AABBBatch const & batch, std::vector<daxa_u32> & visible_indices) -> daxa_u32;
+auto cull_spheres(FrustumPlanes const & frustum, SphereBatch const & batch, std::vector<daxa_u32> & visible_indices) -> daxa_u32;
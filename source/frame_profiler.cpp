@@ -0,0 +1,210 @@
+#include "frame_profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include <nlohmann/json.hpp>
+
+thread_local FrameProfiler::ThreadEvents * FrameProfiler::local_thread_events = nullptr;
+thread_local daxa_u32 FrameProfiler::local_thread_depth = 0;
+
+FrameProfiler::Scope::Scope(char const * name) :
+    name{name}
+{
+    auto & profiler = FrameProfiler::get();
+    // The first scope of a thread allocates its ring buffer, this is kept out of the measured time
+    static_cast<void>(profiler.get_thread_events());
+    local_thread_depth += 1;
+    start_ns = profiler.now_ns();
+}
+
+FrameProfiler::Scope::~Scope()
+{
+    auto & profiler = FrameProfiler::get();
+    local_thread_depth -= 1;
+    profiler.record(name, start_ns, profiler.now_ns(), local_thread_depth);
+}
+
+FrameProfiler::FrameProfiler() : epoch{Clock::now()}
+{
+}
+
+auto FrameProfiler::get() -> FrameProfiler &
+{
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+auto FrameProfiler::now_ns() const -> daxa_u64
+{
+    return static_cast<daxa_u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count());
+}
+
+auto FrameProfiler::get_thread_events() -> ThreadEvents &
+{
+    if(local_thread_events == nullptr)
+    {
+        auto lock = std::lock_guard(threads_mutex);
+        threads.push_back(std::make_unique<ThreadEvents>());
+        threads.back()->thread_index = static_cast<daxa_u32>(threads.size() - 1);
+        local_thread_events = threads.back().get();
+    }
+    return *local_thread_events;
+}
+
+void FrameProfiler::record(char const * name, daxa_u64 start_ns, daxa_u64 end_ns, daxa_u32 depth)
+{
+    auto & local_events = get_thread_events();
+    const daxa_u64 write_index = local_events.write_index.load(std::memory_order_relaxed);
+    local_events.events[write_index % THREAD_EVENT_CAPACITY] = FrameProfileEvent{
+        .name = name,
+        .start_ns = start_ns,
+        .duration_ns = end_ns - start_ns,
+        .frame_index = frame_index.load(std::memory_order_relaxed),
+        .depth = depth,
+        .thread_index = local_events.thread_index
+    };
+    local_events.write_index.store(write_index + 1, std::memory_order_release);
+}
+
+void FrameProfiler::record_counter(char const * name, daxa_f64 value)
+{
+    auto & local_events = get_thread_events();
+    const daxa_u64 write_index = local_events.counter_write_index.load(std::memory_order_relaxed);
+    local_events.counters[write_index % THREAD_COUNTER_CAPACITY] = FrameProfileCounter{
+        .name = name,
+        .value = value,
+        .time_ns = now_ns(),
+        .frame_index = frame_index.load(std::memory_order_relaxed)
+    };
+    local_events.counter_write_index.store(write_index + 1, std::memory_order_release);
+}
+
+void FrameProfiler::begin_frame()
+{
+    const daxa_u64 now = now_ns();
+    if(frame_index.load(std::memory_order_relaxed) > 0)
+    {
+        frame_history.at(completed_frames % FRAME_HISTORY) = FrameProfileFrame{
+            .frame_index = frame_index.load(std::memory_order_relaxed),
+            .start_ns = frame_start_ns,
+            .duration_ns = now - frame_start_ns
+        };
+        completed_frames += 1;
+    }
+    frame_start_ns = now;
+    frame_index.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto FrameProfiler::get_frame_index() const -> daxa_u64
+{
+    return frame_index.load(std::memory_order_relaxed);
+}
+
+auto FrameProfiler::collect_events(bool only_frame, daxa_u64 requested_frame) const -> std::vector<FrameProfileEvent>
+{
+    std::vector<FrameProfileEvent> collected;
+    auto lock = std::lock_guard(threads_mutex);
+    for(auto const & local_events : threads)
+    {
+        const daxa_u64 write_index = local_events->write_index.load(std::memory_order_acquire);
+        const daxa_u64 first_index = write_index > THREAD_EVENT_CAPACITY ? write_index - THREAD_EVENT_CAPACITY : 0;
+        for(daxa_u64 event_index = first_index; event_index < write_index; event_index++)
+        {
+            auto const & event = local_events->events[event_index % THREAD_EVENT_CAPACITY];
+            if(only_frame && event.frame_index != requested_frame) { continue; }
+            collected.push_back(event);
+        }
+    }
+    // Scopes are recorded when they close, sorting by start restores the nesting order
+    std::sort(collected.begin(), collected.end(), [](FrameProfileEvent const & first, FrameProfileEvent const & second)
+    {
+        if(first.thread_index != second.thread_index) { return first.thread_index < second.thread_index; }
+        if(first.start_ns != second.start_ns) { return first.start_ns < second.start_ns; }
+        return first.depth < second.depth;
+    });
+    return collected;
+}
+
+auto FrameProfiler::collect_counters(bool only_frame, daxa_u64 requested_frame) const -> std::vector<FrameProfileCounter>
+{
+    std::vector<FrameProfileCounter> collected;
+    auto lock = std::lock_guard(threads_mutex);
+    for(auto const & local_events : threads)
+    {
+        const daxa_u64 write_index = local_events->counter_write_index.load(std::memory_order_acquire);
+        const daxa_u64 first_index = write_index > THREAD_COUNTER_CAPACITY ? write_index - THREAD_COUNTER_CAPACITY : 0;
+        for(daxa_u64 counter_index = first_index; counter_index < write_index; counter_index++)
+        {
+            auto const & counter = local_events->counters[counter_index % THREAD_COUNTER_CAPACITY];
+            if(only_frame && counter.frame_index != requested_frame) { continue; }
+            collected.push_back(counter);
+        }
+    }
+    return collected;
+}
+
+auto FrameProfiler::get_frame_events(daxa_u64 requested_frame) const -> std::vector<FrameProfileEvent>
+{
+    return collect_events(true, requested_frame);
+}
+
+auto FrameProfiler::get_frame_counters(daxa_u64 requested_frame) const -> std::vector<FrameProfileCounter>
+{
+    return collect_counters(true, requested_frame);
+}
+
+auto FrameProfiler::get_frame_history() const -> std::vector<FrameProfileFrame>
+{
+    const daxa_u64 frame_count = std::min<daxa_u64>(completed_frames, FRAME_HISTORY);
+    std::vector<FrameProfileFrame> history;
+    history.reserve(frame_count);
+    for(daxa_u64 frame = completed_frames - frame_count; frame < completed_frames; frame++)
+    {
+        history.push_back(frame_history.at(frame % FRAME_HISTORY));
+    }
+    return history;
+}
+
+void FrameProfiler::write_chrome_trace(std::string const & path) const
+{
+    auto const events = collect_events(false, 0);
+
+    auto trace_events = nlohmann::json::array();
+    for(auto const & event : events)
+    {
+        trace_events.push_back({
+            {"name", event.name},
+            {"cat", "frame"},
+            {"ph", "X"},
+            {"ts", static_cast<daxa_f64>(event.start_ns) / 1000.0},
+            {"dur", static_cast<daxa_f64>(event.duration_ns) / 1000.0},
+            {"pid", 0},
+            {"tid", event.thread_index},
+            {"args", {{"frame", event.frame_index}}}
+        });
+    }
+    for(auto const & counter : collect_counters(false, 0))
+    {
+        trace_events.push_back({
+            {"name", counter.name},
+            {"cat", "counter"},
+            {"ph", "C"},
+            {"ts", static_cast<daxa_f64>(counter.time_ns) / 1000.0},
+            {"pid", 0},
+            {"args", {{"value", counter.value}}}
+        });
+    }
+
+    auto json = nlohmann::json {};
+    json["traceEvents"] = trace_events;
+    json["displayTimeUnit"] = "ms";
+
+    auto f = std::ofstream(path);
+    if(!f.is_open())
+    {
+        throw std::runtime_error("[FrameProfiler::write_chrome_trace()] Error unable to open file: " + path);
+    }
+    f << json;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+// Scoped timers are compiled out unless TENEBRIS_FRAME_PROFILER is defined, the profiler itself
+// stays available so the overlay and trace export do not need to be guarded
+#if defined(TENEBRIS_FRAME_PROFILER)
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+// Name has to be a string literal, only the pointer is stored
+#define PROFILE_SCOPE(name) FrameProfiler::Scope PROFILER_CONCAT(profile_scope_, __LINE__)(name)
+// Value sampled once per frame, shown as a counter track next to the scopes of the trace
+#define PROFILE_COUNTER(name, value) FrameProfiler::get().record_counter(name, static_cast<daxa_f64>(value))
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_COUNTER(name, value)
+#endif
+
+struct FrameProfileEvent
+{
+    char const * name;
+    // Both relative to the creation of the profiler
+    daxa_u64 start_ns;
+    daxa_u64 duration_ns;
+    daxa_u64 frame_index;
+    daxa_u32 depth;
+    // Ordinal of the thread in the order in which the threads recorded their first scope
+    daxa_u32 thread_index;
+};
+
+struct FrameProfileCounter
+{
+    char const * name;
+    daxa_f64 value;
+    // Relative to the creation of the profiler
+    daxa_u64 time_ns;
+    daxa_u64 frame_index;
+};
+
+struct FrameProfileFrame
+{
+    daxa_u64 frame_index;
+    daxa_u64 start_ns;
+    daxa_u64 duration_ns;
+};
+
+// Hierarchical CPU scope timer. Every thread records into its own fixed size ring buffer
+// so recording a scope never locks or allocates, the oldest events are overwritten
+struct FrameProfiler
+{
+    using Clock = std::chrono::steady_clock;
+    static constexpr daxa_u32 THREAD_EVENT_CAPACITY = 1u << 14;
+    static constexpr daxa_u32 THREAD_COUNTER_CAPACITY = 1u << 12;
+    static constexpr daxa_u32 FRAME_HISTORY = 256;
+
+    struct Scope
+    {
+        Scope(Scope const &) = delete;
+        Scope & operator= (Scope const &) = delete;
+
+        explicit Scope(char const * name);
+        ~Scope();
+
+        private:
+            char const * name;
+            daxa_u64 start_ns;
+    };
+
+    [[nodiscard]] static auto get() -> FrameProfiler &;
+
+    // Closes the previous frame and opens a new one, called once per iteration of the main loop
+    void begin_frame();
+    [[nodiscard]] auto get_frame_index() const -> daxa_u64;
+    // Name has to be a string literal, only the pointer is stored
+    void record_counter(char const * name, daxa_f64 value);
+
+    // Events of the given frame from all threads, sorted by thread and start time
+    [[nodiscard]] auto get_frame_events(daxa_u64 frame_index) const -> std::vector<FrameProfileEvent>;
+    // Counters of the given frame from all threads, in the order in which they were recorded by each thread
+    [[nodiscard]] auto get_frame_counters(daxa_u64 frame_index) const -> std::vector<FrameProfileCounter>;
+    // Completed frames, oldest first
+    [[nodiscard]] auto get_frame_history() const -> std::vector<FrameProfileFrame>;
+
+    // Trace Event Format readable by chrome://tracing or https://ui.perfetto.dev,
+    // contains all the events and counters still held by the ring buffers
+    void write_chrome_trace(std::string const & path) const;
+
+    private:
+        struct ThreadEvents
+        {
+            daxa_u32 thread_index;
+            // Only written by the owning thread, readers may observe events which are
+            // being overwritten when the ring wraps during the read
+            std::atomic<daxa_u64> write_index = 0;
+            std::array<FrameProfileEvent, THREAD_EVENT_CAPACITY> events;
+            std::atomic<daxa_u64> counter_write_index = 0;
+            std::array<FrameProfileCounter, THREAD_COUNTER_CAPACITY> counters;
+        };
+
+        FrameProfiler();
+        [[nodiscard]] auto now_ns() const -> daxa_u64;
+        [[nodiscard]] auto get_thread_events() -> ThreadEvents &;
+        void record(char const * name, daxa_u64 start_ns, daxa_u64 end_ns, daxa_u32 depth);
+        [[nodiscard]] auto collect_events(bool only_frame, daxa_u64 frame_index) const -> std::vector<FrameProfileEvent>;
+        [[nodiscard]] auto collect_counters(bool only_frame, daxa_u64 frame_index) const -> std::vector<FrameProfileCounter>;
+
+        static thread_local ThreadEvents * local_thread_events;
+        static thread_local daxa_u32 local_thread_depth;
+
+        Clock::time_point epoch;
+        std::atomic<daxa_u64> frame_index = 0;
+        daxa_u64 frame_start_ns = 0;
+        std::array<FrameProfileFrame, FRAME_HISTORY> frame_history = {};
+        daxa_u64 completed_frames = 0;
+
+        mutable std::mutex threads_mutex;
+        // Never freed so that the events of finished worker threads stay readable
+        std::vector<std::unique_ptr<ThreadEvents>> threads;
+};
@@ -3,8 +3,14 @@
 #include <nlohmann/json.hpp>
 #include <daxa/utils/imgui.hpp>
 #include <imgui_impl_glfw.h>
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <format>
+#include <stdexcept>
+
+#include "frame_profiler.hpp"
+#include "utils.hpp"
 
 GuiManager::GuiManager(GuiManagerInfo const & info) : 
     info{info},
@@ -16,7 +22,7 @@ GuiManager::GuiManager(GuiManagerInfo const & info) :
 {
     file_browser.SetTypeFilters(std::vector<std::string>{".json"});
     file_browser.SetPwd("assets/gui_state");
-    curr_path = "assets/gui_state/defaults.json";
+    curr_path = info.preset_path;
     globals.lambda = 1.0f;
     load(curr_path, true);
     globals.use_debug_camera = false;
@@ -73,10 +79,6 @@ void GuiManager::on_update()
     ImGui::SliderFloat("Lambda", &globals.lambda, 0.0, 1.0);
     ImGui::SliderFloat("Min luminance", &min_luminance, 0.0, 10.0);
     ImGui::SliderFloat("Max luminance", &max_luminance, 0.0, 10.0);
-    max_luminance = max_luminance < min_luminance ? min_luminance + 0.1 : max_luminance;
-    globals.min_luminance_log2 = std::log2(min_luminance);
-    globals.max_luminance_log2 = std::log2(max_luminance);
-    globals.inv_luminance_range_log2 = 1.0f / (globals.max_luminance_log2 - globals.min_luminance_log2);
 
     ImGui::PlotHistogram(
         "##Luminance histogram",
@@ -84,7 +86,7 @@ void GuiManager::on_update()
             auto typed_data = reinterpret_cast<Histogram*>(data);
             return static_cast<float>(typed_data[idx].bin_count);
         },
-        reinterpret_cast<void *>(info.renderer->context.cpu_histogram.data()),
+        reinterpret_cast<void *>(info.renderer->context.frame.cpu_histogram.data()),
         HISTOGRAM_BIN_COUNT, 0, NULL, 0.0f, 40000.0f, ImVec2(0, 80.0)
     );
 
@@ -153,30 +155,198 @@ void GuiManager::on_update()
     ImGui::SliderFloat("Horizontal angle", &sun_angle.x, 0.0f, 360.0f);
     ImGui::SliderFloat("Vertical angle", &sun_angle.y, 0.0f, 180.0f);
 
-    globals.sun_direction =
-    {
-        daxa_f32(glm::cos(glm::radians(sun_angle.x)) * glm::sin(glm::radians(sun_angle.y))),
-        daxa_f32(glm::sin(glm::radians(sun_angle.x)) * glm::sin(glm::radians(sun_angle.y))),
-        daxa_f32(glm::cos(glm::radians(sun_angle.y)))
-    };
 
     ImGui::SliderFloat("Atmosphere bottom", &globals.atmosphere_bottom, 1.0f, 20000.0f);
     globals.atmosphere_top = glm::max(globals.atmosphere_bottom + 10.0f, globals.atmosphere_top);
     ImGui::SliderFloat("Atmosphere top", &globals.atmosphere_top, globals.atmosphere_bottom + 10.0f, 20000.0f);
     ImGui::SliderFloat("mie scale height", &globals.mie_scale_height, 0.1f, 100.0f);
-    globals.mie_density[1].exp_scale = -1.0f / globals.mie_scale_height;
     ImGui::SliderFloat("rayleigh scale height", &globals.rayleigh_scale_height, 0.1f, 100.0f);
-    globals.rayleigh_density[1].exp_scale = -1.0f / globals.rayleigh_scale_height;
+    ImGui::End();
+
+    ImGui::Begin("Residency");
+    auto & residency = info.renderer->context.residency;
+    auto const to_mib = [](daxa_u64 bytes) -> daxa_f32 { return static_cast<daxa_f32>(bytes) / (1024.0f * 1024.0f); };
+    daxa_i32 budget_mib = static_cast<daxa_i32>(residency.get_budget() / (1024ull * 1024ull));
+    ImGui::SliderInt("Budget (MiB)", &budget_mib, 256, 16384);
+    if(ImGui::IsItemDeactivatedAfterEdit())
+    {
+        residency.set_budget(static_cast<daxa_u64>(budget_mib) * 1024ull * 1024ull);
+        info.renderer->update_quality_tiers();
+    }
+    ImGui::Text("Quality tier: %s", std::string(info.renderer->context.quality_tiers.name).c_str());
+    ImGui::Text("Total tracked: %.2f MiB", to_mib(residency.get_total_usage()));
+    for(daxa_u32 category = 0; category < static_cast<daxa_u32>(ResidencyCategory::COUNT); category++)
+    {
+        ImGui::Text("\t %s: %.2f MiB",
+            std::string(residency_category_names.at(category)).c_str(),
+            to_mib(residency.get_category_usage(static_cast<ResidencyCategory>(category)))
+        );
+    }
+    ImGui::End();
+
+    ImGui::Begin("Shader cache");
+    auto const & shader_cache_statistics = info.renderer->shader_cache.get_statistics();
+    ImGui::Text("Folder: %s", info.renderer->shader_cache.get_folder().string().c_str());
+    ImGui::Text("Stage hits: %u misses: %u", shader_cache_statistics.stage_hits, shader_cache_statistics.stage_misses);
+    ImGui::Text("Startup pipeline creation: %.1f ms", shader_cache_statistics.compile_ms);
+    ImGui::Text("Size: %.2f MiB, evicted files: %u", to_mib(shader_cache_statistics.size_bytes), shader_cache_statistics.evicted_files);
+    ImGui::End();
+
+    ImGui::Begin("Camera path");
+    auto & camera_path = *info.camera_path;
+    const auto camera_path_mode = camera_path.get_mode();
+    // A missing, foreign or truncated track must not take the application down, the error is shown instead
+    auto try_camera_path_action = [&](auto && action)
+    {
+        try
+        {
+            action();
+            camera_path_error.clear();
+        }
+        catch(std::runtime_error const & error)
+        {
+            camera_path_error = error.what();
+            DEBUG_OUT("[GuiManager::on_update()] " << camera_path_error);
+        }
+    };
+    if(camera_path_mode == CameraPathMode::IDLE)
+    {
+        if(ImGui::Button("Record", {150, 20})) { camera_path.start_recording(); }
+        ImGui::SameLine();
+        const bool track_exists = std::filesystem::exists(CameraPath::DEFAULT_TRACK_PATH);
+        if(!track_exists) { ImGui::BeginDisabled(); }
+        if(ImGui::Button("Play", {150, 20}))
+        {
+            try_camera_path_action([&] { camera_path.start_playback(CameraPath::DEFAULT_TRACK_PATH); });
+        }
+        if(!track_exists) { ImGui::EndDisabled(); }
+    } else if(camera_path_mode == CameraPathMode::RECORDING) {
+        if(ImGui::Button("Stop recording", {150, 20}))
+        {
+            try_camera_path_action([&] { camera_path.stop_recording(CameraPath::DEFAULT_TRACK_PATH); });
+        }
+        ImGui::Text("Recorded frames: %u", camera_path.get_frame_count());
+    } else {
+        if(ImGui::Button("Stop playback", {150, 20})) { camera_path.stop_playback(); }
+        ImGui::Text("Frame %u / %u", camera_path.get_current_frame(), camera_path.get_frame_count());
+    }
+    ImGui::Text("Track: %s", CameraPath::DEFAULT_TRACK_PATH);
+    if(!camera_path_error.empty()) { ImGui::TextColored({1.0f, 0.3f, 0.3f, 1.0f}, "%s", camera_path_error.c_str()); }
+    ImGui::End();
+
+    ImGui::Begin("Frame profiler");
+#if defined(TENEBRIS_FRAME_PROFILER)
+    auto & profiler = FrameProfiler::get();
+    auto const frame_history = profiler.get_frame_history();
+    std::vector<daxa_f32> frame_times_ms(frame_history.size());
+    std::transform(frame_history.begin(), frame_history.end(), frame_times_ms.begin(), [](auto const & frame)
+        { return static_cast<daxa_f32>(frame.duration_ns) / 1'000'000.0f; });
+    if(!frame_times_ms.empty())
+    {
+        ImGui::PlotLines("Frame (ms)", frame_times_ms.data(), static_cast<daxa_i32>(frame_times_ms.size()), 0,
+            std::format("{:.2f} ms", frame_times_ms.back()).c_str(), 0.0f, FLT_MAX, {0, 60});
+    }
+    // The current frame is still being recorded, show the last completed one
+    const daxa_u64 shown_frame = profiler.get_frame_index() - 1;
+    for(auto const & event : profiler.get_frame_events(shown_frame))
+    {
+        ImGui::Text("%*s%s: %.3f ms [thread %u]", static_cast<daxa_i32>(2 * event.depth), "", event.name,
+            static_cast<daxa_f64>(event.duration_ns) / 1'000'000.0, event.thread_index);
+    }
+    if(ImGui::Button("Write Chrome trace", {150, 20})) { profiler.write_chrome_trace("frame_trace.json"); }
+#else
+    ImGui::Text("Compiled without TENEBRIS_FRAME_PROFILER");
+#endif
+    ImGui::End();
+
+    ImGui::Begin("VSM clip map");
+    auto const & clip_map_statistics = info.renderer->context.frame.vsm_clip_map.get_statistics();
+    ImGui::Text("Levels updated this frame: %u", clip_map_statistics.levels_updated);
+    ImGui::Text("Levels uploaded this frame: %u", clip_map_statistics.levels_uploaded);
+    ImGui::Text("Average levels updated per frame: %.2f", 
+        clip_map_statistics.total_updates == 0 ? 0.0 :
+        static_cast<daxa_f64>(clip_map_statistics.total_levels_updated) / static_cast<daxa_f64>(clip_map_statistics.total_updates)
+    );
+
+    auto & sun_invalidation = info.renderer->context.frame.vsm_sun_invalidation;
+    auto sun_invalidation_info = sun_invalidation.get_info();
+    auto max_levels_per_frame = static_cast<daxa_i32>(sun_invalidation_info.max_levels_per_frame);
+    auto max_pages_per_frame = static_cast<daxa_i32>(sun_invalidation_info.max_pages_per_frame);
+    bool coarse_first = sun_invalidation_info.order == VSMInvalidationOrder::COARSE_FIRST;
+    bool sun_invalidation_changed = ImGui::SliderFloat("Sun quantization degrees", &sun_invalidation_info.quantization_degrees, 0.0f, 5.0f);
+    sun_invalidation_changed |= ImGui::SliderInt("Levels switched per frame", &max_levels_per_frame, 1, VSM_CLIP_LEVELS);
+    // A single clip level holds at most a whole page table worth of pages
+    sun_invalidation_changed |= ImGui::SliderInt("Pages invalidated per frame", &max_pages_per_frame, 1, VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION);
+    sun_invalidation_changed |= ImGui::Checkbox("Switch coarse levels first", &coarse_first);
+    if(sun_invalidation_changed)
+    {
+        sun_invalidation_info.max_levels_per_frame = static_cast<daxa_u32>(max_levels_per_frame);
+        sun_invalidation_info.max_pages_per_frame = static_cast<daxa_u32>(max_pages_per_frame);
+        sun_invalidation_info.order = coarse_first ? VSMInvalidationOrder::COARSE_FIRST : VSMInvalidationOrder::FINE_FIRST;
+        sun_invalidation.set_info(sun_invalidation_info);
+    }
+    auto const & sun_invalidation_statistics = sun_invalidation.get_statistics();
+    ImGui::Text("Levels switched to the new sun direction: %u, %u pages",
+        sun_invalidation_statistics.invalidated_levels, sun_invalidation_statistics.invalidated_pages);
+    ImGui::Text("Levels with an older sun direction: %u", sun_invalidation_statistics.stale_levels);
+    ImGui::End();
+
+    ImGui::Begin("VSM statistics");
+    auto const & vsm_frame = info.renderer->context.frame;
+    auto const & vsm_statistics = vsm_frame.vsm_statistics;
+    ImGui::Text("Previous frame, read back from the GPU");
+    ImGui::Text("Requested pages: %u", vsm_statistics.requested_pages);
+    ImGui::Text("Allocated pages: %u (budget %u)", vsm_statistics.allocated_pages, vsm_frame.vsm_page_budget.get_budget());
+    ImGui::Text("\t from free pages: %u", vsm_statistics.free_allocations);
+    ImGui::Text("\t by eviction: %u", vsm_statistics.evicted_pages);
+    ImGui::Text("\t failed: %u", vsm_statistics.failed_allocations);
+    ImGui::Text("Cleared pages: %u", vsm_statistics.cleared_pages);
+    ImGui::Text("Redrawn pages: %u", vsm_statistics.redrawn_pages);
+    ImGui::Text("Drawn terrain patches: %u", vsm_statistics.drawn_patches);
+    ImGui::Text("Pages invalidated by the sun: %u", vsm_statistics.invalidated_pages);
+    ImGui::Text("Page draw: %.3f ms", vsm_frame.vsm_draw_ms);
+    ImGui::Text("Resident pages: %u", get_vsm_resident_page_count(vsm_statistics));
+    for(daxa_i32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
+    {
+        if(vsm_statistics.resident_pages[clip_level] == 0) { continue; }
+        ImGui::Text("\t Clip %d: %u", clip_level, vsm_statistics.resident_pages[clip_level]);
+    }
+    ImGui::End();
+
+    ImGui::Begin("Uploads");
+    auto const & frame = info.renderer->context.frame;
+    ImGui::Text("Uploaded this frame: %llu bytes", static_cast<unsigned long long>(frame.upload_bytes));
+    for(daxa_u32 target = 0; target < static_cast<daxa_u32>(FrameUploadTarget::COUNT); target++)
+    {
+        if(frame.upload_target_bytes.at(target) == 0) { continue; }
+        ImGui::Text("\t %s: %llu bytes", std::string(frame_upload_target_names.at(target)).c_str(),
+            static_cast<unsigned long long>(frame.upload_target_bytes.at(target)));
+    }
+    std::string dirty_groups;
+    for(daxa_u32 group = 0; group < static_cast<daxa_u32>(GlobalsGroup::COUNT); group++)
+    {
+        if(!frame.dirty_globals_groups.at(group)) { continue; }
+        dirty_groups += (dirty_groups.empty() ? "" : ", ") + std::string(globals_group_names.at(group));
+    }
+    ImGui::Text("Dirty globals groups: %s", dirty_groups.empty() ? "none" : dirty_groups.c_str());
+    ImGui::Text("Atmosphere LUT rebakes: %u, loaded from files: %u", frame.atmosphere_lut_rebakes, frame.atmosphere_lut_loads);
+    auto const & skyview_statistics = frame.skyview_cache.get_statistics();
+    ImGui::Text("Skyview LUT: %u reused, %u blended, %u evaluated, %u cache bakes, %d dispatches saved",
+        skyview_statistics.reused_frames, skyview_statistics.blended_frames, skyview_statistics.evaluated_frames,
+        skyview_statistics.cache_bakes, skyview_statistics.get_dispatches_saved());
+    ImGui::Text("Debug draw: %u boxes, %u lines, %u dropped", frame.debug_draw.get_box_count(),
+        frame.debug_draw.get_line_count(), frame.debug_draw.get_dropped_count());
     ImGui::End();
 
 #if VSM_DEBUG_VIZ_PASS == 1 
     ImGui::Begin("Clip page offsets");
+    auto const & clip_projections = info.renderer->context.frame.vsm_clip_map.get_clip_projections();
     for(daxa_i32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
     {
         ImGui::Text("Clip %d", clip_level);
         ImGui::Text("\t In VSM offset is x: %d y: %d",
-            info.renderer->context.vsm_sun_projections[clip_level].page_offset.x,
-            info.renderer->context.vsm_sun_projections[clip_level].page_offset.y
+            clip_projections[clip_level].page_offset.x,
+            clip_projections[clip_level].page_offset.y
         );
     }
     ImGui::End();
@@ -205,14 +375,37 @@ void GuiManager::on_update()
             .image_view_id = info.renderer->context.images.vsm_debug_meta_memory_table.get_state().images[0].default_view(),
             .sampler_id = info.renderer->context.nearest_sampler
         }),
-        ImVec2(VSM_DEBUG_META_MEMORY_RESOLUTION * 4, VSM_DEBUG_META_MEMORY_RESOLUTION * 4) 
+        ImVec2(
+            vsm_debug_meta_memory_resolution(info.renderer->context.quality_tiers) * 4,
+            vsm_debug_meta_memory_resolution(info.renderer->context.quality_tiers) * 4
+        ) 
     );
     ImGui::End();
 #endif //VSM_DEBUG_VIZ_PASS
 
+    update_globals();
     ImGui::Render();
 }
 
+void GuiManager::update_globals()
+{
+    max_luminance = max_luminance < min_luminance ? min_luminance + 0.1 : max_luminance;
+    globals.min_luminance_log2 = std::log2(min_luminance);
+    globals.max_luminance_log2 = std::log2(max_luminance);
+    globals.inv_luminance_range_log2 = 1.0f / (globals.max_luminance_log2 - globals.min_luminance_log2);
+
+    globals.sun_direction =
+    {
+        daxa_f32(glm::cos(glm::radians(sun_angle.x)) * glm::sin(glm::radians(sun_angle.y))),
+        daxa_f32(glm::sin(glm::radians(sun_angle.x)) * glm::sin(glm::radians(sun_angle.y))),
+        daxa_f32(glm::cos(glm::radians(sun_angle.y)))
+    };
+
+    globals.atmosphere_top = glm::max(globals.atmosphere_bottom + 10.0f, globals.atmosphere_top);
+    globals.mie_density[1].exp_scale = -1.0f / globals.mie_scale_height;
+    globals.rayleigh_density[1].exp_scale = -1.0f / globals.rayleigh_scale_height;
+}
+
 void GuiManager::load(std::string path, bool constructor_load)
 {
     auto json = nlohmann::json::parse(std::ifstream(path));
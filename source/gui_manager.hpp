@@ -3,6 +3,7 @@
 #include <array>
 #include <daxa/types.hpp>
 #include "camera.hpp"
+#include "camera_path.hpp"
 #include "renderer/renderer.hpp"
 #include "renderer/context.hpp"
 #include "imgui_file_dialog.hpp"
@@ -12,12 +13,18 @@ struct GuiManagerInfo
 {
     Camera ** camera;
     Renderer * renderer;
+    CameraPath * camera_path;
+    // Preset loaded at startup
+    std::string preset_path = "assets/gui_state/defaults.json";
 };
 
 struct GuiManager
 {
     GuiManager(GuiManagerInfo const & info);
     void on_update();
+    // Derives the Globals which are computed from the gui state (sun direction, luminance range,
+    // density profile scales), called by on_update() and by the headless frame driver
+    void update_globals();
 
     Globals globals;
 
@@ -32,6 +39,8 @@ struct GuiManager
 
         GuiManagerInfo info;
         std::string curr_path;
+        // Error of the last failed camera path recording or playback, shown in the camera path window
+        std::string camera_path_error;
 
         daxa_f32vec2 sun_angle;
         daxa_u32vec2 trans_lut_dim;
@@ -0,0 +1,358 @@
+#include "headless_frame_driver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+
+#include "frame_profiler.hpp"
+#include "renderer/atmosphere/atmosphere_reference.hpp"
+#include "renderer/atmosphere/atmosphere_lut_files.hpp"
+
+using namespace std::chrono;
+
+static auto elapsed_ms(steady_clock::time_point start, steady_clock::time_point end) -> daxa_f64
+{
+    return duration<daxa_f64, std::milli>(end - start).count();
+}
+
+HeadlessFrameDriver::HeadlessFrameDriver(HeadlessFrameDriverInfo const & info) :
+    info{info},
+    main_camera{get_default_main_camera_info()},
+    debug_camera{get_default_debug_camera_info()},
+    active_camera{&main_camera},
+    gui{{ &active_camera, nullptr, &camera_path, info.preset_path }},
+    histogram_readback{},
+    vsm_simulator{{ .eviction_policy = info.vsm_eviction_policy }},
+    planet{generate_planet()}
+{
+    if(!info.camera_path.empty()) { camera_path.start_playback(info.camera_path); }
+    timings.reserve(info.frame_count);
+    frame.vsm_page_budget.set_info({ .min_pages = info.vsm_page_budget, .max_pages = info.vsm_page_budget });
+    frame.vsm_sun_invalidation.set_info(info.vsm_sun_invalidation);
+}
+
+void HeadlessFrameDriver::update_cameras()
+{
+    gui.update_globals();
+    if(info.sun_degrees_per_frame != 0.0f)
+    {
+        // Keeps the azimuth of the preset sun, starts at the zenith
+        const daxa_f32 azimuth = std::atan2(gui.globals.sun_direction.y, gui.globals.sun_direction.x);
+        const daxa_f32 zenith = static_cast<daxa_f32>(timings.size()) * info.sun_degrees_per_frame * std::numbers::pi_v<daxa_f32> / 180.0f;
+        gui.globals.sun_direction = {
+            std::cos(azimuth) * std::sin(zenith),
+            std::sin(azimuth) * std::sin(zenith),
+            std::cos(zenith)
+        };
+    }
+
+    if(camera_path.get_mode() == CameraPathMode::PLAYBACK)
+    {
+        camera_path.playback_frame(main_camera, debug_camera, gui.globals);
+        return;
+    }
+
+    // Scripted fly-through, a slow turn while moving forward makes the VSM clip levels realign
+    const daxa_f32 delta_time = CameraPath::DEFAULT_FIXED_TIMESTEP;
+    main_camera.move_camera(delta_time, Direction::FORWARD, true);
+    main_camera.update_front_vector(2.0f, 0.0f);
+    gui.globals.time += delta_time;
+}
+
+auto HeadlessFrameDriver::record_uploads(HeadlessFrameTiming & timing) -> daxa_u64
+{
+    daxa_u64 total_size = 0;
+    for(auto const & upload : frame.uploads) { total_size += upload.size; }
+    if(staging_arena.size() < total_size) { staging_arena.resize(total_size); }
+
+    daxa_u64 staging_offset = 0;
+    for(auto const & upload : frame.uploads)
+    {
+        if(upload.size == 0) { continue; }
+        std::memcpy(staging_arena.data() + staging_offset, upload.data, upload.size);
+        staging_offset += upload.size;
+        timing.upload_count += 1;
+        timing.target_bytes.at(static_cast<daxa_u32>(upload.target)) += upload.size;
+    }
+    finish_frame_uploads(frame);
+    return staging_offset;
+}
+
+void HeadlessFrameDriver::bake_reference_atmosphere()
+{
+    gui.update_globals();
+    for(daxa_u32 const thread_count : {1u, 0u})
+    {
+        auto reference = AtmosphereReference({ .thread_count = thread_count });
+        reference.bake(gui.globals);
+        for(auto const & [name, timing] : {
+            std::pair{"transmittance", reference.get_transmittance_timing()},
+            std::pair{"multiscattering", reference.get_multiscattering_timing()},
+            std::pair{"skyview", reference.get_skyview_timing()}})
+        {
+            std::cout << "[HeadlessFrameDriver::bake_reference_atmosphere()] " << name << " " << timing.texel_count << " texels on " <<
+                         timing.thread_count << " threads in " << timing.bake_ms << " ms, " <<
+                         timing.get_texels_per_second_per_core() << " texels/s per core" << std::endl;
+        }
+    }
+}
+
+void HeadlessFrameDriver::write_atmosphere_luts()
+{
+    gui.update_globals();
+    auto reference = AtmosphereReference();
+    reference.bake_transmittance(gui.globals);
+    reference.bake_multiscattering(gui.globals);
+
+    auto const files = get_atmosphere_lut_files(info.atmosphere_lut_directory, get_atmosphere_lut_hash(gui.globals));
+    write_atmosphere_lut_files(files, reference);
+    std::cout << "[HeadlessFrameDriver::write_atmosphere_luts()] Baked " << info.preset_path << " into " <<
+                 files.transmittance << " and " << files.multiscattering << " in " <<
+                 reference.get_transmittance_timing().bake_ms + reference.get_multiscattering_timing().bake_ms << " ms" << std::endl;
+}
+
+void HeadlessFrameDriver::simulate_vsm(HeadlessFrameTiming & timing)
+{
+    const auto simulation_start = steady_clock::now();
+    vsm_page_requests.clear();
+    generate_vsm_page_requests({
+        .main_camera = main_camera,
+        .clip_projections = frame.vsm_clip_map.get_clip_projections(),
+        .clip0_texel_world_size = frame.vsm_clip_map.get_clip0_texel_world_size(),
+        .screen_resolution = info.vsm_screen_resolution
+    }, vsm_page_requests);
+    vsm_simulator.simulate_frame({
+        .clip_projections = frame.vsm_clip_map.get_clip_projections(),
+        .free_wrapped_pages_info = frame.vsm_clip_map.get_free_wrapped_pages_info(),
+        .page_requests = vsm_page_requests,
+        .page_budget = gui.globals.vsm_page_budget
+    });
+    timing.vsm_simulation_ms = elapsed_ms(simulation_start, steady_clock::now());
+
+    const auto frame_total = vsm_simulator.get_frame_statistics().get_total();
+    timing.vsm_requested_pages = frame_total.requested_pages;
+    timing.vsm_allocations = frame_total.allocations;
+    timing.vsm_evictions = frame_total.evictions;
+    timing.vsm_deferred_requests = frame_total.deferred_requests;
+    timing.vsm_invalidated_pages = frame_total.invalidations;
+    timing.vsm_drawn_patches = count_vsm_drawn_patches();
+
+    // Stands in for the statistics readback, the sun invalidation of the next frame prices the clip levels with it
+    const auto resident_pages = vsm_simulator.get_resident_page_counts();
+    std::copy(resident_pages.begin(), resident_pages.end(), std::begin(frame.vsm_statistics.resident_pages));
+}
+
+auto HeadlessFrameDriver::get_terrain_patch_bounds(size_t first_index, daxa_f32 min_height, daxa_f32 max_height) const -> std::pair<daxa_f32vec3, daxa_f32vec3>
+{
+    auto min_uv = daxa_f32vec2{1.0f, 1.0f};
+    auto max_uv = daxa_f32vec2{0.0f, 0.0f};
+    for(daxa_u32 corner = 0; corner < TERRAIN_PATCH_INDEX_COUNT; corner++)
+    {
+        auto const & uv = planet.vertices.at(planet.indices.at(first_index + corner));
+        min_uv = {std::min(min_uv.x, uv.x), std::min(min_uv.y, uv.y)};
+        max_uv = {std::max(max_uv.x, uv.x), std::max(max_uv.y, uv.y)};
+    }
+    // Border patches are pulled down to the skirt like in vsm_cull_terrain_patches.glsl
+    const bool touches_border = min_uv.x < 0.001f || min_uv.y < 0.001f || max_uv.x > 0.999f || max_uv.y > 0.999f;
+    const auto terrain_scale = gui.globals.terrain_scale;
+    return {
+        {min_uv.x * terrain_scale.x, min_uv.y * terrain_scale.y, touches_border ? static_cast<daxa_f32>(TERRAIN_BORDER_HEIGHT) : min_height},
+        {max_uv.x * terrain_scale.x, max_uv.y * terrain_scale.y, max_height}
+    };
+}
+
+auto HeadlessFrameDriver::count_vsm_drawn_patches() const -> daxa_u64
+{
+    auto const & dirty_pyramid = vsm_simulator.get_dirty_pyramid();
+    auto const & clip_projections = frame.vsm_clip_map.get_clip_projections();
+
+    daxa_u64 drawn_patches = 0;
+    for(size_t first_index = 0; first_index + TERRAIN_PATCH_INDEX_COUNT <= planet.indices.size(); first_index += TERRAIN_PATCH_INDEX_COUNT)
+    {
+        // The page requests come from a ground plane, the terrain is flattened onto it
+        const auto [min_bounds, max_bounds] = get_terrain_patch_bounds(first_index, 0.0f, 0.0f);
+        for(daxa_i32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
+        {
+            const auto page_rect = get_vsm_page_rect(clip_projections[clip_level], min_bounds, max_bounds);
+            if(page_rect.has_value() && dirty_pyramid.query(clip_level, page_rect.value())) { drawn_patches += 1; }
+        }
+    }
+    return drawn_patches;
+}
+
+void HeadlessFrameDriver::cull_terrain_patches(HeadlessFrameTiming & timing)
+{
+    // Heights come from the height map, the bounds span everything the height scale can produce
+    const daxa_f32 low_height = -gui.globals.terrain_midpoint * gui.globals.terrain_height_scale;
+    const daxa_f32 high_height = (1.0f - gui.globals.terrain_midpoint) * gui.globals.terrain_height_scale;
+    terrain_patch_bounds.clear();
+    for(size_t first_index = 0; first_index + TERRAIN_PATCH_INDEX_COUNT <= planet.indices.size(); first_index += TERRAIN_PATCH_INDEX_COUNT)
+    {
+        const auto [min_bounds, max_bounds] = get_terrain_patch_bounds(first_index, std::min(low_height, high_height), std::max(low_height, high_height));
+        terrain_patch_bounds.push_back(min_bounds, max_bounds);
+    }
+
+    const auto frustum_planes = main_camera.get_frustum_planes();
+    const auto cull_start = steady_clock::now();
+    visible_terrain_patches.clear();
+    timing.frustum_visible_patches = cull_aabbs(frustum_planes, terrain_patch_bounds, visible_terrain_patches);
+    timing.frustum_cull_ms = elapsed_ms(cull_start, steady_clock::now());
+}
+
+void HeadlessFrameDriver::run()
+{
+    if(info.bake_reference_atmosphere) { bake_reference_atmosphere(); }
+    if(!info.atmosphere_lut_directory.empty()) { write_atmosphere_luts(); }
+    for(daxa_u32 frame_index = 0; frame_index < info.frame_count; frame_index++)
+    {
+        if(!info.camera_path.empty() && camera_path.get_mode() != CameraPathMode::PLAYBACK) { break; }
+
+        FrameProfiler::get().begin_frame();
+        PROFILE_SCOPE("frame");
+        auto timing = HeadlessFrameTiming{};
+        const auto frame_start = steady_clock::now();
+
+        update_cameras();
+        const auto update_end = steady_clock::now();
+
+        prepare_frame(frame, {
+            .main_camera = main_camera,
+            .debug_camera = debug_camera,
+            .globals = gui.globals
+        });
+        const auto prepare_end = steady_clock::now();
+        timing.skyview_source = frame.skyview_cache.get_plan().source;
+        timing.skyview_cache_bakes = frame.skyview_cache.get_plan().bake_count;
+        timing.vsm_invalidated_levels = frame.vsm_sun_invalidation.get_statistics().invalidated_levels;
+
+        timing.upload_bytes = record_uploads(timing);
+        const auto upload_end = steady_clock::now();
+
+        read_back_histogram(frame, histogram_readback.data(), gui.globals.frame_index);
+        gui.globals.frame_index++;
+        const auto frame_end = steady_clock::now();
+
+        timing.update_ms = elapsed_ms(frame_start, update_end);
+        timing.prepare_ms = elapsed_ms(update_end, prepare_end);
+        timing.upload_ms = elapsed_ms(prepare_end, upload_end);
+        timing.readback_ms = elapsed_ms(upload_end, frame_end);
+        timing.frame_ms = elapsed_ms(frame_start, frame_end);
+        if(info.simulate_vsm) { simulate_vsm(timing); }
+        if(info.cull_terrain) { cull_terrain_patches(timing); }
+        timings.push_back(timing);
+    }
+    write_timings();
+#if defined(TENEBRIS_FRAME_PROFILER)
+    FrameProfiler::get().write_chrome_trace(info.trace_path);
+#endif
+}
+
+void HeadlessFrameDriver::write_timings() const
+{
+    if(timings.empty()) { return; }
+
+    auto file = std::ofstream(info.timings_path);
+    if(!file.is_open())
+    {
+        throw std::runtime_error("[HeadlessFrameDriver::write_timings()] Failed to open " + info.timings_path + " for writing");
+    }
+
+    file << "frame,frame_ms,update_ms,prepare_ms,upload_ms,readback_ms,upload_count,upload_bytes,skyview_source,skyview_cache_bakes," <<
+            "vsm_simulation_ms,vsm_requested_pages,vsm_allocations,vsm_evictions,vsm_deferred_requests,vsm_drawn_patches," <<
+            "vsm_invalidated_levels,vsm_invalidated_pages,frustum_cull_ms,frustum_visible_patches";
+    for(auto const & target_name : frame_upload_target_names)
+    {
+        auto column_name = std::string(target_name);
+        std::replace(column_name.begin(), column_name.end(), ' ', '_');
+        file << "," << column_name << "_bytes";
+    }
+    file << "\n";
+
+    daxa_f64 total_frame_ms = 0.0;
+    daxa_f64 total_prepare_ms = 0.0;
+    daxa_u64 total_upload_bytes = 0;
+    for(daxa_u32 frame_index = 0; frame_index < timings.size(); frame_index++)
+    {
+        auto const & timing = timings.at(frame_index);
+        file << frame_index << "," << timing.frame_ms << "," << timing.update_ms << "," << timing.prepare_ms << "," <<
+                timing.upload_ms << "," << timing.readback_ms << "," << timing.upload_count << "," << timing.upload_bytes << "," <<
+                static_cast<daxa_u32>(timing.skyview_source) << "," << timing.skyview_cache_bakes << "," <<
+                timing.vsm_simulation_ms << "," << timing.vsm_requested_pages << "," << timing.vsm_allocations << "," << timing.vsm_evictions << "," <<
+                timing.vsm_deferred_requests << "," << timing.vsm_drawn_patches << "," <<
+                timing.vsm_invalidated_levels << "," << timing.vsm_invalidated_pages << "," <<
+                timing.frustum_cull_ms << "," << timing.frustum_visible_patches;
+        for(auto const target_bytes : timing.target_bytes) { file << "," << target_bytes; }
+        file << "\n";
+
+        total_frame_ms += timing.frame_ms;
+        total_prepare_ms += timing.prepare_ms;
+        total_upload_bytes += timing.upload_bytes;
+    }
+
+    const auto frame_count = static_cast<daxa_f64>(timings.size());
+    std::cout << "[HeadlessFrameDriver::write_timings()] " << timings.size() << " frames, average frame " <<
+                 total_frame_ms / frame_count << " ms, average prepare " << total_prepare_ms / frame_count <<
+                 " ms, average upload " << static_cast<daxa_f64>(total_upload_bytes) / frame_count <<
+                 " bytes, timings written to " << info.timings_path << std::endl;
+
+    auto const & skyview_statistics = frame.skyview_cache.get_statistics();
+    std::cout << "[HeadlessFrameDriver::write_timings()] Skyview LUT " << skyview_statistics.reused_frames << " reused, " <<
+                 skyview_statistics.blended_frames << " blended, " << skyview_statistics.evaluated_frames << " evaluated, " <<
+                 skyview_statistics.cache_bakes << " cache bakes, " << skyview_statistics.get_dispatches_saved() <<
+                 " raymarch dispatches saved" << std::endl;
+
+    if(info.cull_terrain)
+    {
+        daxa_f64 total_cull_ms = 0.0;
+        daxa_u64 total_visible_patches = 0;
+        for(auto const & timing : timings)
+        {
+            total_cull_ms += timing.frustum_cull_ms;
+            total_visible_patches += timing.frustum_visible_patches;
+        }
+        const auto tested_patches = static_cast<daxa_f64>(terrain_patch_bounds.size()) * frame_count;
+        std::cout << "[HeadlessFrameDriver::write_timings()] Frustum culling " << static_cast<daxa_f64>(total_visible_patches) / frame_count <<
+                     " of " << terrain_patch_bounds.size() << " terrain patches visible per frame on average, " <<
+                     total_cull_ms / frame_count << " ms per frame, " << tested_patches / (total_cull_ms * 1000.0) <<
+                     " million AABB tests per second with " << get_culling_simd_width() << " wide SIMD" << std::endl;
+    }
+
+    if(!info.simulate_vsm) { return; }
+    auto const & vsm_statistics = vsm_simulator.get_statistics();
+    for(daxa_u32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
+    {
+        auto const & level = vsm_statistics.levels.at(clip_level);
+        if(level.requested_pages == 0 && level.get_churn() == 0) { continue; }
+        std::cout << "[HeadlessFrameDriver::write_timings()] VSM clip level " << clip_level << " hit rate " << level.get_hit_rate() <<
+                     ", " << level.allocations << " allocations, " << level.allocation_failures << " failures, " <<
+                     level.dropped_requests << " dropped requests, " << level.deferred_requests << " deferred requests, " <<
+                     level.evictions << " evictions, " <<
+                     level.wrapped_frees << " wrapped frees, " << level.invalidations << " sun invalidations, churn " <<
+                     static_cast<daxa_f64>(level.get_churn()) / static_cast<daxa_f64>(vsm_statistics.frames) << " pages per frame" << std::endl;
+    }
+    const auto total = vsm_statistics.get_total();
+    std::cout << "[HeadlessFrameDriver::write_timings()] VSM total hit rate " << total.get_hit_rate() << ", " <<
+                 total.allocation_failures << " allocation failures, " << vsm_simulator.get_allocated_page_count() <<
+                 " pages resident at the end" << std::endl;
+
+    daxa_u64 total_drawn_patches = 0;
+    for(auto const & timing : timings) { total_drawn_patches += timing.vsm_drawn_patches; }
+    const auto unculled_patches = static_cast<daxa_f64>((planet.indices.size() / TERRAIN_PATCH_INDEX_COUNT) * VSM_CLIP_LEVELS);
+    std::cout << "[HeadlessFrameDriver::write_timings()] VSM page draw submits " << static_cast<daxa_f64>(total_drawn_patches) / frame_count <<
+                 " terrain patches per frame on average, " << unculled_patches << " without the dirty page culling" << std::endl;
+
+    daxa_u64 max_invalidated_pages = 0;
+    for(auto const & timing : timings) { max_invalidated_pages = std::max(max_invalidated_pages, timing.vsm_invalidated_pages); }
+    auto const & sun_invalidation = frame.vsm_sun_invalidation.get_statistics();
+    std::cout << "[HeadlessFrameDriver::write_timings()] VSM sun invalidation " << sun_invalidation.direction_updates <<
+                 " direction updates, " << sun_invalidation.total_invalidated_levels << " clip levels switched, " <<
+                 static_cast<daxa_f64>(total.invalidations) / frame_count << " pages invalidated per frame on average, " <<
+                 max_invalidated_pages << " at most" << std::endl;
+}
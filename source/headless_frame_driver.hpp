@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+#include "application.hpp"
+#include "camera_path.hpp"
+#include "culling.hpp"
+#include "gui_manager.hpp"
+#include "renderer/frame_state.hpp"
+#include "renderer/vsm_simulator.hpp"
+#include "terrain_gen/planet_generator.hpp"
+
+struct HeadlessFrameDriverInfo
+{
+    daxa_u32 frame_count = 1000;
+    // When empty the main camera flies along a fixed scripted path instead
+    std::string camera_path = {};
+    std::string timings_path = "headless_timings.csv";
+    // Chrome trace of the profiled scopes, only written when the profiler is compiled in
+    std::string trace_path = "headless_trace.json";
+    // Bakes the CPU reference atmosphere LUTs on one and on all hardware threads before the frames are run
+    bool bake_reference_atmosphere = false;
+    // Preset whose globals the frames (and the LUT bake) are run with
+    std::string preset_path = "assets/gui_state/defaults.json";
+    // When not empty the transmittance and multiscattering LUTs of the preset are baked on the CPU and
+    // written into this directory, Renderer loads them instead of dispatching the LUT passes
+    std::string atmosphere_lut_directory = {};
+    // Day cycle, the sun zenith angle advances by this much every frame. Zero keeps the sun of the preset
+    daxa_f32 sun_degrees_per_frame = 0.0f;
+    // Feeds the VSM page allocator simulator with the page requests of the main camera looking at a ground plane,
+    // screen resolution decides the clip levels the requests land in
+    bool simulate_vsm = false;
+    daxa_u32vec2 vsm_screen_resolution = {1920, 1080};
+    VSMEvictionPolicy vsm_eviction_policy = VSMEvictionPolicy::LRU;
+    // Fixed page budget of the simulated frames, there is no draw pass to measure the budget from
+    daxa_u32 vsm_page_budget = MAX_NUM_VSM_ALLOC_REQUEST;
+    // Quantization and amortization of the clip level invalidations caused by the day cycle
+    VSMSunInvalidationInfo vsm_sun_invalidation = {};
+    // Culls the terrain patches against the frustum of the main camera every frame and reports the culling throughput
+    bool cull_terrain = false;
+};
+
+struct HeadlessFrameTiming
+{
+    // Gui derived globals and camera movement or camera path playback
+    daxa_f64 update_ms;
+    // prepare_frame(), the CPU part of Renderer::draw()
+    daxa_f64 prepare_ms;
+    // Copies of the collected uploads into the staging arena
+    daxa_f64 upload_ms;
+    daxa_f64 readback_ms;
+    daxa_f64 frame_ms;
+    daxa_u32 upload_count;
+    daxa_u64 upload_bytes;
+    // Sky-view LUT cache decision and the cache layers baked for it
+    SkyviewSource skyview_source;
+    daxa_u32 skyview_cache_bakes;
+    // VSM simulation, not part of frame_ms
+    daxa_f64 vsm_simulation_ms;
+    daxa_u64 vsm_requested_pages;
+    daxa_u64 vsm_allocations;
+    daxa_u64 vsm_evictions;
+    daxa_u64 vsm_deferred_requests;
+    // Terrain patches the page draw would submit after culling against the dirty pages, summed over the clip levels
+    daxa_u64 vsm_drawn_patches;
+    // Clip levels switched to a new sun direction and the pages they lost
+    daxa_u32 vsm_invalidated_levels;
+    daxa_u64 vsm_invalidated_pages;
+    // Frustum culling of the terrain patches, not part of frame_ms
+    daxa_f64 frustum_cull_ms;
+    daxa_u32 frustum_visible_patches;
+    std::array<daxa_u64, static_cast<daxa_u32>(FrameUploadTarget::COUNT)> target_bytes;
+};
+
+// Runs the CPU side of the frame loop without a window or a device. The uploads the upload
+// task would record are copied into a host staging arena and counted instead of being submitted,
+// the histogram readback is served from a host buffer
+struct HeadlessFrameDriver
+{
+    explicit HeadlessFrameDriver(HeadlessFrameDriverInfo const & info);
+
+    // Runs the requested number of frames (or until the camera path ends) and writes the timings
+    void run();
+
+    private:
+        void update_cameras();
+        void bake_reference_atmosphere();
+        void write_atmosphere_luts();
+        void simulate_vsm(HeadlessFrameTiming & timing);
+        // World space bounds of the terrain patch starting at first_index, the height range is supplied by the caller
+        auto get_terrain_patch_bounds(size_t first_index, daxa_f32 min_height, daxa_f32 max_height) const -> std::pair<daxa_f32vec3, daxa_f32vec3>;
+        // Mirrors vsm_cull_terrain_patches.glsl with the terrain flattened onto the ground plane of the page requests
+        auto count_vsm_drawn_patches() const -> daxa_u64;
+        void cull_terrain_patches(HeadlessFrameTiming & timing);
+        auto record_uploads(HeadlessFrameTiming & timing) -> daxa_u64;
+        void write_timings() const;
+
+        HeadlessFrameDriverInfo info;
+        Camera main_camera;
+        Camera debug_camera;
+        Camera * active_camera;
+        CameraPath camera_path;
+        GuiManager gui;
+
+        FrameState frame;
+        std::vector<std::byte> staging_arena;
+        std::array<Histogram, 2 * HISTOGRAM_BIN_COUNT> histogram_readback;
+        std::vector<HeadlessFrameTiming> timings;
+        VSMSimulator vsm_simulator;
+        std::vector<daxa_i32vec3> vsm_page_requests;
+        PlanetGeometry planet;
+        AABBBatch terrain_patch_bounds;
+        std::vector<daxa_u32> visible_terrain_patches;
+};
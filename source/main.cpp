@@ -1,14 +1,65 @@
 #include <stdexcept>
 #include <iostream>
+#include <string>
+#include <string_view>
 
 #include "application.hpp"
+#include "headless_frame_driver.hpp"
 
-int main()
+int main(int argc, char * argv[])
 {
+    std::string camera_path = {};
+    bool headless_frames = false;
+    HeadlessFrameDriverInfo headless_info = {};
+
+    for(int arg = 1; arg < argc; arg++)
+    {
+        const auto argument = std::string_view(argv[arg]);
+        const bool has_value = arg + 1 < argc;
+        // --play-camera-path <track> renders the recorded track, writes the frame timings and exits
+        if(argument == "--play-camera-path" && has_value) { camera_path = argv[++arg]; }
+        // --headless <frame count> runs only the CPU side of the frames without a window or a device
+        else if(argument == "--headless" && has_value) { headless_frames = true; headless_info.frame_count = std::stoul(argv[++arg]); }
+        else if(argument == "--headless-timings" && has_value) { headless_info.timings_path = argv[++arg]; }
+        // --atmosphere-reference benchmarks the CPU atmosphere LUT bake before the headless frames
+        else if(argument == "--atmosphere-reference") { headless_info.bake_reference_atmosphere = true; }
+        // --day-cycle <degrees per frame> moves the sun during the headless frames
+        else if(argument == "--day-cycle" && has_value) { headless_info.sun_degrees_per_frame = std::stof(argv[++arg]); }
+        // --vsm-simulation runs the CPU VSM page allocator on the headless frames and reports its statistics
+        else if(argument == "--vsm-simulation") { headless_info.simulate_vsm = true; }
+        // --vsm-visited-eviction simulates the previous raster order eviction instead of the LRU buckets
+        else if(argument == "--vsm-visited-eviction") { headless_info.vsm_eviction_policy = VSMEvictionPolicy::VISITED_BIT; }
+        // --vsm-page-budget <pages> caps the pages the simulated frames allocate, the rest is deferred to later frames
+        else if(argument == "--vsm-page-budget" && has_value) { headless_info.vsm_page_budget = std::stoul(argv[++arg]); }
+        // --vsm-sun-quantization <degrees> sun movement the shadows ignore, zero switches the clip levels on every change
+        else if(argument == "--vsm-sun-quantization" && has_value) { headless_info.vsm_sun_invalidation.quantization_degrees = std::stof(argv[++arg]); }
+        // --vsm-sun-levels-per-frame <levels> clip levels switched to a new sun direction per frame
+        else if(argument == "--vsm-sun-levels-per-frame" && has_value) { headless_info.vsm_sun_invalidation.max_levels_per_frame = std::stoul(argv[++arg]); }
+        // --vsm-sun-coarse-first switches the coarse clip levels to a new sun direction first
+        else if(argument == "--vsm-sun-coarse-first") { headless_info.vsm_sun_invalidation.order = VSMInvalidationOrder::COARSE_FIRST; }
+        // --frustum-culling culls the terrain patches against the main camera during the headless frames and reports the throughput
+        else if(argument == "--frustum-culling") { headless_info.cull_terrain = true; }
+        // --preset <json> gui state the headless frames and the LUT bake are run with
+        else if(argument == "--preset" && has_value) { headless_info.preset_path = argv[++arg]; }
+        // --bake-atmosphere-luts <directory> writes the atmosphere LUTs of the preset and exits unless frames were requested,
+        // Renderer picks them up from ATMOSPHERE_LUT_DIRECTORY
+        else if(argument == "--bake-atmosphere-luts" && has_value) { headless_info.atmosphere_lut_directory = argv[++arg]; }
+    }
+
+    const bool bake_atmosphere_luts = !headless_info.atmosphere_lut_directory.empty();
+    if(headless_frames || bake_atmosphere_luts)
+    {
+        if(!headless_frames) { headless_info.frame_count = 0; }
+        headless_info.camera_path = camera_path;
+        HeadlessFrameDriver driver(headless_info);
+        driver.run();
+        return 0;
+    }
+
     Application application = {};
+    if(!camera_path.empty()) { application.play_camera_path(camera_path, true); }
 
     application.main_loop();
 
     return 0;
 }
-    
\ No newline at end of file
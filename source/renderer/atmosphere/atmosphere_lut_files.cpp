@@ -0,0 +1,34 @@
+#include "atmosphere_lut_files.hpp"
+
+#include <filesystem>
+#include <format>
+#include <utility>
+
+#include "../texture_manager/load_formats.hpp"
+
+auto get_atmosphere_lut_files(std::string_view directory, daxa_u64 lut_hash) -> AtmosphereLUTFiles
+{
+    auto const directory_path = std::filesystem::path(directory);
+    return {
+        .transmittance = (directory_path / std::format("transmittance_{:016x}.dds", lut_hash)).string(),
+        .multiscattering = (directory_path / std::format("multiscattering_{:016x}.dds", lut_hash)).string()
+    };
+}
+
+auto atmosphere_lut_files_exist(AtmosphereLUTFiles const & files) -> bool
+{
+    std::error_code error;
+    return std::filesystem::is_regular_file(files.transmittance, error) &&
+           std::filesystem::is_regular_file(files.multiscattering, error);
+}
+
+void write_atmosphere_lut_files(AtmosphereLUTFiles const & files, AtmosphereReference const & reference)
+{
+    for(auto const & [path, lut] : {
+        std::pair{&files.transmittance, &reference.get_transmittance()},
+        std::pair{&files.multiscattering, &reference.get_multiscattering()}})
+    {
+        std::filesystem::create_directories(std::filesystem::path(*path).parent_path());
+        write_dds_rgba32f(*path, lut->dimensions, lut->texels);
+    }
+}
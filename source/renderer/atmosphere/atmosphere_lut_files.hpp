@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+#include "atmosphere_reference.hpp"
+
+// Offline baked transmittance and multiscattering LUTs are written to and loaded from here
+static constexpr std::string_view ATMOSPHERE_LUT_DIRECTORY = "assets/atmosphere_luts";
+
+struct AtmosphereLUTFiles
+{
+    std::string transmittance;
+    std::string multiscattering;
+};
+
+// The files are named by the atmosphere LUT hash (see get_atmosphere_lut_hash()) so every preset finds
+// its own LUTs without the presets storing any paths, a preset without baked files falls back to the GPU bake
+auto get_atmosphere_lut_files(std::string_view directory, daxa_u64 lut_hash) -> AtmosphereLUTFiles;
+[[nodiscard]] auto atmosphere_lut_files_exist(AtmosphereLUTFiles const & files) -> bool;
+// Writes the transmittance and multiscattering LUTs of the reference as R32G32B32A32_FLOAT DDS files
+void write_atmosphere_lut_files(AtmosphereLUTFiles const & files, AtmosphereReference const & reference);
@@ -0,0 +1,538 @@
+#include "atmosphere_reference.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "medium_lut.hpp"
+#include "../../utils.hpp"
+
+using namespace std::chrono;
+
+// Constants and helpers mirror common_func.glsl, keep the two in sync
+static constexpr daxa_f32 PLANET_RADIUS_OFFSET = 0.01f;
+static constexpr daxa_f32 PI = 3.1415926535897932384626433832795f;
+static constexpr daxa_f32 GOLDEN_RATIO = 1.6180339f;
+static constexpr daxa_u32 SPHERE_SAMPLES = 64;
+
+#pragma region vector_math
+struct Vec3
+{
+    daxa_f32 x, y, z;
+};
+
+static inline auto operator+(Vec3 a, Vec3 b) -> Vec3 { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+static inline auto operator-(Vec3 a, Vec3 b) -> Vec3 { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+static inline auto operator*(Vec3 a, Vec3 b) -> Vec3 { return {a.x * b.x, a.y * b.y, a.z * b.z}; }
+static inline auto operator*(Vec3 a, daxa_f32 b) -> Vec3 { return {a.x * b, a.y * b, a.z * b}; }
+static inline auto operator*(daxa_f32 a, Vec3 b) -> Vec3 { return b * a; }
+static inline auto operator+=(Vec3 & a, Vec3 b) -> Vec3 & { a = a + b; return a; }
+static inline auto operator*=(Vec3 & a, Vec3 b) -> Vec3 & { a = a * b; return a; }
+static inline auto dot(Vec3 a, Vec3 b) -> daxa_f32 { return a.x * b.x + a.y * b.y + a.z * b.z; }
+static inline auto length(Vec3 a) -> daxa_f32 { return std::sqrt(dot(a, a)); }
+static inline auto normalize(Vec3 a) -> Vec3 { return a * (1.0f / length(a)); }
+static inline auto exp(Vec3 a) -> Vec3 { return {std::exp(a.x), std::exp(a.y), std::exp(a.z)}; }
+static inline auto to_vec3(daxa_f32vec3 a) -> Vec3 { return {a.x, a.y, a.z}; }
+static inline auto to_vec3(daxa_f32vec4 a) -> Vec3 { return {a.x, a.y, a.z}; }
+static inline auto to_daxa(Vec3 a) -> daxa_f32vec3 { return {a.x, a.y, a.z}; }
+
+// (a - a * transmittance) / extinction per channel, zero where the extinction is zero
+static inline auto integrate_step(Vec3 a, Vec3 step_transmittance, Vec3 extinction) -> Vec3
+{
+    auto channel = [](daxa_f32 value, daxa_f32 transmittance, daxa_f32 extinction)
+        { return extinction == 0.0f ? 0.0f : (value - value * transmittance) / extinction; };
+    return {
+        channel(a.x, step_transmittance.x, extinction.x),
+        channel(a.y, step_transmittance.y, extinction.y),
+        channel(a.z, step_transmittance.z, extinction.z)
+    };
+}
+#pragma endregion
+
+#pragma region common_func
+static inline auto safe_sqrt(daxa_f32 x) -> daxa_f32 { return std::sqrt(std::max(0.0f, x)); }
+
+static inline auto from_subuv_to_unit(daxa_f32 u, daxa_f32 resolution) -> daxa_f32
+{
+    return (u - 0.5f / resolution) * (resolution / (resolution - 1.0f));
+}
+
+static inline auto from_unit_to_subuv(daxa_f32 u, daxa_f32 resolution) -> daxa_f32
+{
+    return (u + 0.5f / resolution) * (resolution / (resolution + 1.0f));
+}
+
+struct TransmittanceParams
+{
+    daxa_f32 height;
+    daxa_f32 zenith_cos_angle;
+};
+
+static auto transmittance_lut_to_uv(TransmittanceParams params, daxa_f32 atmosphere_bottom, daxa_f32 atmosphere_top) -> daxa_f32vec2
+{
+    const daxa_f32 H = safe_sqrt(atmosphere_top * atmosphere_top - atmosphere_bottom * atmosphere_bottom);
+    const daxa_f32 rho = safe_sqrt(params.height * params.height - atmosphere_bottom * atmosphere_bottom);
+    const daxa_f32 discriminant = params.height * params.height *
+        (params.zenith_cos_angle * params.zenith_cos_angle - 1.0f) + atmosphere_top * atmosphere_top;
+    // Distance to top atmosphere boundary
+    const daxa_f32 d = std::max(0.0f, -params.height * params.zenith_cos_angle + safe_sqrt(discriminant));
+    const daxa_f32 d_min = atmosphere_top - params.height;
+    const daxa_f32 d_max = rho + H;
+    return {(d - d_min) / (d_max - d_min), rho / H};
+}
+
+static auto uv_to_transmittance_lut_params(daxa_f32vec2 uv, daxa_f32 atmosphere_bottom, daxa_f32 atmosphere_top) -> TransmittanceParams
+{
+    const daxa_f32 H = safe_sqrt(atmosphere_top * atmosphere_top - atmosphere_bottom * atmosphere_bottom);
+    const daxa_f32 rho = H * uv.y;
+    const daxa_f32 height = safe_sqrt(rho * rho + atmosphere_bottom * atmosphere_bottom);
+    const daxa_f32 d_min = atmosphere_top - height;
+    const daxa_f32 d_max = rho + H;
+    const daxa_f32 d = d_min + uv.x * (d_max - d_min);
+    const daxa_f32 zenith_cos_angle = d == 0.0f ? 1.0f : (H * H - rho * rho - d * d) / (2.0f * height * d);
+    return {height, std::clamp(zenith_cos_angle, -1.0f, 1.0f)};
+}
+
+struct SkyviewParams
+{
+    daxa_f32 view_zenith_angle;
+    daxa_f32 light_view_angle;
+};
+
+static auto uv_to_skyview_lut_params(daxa_f32vec2 uv, daxa_f32 atmosphere_bottom, daxa_u32vec2 dimensions, daxa_f32 view_height) -> SkyviewParams
+{
+    // Constrain uvs to valid sub texel range (avoid zenith derivative issue making LUT usage visible)
+    uv = {from_subuv_to_unit(uv.x, static_cast<daxa_f32>(dimensions.x)), from_subuv_to_unit(uv.y, static_cast<daxa_f32>(dimensions.y))};
+    const daxa_f32 beta = std::asin(atmosphere_bottom / view_height);
+    const daxa_f32 zenith_horizon_angle = PI - beta;
+
+    // Nonuniform mapping near the horizon to avoid artefacts
+    daxa_f32 view_zenith_angle;
+    if(uv.y < 0.5f)
+    {
+        const daxa_f32 coord = 1.0f - (1.0f - 2.0f * uv.y) * (1.0f - 2.0f * uv.y);
+        view_zenith_angle = zenith_horizon_angle * coord;
+    } else {
+        const daxa_f32 coord = (uv.y * 2.0f - 1.0f) * (uv.y * 2.0f - 1.0f);
+        view_zenith_angle = zenith_horizon_angle + beta * coord;
+    }
+    return {view_zenith_angle, uv.x * uv.x * PI};
+}
+
+// Distance of the first intersection between the ray and the sphere or -1.0 if there is none
+static auto ray_sphere_intersect_nearest(Vec3 r0, Vec3 rd, Vec3 s0, daxa_f32 sR) -> daxa_f32
+{
+    const daxa_f32 a = dot(rd, rd);
+    const Vec3 s0_r0 = r0 - s0;
+    const daxa_f32 b = 2.0f * dot(rd, s0_r0);
+    const daxa_f32 c = dot(s0_r0, s0_r0) - (sR * sR);
+    const daxa_f32 delta = b * b - 4.0f * a * c;
+    if(delta < 0.0f || a == 0.0f) { return -1.0f; }
+    const daxa_f32 sol0 = (-b - safe_sqrt(delta)) / (2.0f * a);
+    const daxa_f32 sol1 = (-b + safe_sqrt(delta)) / (2.0f * a);
+    if(sol0 < 0.0f && sol1 < 0.0f) { return -1.0f; }
+    if(sol0 < 0.0f) { return std::max(0.0f, sol1); }
+    if(sol1 < 0.0f) { return std::max(0.0f, sol0); }
+    return std::max(0.0f, std::min(sol0, sol1));
+}
+
+// Moves a position outside of the atmosphere onto its top boundary, false when the ray misses the atmosphere
+static auto move_to_top_atmosphere(Vec3 & world_position, Vec3 world_direction, daxa_f32 atmosphere_top) -> bool
+{
+    if(length(world_position) <= atmosphere_top) { return true; }
+    const daxa_f32 distance = ray_sphere_intersect_nearest(world_position, world_direction, {0.0f, 0.0f, 0.0f}, atmosphere_top);
+    if(distance == -1.0f) { return false; }
+    world_position += world_direction * distance + normalize(world_position) * -PLANET_RADIUS_OFFSET;
+    return true;
+}
+
+// Length of the raymarched segment, zero when the ray misses both the planet and the atmosphere
+static auto get_integration_length(Globals const & globals, Vec3 world_position, Vec3 world_direction) -> daxa_f32
+{
+    const Vec3 planet_zero = {0.0f, 0.0f, 0.0f};
+    const daxa_f32 planet_distance = ray_sphere_intersect_nearest(world_position, world_direction, planet_zero, globals.atmosphere_bottom);
+    const daxa_f32 atmosphere_distance = ray_sphere_intersect_nearest(world_position, world_direction, planet_zero, globals.atmosphere_top);
+    if(planet_distance == -1.0f && atmosphere_distance == -1.0f) { return 0.0f; }
+    if(planet_distance == -1.0f) { return atmosphere_distance; }
+    if(atmosphere_distance == -1.0f) { return planet_distance; }
+    return std::min(planet_distance, atmosphere_distance);
+}
+
+static auto rayleigh_phase(daxa_f32 cos_theta) -> daxa_f32
+{
+    return 3.0f / (16.0f * PI) * (1.0f + cos_theta * cos_theta);
+}
+
+// https://research.nvidia.com/labs/rtr/approximate-mie/publications/approximate-mie.pdf
+static auto draine_phase(daxa_f32 alpha, daxa_f32 g, daxa_f32 cos_theta) -> daxa_f32
+{
+    return (1.0f / (4.0f * PI)) *
+        ((1.0f - g * g) / std::pow(1.0f + g * g - 2.0f * g * cos_theta, 1.5f)) *
+        ((1.0f + alpha * cos_theta * cos_theta) / (1.0f + alpha * (1.0f / 3.0f) * (1.0f + 2.0f * g * g)));
+}
+
+static auto hg_draine_phase(daxa_f32 cos_theta, daxa_f32 diameter) -> daxa_f32
+{
+    const daxa_f32 g_hg = std::exp(-(0.0990567f / (diameter - 1.67154f)));
+    const daxa_f32 g_d = std::exp(-(2.20679f / (diameter + 3.91029f)) - 0.428934f);
+    const daxa_f32 alpha = std::exp(3.62489f - (0.599085f / (diameter + 5.52825f)));
+    const daxa_f32 w_d = std::exp(-(0.599085f / (diameter - 0.641583f)) - 0.665888f);
+    return (1.0f - w_d) * draine_phase(0.0f, g_hg, cos_theta) + w_d * draine_phase(alpha, g_d, cos_theta);
+}
+#pragma endregion
+
+struct MediumSample
+{
+    Vec3 mie_scattering;
+    Vec3 rayleigh_scattering;
+    Vec3 extinction;
+};
+
+// Ozone only absorbs, it contributes to the extinction but not to the scattering
+static auto sample_medium(Globals const & globals, Vec3 position) -> MediumSample
+{
+    const daxa_f32 height = length(position) - globals.atmosphere_bottom;
+    const daxa_f32 mie_density = sample_density_profile(globals.mie_density, height);
+    const daxa_f32 rayleigh_density = sample_density_profile(globals.rayleigh_density, height);
+    const daxa_f32 absorption_density = sample_density_profile(globals.absorption_density, height);
+    return {
+        .mie_scattering = to_vec3(globals.mie_scattering) * mie_density,
+        .rayleigh_scattering = to_vec3(globals.rayleigh_scattering) * rayleigh_density,
+        .extinction =
+            to_vec3(globals.mie_extinction) * mie_density +
+            to_vec3(globals.rayleigh_scattering) * rayleigh_density +
+            to_vec3(globals.absorption_extinction) * absorption_density
+    };
+}
+
+// Bilinear lookup with clamp to edge addressing, same as a linear sampler on the GPU
+static auto sample_lut(AtmosphereLUT const & lut, daxa_f32vec2 uv) -> Vec3
+{
+    const daxa_f32 x = std::clamp(uv.x * static_cast<daxa_f32>(lut.dimensions.x) - 0.5f, 0.0f, static_cast<daxa_f32>(lut.dimensions.x - 1));
+    const daxa_f32 y = std::clamp(uv.y * static_cast<daxa_f32>(lut.dimensions.y) - 0.5f, 0.0f, static_cast<daxa_f32>(lut.dimensions.y - 1));
+    const auto x0 = static_cast<daxa_u32>(x);
+    const auto y0 = static_cast<daxa_u32>(y);
+    const daxa_u32 x1 = std::min(x0 + 1, lut.dimensions.x - 1);
+    const daxa_u32 y1 = std::min(y0 + 1, lut.dimensions.y - 1);
+    const daxa_f32 weight_x = x - static_cast<daxa_f32>(x0);
+    const daxa_f32 weight_y = y - static_cast<daxa_f32>(y0);
+
+    const Vec3 top = to_vec3(lut.texel(x0, y0)) * (1.0f - weight_x) + to_vec3(lut.texel(x1, y0)) * weight_x;
+    const Vec3 bottom = to_vec3(lut.texel(x0, y1)) * (1.0f - weight_x) + to_vec3(lut.texel(x1, y1)) * weight_x;
+    return top * (1.0f - weight_y) + bottom * weight_y;
+}
+
+static auto sample_transmittance_to_sun(Globals const & globals, AtmosphereLUT const & transmittance, Vec3 position, Vec3 sun_direction) -> Vec3
+{
+    const auto params = TransmittanceParams{length(position), dot(sun_direction, normalize(position))};
+    return sample_lut(transmittance, transmittance_lut_to_uv(params, globals.atmosphere_bottom, globals.atmosphere_top));
+}
+
+#pragma region integrators
+static auto integrate_transmittance(Globals const & globals, Vec3 world_position, Vec3 world_direction, daxa_u32 sample_count) -> Vec3
+{
+    const daxa_f32 integration_length = ray_sphere_intersect_nearest(world_position, world_direction, {0.0f, 0.0f, 0.0f}, globals.atmosphere_top);
+    const daxa_f32 integration_step = integration_length / static_cast<daxa_f32>(sample_count);
+
+    Vec3 optical_depth = {0.0f, 0.0f, 0.0f};
+    for(daxa_u32 i = 0; i < sample_count; i++)
+    {
+        const Vec3 position = world_position + world_direction * (static_cast<daxa_f32>(i) * integration_step);
+        optical_depth += sample_medium(globals, position).extinction * integration_step;
+    }
+    return optical_depth;
+}
+
+struct MultiscatteringRaymarch
+{
+    Vec3 luminance;
+    Vec3 multiscattering;
+};
+
+static auto integrate_multiscattering(Globals const & globals, AtmosphereLUT const & transmittance,
+    Vec3 world_position, Vec3 world_direction, Vec3 sun_direction, daxa_u32 sample_count) -> MultiscatteringRaymarch
+{
+    static constexpr daxa_f32 uniform_phase = 1.0f / (4.0f * PI);
+    auto result = MultiscatteringRaymarch{};
+    const daxa_f32 integration_length = get_integration_length(globals, world_position, world_direction);
+    if(integration_length == 0.0f) { return result; }
+
+    Vec3 accum_transmittance = {1.0f, 1.0f, 1.0f};
+    daxa_f32 old_ray_shift = 0.0f;
+    for(daxa_u32 i = 0; i < sample_count; i++)
+    {
+        // Sampling at 1/3rd of the integration step gives better results for exponential functions
+        const daxa_f32 new_ray_shift = integration_length * (static_cast<daxa_f32>(i) + 0.3f) / static_cast<daxa_f32>(sample_count);
+        const daxa_f32 integration_step = new_ray_shift - old_ray_shift;
+        const Vec3 position = world_position + new_ray_shift * world_direction;
+        old_ray_shift = new_ray_shift;
+
+        const Vec3 up_vector = normalize(position);
+        const Vec3 transmittance_to_sun = sample_transmittance_to_sun(globals, transmittance, position, sun_direction);
+        const auto medium = sample_medium(globals, position);
+        const Vec3 scattering = medium.mie_scattering + medium.rayleigh_scattering;
+        const Vec3 step_transmittance = exp(medium.extinction * -integration_step);
+
+        const daxa_f32 earth_distance = ray_sphere_intersect_nearest(position, sun_direction,
+            up_vector * PLANET_RADIUS_OFFSET, globals.atmosphere_bottom);
+        const daxa_f32 in_earth_shadow = earth_distance == -1.0f ? 1.0f : 0.0f;
+
+        const Vec3 sun_light = in_earth_shadow * transmittance_to_sun * scattering * uniform_phase;
+        result.multiscattering += accum_transmittance * integrate_step(scattering, step_transmittance, medium.extinction);
+        result.luminance += accum_transmittance * integrate_step(sun_light, step_transmittance, medium.extinction);
+        accum_transmittance *= step_transmittance;
+    }
+    return result;
+}
+
+static auto integrate_scattered_luminance(Globals const & globals, AtmosphereLUT const & transmittance, AtmosphereLUT const & multiscattering,
+    Vec3 world_position, Vec3 world_direction, Vec3 sun_direction, daxa_u32 sample_count) -> Vec3
+{
+    const daxa_f32 integration_length = get_integration_length(globals, world_position, world_direction);
+    if(integration_length == 0.0f) { return {0.0f, 0.0f, 0.0f}; }
+
+    const daxa_f32 cos_theta = dot(sun_direction, world_direction);
+    const daxa_f32 mie_phase_value = hg_draine_phase(cos_theta, 3.6f);
+    const daxa_f32 rayleigh_phase_value = rayleigh_phase(cos_theta);
+
+    Vec3 accum_transmittance = {1.0f, 1.0f, 1.0f};
+    Vec3 accum_light = {0.0f, 0.0f, 0.0f};
+    for(daxa_u32 i = 0; i < sample_count; i++)
+    {
+        // Quadratically growing steps, sampled at one third of each step
+        daxa_f32 step_0 = static_cast<daxa_f32>(i) / static_cast<daxa_f32>(sample_count);
+        daxa_f32 step_1 = static_cast<daxa_f32>(i + 1) / static_cast<daxa_f32>(sample_count);
+        step_0 *= step_0;
+        step_1 *= step_1;
+        step_0 = step_0 * integration_length;
+        step_1 = step_1 > 1.0f ? integration_length : step_1 * integration_length;
+        const daxa_f32 integration_step = step_0 + (step_1 - step_0) * 0.3f;
+        const daxa_f32 d_int_step = step_1 - step_0;
+
+        const Vec3 position = world_position + integration_step * world_direction;
+        const auto medium = sample_medium(globals, position);
+        const Vec3 up_vector = normalize(position);
+        const Vec3 transmittance_to_sun = sample_transmittance_to_sun(globals, transmittance, position, sun_direction);
+        const Vec3 phase_times_scattering = medium.mie_scattering * mie_phase_value + medium.rayleigh_scattering * rayleigh_phase_value;
+
+        const daxa_f32 earth_distance = ray_sphere_intersect_nearest(position, sun_direction, {0.0f, 0.0f, 0.0f}, globals.atmosphere_bottom);
+        const daxa_f32 in_earth_shadow = earth_distance == -1.0f ? 1.0f : 0.0f;
+
+        // Multiple scattering LUT lookup, same parametrization as the multiscattering bake
+        const daxa_f32vec2 multiscattering_uv = {
+            from_unit_to_subuv(std::clamp(dot(sun_direction, up_vector) * 0.5f + 0.5f, 0.0f, 1.0f), static_cast<daxa_f32>(multiscattering.dimensions.x)),
+            from_unit_to_subuv(std::clamp((length(position) - globals.atmosphere_bottom) /
+                (globals.atmosphere_top - globals.atmosphere_bottom), 0.0f, 1.0f), static_cast<daxa_f32>(multiscattering.dimensions.y))
+        };
+        const Vec3 multiscattered_luminance = sample_lut(multiscattering, multiscattering_uv);
+
+        const Vec3 sun_light = in_earth_shadow * transmittance_to_sun * phase_times_scattering +
+            multiscattered_luminance * (medium.rayleigh_scattering + medium.mie_scattering);
+        const Vec3 step_transmittance = exp(medium.extinction * -d_int_step);
+
+        accum_light += accum_transmittance * integrate_step(sun_light, step_transmittance, medium.extinction);
+        accum_transmittance *= step_transmittance;
+    }
+    return accum_light;
+}
+#pragma endregion
+
+auto compute_single_scattering(Globals const & globals, daxa_f32vec3 position, daxa_f32vec3 direction, daxa_f32vec3 sun_direction, daxa_u32 sample_count) -> daxa_f32vec3
+{
+    Vec3 world_position = to_vec3(position);
+    const Vec3 world_direction = normalize(to_vec3(direction));
+    const Vec3 sun = normalize(to_vec3(sun_direction));
+    if(!move_to_top_atmosphere(world_position, world_direction, globals.atmosphere_top)) { return {0.0f, 0.0f, 0.0f}; }
+    const daxa_f32 integration_length = get_integration_length(globals, world_position, world_direction);
+    if(integration_length == 0.0f) { return {0.0f, 0.0f, 0.0f}; }
+
+    const daxa_f32 cos_theta = dot(sun, world_direction);
+    const daxa_f32 mie_phase_value = hg_draine_phase(cos_theta, 3.6f);
+    const daxa_f32 rayleigh_phase_value = rayleigh_phase(cos_theta);
+    const daxa_f32 integration_step = integration_length / static_cast<daxa_f32>(sample_count);
+
+    Vec3 accum_transmittance = {1.0f, 1.0f, 1.0f};
+    Vec3 accum_light = {0.0f, 0.0f, 0.0f};
+    for(daxa_u32 i = 0; i < sample_count; i++)
+    {
+        const Vec3 sample_position = world_position + world_direction * ((static_cast<daxa_f32>(i) + 0.5f) * integration_step);
+        const auto medium = sample_medium(globals, sample_position);
+        const Vec3 step_transmittance = exp(medium.extinction * -integration_step);
+        if(ray_sphere_intersect_nearest(sample_position, sun, {0.0f, 0.0f, 0.0f}, globals.atmosphere_bottom) == -1.0f)
+        {
+            // Transmittance to the sun raymarched directly instead of looked up in the transmittance LUT
+            const Vec3 transmittance_to_sun = exp(integrate_transmittance(globals, sample_position, sun, sample_count) * -1.0f);
+            const Vec3 sun_light = transmittance_to_sun * (medium.mie_scattering * mie_phase_value + medium.rayleigh_scattering * rayleigh_phase_value);
+            accum_light += accum_transmittance * integrate_step(sun_light, step_transmittance, medium.extinction);
+        }
+        accum_transmittance *= step_transmittance;
+    }
+    return to_daxa(accum_light);
+}
+
+auto AtmosphereLUT::texel(daxa_u32 x, daxa_u32 y) const -> daxa_f32vec4 const &
+{
+    return texels.at(static_cast<size_t>(y) * dimensions.x + x);
+}
+
+auto AtmosphereBakeTiming::get_texels_per_second_per_core() const -> daxa_f64
+{
+    if(bake_ms <= 0.0 || thread_count == 0) { return 0.0; }
+    return static_cast<daxa_f64>(texel_count) / (bake_ms * 0.001) / static_cast<daxa_f64>(thread_count);
+}
+
+AtmosphereReference::AtmosphereReference(AtmosphereReferenceInfo const & info) : info{info}
+{
+}
+
+void AtmosphereReference::bake_lut(AtmosphereLUT & lut, daxa_u32vec2 dimensions, AtmosphereBakeTiming & timing, auto && bake_texel)
+{
+    lut.dimensions = dimensions;
+    lut.texels.resize(static_cast<size_t>(dimensions.x) * dimensions.y);
+
+    const daxa_u32 requested_threads = info.thread_count == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : info.thread_count;
+    const daxa_u32 thread_count = std::clamp(requested_threads, 1u, std::max(dimensions.y, 1u));
+
+    // Rows are handed out one at a time, texels close to the horizon take longer to march
+    std::atomic<daxa_u32> next_row = 0;
+    auto bake_rows = [&]
+    {
+        for(daxa_u32 y = next_row++; y < dimensions.y; y = next_row++)
+        {
+            for(daxa_u32 x = 0; x < dimensions.x; x++)
+            {
+                const Vec3 value = bake_texel(x, y);
+                lut.texels.at(static_cast<size_t>(y) * dimensions.x + x) = daxa_f32vec4{value.x, value.y, value.z, 1.0f};
+            }
+        }
+    };
+
+    const auto start = steady_clock::now();
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for(daxa_u32 thread_index = 1; thread_index < thread_count; thread_index++) { threads.emplace_back(bake_rows); }
+    bake_rows();
+    for(auto & thread : threads) { thread.join(); }
+
+    timing = AtmosphereBakeTiming{
+        .texel_count = dimensions.x * dimensions.y,
+        .thread_count = thread_count,
+        .bake_ms = duration<daxa_f64, std::milli>(steady_clock::now() - start).count()
+    };
+}
+
+void AtmosphereReference::bake(Globals const & globals)
+{
+    bake_transmittance(globals);
+    bake_multiscattering(globals);
+    bake_skyview(globals);
+}
+
+void AtmosphereReference::bake_transmittance(Globals const & globals)
+{
+    const auto dimensions = globals.trans_lut_dim;
+    bake_lut(transmittance, dimensions, transmittance_timing, [&](daxa_u32 x, daxa_u32 y) -> Vec3
+    {
+        const daxa_f32vec2 uv = {
+            static_cast<daxa_f32>(x) / static_cast<daxa_f32>(dimensions.x),
+            static_cast<daxa_f32>(y) / static_cast<daxa_f32>(dimensions.y)
+        };
+        const auto mapping = uv_to_transmittance_lut_params(uv, globals.atmosphere_bottom, globals.atmosphere_top);
+        const Vec3 world_position = {0.0f, 0.0f, mapping.height};
+        const Vec3 world_direction = {safe_sqrt(1.0f - mapping.zenith_cos_angle * mapping.zenith_cos_angle), 0.0f, mapping.zenith_cos_angle};
+        return exp(integrate_transmittance(globals, world_position, world_direction, info.transmittance_samples) * -1.0f);
+    });
+}
+
+void AtmosphereReference::bake_multiscattering(Globals const & globals)
+{
+    DBG_ASSERT_TRUE_M(!transmittance.texels.empty(), "[AtmosphereReference::bake_multiscattering()] Transmittance LUT has to be baked first");
+    const auto dimensions = globals.mult_lut_dim;
+    bake_lut(multiscattering, dimensions, multiscattering_timing, [&](daxa_u32 x, daxa_u32 y) -> Vec3
+    {
+        const daxa_f32vec2 uv = {
+            from_subuv_to_unit((static_cast<daxa_f32>(x) + 0.5f) / static_cast<daxa_f32>(dimensions.x), static_cast<daxa_f32>(dimensions.x)),
+            from_subuv_to_unit((static_cast<daxa_f32>(y) + 0.5f) / static_cast<daxa_f32>(dimensions.y), static_cast<daxa_f32>(dimensions.y))
+        };
+        const daxa_f32 sun_cos_zenith_angle = uv.x * 2.0f - 1.0f;
+        const Vec3 sun_direction = {0.0f, safe_sqrt(std::clamp(1.0f - sun_cos_zenith_angle * sun_cos_zenith_angle, 0.0f, 1.0f)), sun_cos_zenith_angle};
+        const daxa_f32 view_height = globals.atmosphere_bottom + std::clamp(uv.y + PLANET_RADIUS_OFFSET, 0.0f, 1.0f) *
+            (globals.atmosphere_top - globals.atmosphere_bottom - PLANET_RADIUS_OFFSET);
+        const Vec3 world_position = {0.0f, 0.0f, view_height};
+
+        // Fibonacci lattice over the sphere, the shader runs one sample per thread of the workgroup
+        Vec3 multiscattering_sum = {0.0f, 0.0f, 0.0f};
+        Vec3 luminance_sum = {0.0f, 0.0f, 0.0f};
+        for(daxa_u32 sample = 0; sample < SPHERE_SAMPLES; sample++)
+        {
+            const auto sample_index = static_cast<daxa_f32>(sample);
+            const daxa_f32 theta = std::acos(1.0f - 2.0f * (sample_index + 0.5f) / static_cast<daxa_f32>(SPHERE_SAMPLES));
+            const daxa_f32 phi = (2.0f * PI * sample_index) / GOLDEN_RATIO;
+            const Vec3 world_direction = {std::cos(theta) * std::sin(phi), std::sin(theta) * std::sin(phi), std::cos(phi)};
+            const auto result = integrate_multiscattering(globals, transmittance, world_position, world_direction,
+                sun_direction, info.multiscattering_samples);
+            multiscattering_sum += result.multiscattering * (1.0f / SPHERE_SAMPLES);
+            luminance_sum += result.luminance * (1.0f / SPHERE_SAMPLES);
+        }
+        // Geometric series of all the scattering orders
+        const Vec3 all_orders = {
+            1.0f / (1.0f - multiscattering_sum.x),
+            1.0f / (1.0f - multiscattering_sum.y),
+            1.0f / (1.0f - multiscattering_sum.z)
+        };
+        return luminance_sum * all_orders;
+    });
+}
+
+void AtmosphereReference::bake_skyview(Globals const & globals)
+{
+    DBG_ASSERT_TRUE_M(!multiscattering.texels.empty(), "[AtmosphereReference::bake_skyview()] Multiscattering LUT has to be baked first");
+    const auto dimensions = globals.sky_lut_dim;
+    Vec3 camera_position = (to_vec3(globals.camera_position) - Vec3{
+        static_cast<daxa_f32>(globals.offset.x),
+        static_cast<daxa_f32>(globals.offset.y),
+        static_cast<daxa_f32>(globals.offset.z)}) * static_cast<daxa_f32>(UNIT_SCALE);
+    camera_position.z += globals.atmosphere_bottom;
+    const daxa_f32 view_height = length(camera_position);
+
+    // The LUT is parametrized relative to the sun, rotate it so that it lies in the y = 0 plane
+    const daxa_f32 sun_zenith_cos_angle = dot(normalize(camera_position), to_vec3(globals.sun_direction));
+    const Vec3 local_sun_direction = normalize({safe_sqrt(1.0f - sun_zenith_cos_angle * sun_zenith_cos_angle), 0.0f, sun_zenith_cos_angle});
+
+    bake_lut(skyview, dimensions, skyview_timing, [&](daxa_u32 x, daxa_u32 y) -> Vec3
+    {
+        const daxa_f32vec2 uv = {
+            static_cast<daxa_f32>(x) / static_cast<daxa_f32>(dimensions.x),
+            static_cast<daxa_f32>(y) / static_cast<daxa_f32>(dimensions.y)
+        };
+        const auto params = uv_to_skyview_lut_params(uv, globals.atmosphere_bottom, dimensions, view_height);
+        const Vec3 world_direction = {
+            std::cos(params.light_view_angle) * std::sin(params.view_zenith_angle),
+            std::sin(params.light_view_angle) * std::sin(params.view_zenith_angle),
+            std::cos(params.view_zenith_angle)
+        };
+        Vec3 world_position = {0.0f, 0.0f, view_height};
+        if(!move_to_top_atmosphere(world_position, world_direction, globals.atmosphere_top)) { return {0.0f, 0.0f, 0.0f}; }
+        return integrate_scattered_luminance(globals, transmittance, multiscattering, world_position, world_direction,
+            local_sun_direction, info.skyview_samples);
+    });
+}
+
+auto AtmosphereReference::evaluate_sky_luminance(Globals const & globals, daxa_f32vec3 position, daxa_f32vec3 direction) const -> daxa_f32vec3
+{
+    DBG_ASSERT_TRUE_M(!multiscattering.texels.empty(), "[AtmosphereReference::evaluate_sky_luminance()] Multiscattering LUT has to be baked first");
+    Vec3 world_position = to_vec3(position);
+    const Vec3 world_direction = normalize(to_vec3(direction));
+    if(!move_to_top_atmosphere(world_position, world_direction, globals.atmosphere_top)) { return {0.0f, 0.0f, 0.0f}; }
+    return to_daxa(integrate_scattered_luminance(globals, transmittance, multiscattering, world_position, world_direction,
+        normalize(to_vec3(globals.sun_direction)), info.skyview_samples));
+}
+
+auto AtmosphereReference::get_transmittance() const -> AtmosphereLUT const & { return transmittance; }
+auto AtmosphereReference::get_multiscattering() const -> AtmosphereLUT const & { return multiscattering; }
+auto AtmosphereReference::get_skyview() const -> AtmosphereLUT const & { return skyview; }
+auto AtmosphereReference::get_transmittance_timing() const -> AtmosphereBakeTiming const & { return transmittance_timing; }
+auto AtmosphereReference::get_multiscattering_timing() const -> AtmosphereBakeTiming const & { return multiscattering_timing; }
+auto AtmosphereReference::get_skyview_timing() const -> AtmosphereBakeTiming const & { return skyview_timing; }
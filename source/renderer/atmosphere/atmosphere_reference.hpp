@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+#include "../shared/shared.inl"
+
+struct AtmosphereReferenceInfo
+{
+    // Zero uses one thread per hardware thread
+    daxa_u32 thread_count = 0;
+    // Raymarch sample counts, the defaults match the LUT shaders
+    daxa_u32 transmittance_samples = 400;
+    daxa_u32 multiscattering_samples = 20;
+    daxa_u32 skyview_samples = 50;
+};
+
+// Texels in the same layout as the GPU LUT images, row major starting at texel (0, 0)
+struct AtmosphereLUT
+{
+    daxa_u32vec2 dimensions = {0, 0};
+    std::vector<daxa_f32vec4> texels = {};
+
+    [[nodiscard]] auto texel(daxa_u32 x, daxa_u32 y) const -> daxa_f32vec4 const &;
+};
+
+struct AtmosphereBakeTiming
+{
+    daxa_u32 texel_count;
+    daxa_u32 thread_count;
+    daxa_f64 bake_ms;
+
+    [[nodiscard]] auto get_texels_per_second_per_core() const -> daxa_f64;
+};
+
+// Single scattered luminance arriving at position from direction with the sun transmittance raymarched as well,
+// needs no LUTs. A cheap estimate of how the sky changes with the sun and the camera, not of its absolute value
+[[nodiscard]] auto compute_single_scattering(Globals const & globals, daxa_f32vec3 position, daxa_f32vec3 direction, daxa_f32vec3 sun_direction, daxa_u32 sample_count) -> daxa_f32vec3;
+
+// CPU port of the transmittance, multiscattering and skyview LUT shaders driven by the same Globals fields.
+// The medium densities are evaluated from the density profiles directly instead of the baked medium LUT so
+// the results are the ground truth the GPU LUTs converge to. Rows of a LUT are baked in parallel
+struct AtmosphereReference
+{
+    explicit AtmosphereReference(AtmosphereReferenceInfo const & info = {});
+
+    // Bakes all three LUTs in dependency order with the LUT dimensions stored in globals
+    void bake(Globals const & globals);
+    void bake_transmittance(Globals const & globals);
+    // Both need the transmittance LUT, the skyview LUT the multiscattering one as well
+    void bake_multiscattering(Globals const & globals);
+    void bake_skyview(Globals const & globals);
+
+    // Luminance arriving at position (planet centered, in km) from direction, computed the same way as a
+    // skyview LUT texel but without the LUT parametrization. Needs the transmittance and multiscattering LUTs
+    [[nodiscard]] auto evaluate_sky_luminance(Globals const & globals, daxa_f32vec3 position, daxa_f32vec3 direction) const -> daxa_f32vec3;
+
+    [[nodiscard]] auto get_transmittance() const -> AtmosphereLUT const &;
+    [[nodiscard]] auto get_multiscattering() const -> AtmosphereLUT const &;
+    [[nodiscard]] auto get_skyview() const -> AtmosphereLUT const &;
+
+    [[nodiscard]] auto get_transmittance_timing() const -> AtmosphereBakeTiming const &;
+    [[nodiscard]] auto get_multiscattering_timing() const -> AtmosphereBakeTiming const &;
+    [[nodiscard]] auto get_skyview_timing() const -> AtmosphereBakeTiming const &;
+
+    private:
+        // Calls bake_texel(x, y) for every texel of the lut and measures the bake
+        void bake_lut(AtmosphereLUT & lut, daxa_u32vec2 dimensions, AtmosphereBakeTiming & timing, auto && bake_texel);
+
+        AtmosphereReferenceInfo info;
+        AtmosphereLUT transmittance = {};
+        AtmosphereLUT multiscattering = {};
+        AtmosphereLUT skyview = {};
+        AtmosphereBakeTiming transmittance_timing = {};
+        AtmosphereBakeTiming multiscattering_timing = {};
+        AtmosphereBakeTiming skyview_timing = {};
+};
@@ -0,0 +1,129 @@
+#include "medium_lut.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "../../utils.hpp"
+
+// Midpoints between texels are where linear interpolation is the least accurate
+static constexpr daxa_u32 ERROR_SAMPLES_PER_TEXEL = 4;
+
+static auto sample_densities(MediumDensityParams const & params, daxa_f32 height) -> std::array<daxa_f32, 3>
+{
+    return {
+        sample_density_profile(params.mie_density, height),
+        sample_density_profile(params.rayleigh_density, height),
+        sample_density_profile(params.absorption_density, height)
+    };
+}
+
+auto get_medium_density_params(Globals const & globals) -> MediumDensityParams
+{
+    auto params = MediumDensityParams{ .atmosphere_height = globals.atmosphere_top - globals.atmosphere_bottom };
+    std::copy_n(globals.mie_density, 2, params.mie_density);
+    std::copy_n(globals.rayleigh_density, 2, params.rayleigh_density);
+    std::copy_n(globals.absorption_density, 2, params.absorption_density);
+    return params;
+}
+
+auto sample_density_profile(DensityProfileLayer const (&profile)[2], daxa_f32 height) -> daxa_f32
+{
+    auto const & layer = height < profile[0].layer_width ? profile[0] : profile[1];
+    const daxa_f32 density = layer.exp_term * std::exp(layer.exp_scale * height) + layer.lin_term * height + layer.const_term;
+    return std::clamp(density, 0.0f, 1.0f);
+}
+
+auto MediumLUT::update(Globals const & globals) -> bool
+{
+    const auto params = get_medium_density_params(globals);
+    if(baked && std::memcmp(&params, &last_params, sizeof(MediumDensityParams)) == 0) { return false; }
+
+    const auto start = std::chrono::steady_clock::now();
+    bake(params);
+    bake_time_us = std::chrono::duration<daxa_f64, std::micro>(std::chrono::steady_clock::now() - start).count();
+    measure_error(params);
+
+    DEBUG_OUT("[MediumLUT::update()] Baked " << MEDIUM_LUT_RESOLUTION << " texels in " << bake_time_us <<
+              " us, max normalized error " << max_normalized_error);
+
+    last_params = params;
+    baked = true;
+    upload_pending = true;
+    return true;
+}
+
+void MediumLUT::bake(MediumDensityParams const & params)
+{
+    texels.resize(MEDIUM_LUT_RESOLUTION);
+    for(daxa_u32 texel = 0; texel < MEDIUM_LUT_RESOLUTION; texel++)
+    {
+        const daxa_f32 height = params.atmosphere_height * static_cast<daxa_f32>(texel) / static_cast<daxa_f32>(MEDIUM_LUT_RESOLUTION - 1);
+        const auto densities = sample_densities(params, height);
+        texels.at(texel) = daxa_f32vec4{densities[0], densities[1], densities[2], 0.0f};
+    }
+}
+
+void MediumLUT::measure_error(MediumDensityParams const & params)
+{
+    static constexpr daxa_u32 sample_count = (MEDIUM_LUT_RESOLUTION - 1) * ERROR_SAMPLES_PER_TEXEL + 1;
+    std::array<daxa_f32, 3> peak_density = {};
+    std::array<daxa_f32, 3> max_error = {};
+
+    for(daxa_u32 sample = 0; sample < sample_count; sample++)
+    {
+        const daxa_f32 lut_position = static_cast<daxa_f32>(sample) / static_cast<daxa_f32>(ERROR_SAMPLES_PER_TEXEL);
+        const daxa_u32 left_texel = std::min(static_cast<daxa_u32>(lut_position), static_cast<daxa_u32>(MEDIUM_LUT_RESOLUTION - 2));
+        const daxa_f32 weight = lut_position - static_cast<daxa_f32>(left_texel);
+
+        auto const & left = texels.at(left_texel);
+        auto const & right = texels.at(left_texel + 1);
+        const std::array<daxa_f32, 3> interpolated = {
+            left.x + (right.x - left.x) * weight,
+            left.y + (right.y - left.y) * weight,
+            left.z + (right.z - left.z) * weight
+        };
+
+        const daxa_f32 height = params.atmosphere_height * lut_position / static_cast<daxa_f32>(MEDIUM_LUT_RESOLUTION - 1);
+        const auto analytic = sample_densities(params, height);
+        for(daxa_u32 medium = 0; medium < 3; medium++)
+        {
+            peak_density[medium] = std::max(peak_density[medium], analytic[medium]);
+            max_error[medium] = std::max(max_error[medium], std::abs(interpolated[medium] - analytic[medium]));
+        }
+    }
+
+    max_normalized_error = 0.0f;
+    for(daxa_u32 medium = 0; medium < 3; medium++)
+    {
+        if(peak_density[medium] <= 0.0f) { continue; }
+        max_normalized_error = std::max(max_normalized_error, max_error[medium] / peak_density[medium]);
+    }
+}
+
+auto MediumLUT::get_texels() const -> std::vector<daxa_f32vec4> const &
+{
+    return texels;
+}
+
+auto MediumLUT::needs_upload() const -> bool
+{
+    return upload_pending;
+}
+
+void MediumLUT::mark_uploaded()
+{
+    upload_pending = false;
+}
+
+auto MediumLUT::get_max_normalized_error() const -> daxa_f32
+{
+    return max_normalized_error;
+}
+
+auto MediumLUT::get_bake_time_us() const -> daxa_f64
+{
+    return bake_time_us;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+#include "../shared/shared.inl"
+
+// Only the parameters which change the medium densities, the scattering and extinction
+// coefficients are applied in the shaders and can thus change without rebaking the LUT
+struct MediumDensityParams
+{
+    daxa_f32 atmosphere_height;
+    DensityProfileLayer mie_density[2];
+    DensityProfileLayer rayleigh_density[2];
+    DensityProfileLayer absorption_density[2];
+};
+
+[[nodiscard]] auto get_medium_density_params(Globals const & globals) -> MediumDensityParams;
+// density = clamp(exp_term * exp(exp_scale * h) + lin_term * h + const_term, 0, 1) using the first layer below its width
+[[nodiscard]] auto sample_density_profile(DensityProfileLayer const (&profile)[2], daxa_f32 height) -> daxa_f32;
+
+// Mie, rayleigh and ozone densities tabulated over the atmosphere height, texel i holds the densities at
+// height i / (MEDIUM_LUT_RESOLUTION - 1) * atmosphere_height
+struct MediumLUT
+{
+    // Rebakes the texels when the density parameters differ from the last bake, returns true if it did
+    auto update(Globals const & globals) -> bool;
+
+    [[nodiscard]] auto get_texels() const -> std::vector<daxa_f32vec4> const &;
+    [[nodiscard]] auto needs_upload() const -> bool;
+    void mark_uploaded();
+
+    // Largest difference between the linearly interpolated LUT and the analytic densities
+    // relative to the peak density of each medium
+    [[nodiscard]] auto get_max_normalized_error() const -> daxa_f32;
+    [[nodiscard]] auto get_bake_time_us() const -> daxa_f64;
+
+    private:
+        void bake(MediumDensityParams const & params);
+        void measure_error(MediumDensityParams const & params);
+
+        bool baked = false;
+        bool upload_pending = false;
+        MediumDensityParams last_params = {};
+        std::vector<daxa_f32vec4> texels = {};
+        daxa_f32 max_normalized_error = 0.0f;
+        daxa_f64 bake_time_us = 0.0;
+};
@@ -0,0 +1,213 @@
+#include "skyview_cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "atmosphere_reference.hpp"
+
+auto get_skyview_parameters(Globals const & globals) -> SkyviewParameters
+{
+    const daxa_f32vec3 world_position = {
+        (globals.camera_position.x - static_cast<daxa_f32>(globals.offset.x)) * static_cast<daxa_f32>(UNIT_SCALE),
+        (globals.camera_position.y - static_cast<daxa_f32>(globals.offset.y)) * static_cast<daxa_f32>(UNIT_SCALE),
+        (globals.camera_position.z - static_cast<daxa_f32>(globals.offset.z)) * static_cast<daxa_f32>(UNIT_SCALE) + globals.atmosphere_bottom
+    };
+    const daxa_f32 camera_height = std::sqrt(
+        world_position.x * world_position.x + world_position.y * world_position.y + world_position.z * world_position.z);
+    const daxa_f32 sun_zenith_cos_angle = (
+        world_position.x * globals.sun_direction.x +
+        world_position.y * globals.sun_direction.y +
+        world_position.z * globals.sun_direction.z) / camera_height;
+    return { camera_height, std::clamp(sun_zenith_cos_angle, -1.0f, 1.0f) };
+}
+
+auto SkyviewCacheStatistics::get_dispatches_saved() const -> daxa_i32
+{
+    const daxa_u32 frames = reused_frames + blended_frames + evaluated_frames;
+    return static_cast<daxa_i32>(frames) - static_cast<daxa_i32>(evaluated_frames + cache_bakes);
+}
+
+SkyviewCache::SkyviewCache(SkyviewCacheInfo const & info) : info{info}
+{
+}
+
+auto SkyviewCache::plan(Globals const & globals, bool invalidate) -> SkyviewCachePlan const &
+{
+    frame_index += 1;
+    if(invalidate || globals.sky_lut_dim.x != lut_dimensions.x || globals.sky_lut_dim.y != lut_dimensions.y)
+    {
+        layers = {};
+        output_valid = false;
+        lut_dimensions = globals.sky_lut_dim;
+    }
+
+    const auto parameters = get_skyview_parameters(globals);
+    const Probes reference = evaluate_probes(globals, parameters);
+
+    current_plan = {};
+    if(output_valid && estimate_error(output_probes, reference) <= info.max_relative_error)
+    {
+        current_plan.source = SkyviewSource::REUSE;
+        current_plan.parameters = output_parameters;
+        planned_probes = output_probes;
+        return current_plan;
+    }
+
+    // Cell of the cache grid containing the parameters, clamped so that all four corners lie inside the atmosphere
+    const daxa_f32 altitude_range = std::max(globals.atmosphere_top - globals.atmosphere_bottom, info.altitude_step);
+    const auto altitude_cells = static_cast<daxa_i32>(std::ceil(altitude_range / info.altitude_step));
+    const auto sun_zenith_cells = static_cast<daxa_i32>(std::ceil(2.0f / info.sun_zenith_cos_step));
+    const daxa_f32 altitude_coord = std::clamp((parameters.camera_height - globals.atmosphere_bottom) / info.altitude_step,
+        0.0f, static_cast<daxa_f32>(altitude_cells));
+    const daxa_f32 sun_zenith_coord = std::clamp((parameters.sun_zenith_cos_angle + 1.0f) / info.sun_zenith_cos_step,
+        0.0f, static_cast<daxa_f32>(sun_zenith_cells));
+    const daxa_i32 altitude_cell = std::min(static_cast<daxa_i32>(altitude_coord), altitude_cells - 1);
+    const daxa_i32 sun_zenith_cell = std::min(static_cast<daxa_i32>(sun_zenith_coord), sun_zenith_cells - 1);
+    const daxa_f32 altitude_weight = altitude_coord - static_cast<daxa_f32>(altitude_cell);
+    const daxa_f32 sun_zenith_weight = sun_zenith_coord - static_cast<daxa_f32>(sun_zenith_cell);
+
+    std::array<daxa_i32vec2, 4> corner_keys = {};
+    std::array<SkyviewParameters, 4> corner_parameters = {};
+    std::array<daxa_f32, 4> corner_weights = {};
+    Probes interpolated = {};
+    for(daxa_u32 corner = 0; corner < 4; corner++)
+    {
+        const daxa_i32 altitude_offset = static_cast<daxa_i32>(corner & 1u);
+        const daxa_i32 sun_zenith_offset = static_cast<daxa_i32>(corner >> 1u);
+        corner_keys.at(corner) = {altitude_cell + altitude_offset, sun_zenith_cell + sun_zenith_offset};
+        corner_parameters.at(corner) = {
+            .camera_height = globals.atmosphere_bottom + static_cast<daxa_f32>(corner_keys.at(corner).x) * info.altitude_step,
+            .sun_zenith_cos_angle = std::min(static_cast<daxa_f32>(corner_keys.at(corner).y) * info.sun_zenith_cos_step - 1.0f, 1.0f)
+        };
+        corner_weights.at(corner) =
+            (altitude_offset == 1 ? altitude_weight : 1.0f - altitude_weight) *
+            (sun_zenith_offset == 1 ? sun_zenith_weight : 1.0f - sun_zenith_weight);
+
+        const Probes corner_probes = evaluate_probes(globals, corner_parameters.at(corner));
+        for(daxa_u32 probe = 0; probe < SKYVIEW_ERROR_PROBES; probe++)
+        {
+            interpolated.at(probe).x += corner_weights.at(corner) * corner_probes.at(probe).x;
+            interpolated.at(probe).y += corner_weights.at(corner) * corner_probes.at(probe).y;
+            interpolated.at(probe).z += corner_weights.at(corner) * corner_probes.at(probe).z;
+        }
+    }
+
+    current_plan.parameters = parameters;
+    if(estimate_error(interpolated, reference) > info.max_relative_error)
+    {
+        current_plan.source = SkyviewSource::EVALUATE;
+        planned_probes = reference;
+        return current_plan;
+    }
+
+    current_plan.source = SkyviewSource::BLEND;
+    planned_probes = interpolated;
+    std::array<daxa_u32, 4> corner_layers = {};
+    for(daxa_u32 corner = 0; corner < 4; corner++)
+    {
+        corner_layers.at(corner) = acquire_layer(corner_keys.at(corner));
+        if(!layers.at(corner_layers.at(corner)).baked)
+        {
+            current_plan.bakes.at(current_plan.bake_count) = {
+                .layer = corner_layers.at(corner),
+                .parameters = corner_parameters.at(corner)
+            };
+            current_plan.bake_count += 1;
+        }
+    }
+    current_plan.blend_layers = {corner_layers.at(0), corner_layers.at(1), corner_layers.at(2), corner_layers.at(3)};
+    current_plan.blend_weights = {corner_weights.at(0), corner_weights.at(1), corner_weights.at(2), corner_weights.at(3)};
+    return current_plan;
+}
+
+void SkyviewCache::commit()
+{
+    for(daxa_u32 bake = 0; bake < current_plan.bake_count; bake++)
+    {
+        layers.at(current_plan.bakes.at(bake).layer).baked = true;
+    }
+    statistics.cache_bakes += current_plan.bake_count;
+    switch(current_plan.source)
+    {
+        case SkyviewSource::REUSE: statistics.reused_frames += 1; break;
+        case SkyviewSource::BLEND: statistics.blended_frames += 1; break;
+        case SkyviewSource::EVALUATE: statistics.evaluated_frames += 1; break;
+    }
+    output_valid = true;
+    output_parameters = current_plan.parameters;
+    output_probes = planned_probes;
+}
+
+auto SkyviewCache::acquire_layer(daxa_i32vec2 key) -> daxa_u32
+{
+    daxa_u32 victim = 0;
+    for(daxa_u32 layer = 0; layer < SKYVIEW_CACHE_LAYERS; layer++)
+    {
+        auto & candidate = layers.at(layer);
+        if(candidate.allocated && candidate.key.x == key.x && candidate.key.y == key.y)
+        {
+            candidate.last_used_frame = frame_index;
+            return layer;
+        }
+        // Free layers first, otherwise the least recently used one. Layers used this frame are never evicted
+        // as there are always more layers than corners
+        auto const & current_victim = layers.at(victim);
+        if(current_victim.allocated && (!candidate.allocated || candidate.last_used_frame < current_victim.last_used_frame))
+        {
+            victim = layer;
+        }
+    }
+    layers.at(victim) = { .key = key, .last_used_frame = frame_index, .allocated = true, .baked = false };
+    return victim;
+}
+
+auto SkyviewCache::evaluate_probes(Globals const & globals, SkyviewParameters const & parameters) const -> Probes
+{
+    // Same local frame as the skyview shader, the sun lies in the xz plane. Most probes look towards the sun
+    // close to the horizon where the sky changes the most
+    static constexpr std::array<daxa_f32vec3, SKYVIEW_ERROR_PROBES> directions = {
+        daxa_f32vec3{0.0f, 0.0f, 1.0f},
+        daxa_f32vec3{0.985f, 0.0f, 0.174f},
+        daxa_f32vec3{0.707f, 0.0f, 0.707f},
+        daxa_f32vec3{0.0f, 0.985f, 0.174f},
+        daxa_f32vec3{-0.985f, 0.0f, 0.174f},
+    };
+    const daxa_f32 sun_zenith_cos_angle = parameters.sun_zenith_cos_angle;
+    const daxa_f32vec3 sun_direction = {std::sqrt(std::max(0.0f, 1.0f - sun_zenith_cos_angle * sun_zenith_cos_angle)), 0.0f, sun_zenith_cos_angle};
+    const daxa_f32vec3 position = {0.0f, 0.0f, parameters.camera_height};
+
+    Probes probes = {};
+    for(daxa_u32 probe = 0; probe < SKYVIEW_ERROR_PROBES; probe++)
+    {
+        probes.at(probe) = compute_single_scattering(globals, position, directions.at(probe), sun_direction, info.estimate_samples);
+    }
+    return probes;
+}
+
+auto SkyviewCache::estimate_error(Probes const & approximation, Probes const & reference) const -> daxa_f32
+{
+    // Relative to the reference with a floor at a fraction of the brightest probe, dim parts of the sky
+    // opposite of the sun would otherwise dominate the error
+    static constexpr daxa_f32 RELATIVE_FLOOR = 0.05f;
+    daxa_f32 peak = 0.0f;
+    for(auto const & luminance : reference) { peak = std::max({peak, luminance.x, luminance.y, luminance.z}); }
+    const daxa_f32 floor = std::max(peak * RELATIVE_FLOOR, std::numeric_limits<daxa_f32>::min());
+
+    daxa_f32 error = 0.0f;
+    auto channel = [&](daxa_f32 approximation, daxa_f32 reference)
+    {
+        error = std::max(error, std::abs(approximation - reference) / std::max(reference, floor));
+    };
+    for(daxa_u32 probe = 0; probe < SKYVIEW_ERROR_PROBES; probe++)
+    {
+        channel(approximation.at(probe).x, reference.at(probe).x);
+        channel(approximation.at(probe).y, reference.at(probe).y);
+        channel(approximation.at(probe).z, reference.at(probe).z);
+    }
+    return error;
+}
+
+auto SkyviewCache::get_plan() const -> SkyviewCachePlan const & { return current_plan; }
+auto SkyviewCache::get_statistics() const -> SkyviewCacheStatistics const & { return statistics; }
+auto SkyviewCache::get_info() const -> SkyviewCacheInfo const & { return info; }
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+#include "../shared/shared.inl"
+
+// Layers of the GPU sky-view cache image, four are needed for one interpolation
+static constexpr daxa_u32 SKYVIEW_CACHE_LAYERS = 16;
+// View directions the error of a reused or interpolated LUT is estimated in
+static constexpr daxa_u32 SKYVIEW_ERROR_PROBES = 5;
+
+struct SkyviewCacheInfo
+{
+    // Spacing of the cache grid, camera altitude above the planet surface in km and sun zenith cos angle
+    daxa_f32 altitude_step = 0.5f;
+    daxa_f32 sun_zenith_cos_step = 0.02f;
+    // Largest estimated relative error of a reused or interpolated LUT, above it the LUT is evaluated again
+    daxa_f32 max_relative_error = 0.01f;
+    // Raymarch steps (along the view and towards the sun) of the single scattering the error is estimated with
+    daxa_u32 estimate_samples = 12;
+};
+
+// Apart from the atmosphere parameters the sky-view LUT only depends on these two
+struct SkyviewParameters
+{
+    // Distance of the camera from the planet center in km
+    daxa_f32 camera_height;
+    // Cos of the angle between the sun and the local up vector of the camera
+    daxa_f32 sun_zenith_cos_angle;
+};
+
+// Same derivation as the skyview shader did from Globals
+[[nodiscard]] auto get_skyview_parameters(Globals const & globals) -> SkyviewParameters;
+
+enum struct SkyviewSource
+{
+    // The LUT of the last frame is still within the error bound, nothing is dispatched
+    REUSE,
+    // Interpolated from the four cache layers around the parameters, missing layers are baked first
+    BLEND,
+    // Raymarched for the exact parameters, as without the cache
+    EVALUATE
+};
+
+struct SkyviewCacheBake
+{
+    daxa_u32 layer;
+    SkyviewParameters parameters;
+};
+
+// What the skyview task records this frame
+struct SkyviewCachePlan
+{
+    SkyviewSource source = SkyviewSource::EVALUATE;
+    // Parameters the skyview LUT holds after this frame
+    SkyviewParameters parameters = {};
+    std::array<SkyviewCacheBake, 4> bakes = {};
+    daxa_u32 bake_count = 0;
+    daxa_u32vec4 blend_layers = {0, 0, 0, 0};
+    daxa_f32vec4 blend_weights = {0.0f, 0.0f, 0.0f, 0.0f};
+};
+
+struct SkyviewCacheStatistics
+{
+    daxa_u32 reused_frames = 0;
+    daxa_u32 blended_frames = 0;
+    daxa_u32 evaluated_frames = 0;
+    daxa_u32 cache_bakes = 0;
+
+    // Full sky-view raymarch dispatches compared to evaluating the LUT every frame
+    [[nodiscard]] auto get_dispatches_saved() const -> daxa_i32;
+};
+
+// CPU policy of the sky-view LUT cache. Cached LUTs are keyed by the quantised camera altitude and sun zenith and
+// interpolated bilinearly. The error of reusing or interpolating is estimated from the single scattered luminance
+// in a few probe directions, which needs no LUTs and changes fastest where the sky does (around sunrise and sunset).
+// Does not reference any device object, Renderer records the plan and the headless driver only counts it
+struct SkyviewCache
+{
+    explicit SkyviewCache(SkyviewCacheInfo const & info = {});
+
+    // Plans the skyview update of a frame, invalidate drops all cached LUTs (the atmosphere parameters changed)
+    auto plan(Globals const & globals, bool invalidate) -> SkyviewCachePlan const &;
+    // Called once the plan was recorded, the baked layers and the skyview LUT now hold what it describes
+    void commit();
+
+    [[nodiscard]] auto get_plan() const -> SkyviewCachePlan const &;
+    [[nodiscard]] auto get_statistics() const -> SkyviewCacheStatistics const &;
+    [[nodiscard]] auto get_info() const -> SkyviewCacheInfo const &;
+
+    private:
+        struct Layer
+        {
+            daxa_i32vec2 key = {0, 0};
+            daxa_u64 last_used_frame = 0;
+            bool allocated = false;
+            bool baked = false;
+        };
+
+        using Probes = std::array<daxa_f32vec3, SKYVIEW_ERROR_PROBES>;
+
+        // Returns the layer holding key, allocating the least recently used one when there is none
+        auto acquire_layer(daxa_i32vec2 key) -> daxa_u32;
+        [[nodiscard]] auto evaluate_probes(Globals const & globals, SkyviewParameters const & parameters) const -> Probes;
+        [[nodiscard]] auto estimate_error(Probes const & approximation, Probes const & reference) const -> daxa_f32;
+
+        SkyviewCacheInfo info;
+        std::array<Layer, SKYVIEW_CACHE_LAYERS> layers = {};
+        SkyviewCachePlan current_plan = {};
+        SkyviewCacheStatistics statistics = {};
+        daxa_u64 frame_index = 0;
+        // The skyview LUT image and the cache layers are recreated with new dimensions
+        daxa_u32vec2 lut_dimensions = {0, 0};
+        bool output_valid = false;
+        SkyviewParameters output_parameters = {};
+        // Probes of what the skyview LUT holds, interpolated ones when it was blended
+        Probes output_probes = {};
+        Probes planned_probes = {};
+};
@@ -9,6 +9,8 @@
 #include <daxa/utils/pipeline_manager.hpp>
 
 #include "../camera.hpp"
+#include "residency_manager.hpp"
+#include "frame_state.hpp"
 
 #include "shared/shared.inl"
 
@@ -23,9 +25,23 @@ struct Context
         daxa::TaskBuffer globals;
         daxa::TaskBuffer terrain_vertices;
         daxa::TaskBuffer terrain_indices;
+        // Height range of each terrain patch, recomputed whenever the terrain geometry is uploaded
+        daxa::TaskBuffer terrain_patch_bounds;
+        // Terrain patches touching a dirty page, VSM_CLIP_LEVELS index ranges the size of terrain_indices
+        daxa::TaskBuffer vsm_culled_terrain_indices;
         daxa::TaskBuffer frustum_indices;
+        // Only grow, sized to the largest debug draw stream seen so far
+        daxa::TaskBuffer debug_frustum_vertices;
+        daxa::TaskBuffer debug_frustum_colors;
+        daxa::TaskBuffer debug_line_vertices;
         daxa::TaskBuffer average_luminance;
         daxa::TaskBuffer histogram_readback;
+        daxa::TaskBuffer vsm_statistics_readback;
+        daxa::TaskBuffer vsm_sun_projections;
+        daxa::TaskBuffer vsm_free_wrapped_pages_info;
+        // Texels of the offline baked atmosphere LUTs, copied into the LUT images by the frame that loaded them
+        daxa::TaskBuffer transmittance_lut_staging;
+        daxa::TaskBuffer multiscattering_lut_staging;
     };
 
     struct Images
@@ -36,12 +52,21 @@ struct Context
         daxa::TaskImage height_map;
         daxa::TaskImage normal_map;
         daxa::TaskImage tonemapping_lut;
+        daxa::TaskImage medium_lut;
+        // Persistent so that they are only rebaked when the atmosphere parameters change
+        daxa::TaskImage transmittance_lut;
+        daxa::TaskImage multiscattering_lut;
+        // Persistent so that frames within the skyview cache error bound skip the skyview pass
+        daxa::TaskImage skyview_lut;
+        daxa::TaskImage skyview_cache;
 
         daxa::TaskImage vsm_page_table;
         daxa::TaskImage vsm_page_height_offset;
         daxa::TaskImage vsm_debug_page_table;
         daxa::TaskImage vsm_memory;
         daxa::TaskImage vsm_meta_memory_table;
+        // Frame index each physical page was last used in, orders the eviction candidates
+        daxa::TaskImage vsm_meta_memory_last_used;
         daxa::TaskImage vsm_debug_meta_memory_table;
     };
 
@@ -50,6 +75,8 @@ struct Context
         std::shared_ptr<daxa::ComputePipeline> transmittance;
         std::shared_ptr<daxa::ComputePipeline> multiscattering;
         std::shared_ptr<daxa::ComputePipeline> skyview;
+        std::shared_ptr<daxa::ComputePipeline> skyview_cache_bake;
+        std::shared_ptr<daxa::ComputePipeline> skyview_cache_blend;
         std::shared_ptr<daxa::ComputePipeline> first_esm_pass;
         std::shared_ptr<daxa::ComputePipeline> second_esm_pass;
         std::shared_ptr<daxa::ComputePipeline> analyze_depthbuffer_first_pass;
@@ -57,10 +84,14 @@ struct Context
         std::shared_ptr<daxa::ComputePipeline> prepare_shadow_matrices;
         std::shared_ptr<daxa::ComputePipeline> luminance_histogram;
         std::shared_ptr<daxa::ComputePipeline> adapt_average_luminance;
+        std::shared_ptr<daxa::ComputePipeline> terrain_patch_bounds;
         std::shared_ptr<daxa::ComputePipeline> vsm_free_wrapped_pages;
+        std::shared_ptr<daxa::ComputePipeline> vsm_prioritize_requests;
         std::shared_ptr<daxa::ComputePipeline> vsm_find_free_pages;
         std::shared_ptr<daxa::ComputePipeline> vsm_allocate_pages;
         std::shared_ptr<daxa::ComputePipeline> vsm_clear_pages;
+        std::shared_ptr<daxa::ComputePipeline> vsm_build_dirty_pyramid;
+        std::shared_ptr<daxa::ComputePipeline> vsm_cull_terrain_patches;
         std::shared_ptr<daxa::RasterPipeline> vsm_draw_pages;
         std::shared_ptr<daxa::ComputePipeline> vsm_clear_dirty_bit;
         std::shared_ptr<daxa::ComputePipeline> vsm_debug_page_table;
@@ -69,6 +100,7 @@ struct Context
         std::shared_ptr<daxa::RasterPipeline> post_process;
         std::shared_ptr<daxa::RasterPipeline> deferred_pass;
         std::shared_ptr<daxa::RasterPipeline> debug_draw_frustum;
+        std::shared_ptr<daxa::RasterPipeline> debug_draw_lines;
         std::shared_ptr<daxa::RasterPipeline> draw_terrain_wireframe;
         std::shared_ptr<daxa::RasterPipeline> draw_terrain_solid;
         std::shared_ptr<daxa::RasterPipeline> draw_terrain_shadowmap;
@@ -80,6 +112,9 @@ struct Context
         enum Conditionals 
         {
             USE_DEBUG_CAMERA,
+            UPDATE_ATMOSPHERE_LUTS,
+            UPLOAD_BAKED_ATMOSPHERE_LUTS,
+            UPDATE_SKYVIEW_LUT,
             COUNT
         };
 
@@ -87,11 +122,11 @@ struct Context
         {
             daxa::TaskBufferView depth_limits;
             daxa::TaskBufferView shadowmap_data;
-            daxa::TaskBufferView frustum_vertices;
-            daxa::TaskBufferView frustum_colors;
             daxa::TaskBufferView frustum_indirect;
             daxa::TaskBufferView luminance_histogram;
 
+            daxa::TaskBufferView vsm_page_request_count;
+            daxa::TaskBufferView vsm_page_requests;
             daxa::TaskBufferView vsm_allocation_count;
             daxa::TaskBufferView vsm_allocation_requests;
 
@@ -99,19 +134,16 @@ struct Context
             daxa::TaskBufferView vsm_clear_indirect;
             daxa::TaskBufferView vsm_clear_dirty_bit_indirect;
 
-            daxa::TaskBufferView vsm_free_wrapped_pages_info;
             daxa::TaskBufferView vsm_free_page_buffer;
             daxa::TaskBufferView vsm_not_visited_page_buffer;
             daxa::TaskBufferView vsm_find_free_pages_header;
-            daxa::TaskBufferView vsm_sun_projection_matrices;
+            daxa::TaskBufferView vsm_statistics;
+            daxa::TaskBufferView vsm_dirty_pyramid;
+            daxa::TaskBufferView vsm_terrain_draw_commands;
         };
 
         struct TransientImages
         {
-            daxa::TaskImageView transmittance_lut;
-            daxa::TaskImageView multiscattering_lut;
-            daxa::TaskImageView skyview_lut;
-
             // GBuffer
             daxa::TaskImageView g_albedo;
             daxa::TaskImageView g_normals;
@@ -124,6 +156,8 @@ struct Context
             daxa::TaskImageView esm_cascades;
 
             daxa::TaskImageView vsm_debug_image;
+            // Depth samples which requested each unallocated page this frame
+            daxa::TaskImageView vsm_page_request_coverage;
         };
 
         std::array<bool, Conditionals::COUNT> conditionals;
@@ -133,8 +167,6 @@ struct Context
         TransientBuffers buffers;
     };
 
-    Camera sun_camera;
-
     daxa::Instance daxa_instance;
     daxa::Device device;
     daxa::Swapchain swapchain;
@@ -151,16 +183,15 @@ struct Context
     // linear min, linear max, clamp edge
     daxa::SamplerId llce_sampler;
     daxa::ImGuiRenderer imgui_renderer;
+    // Start and end of the VSM page draw pass, one pair per frame in flight
+    daxa::TimelineQueryPool vsm_draw_timestamps;
+
+    ResidencyManager residency;
+    QualityTiers quality_tiers;
 
     daxa_u32 terrain_index_size;
 
-    daxa_u32 debug_frustum_cpu_count;
-    std::array<Histogram, HISTOGRAM_BIN_COUNT> cpu_histogram;
-    std::array<FrustumVertex, 8 * MAX_FRUSTUM_COUNT> frustum_vertices;
-    std::array<FrustumColor, MAX_FRUSTUM_COUNT> frustum_colors;
-    std::array<VSMClipProjection, VSM_CLIP_LEVELS> vsm_sun_projections;
-    std::array<FreeWrappedPagesInfo, VSM_CLIP_LEVELS> vsm_free_wrapped_pages_info;
-    std::array<daxa_i32vec2, VSM_CLIP_LEVELS> vsm_last_frame_offset;
+    FrameState frame;
 };
 
 using MainConditionals = Context::MainTaskList::Conditionals;
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "debug_draw.hpp"
+
+#include <algorithm>
+#include <array>
+
+DebugDrawStream::DebugDrawStream(DebugDrawStreamInfo const & info) : info{info}
+{
+}
+
+void DebugDrawStream::reset()
+{
+    box_vertices.clear();
+    box_colors.clear();
+    line_vertices.clear();
+    dropped_count = 0;
+}
+
+void DebugDrawStream::line(daxa_f32vec3 start, daxa_f32vec3 end, daxa_f32vec3 color)
+{
+    if(get_line_count() >= info.max_lines) { dropped_count += 1; return; }
+    line_vertices.push_back({ .position = start, .color = color });
+    line_vertices.push_back({ .position = end, .color = color });
+}
+
+void DebugDrawStream::box(daxa_f32vec3 min, daxa_f32vec3 max, daxa_f32vec3 color)
+{
+    auto vertices = allocate_boxes(1, color);
+    if(vertices.empty()) { return; }
+    // Near face (min z) followed by the far face, same winding as Camera::write_frustum_vertices()
+    const std::array<daxa_f32vec2, 8> corners = {
+        daxa_f32vec2{min.x, max.y}, daxa_f32vec2{min.x, min.y}, daxa_f32vec2{max.x, min.y}, daxa_f32vec2{max.x, max.y},
+        daxa_f32vec2{max.x, max.y}, daxa_f32vec2{min.x, max.y}, daxa_f32vec2{min.x, min.y}, daxa_f32vec2{max.x, min.y}
+    };
+    for(daxa_u32 i = 0; i < FRUSTUM_VERTEX_COUNT; i++)
+    {
+        vertices[i].vertex = daxa_f32vec3{corners.at(i).x, corners.at(i).y, i < 4 ? min.z : max.z};
+    }
+}
+
+void DebugDrawStream::frustum(std::span<FrustumVertex const, FRUSTUM_VERTEX_COUNT> vertices, daxa_f32vec3 color)
+{
+    auto dst = allocate_boxes(1, color);
+    if(dst.empty()) { return; }
+    std::copy(vertices.begin(), vertices.end(), dst.begin());
+}
+
+auto DebugDrawStream::allocate_boxes(daxa_u32 count, daxa_f32vec3 color) -> std::span<FrustumVertex>
+{
+    if(get_box_count() + count > info.max_boxes) { dropped_count += count; return {}; }
+    const size_t first_vertex = box_vertices.size();
+    box_vertices.resize(first_vertex + size_t(count) * FRUSTUM_VERTEX_COUNT);
+    box_colors.resize(box_colors.size() + count, FrustumColor{ .color = color });
+    return std::span<FrustumVertex>{box_vertices}.subspan(first_vertex);
+}
+
+auto DebugDrawStream::get_box_vertices() const -> std::span<FrustumVertex const> { return box_vertices; }
+auto DebugDrawStream::get_box_colors() const -> std::span<FrustumColor const> { return box_colors; }
+auto DebugDrawStream::get_line_vertices() const -> std::span<DebugLineVertex const> { return line_vertices; }
+auto DebugDrawStream::get_box_count() const -> daxa_u32 { return static_cast<daxa_u32>(box_colors.size()); }
+auto DebugDrawStream::get_line_count() const -> daxa_u32 { return static_cast<daxa_u32>(line_vertices.size() / 2); }
+auto DebugDrawStream::get_dropped_count() const -> daxa_u32 { return dropped_count; }
+auto DebugDrawStream::get_info() const -> DebugDrawStreamInfo const & { return info; }
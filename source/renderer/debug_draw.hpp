@@ -0,0 +1,57 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+#include "shared/shared.inl"
+
+// Boxes appended on the GPU by the shadowmap matrix pass, the end of the box buffer is kept free for them
+static constexpr daxa_u32 GPU_DEBUG_BOX_COUNT = 2 * NUM_CASCADES;
+// Initial capacities of the GPU buffers the stream is uploaded into
+static constexpr daxa_u32 MIN_DEBUG_BOX_CAPACITY = 64;
+static constexpr daxa_u32 MIN_DEBUG_LINE_CAPACITY = 1024;
+
+struct DebugDrawStreamInfo
+{
+    // Everything above the limits is dropped and counted, the stream never grows past them
+    daxa_u32 max_boxes = MAX_FRUSTUM_COUNT - GPU_DEBUG_BOX_COUNT;
+    daxa_u32 max_lines = 1u << 16;
+};
+
+// Immediate mode debug geometry of a single frame. Anything with eight corners (frusta, boxes, VSM pages) is
+// stored as a box and drawn with a single instanced draw, lines are drawn as one line list. The storage is
+// kept between frames so a steady amount of debug geometry does not allocate, an empty stream uploads nothing
+struct DebugDrawStream
+{
+    explicit DebugDrawStream(DebugDrawStreamInfo const & info = {});
+
+    // Called at the start of every frame, keeps the capacity
+    void reset();
+
+    void line(daxa_f32vec3 start, daxa_f32vec3 end, daxa_f32vec3 color);
+    // Axis aligned box, the corners follow the frustum vertex order so it uses the same index buffer
+    void box(daxa_f32vec3 min, daxa_f32vec3 max, daxa_f32vec3 color);
+    void frustum(std::span<FrustumVertex const, FRUSTUM_VERTEX_COUNT> vertices, daxa_f32vec3 color);
+    // Reserves count boxes of the same color, the caller writes FRUSTUM_VERTEX_COUNT vertices per box.
+    // Returns an empty span when the boxes would not fit into the limit
+    auto allocate_boxes(daxa_u32 count, daxa_f32vec3 color) -> std::span<FrustumVertex>;
+
+    [[nodiscard]] auto get_box_vertices() const -> std::span<FrustumVertex const>;
+    [[nodiscard]] auto get_box_colors() const -> std::span<FrustumColor const>;
+    [[nodiscard]] auto get_line_vertices() const -> std::span<DebugLineVertex const>;
+    [[nodiscard]] auto get_box_count() const -> daxa_u32;
+    [[nodiscard]] auto get_line_count() const -> daxa_u32;
+    // Primitives which did not fit into the limits this frame
+    [[nodiscard]] auto get_dropped_count() const -> daxa_u32;
+    [[nodiscard]] auto get_info() const -> DebugDrawStreamInfo const &;
+
+    private:
+        DebugDrawStreamInfo info;
+        std::vector<FrustumVertex> box_vertices = {};
+        std::vector<FrustumColor> box_colors = {};
+        std::vector<DebugLineVertex> line_vertices = {};
+        daxa_u32 dropped_count = 0;
+};
@@ -0,0 +1,302 @@
+#include "frame_state.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "../frame_profiler.hpp"
+
+static void write_camera_globals(FrameState & state, PrepareFrameInfo const & info)
+{
+    auto & globals = info.globals;
+    Camera * primary_camera = globals.use_debug_camera ? &info.debug_camera : &info.main_camera;
+    Camera * secondary_camera = globals.use_debug_camera ? &info.main_camera : &info.debug_camera;
+
+    globals.camera_position     = primary_camera->get_camera_position();
+    globals.offset              = primary_camera->offset;
+    globals.view                = primary_camera->get_view_matrix();
+    globals.projection          = primary_camera->get_projection_matrix();
+    globals.inv_projection      = primary_camera->get_inv_projection_matrix();
+    globals.inv_view_projection = primary_camera->get_inv_view_proj_matrix();
+
+    globals.secondary_camera_position     = secondary_camera->get_camera_position();
+    globals.secondary_offset              = secondary_camera->offset;
+    globals.secondary_view                = secondary_camera->get_view_matrix();
+    globals.secondary_projection          = secondary_camera->get_projection_matrix();
+    globals.secondary_inv_view_projection = secondary_camera->get_inv_view_proj_matrix();
+
+    if(globals.use_debug_camera && globals.control_main_camera)
+    {
+        auto vertices = state.debug_draw.allocate_boxes(1, daxa_f32vec3{1.0, 1.0, 1.0});
+        if(!vertices.empty())
+        {
+            secondary_camera->write_frustum_vertices({ std::span<FrustumVertex, 8>{vertices.data(), 8} });
+        }
+    }
+}
+
+static void update_vsm_clip_map(FrameState & state, PrepareFrameInfo const & info)
+{
+    auto & globals = info.globals;
+    // Setup VSM Clip projection matrices
+    // The page frusti are only visible from the debug camera, they are not even computed otherwise
+    auto page_frusti = std::span<FrustumVertex>{};
+    if(globals.force_view_clip_level && globals.use_debug_camera)
+    {
+        page_frusti = state.debug_draw.allocate_boxes(VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION, daxa_f32vec3{0.0, 0.0, 1.0});
+    }
+    // Resident pages of the previous frame price the clip levels switched to a new sun direction
+    state.vsm_sun_invalidation.update(globals.sun_direction, state.vsm_statistics.resident_pages);
+    state.vsm_clip_map.update({
+        .player_camera = info.main_camera,
+        .sun_camera = state.sun_camera,
+        .sun_directions = state.vsm_sun_invalidation.get_level_sun_directions(),
+        .page_frusti_clip_level = page_frusti.empty() ? -1 : globals.vsm_debug_clip_level,
+        .page_frusti_dst = page_frusti
+    });
+    globals.vsm_sun_offset = state.sun_camera.offset;
+    globals.vsm_clip0_texel_world_size = state.vsm_clip_map.get_clip0_texel_world_size();
+    globals.vsm_page_budget = state.vsm_page_budget.get_budget();
+
+    if(globals.use_debug_camera)
+    {
+        state.debug_draw.frustum(state.vsm_clip_map.get_clip_frustum_vertices(globals.vsm_debug_clip_level), daxa_f32vec3{1.0, 1.0, 0.2});
+    }
+}
+
+auto get_atmosphere_lut_hash(Globals const & globals) -> daxa_u64
+{
+    // FNV-1a over the atmosphere section of Globals and the LUT dimensions, the sun only affects the skyview LUT
+    daxa_u64 hash = 0xcbf29ce484222325ull;
+    auto hash_bytes = [&hash](void const * data, size_t size)
+    {
+        auto const * bytes = reinterpret_cast<std::byte const *>(data);
+        for(size_t byte = 0; byte < size; byte++)
+        {
+            hash = (hash ^ static_cast<daxa_u64>(bytes[byte])) * 0x100000001b3ull;
+        }
+    };
+    auto const * globals_bytes = reinterpret_cast<std::byte const *>(&globals);
+    hash_bytes(globals_bytes + offsetof(Globals, atmosphere_bottom), offsetof(Globals, use_debug_camera) - offsetof(Globals, atmosphere_bottom));
+    hash_bytes(&globals.trans_lut_dim, sizeof(globals.trans_lut_dim));
+    hash_bytes(&globals.mult_lut_dim, sizeof(globals.mult_lut_dim));
+    return hash;
+}
+
+static void update_atmosphere_lut_hash(FrameState & state, Globals const & globals)
+{
+    const daxa_u64 hash = get_atmosphere_lut_hash(globals);
+    if(hash != state.atmosphere_lut_hash)
+    {
+        state.atmosphere_lut_hash = hash;
+        state.atmosphere_luts_dirty = true;
+    }
+}
+
+static void collect_globals_uploads(FrameState & state, Globals const & globals)
+{
+    auto const * globals_bytes = reinterpret_cast<std::byte const *>(&globals);
+    auto const * uploaded_bytes = reinterpret_cast<std::byte const *>(&state.uploaded_globals);
+    for(daxa_u32 group = 0; group < static_cast<daxa_u32>(GlobalsGroup::COUNT); group++)
+    {
+        auto const & range = globals_group_ranges.at(group);
+        state.dirty_globals_groups.at(group) = !state.persistent_buffers_initialized ||
+            std::memcmp(globals_bytes + range.begin, uploaded_bytes + range.begin, range.end - range.begin) != 0;
+    }
+
+    // Neighbouring dirty groups are merged into a single copy
+    for(daxa_u32 group = 0; group < static_cast<daxa_u32>(GlobalsGroup::COUNT);)
+    {
+        if(!state.dirty_globals_groups.at(group)) { group++; continue; }
+        const size_t begin = globals_group_ranges.at(group).begin;
+        while(group < static_cast<daxa_u32>(GlobalsGroup::COUNT) && state.dirty_globals_groups.at(group)) { group++; }
+        const size_t end = globals_group_ranges.at(group - 1).end;
+        state.uploads.push_back({
+            .target = FrameUploadTarget::GLOBALS,
+            .data = globals_bytes + begin,
+            .size = end - begin,
+            .dst_offset = begin
+        });
+    }
+}
+
+static void collect_uploads(FrameState & state, Globals const & globals)
+{
+    auto & uploads = state.uploads;
+    uploads.clear();
+
+    collect_globals_uploads(state, globals);
+    // Medium LUT, only uploaded when the density profiles changed and the LUT was rebaked
+    if(state.medium_lut.needs_upload())
+    {
+        auto const & texels = state.medium_lut.get_texels();
+        uploads.push_back({
+            .target = FrameUploadTarget::MEDIUM_LUT,
+            .data = texels.data(),
+            .size = sizeof(daxa_f32vec4) * texels.size()
+        });
+    }
+    // Debug geometry, nothing is uploaded when the stream is empty. The indirect arguments are always written,
+    // the GPU appends its own boxes after the CPU ones
+    auto const & debug_draw = state.debug_draw;
+    if(debug_draw.get_box_count() > 0)
+    {
+        uploads.push_back({
+            .target = FrameUploadTarget::FRUSTUM_VERTICES,
+            .data = debug_draw.get_box_vertices().data(),
+            .size = debug_draw.get_box_vertices().size_bytes()
+        });
+        uploads.push_back({
+            .target = FrameUploadTarget::FRUSTUM_COLORS,
+            .data = debug_draw.get_box_colors().data(),
+            .size = debug_draw.get_box_colors().size_bytes()
+        });
+    }
+    state.frustum_indirect = DrawIndexedIndirectStruct{
+        .index_count = 18,
+        .instance_count = debug_draw.get_box_count(),
+        .first_index = 0,
+        .vertex_offset = 0,
+        .first_instance = 0
+    };
+    uploads.push_back({
+        .target = FrameUploadTarget::FRUSTUM_INDIRECT,
+        .data = &state.frustum_indirect,
+        .size = sizeof(DrawIndexedIndirectStruct)
+    });
+    if(debug_draw.get_line_count() > 0)
+    {
+        uploads.push_back({
+            .target = FrameUploadTarget::DEBUG_LINE_VERTICES,
+            .data = debug_draw.get_line_vertices().data(),
+            .size = debug_draw.get_line_vertices().size_bytes()
+        });
+    }
+    uploads.push_back({
+        .target = FrameUploadTarget::LUMINANCE_HISTOGRAM,
+        .data = state.histogram_reset.data(),
+        .size = sizeof(Histogram) * HISTOGRAM_BIN_COUNT
+    });
+    uploads.push_back({
+        .target = FrameUploadTarget::VSM_PAGE_REQUEST_COUNT,
+        .data = &state.vsm_page_request_count_reset,
+        .size = sizeof(AllocationCount)
+    });
+    uploads.push_back({
+        .target = FrameUploadTarget::VSM_STATISTICS,
+        .data = &state.vsm_statistics_reset,
+        .size = sizeof(VSMStatistics)
+    });
+    uploads.push_back({
+        .target = FrameUploadTarget::VSM_FIND_FREE_PAGES_HEADER,
+        .data = &state.vsm_find_free_pages_header_reset,
+        .size = sizeof(FindFreePagesHeader)
+    });
+    // VSM sun clip matrices, the buffer is persistent so only the levels which moved are uploaded
+    const auto [first_dirty_level, last_dirty_level] = state.vsm_clip_map.get_dirty_level_range();
+    uploads.push_back({
+        .target = FrameUploadTarget::VSM_SUN_PROJECTIONS,
+        .data = &state.vsm_clip_map.get_clip_projections().at(first_dirty_level),
+        .size = sizeof(VSMClipProjection) * (last_dirty_level - first_dirty_level),
+        .dst_offset = sizeof(VSMClipProjection) * first_dirty_level
+    });
+    // The buffer is persistent as well, the clear offsets are zero unless a level moved so this is rarely uploaded
+    auto const & free_wrapped_pages_info = state.vsm_clip_map.get_free_wrapped_pages_info();
+    if(!state.persistent_buffers_initialized || std::memcmp(free_wrapped_pages_info.data(),
+        state.uploaded_free_wrapped_pages_info.data(), sizeof(FreeWrappedPagesInfo) * VSM_CLIP_LEVELS) != 0)
+    {
+        uploads.push_back({
+            .target = FrameUploadTarget::VSM_FREE_WRAPPED_PAGES_INFO,
+            .data = free_wrapped_pages_info.data(),
+            .size = sizeof(FreeWrappedPagesInfo) * VSM_CLIP_LEVELS
+        });
+    }
+
+    state.upload_target_bytes = {};
+    state.upload_bytes = 0;
+    for(auto const & upload : uploads)
+    {
+        state.upload_target_bytes.at(static_cast<daxa_u32>(upload.target)) += upload.size;
+        state.upload_bytes += upload.size;
+    }
+}
+
+void prepare_frame(FrameState & state, PrepareFrameInfo const & info)
+{
+    state.debug_draw.reset();
+
+    {
+        PROFILE_SCOPE("camera setup");
+        write_camera_globals(state, info);
+        auto [front, top, right] = info.main_camera.get_frustum_info();
+        info.globals.camera_front = front;
+        info.globals.camera_frust_top_offset = top;
+        info.globals.camera_frust_right_offset = right;
+    }
+    {
+        PROFILE_SCOPE("clip alignment");
+        update_vsm_clip_map(state, info);
+    }
+    {
+        PROFILE_SCOPE("medium lut");
+        state.medium_lut.update(info.globals);
+        update_atmosphere_lut_hash(state, info.globals);
+    }
+    {
+        PROFILE_SCOPE("skyview cache");
+        // The cached LUTs were integrated through the old transmittance and multiscattering LUTs
+        state.skyview_cache.plan(info.globals, state.atmosphere_luts_dirty);
+    }
+    {
+        PROFILE_SCOPE("collect uploads");
+        collect_uploads(state, info.globals);
+    }
+}
+
+void finish_frame_uploads(FrameState & state)
+{
+    for(auto const & upload : state.uploads)
+    {
+        if(upload.target == FrameUploadTarget::GLOBALS)
+        {
+            std::memcpy(reinterpret_cast<std::byte *>(&state.uploaded_globals) + upload.dst_offset, upload.data, upload.size);
+        } else if(upload.target == FrameUploadTarget::VSM_FREE_WRAPPED_PAGES_INFO) {
+            std::memcpy(state.uploaded_free_wrapped_pages_info.data(), upload.data, upload.size);
+        }
+    }
+    state.persistent_buffers_initialized = true;
+    state.vsm_clip_map.clear_dirty_levels();
+    state.medium_lut.mark_uploaded();
+    // The task graph conditionals of this frame were set before it started executing
+    if(state.atmosphere_luts_dirty) { state.atmosphere_lut_rebakes += 1; }
+    state.atmosphere_luts_dirty = false;
+    state.skyview_cache.commit();
+}
+
+void read_back_histogram(FrameState & state, Histogram const * readback, daxa_u32 frame_index)
+{
+    const bool was_last_frame_even = ((frame_index - 1) % 2) == 0;
+    const daxa_u32 offset = was_last_frame_even ? 0 : HISTOGRAM_BIN_COUNT;
+    std::memcpy(state.cpu_histogram.data(), readback + offset, sizeof(Histogram) * HISTOGRAM_BIN_COUNT);
+}
+
+void read_back_vsm_statistics(FrameState & state, VSMStatistics const * readback, daxa_u32 frame_index, std::optional<daxa_f64> draw_ms)
+{
+    const bool was_last_frame_even = ((frame_index - 1) % 2) == 0;
+    state.vsm_statistics = readback[was_last_frame_even ? 0 : 1];
+    if(draw_ms.has_value())
+    {
+        state.vsm_draw_ms = draw_ms.value();
+        state.vsm_page_budget.record_frame(state.vsm_statistics.allocated_pages, draw_ms.value());
+    }
+}
+
+auto get_vsm_resident_page_count(VSMStatistics const & statistics) -> daxa_u32
+{
+    daxa_u32 resident_pages = 0;
+    for(daxa_u32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
+    {
+        resident_pages += statistics.resident_pages[clip_level];
+    }
+    return resident_pages;
+}
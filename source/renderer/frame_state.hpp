@@ -0,0 +1,174 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+#include "../camera.hpp"
+#include "vsm_clip_map.hpp"
+#include "vsm_page_budget.hpp"
+#include "vsm_sun_invalidation.hpp"
+#include "debug_draw.hpp"
+#include "atmosphere/medium_lut.hpp"
+#include "atmosphere/skyview_cache.hpp"
+#include "shared/shared.inl"
+
+using namespace std::literals;
+
+enum struct FrameUploadTarget
+{
+    GLOBALS,
+    MEDIUM_LUT,
+    FRUSTUM_VERTICES,
+    FRUSTUM_COLORS,
+    FRUSTUM_INDIRECT,
+    DEBUG_LINE_VERTICES,
+    LUMINANCE_HISTOGRAM,
+    VSM_PAGE_REQUEST_COUNT,
+    VSM_STATISTICS,
+    VSM_FIND_FREE_PAGES_HEADER,
+    VSM_SUN_PROJECTIONS,
+    VSM_FREE_WRAPPED_PAGES_INFO,
+    COUNT
+};
+
+static constexpr std::array<std::string_view, static_cast<daxa_u32>(FrameUploadTarget::COUNT)> frame_upload_target_names = {
+    "globals"sv,
+    "medium lut"sv,
+    "frustum vertices"sv,
+    "frustum colors"sv,
+    "frustum indirect"sv,
+    "debug line vertices"sv,
+    "luminance histogram"sv,
+    "vsm page request count"sv,
+    "vsm statistics"sv,
+    "vsm find free pages header"sv,
+    "vsm sun projections"sv,
+    "vsm free wrapped pages info"sv
+};
+
+// Field groups of Globals, follow the sections of the struct in shared.inl
+enum struct GlobalsGroup : daxa_u32
+{
+    FRAME,
+    ATMOSPHERE,
+    CAMERA,
+    TERRAIN,
+    SHADOWS,
+    POST_PROCESS,
+    COUNT
+};
+
+static constexpr std::array<std::string_view, static_cast<daxa_u32>(GlobalsGroup::COUNT)> globals_group_names = {
+    "frame"sv,
+    "atmosphere"sv,
+    "camera"sv,
+    "terrain"sv,
+    "shadows"sv,
+    "post process"sv
+};
+
+struct GlobalsGroupRange
+{
+    size_t begin;
+    size_t end;
+};
+
+static constexpr std::array<GlobalsGroupRange, static_cast<daxa_u32>(GlobalsGroup::COUNT)> globals_group_ranges = {
+    GlobalsGroupRange{ offsetof(Globals, time),               offsetof(Globals, sun_brightness) },
+    GlobalsGroupRange{ offsetof(Globals, sun_brightness),     offsetof(Globals, use_debug_camera) },
+    GlobalsGroupRange{ offsetof(Globals, use_debug_camera),   offsetof(Globals, terrain_scale) },
+    GlobalsGroupRange{ offsetof(Globals, terrain_scale),      offsetof(Globals, lambda) },
+    GlobalsGroupRange{ offsetof(Globals, lambda),             offsetof(Globals, min_luminance_log2) },
+    GlobalsGroupRange{ offsetof(Globals, min_luminance_log2), sizeof(Globals) }
+};
+
+// Copy of size bytes from data into the target resource at dst_offset
+struct FrameUpload
+{
+    FrameUploadTarget target;
+    void const * data;
+    size_t size;
+    size_t dst_offset = 0;
+};
+
+// CPU side of a frame, everything Renderer::draw() computes before the task graph is executed.
+// Does not reference any device object so the same work can be driven without a GPU
+struct FrameState
+{
+    Camera sun_camera = Camera({
+        .position = {0.0f, 0.0f, 0.0f},
+        .front    = {0.0f, 1.0f, 0.0f},
+        .up       = {0.0f, 0.0f, 1.0f}
+    });
+    VSMClipMap vsm_clip_map = {};
+    VSMPageBudget vsm_page_budget = {};
+    VSMSunInvalidation vsm_sun_invalidation = {};
+    MediumLUT medium_lut = {};
+    SkyviewCache skyview_cache = {};
+    // Reset by prepare_frame(), anything recording CPU debug geometry for the frame appends to it afterwards
+    DebugDrawStream debug_draw = {};
+
+    std::array<Histogram, HISTOGRAM_BIN_COUNT> cpu_histogram = {};
+    // Counters of the VSM passes of the previous frame
+    VSMStatistics vsm_statistics = {};
+    // GPU time of the page draw pass of the latest frame whose timestamps were available
+    daxa_f64 vsm_draw_ms = 0.0;
+
+    // Sources of the uploads which are not stored anywhere else, they need to
+    // stay alive until the upload task records the copies
+    DrawIndexedIndirectStruct frustum_indirect = {};
+    std::array<Histogram, HISTOGRAM_BIN_COUNT> histogram_reset = {};
+    AllocationCount vsm_page_request_count_reset = {};
+    VSMStatistics vsm_statistics_reset = {};
+    FindFreePagesHeader vsm_find_free_pages_header_reset = {};
+
+    // Contents of the persistent buffers as of the last recorded upload, ranges which still match are not uploaded again.
+    // Comparing against these catches every edit, the gui widgets write straight into Globals
+    Globals uploaded_globals = {};
+    std::array<FreeWrappedPagesInfo, VSM_CLIP_LEVELS> uploaded_free_wrapped_pages_info = {};
+    bool persistent_buffers_initialized = false;
+
+    // Hash of the Globals fields the transmittance and multiscattering LUTs depend on, the LUTs are only
+    // rebaked in the frames where it changes
+    daxa_u64 atmosphere_lut_hash = 0;
+    bool atmosphere_luts_dirty = true;
+    daxa_u32 atmosphere_lut_rebakes = 0;
+    // LUTs loaded from offline baked files instead of being rebaked
+    daxa_u32 atmosphere_lut_loads = 0;
+
+    // Filled by prepare_frame() in the order in which the upload task records them
+    std::vector<FrameUpload> uploads = {};
+    std::array<bool, static_cast<daxa_u32>(GlobalsGroup::COUNT)> dirty_globals_groups = {};
+    std::array<daxa_u64, static_cast<daxa_u32>(FrameUploadTarget::COUNT)> upload_target_bytes = {};
+    daxa_u64 upload_bytes = 0;
+};
+
+struct PrepareFrameInfo
+{
+    Camera & main_camera;
+    Camera & debug_camera;
+    Globals & globals;
+};
+
+// Hash of the Globals fields the transmittance and multiscattering LUTs depend on, also names the offline baked LUT files
+auto get_atmosphere_lut_hash(Globals const & globals) -> daxa_u64;
+// Fills the camera part of Globals, records the debug frusti, updates the VSM clip map and the medium LUT,
+// plans the skyview LUT update and collects the uploads of the frame into state.uploads
+void prepare_frame(FrameState & state, PrepareFrameInfo const & info);
+// Called once all of state.uploads were recorded, clears the dirty flags of the uploaded data
+// and updates the copies of the persistent buffer contents
+void finish_frame_uploads(FrameState & state);
+// The readback buffer holds the histograms of two consecutive frames, copies out the one
+// written by the frame preceding frame_index
+void read_back_histogram(FrameState & state, Histogram const * readback, daxa_u32 frame_index);
+// Same two frame layout as the histogram readback. The pages allocated by the frame preceding frame_index and
+// the GPU time of its page draw pass, when the timestamps were already available, feed the VSM page budget
+void read_back_vsm_statistics(FrameState & state, VSMStatistics const * readback, daxa_u32 frame_index, std::optional<daxa_f64> draw_ms);
+// Allocated physical pages summed over all clip levels
+auto get_vsm_resident_page_count(VSMStatistics const & statistics) -> daxa_u32;
@@ -0,0 +1,160 @@
+#include "pipeline_batch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+using namespace std::chrono;
+
+void PipelineBatch::add(daxa::ComputePipelineCompileInfo const & compile_info, std::shared_ptr<daxa::ComputePipeline> & target)
+{
+    entries.push_back({ .compile_info = compile_info, .target = &target, .error = {}, .compiled = false, .compile_ms = 0.0 });
+}
+
+void PipelineBatch::add(daxa::RasterPipelineCompileInfo const & compile_info, std::shared_ptr<daxa::RasterPipeline> & target)
+{
+    entries.push_back({ .compile_info = compile_info, .target = &target, .error = {}, .compiled = false, .compile_ms = 0.0 });
+}
+
+auto PipelineBatch::get_stage_count() const -> daxa_u32
+{
+    daxa_u32 stage_count = 0;
+    for(auto const & entry : entries)
+    {
+        if(auto const * raster_info = std::get_if<daxa::RasterPipelineCompileInfo>(&entry.compile_info))
+        {
+            stage_count +=
+                static_cast<daxa_u32>(raster_info->vertex_shader_info.has_value()) +
+                static_cast<daxa_u32>(raster_info->tesselation_control_shader_info.has_value()) +
+                static_cast<daxa_u32>(raster_info->tesselation_evaluation_shader_info.has_value()) +
+                static_cast<daxa_u32>(raster_info->fragment_shader_info.has_value());
+        } else {
+            stage_count += 1;
+        }
+    }
+    return stage_count;
+}
+
+auto PipelineBatch::get_cache_stages(daxa::ShaderCompileOptions const & global_options) const -> std::vector<ShaderCacheStage>
+{
+    std::vector<ShaderCacheStage> stages;
+    stages.reserve(get_stage_count());
+    auto add_stage = [&](daxa::ShaderCompileInfo const & shader_info, std::string_view stage_name, daxa_u32 pipeline_index)
+    {
+        auto stage = ShaderCacheStage{ .key = std::string(stage_name), .source_path = {}, .pipeline_index = pipeline_index };
+        if(auto const * file = std::get_if<daxa::ShaderFile>(&shader_info.source))
+        {
+            stage.key += " " + file->path.generic_string();
+            stage.source_path = file->path;
+        }
+        if(auto const * code = std::get_if<daxa::ShaderCode>(&shader_info.source)) { stage.key += " " + code->string; }
+        for(auto const * defines : {&global_options.defines, &shader_info.compile_options.defines})
+        {
+            for(auto const & define : *defines) { stage.key += " " + define.name + "=" + define.value; }
+        }
+        stages.push_back(std::move(stage));
+    };
+
+    for(daxa_u32 pipeline_index = 0; pipeline_index < entries.size(); pipeline_index++)
+    {
+        auto const & entry = entries.at(pipeline_index);
+        if(auto const * raster_info = std::get_if<daxa::RasterPipelineCompileInfo>(&entry.compile_info))
+        {
+            for(auto const & [shader_info, stage_name] : {
+                std::pair{&raster_info->vertex_shader_info, "vertex"},
+                std::pair{&raster_info->tesselation_control_shader_info, "tesselation control"},
+                std::pair{&raster_info->tesselation_evaluation_shader_info, "tesselation evaluation"},
+                std::pair{&raster_info->fragment_shader_info, "fragment"}})
+            {
+                if(shader_info->has_value()) { add_stage(shader_info->value(), stage_name, pipeline_index); }
+            }
+        } else {
+            add_stage(std::get<daxa::ComputePipelineCompileInfo>(entry.compile_info).shader_info, "compute", pipeline_index);
+        }
+    }
+    return stages;
+}
+
+auto PipelineBatch::get_timing() const -> PipelineBatchTiming const &
+{
+    return timing;
+}
+
+auto PipelineBatch::has_compiled(daxa_u32 pipeline_index) const -> bool
+{
+    return entries.at(pipeline_index).compiled;
+}
+
+auto PipelineBatch::compile(PipelineBatchInfo const & info) -> std::vector<std::string>
+{
+    const daxa_u32 requested_threads = info.thread_count == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : info.thread_count;
+    const daxa_u32 thread_count = std::clamp(requested_threads, 1u, std::max(static_cast<daxa_u32>(entries.size()), 1u));
+
+    // Created up front on this thread, only the compilation itself runs in parallel
+    std::vector<daxa::PipelineManager> pipeline_managers;
+    pipeline_managers.reserve(thread_count);
+    for(daxa_u32 thread_index = 0; thread_index < thread_count; thread_index++)
+    {
+        pipeline_managers.emplace_back(info.pipeline_manager_info);
+    }
+
+    // Entries are handed out one at a time, compile times differ a lot between pipelines
+    // so a static split would leave threads idle
+    std::atomic<daxa_u32> next_entry = 0;
+    auto compile_entries = [&](daxa::PipelineManager & pipeline_manager)
+    {
+        for(daxa_u32 entry_index = next_entry++; entry_index < entries.size(); entry_index = next_entry++)
+        {
+            auto & entry = entries.at(entry_index);
+            const auto start = steady_clock::now();
+            std::visit([&](auto const & compile_info)
+            {
+                using CompileInfoT = std::remove_cvref_t<decltype(compile_info)>;
+                if constexpr (std::is_same_v<CompileInfoT, daxa::ComputePipelineCompileInfo>)
+                {
+                    auto result = pipeline_manager.add_compute_pipeline(compile_info);
+                    entry.compiled = result.is_ok();
+                    if(result.is_ok()) { *std::get<std::shared_ptr<daxa::ComputePipeline> *>(entry.target) = result.value(); }
+                    else               { entry.error = result.to_string(); }
+                } else {
+                    auto result = pipeline_manager.add_raster_pipeline(compile_info);
+                    entry.compiled = result.is_ok();
+                    if(result.is_ok()) { *std::get<std::shared_ptr<daxa::RasterPipeline> *>(entry.target) = result.value(); }
+                    else               { entry.error = result.to_string(); }
+                }
+            }, entry.compile_info);
+            entry.compile_ms = duration<daxa_f64, std::milli>(steady_clock::now() - start).count();
+        }
+    };
+
+    const auto batch_start = steady_clock::now();
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for(daxa_u32 thread_index = 1; thread_index < thread_count; thread_index++)
+    {
+        threads.emplace_back(compile_entries, std::ref(pipeline_managers.at(thread_index)));
+    }
+    compile_entries(pipeline_managers.at(0));
+    for(auto & thread : threads) { thread.join(); }
+
+    timing = PipelineBatchTiming{
+        .thread_count = thread_count,
+        .wall_ms = duration<daxa_f64, std::milli>(steady_clock::now() - batch_start).count(),
+        .serial_ms = 0.0,
+        .pipelines = {}
+    };
+    std::vector<std::string> errors;
+    for(auto const & entry : entries)
+    {
+        auto const & name = std::visit([](auto const & compile_info) -> std::string const & { return compile_info.name; }, entry.compile_info);
+        timing.serial_ms += entry.compile_ms;
+        timing.pipelines.push_back({ .name = name, .compile_ms = entry.compile_ms });
+        if(!entry.error.empty()) { errors.push_back(entry.error); }
+    }
+    std::sort(timing.pipelines.begin(), timing.pipelines.end(), [](auto const & first, auto const & second)
+        { return first.compile_ms > second.compile_ms; });
+    return errors;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <daxa/daxa.hpp>
+#include <daxa/utils/pipeline_manager.hpp>
+using namespace daxa::types;
+
+#include "shader_cache.hpp"
+
+struct PipelineBatchInfo
+{
+    // Every worker thread creates its own pipeline manager from this, the managers are not thread safe
+    daxa::PipelineManagerInfo pipeline_manager_info;
+    // Zero uses one thread per hardware thread, one compiles serially on the calling thread
+    daxa_u32 thread_count = 0;
+};
+
+struct PipelineCompileTiming
+{
+    std::string name;
+    daxa_f64 compile_ms;
+};
+
+struct PipelineBatchTiming
+{
+    daxa_u32 thread_count;
+    daxa_f64 wall_ms;
+    // Sum of the single pipeline compile times, roughly what a serial compile would take
+    daxa_f64 serial_ms;
+    // Sorted from the slowest pipeline, the slowest one bounds the wall time
+    std::vector<PipelineCompileTiming> pipelines;
+};
+
+// Collects pipeline compile infos and creates all of them at once on a pool of threads
+struct PipelineBatch
+{
+    void add(daxa::ComputePipelineCompileInfo const & compile_info, std::shared_ptr<daxa::ComputePipeline> & target);
+    void add(daxa::RasterPipelineCompileInfo const & compile_info, std::shared_ptr<daxa::RasterPipeline> & target);
+
+    [[nodiscard]] auto get_stage_count() const -> daxa_u32;
+    // One entry per shader stage with a key naming its source, stage and defines, global_options are the
+    // options of the pipeline manager the stages are compiled with. The pipeline indices are in the order
+    // the pipelines were added, used by ShaderCache to look the stages up
+    [[nodiscard]] auto get_cache_stages(daxa::ShaderCompileOptions const & global_options) const -> std::vector<ShaderCacheStage>;
+
+    // Blocks until all pipelines are created, targets of the pipelines which failed to compile are
+    // left untouched and the compile errors are returned
+    auto compile(PipelineBatchInfo const & info) -> std::vector<std::string>;
+    [[nodiscard]] auto get_timing() const -> PipelineBatchTiming const &;
+    // Whether the pipeline added at pipeline_index was created by the last compile()
+    [[nodiscard]] auto has_compiled(daxa_u32 pipeline_index) const -> bool;
+
+    private:
+        using CompileInfo = std::variant<daxa::ComputePipelineCompileInfo, daxa::RasterPipelineCompileInfo>;
+        using PipelineTarget = std::variant<std::shared_ptr<daxa::ComputePipeline> *, std::shared_ptr<daxa::RasterPipeline> *>;
+
+        struct PipelineEntry
+        {
+            CompileInfo compile_info;
+            PipelineTarget target;
+            std::string error;
+            bool compiled;
+            daxa_f64 compile_ms;
+        };
+
+        std::vector<PipelineEntry> entries;
+        PipelineBatchTiming timing = {};
+};
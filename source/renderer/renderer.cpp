@@ -1,13 +1,25 @@
 #include "renderer.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <filesystem>
 #include <string>
+#include <utility>
 
 #include <imgui_impl_glfw.h>
 #include <daxa/utils/imgui.hpp>
 
+#include "../frame_profiler.hpp"
+#include "atmosphere/atmosphere_lut_files.hpp"
+
+// Images and buffers have separate index spaces
+static auto residency_key(daxa::ImageId image) -> daxa_u64 { return static_cast<daxa_u64>(image.index); }
+static auto residency_key(daxa::BufferId buffer) -> daxa_u64 { return (daxa_u64(1) << 32) | static_cast<daxa_u64>(buffer.index); }
+
 Renderer::Renderer(const AppWindow & window, Globals * globals) :
     context { .daxa_instance{daxa::create_instance({})} },
-    globals{globals}
+    globals{globals},
+    shader_cache{{ .compiler_version = TENEBRIS_SHADER_COMPILER_VERSION }}
 {
     context.device = context.daxa_instance.create_device({ .name = "Daxa device" });
 
@@ -24,46 +36,63 @@ Renderer::Renderer(const AppWindow & window, Globals * globals) :
         .name = "Swapchain",
     });
 
-    context.pipeline_manager = daxa::PipelineManager({
+    // Nothing is allocated yet so this only accounts for the framebuffer and VSM memory,
+    // the remaining tiers are reselected once the textures are loaded
+    auto const startup_extent = context.swapchain.get_surface_extent();
+    context.quality_tiers = context.residency.select_quality_tiers({
+        .framebuffer_extent = {startup_extent.x, startup_extent.y}
+    });
+
+    auto const shader_root_paths = std::vector<std::filesystem::path>{
+        DAXA_SHADER_INCLUDE_DIR,
+        "source/renderer",
+        "source/renderer/shaders",
+        "source/renderer/texture_manager/shaders",
+        "shaders",
+        "shared"
+    };
+    auto const pipeline_manager_info = daxa::PipelineManagerInfo{
         .device = context.device,
         .shader_compile_options = {
-            .root_paths = { 
-                DAXA_SHADER_INCLUDE_DIR,
-                "source/renderer",
-                "source/renderer/shaders",
-                "source/renderer/texture_manager/shaders",
-                "shaders",
-                "shared"
-            },
+            .root_paths = shader_root_paths,
+            .spirv_cache_folder = shader_cache.get_folder(),
+            .defines = {{"VSM_MEMORY_RESOLUTION", std::to_string(context.quality_tiers.vsm_memory_resolution)}},
             .language = daxa::ShaderLanguage::GLSL,
             .enable_debug_info = true
         },
         .name = "Pipeline Compiler",
+    };
+    context.pipeline_manager = daxa::PipelineManager(pipeline_manager_info);
+#if defined(TENEBRIS_SHADER_HOT_RELOAD)
+    shader_reloader = std::make_unique<ShaderHotReloader>(ShaderHotReloaderInfo{
+        .pipeline_manager = context.pipeline_manager,
+        .root_paths = shader_root_paths
     });
+#endif
 
+    // Pipelines are only collected here and compiled in parallel once all of them are known
+    auto pipeline_batch = PipelineBatch{};
     auto init_compute_pipeline = [&](daxa::ComputePipelineCompileInfo ci, std::shared_ptr<daxa::ComputePipeline> & pip)
     {
-        if(auto result = context.pipeline_manager.add_compute_pipeline(ci); result.is_ok())
-        {
-            pip = result.value();
-        } else {
-            DBG_ASSERT_TRUE_M(false, result.to_string());
-        }
+        pipeline_batch.add(ci, pip);
+#if defined(TENEBRIS_SHADER_HOT_RELOAD)
+        shader_reloader->register_pipeline(ci, pip);
+#endif
     };
     
     auto init_raster_pipeline = [&](daxa::RasterPipelineCompileInfo ci, std::shared_ptr<daxa::RasterPipeline> & pip)
     {
-        if(auto result = context.pipeline_manager.add_raster_pipeline(ci); result.is_ok())
-        {
-            pip = result.value();
-        } else {
-            DBG_ASSERT_TRUE_M(false, result.to_string());
-        }
+        pipeline_batch.add(ci, pip);
+#if defined(TENEBRIS_SHADER_HOT_RELOAD)
+        shader_reloader->register_pipeline(ci, pip);
+#endif
     };
 
     init_compute_pipeline(get_transmittance_LUT_pipeline(), context.pipelines.transmittance);
     init_compute_pipeline(get_multiscattering_LUT_pipeline(), context.pipelines.multiscattering);
     init_compute_pipeline(get_skyview_LUT_pipeline(), context.pipelines.skyview);
+    init_compute_pipeline(get_skyview_LUT_pipeline(SkyviewPipeline::CACHE_BAKE), context.pipelines.skyview_cache_bake);
+    init_compute_pipeline(get_skyview_LUT_pipeline(SkyviewPipeline::CACHE_BLEND), context.pipelines.skyview_cache_blend);
     init_compute_pipeline(get_esm_pass_pipeline(true), context.pipelines.first_esm_pass);
     init_compute_pipeline(get_esm_pass_pipeline(false), context.pipelines.second_esm_pass);
     init_compute_pipeline(get_analyze_depthbuffer_pipeline(true), context.pipelines.analyze_depthbuffer_first_pass);
@@ -71,11 +100,15 @@ Renderer::Renderer(const AppWindow & window, Globals * globals) :
     init_compute_pipeline(get_prepare_shadow_matrices_pipeline(), context.pipelines.prepare_shadow_matrices);
     init_compute_pipeline(get_luminance_histogram_pipeline(), context.pipelines.luminance_histogram);
     init_compute_pipeline(get_adapt_average_luminance_pipeline(), context.pipelines.adapt_average_luminance);
+    init_compute_pipeline(get_terrain_patch_bounds_pipeline(), context.pipelines.terrain_patch_bounds);
 
     init_compute_pipeline(get_vsm_free_wrapped_pages_pipeline(), context.pipelines.vsm_free_wrapped_pages);
+    init_compute_pipeline(get_vsm_prioritize_requests_pipeline(), context.pipelines.vsm_prioritize_requests);
     init_compute_pipeline(get_vsm_find_free_pages_pipeline(), context.pipelines.vsm_find_free_pages);
     init_compute_pipeline(get_vsm_allocate_pages_pipeline(), context.pipelines.vsm_allocate_pages);
     init_compute_pipeline(get_vsm_clear_pages_pipeline(), context.pipelines.vsm_clear_pages);
+    init_compute_pipeline(get_vsm_build_dirty_pyramid_pipeline(), context.pipelines.vsm_build_dirty_pyramid);
+    init_compute_pipeline(get_vsm_cull_terrain_patches_pipeline(), context.pipelines.vsm_cull_terrain_patches);
     init_raster_pipeline(get_vsm_draw_pages_pipeline(), context.pipelines.vsm_draw_pages);
     init_compute_pipeline(get_vsm_clear_dirty_bit_pipeline(), context.pipelines.vsm_clear_dirty_bit);
     init_compute_pipeline(get_vsm_debug_page_table_pipeline(), context.pipelines.vsm_debug_page_table);
@@ -84,10 +117,28 @@ Renderer::Renderer(const AppWindow & window, Globals * globals) :
     init_raster_pipeline(get_draw_terrain_pipeline(false), context.pipelines.draw_terrain_solid);
     init_raster_pipeline(get_draw_terrain_pipeline(true), context.pipelines.draw_terrain_wireframe);
     init_raster_pipeline(get_debug_draw_frustum_pipeline(context), context.pipelines.debug_draw_frustum);
+    init_raster_pipeline(get_debug_draw_lines_pipeline(context), context.pipelines.debug_draw_lines);
     init_raster_pipeline(get_terrain_shadowmap_pipeline(), context.pipelines.draw_terrain_shadowmap);
     init_raster_pipeline(get_deferred_pass_pipeline(), context.pipelines.deferred_pass);
     init_raster_pipeline(get_post_process_pipeline(context), context.pipelines.post_process);
 
+    auto const cache_stages = pipeline_batch.get_cache_stages(pipeline_manager_info.shader_compile_options);
+    auto const pipeline_errors = shader_cache.track_compile(cache_stages, shader_root_paths,
+        [&] { return pipeline_batch.compile({ .pipeline_manager_info = pipeline_manager_info }); },
+        [&](daxa_u32 pipeline_index) { return pipeline_batch.has_compiled(pipeline_index); });
+    for(auto const & pipeline_error : pipeline_errors) { DBG_ASSERT_TRUE_M(false, pipeline_error); }
+    shader_cache.trim();
+
+    auto const & pipeline_timing = pipeline_batch.get_timing();
+    auto const & shader_cache_statistics = shader_cache.get_statistics();
+    DEBUG_OUT("[Renderer::Renderer()] Pipelines created in " << pipeline_timing.wall_ms << " ms on " << pipeline_timing.thread_count <<
+              " threads, serial compile estimate " << pipeline_timing.serial_ms << " ms, shader cache hits " <<
+              shader_cache_statistics.stage_hits << " misses " << shader_cache_statistics.stage_misses);
+    for(auto const & pipeline : pipeline_timing.pipelines)
+    {
+        DEBUG_OUT("\t" << pipeline.name << ": " << pipeline.compile_ms << " ms");
+    }
+
     context.linear_sampler = context.device.create_sampler({
         .address_mode_u = daxa::SamplerAddressMode::CLAMP_TO_BORDER,
         .address_mode_v = daxa::SamplerAddressMode::CLAMP_TO_BORDER,
@@ -115,6 +166,11 @@ Renderer::Renderer(const AppWindow & window, Globals * globals) :
         .format = context.swapchain.get_format(),
     });
 
+    context.vsm_draw_timestamps = context.device.create_timeline_query_pool({
+        .query_count = 2 * Context::frames_in_flight,
+        .name = "vsm draw timestamps"
+    });
+
     context.main_task_list.task_list = daxa::TaskGraph({
         .device = context.device,
         .swapchain = context.swapchain,
@@ -133,15 +189,13 @@ Renderer::Renderer(const AppWindow & window, Globals * globals) :
         .pipeline_manager = context.pipeline_manager,
     });
 
-    context.sun_camera = Camera({
-        .position = {0.0f, 0.0f, 0.0f},
-        .front    = {0.0f, 1.0f, 0.0f},
-        .up       = {0.0f, 0.0f, 1.0f}
-    });
-
     load_textures();
 
     initialize_main_tasklist();
+#if defined(TENEBRIS_SHADER_HOT_RELOAD)
+    // Started last, until here the pipeline manager is also used by the texture manager on this thread
+    shader_reloader->start();
+#endif
 }
 
 void Renderer::create_persistent_resources()
@@ -149,11 +203,11 @@ void Renderer::create_persistent_resources()
     context.buffers.globals = daxa::TaskBuffer({
         .initial_buffers = {
             .buffers = std::array{
-                context.device.create_buffer(daxa::BufferInfo{
+                create_tracked_buffer(daxa::BufferInfo{
                     .size = sizeof(Globals),
                     .allocate_info = daxa::MemoryFlagBits::DEDICATED_MEMORY,
                     .name = "atmosphere parameters",
-                })
+                }, ResidencyCategory::BUFFERS)
             },
         },
         .name = "globals task buffer"
@@ -162,57 +216,158 @@ void Renderer::create_persistent_resources()
     context.buffers.histogram_readback = daxa::TaskBuffer({
         .initial_buffers = {
             .buffers = std::array{
-                context.device.create_buffer(daxa::BufferInfo{
+                create_tracked_buffer(daxa::BufferInfo{
                     .size = static_cast<daxa_u32>(sizeof(Histogram) * HISTOGRAM_BIN_COUNT * 2),
                     .allocate_info = 
                         daxa::MemoryFlagBits::DEDICATED_MEMORY |
                         daxa::MemoryFlagBits::HOST_ACCESS_RANDOM
                     ,
                     .name = "histogram readback buffer",
-                })
+                }, ResidencyCategory::BUFFERS)
             },
         },
         .name = "histogram readback task buffer"
     });
 
+    context.buffers.vsm_statistics_readback = daxa::TaskBuffer({
+        .initial_buffers = {
+            .buffers = std::array{
+                create_tracked_buffer(daxa::BufferInfo{
+                    .size = static_cast<daxa_u32>(sizeof(VSMStatistics) * 2),
+                    .allocate_info = 
+                        daxa::MemoryFlagBits::DEDICATED_MEMORY |
+                        daxa::MemoryFlagBits::HOST_ACCESS_RANDOM
+                    ,
+                    .name = "vsm statistics readback buffer",
+                }, ResidencyCategory::BUFFERS)
+            },
+        },
+        .name = "vsm statistics readback task buffer"
+    });
+
 
     context.buffers.frustum_indices = daxa::TaskBuffer({
         .initial_buffers = {
             .buffers = std::array{
-                context.device.create_buffer(daxa::BufferInfo{
+                create_tracked_buffer(daxa::BufferInfo{
                     .size = sizeof(FrustumIndex) * DebugDrawFrustumTask::index_count,
                     .allocate_info = daxa::MemoryFlagBits::DEDICATED_MEMORY,
                     .name = "debug frustum indices",
-                })
+                }, ResidencyCategory::BUFFERS)
             },
         },
         .name = "frustum indices task buffer"
     });
 
+    // Start small, reserve_debug_draw_buffers() grows them once debug geometry is recorded
+    context.buffers.debug_frustum_vertices = daxa::TaskBuffer({
+        .initial_buffers = {
+            .buffers = std::array{
+                create_tracked_buffer(daxa::BufferInfo{
+                    .size = static_cast<daxa_u32>(sizeof(FrustumVertex) * FRUSTUM_VERTEX_COUNT * MIN_DEBUG_BOX_CAPACITY),
+                    .allocate_info = daxa::MemoryFlagBits::DEDICATED_MEMORY,
+                    .name = "debug frustum vertices",
+                }, ResidencyCategory::BUFFERS)
+            },
+        },
+        .name = "debug frustum vertices task buffer"
+    });
+
+    context.buffers.debug_frustum_colors = daxa::TaskBuffer({
+        .initial_buffers = {
+            .buffers = std::array{
+                create_tracked_buffer(daxa::BufferInfo{
+                    .size = static_cast<daxa_u32>(sizeof(FrustumColor) * MIN_DEBUG_BOX_CAPACITY),
+                    .allocate_info = daxa::MemoryFlagBits::DEDICATED_MEMORY,
+                    .name = "debug frustum colors",
+                }, ResidencyCategory::BUFFERS)
+            },
+        },
+        .name = "debug frustum colors task buffer"
+    });
+
+    context.buffers.debug_line_vertices = daxa::TaskBuffer({
+        .initial_buffers = {
+            .buffers = std::array{
+                create_tracked_buffer(daxa::BufferInfo{
+                    .size = static_cast<daxa_u32>(sizeof(DebugLineVertex) * 2 * MIN_DEBUG_LINE_CAPACITY),
+                    .allocate_info = daxa::MemoryFlagBits::DEDICATED_MEMORY,
+                    .name = "debug line vertices",
+                }, ResidencyCategory::BUFFERS)
+            },
+        },
+        .name = "debug line vertices task buffer"
+    });
+
     context.buffers.average_luminance = daxa::TaskBuffer({
         .initial_buffers = {
             .buffers = std::array{
-                context.device.create_buffer(daxa::BufferInfo{
+                create_tracked_buffer(daxa::BufferInfo{
                     .size = sizeof(AverageLuminance),
                     .allocate_info = daxa::MemoryFlagBits::DEDICATED_MEMORY,
                     .name = "average luminance buffer"
-                })
+                }, ResidencyCategory::BUFFERS)
             },
         },
         .name = "average luminance task buffer"
     });
 
     #pragma region vsm
+    context.buffers.vsm_sun_projections = daxa::TaskBuffer({
+        .initial_buffers = {
+            .buffers = std::array{
+                create_tracked_buffer(daxa::BufferInfo{
+                    .size = static_cast<daxa_u32>(sizeof(VSMClipProjection) * VSM_CLIP_LEVELS),
+                    .allocate_info = daxa::MemoryFlagBits::DEDICATED_MEMORY,
+                    .name = "vsm sun projections"
+                }, ResidencyCategory::BUFFERS)
+            },
+        },
+        .name = "vsm sun projections task buffer"
+    });
+
+    context.buffers.vsm_free_wrapped_pages_info = daxa::TaskBuffer({
+        .initial_buffers = {
+            .buffers = std::array{
+                create_tracked_buffer(daxa::BufferInfo{
+                    .size = static_cast<daxa_u32>(sizeof(FreeWrappedPagesInfo) * VSM_CLIP_LEVELS),
+                    .allocate_info = daxa::MemoryFlagBits::DEDICATED_MEMORY,
+                    .name = "vsm free wrapped pages info"
+                }, ResidencyCategory::BUFFERS)
+            },
+        },
+        .name = "vsm free wrapped pages info task buffer"
+    });
+
+    // Replaced by the staging buffers of the loaded LUTs, the placeholders keep the persistent buffers valid until then
+    auto create_lut_staging_buffer = [&](char const * name) -> daxa::TaskBuffer
+    {
+        return daxa::TaskBuffer({
+            .initial_buffers = {
+                .buffers = std::array{
+                    context.device.create_buffer(daxa::BufferInfo{
+                        .size = sizeof(daxa_f32vec4),
+                        .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
+                        .name = name
+                    })
+                },
+            },
+            .name = std::string(name) + " task buffer"
+        });
+    };
+    context.buffers.transmittance_lut_staging = create_lut_staging_buffer("transmittance lut staging");
+    context.buffers.multiscattering_lut_staging = create_lut_staging_buffer("multiscattering lut staging");
+
     context.images.vsm_memory = daxa::TaskImage({
         .initial_images = {
             .images = std::array{
-                context.device.create_image(daxa::ImageInfo{
+                create_tracked_image(daxa::ImageInfo{
                     .flags = daxa::ImageCreateFlagBits::ALLOW_MUTABLE_FORMAT,
                     .format = daxa::Format::R32_SFLOAT,
-                    .size = {VSM_MEMORY_RESOLUTION, VSM_MEMORY_RESOLUTION, 1},
+                    .size = {context.quality_tiers.vsm_memory_resolution, context.quality_tiers.vsm_memory_resolution, 1},
                     .usage = daxa::ImageUsageFlagBits::SHADER_SAMPLED | daxa::ImageUsageFlagBits::SHADER_STORAGE,
                     .name = "vsm memory physical image"
-                })
+                }, ResidencyCategory::VSM_PHYSICAL)
             },
         },
         .name = "vsm memory"
@@ -221,32 +376,46 @@ void Renderer::create_persistent_resources()
     context.images.vsm_meta_memory_table = daxa::TaskImage({
         .initial_images = {
             .images = std::array{
-                context.device.create_image(daxa::ImageInfo{
+                create_tracked_image(daxa::ImageInfo{
                     .format = daxa::Format::R32_UINT,
-                    .size = { VSM_META_MEMORY_RESOLUTION, VSM_META_MEMORY_RESOLUTION, 1 },
+                    .size = { vsm_meta_memory_resolution(context.quality_tiers), vsm_meta_memory_resolution(context.quality_tiers), 1 },
                     .usage = 
                         daxa::ImageUsageFlagBits::SHADER_SAMPLED |
                         daxa::ImageUsageFlagBits::SHADER_STORAGE |
                         daxa::ImageUsageFlagBits::TRANSFER_DST,
                     .name = "vsm meta memory physical image"
-                })
+                }, ResidencyCategory::VSM_PHYSICAL)
             },
         },
         .name = "vsm meta memory table"
     });
 
+    context.images.vsm_meta_memory_last_used = daxa::TaskImage({
+        .initial_images = {
+            .images = std::array{
+                create_tracked_image(daxa::ImageInfo{
+                    .format = daxa::Format::R32_UINT,
+                    .size = { vsm_meta_memory_resolution(context.quality_tiers), vsm_meta_memory_resolution(context.quality_tiers), 1 },
+                    .usage = daxa::ImageUsageFlagBits::SHADER_STORAGE,
+                    .name = "vsm meta memory last used physical image"
+                }, ResidencyCategory::VSM_PHYSICAL)
+            },
+        },
+        .name = "vsm meta memory last used"
+    });
+
     context.images.vsm_debug_meta_memory_table = daxa::TaskImage({
         .initial_images = {
             .images = std::array{
-                context.device.create_image(daxa::ImageInfo{
+                create_tracked_image(daxa::ImageInfo{
                     .format = daxa::Format::R8G8B8A8_UNORM,
-                    .size = { VSM_DEBUG_META_MEMORY_RESOLUTION, VSM_DEBUG_META_MEMORY_RESOLUTION, 1 },
+                    .size = { vsm_debug_meta_memory_resolution(context.quality_tiers), vsm_debug_meta_memory_resolution(context.quality_tiers), 1 },
                     .usage = 
                         daxa::ImageUsageFlagBits::SHADER_SAMPLED |
                         daxa::ImageUsageFlagBits::SHADER_STORAGE |
                         daxa::ImageUsageFlagBits::TRANSFER_DST,
                     .name = "vsm debug meta memory physical image"
-                })
+                }, ResidencyCategory::VSM_PHYSICAL)
             },
         },
         .name = "vsm debug meta memory table"
@@ -255,7 +424,7 @@ void Renderer::create_persistent_resources()
     context.images.vsm_page_table = daxa::TaskImage({
         .initial_images = {
             .images = std::array{
-                context.device.create_image(daxa::ImageInfo{
+                create_tracked_image(daxa::ImageInfo{
                     .format = daxa::Format::R32_UINT,
                     .size = { VSM_PAGE_TABLE_RESOLUTION, VSM_PAGE_TABLE_RESOLUTION, 1 },
                     .array_layer_count = VSM_CLIP_LEVELS,
@@ -264,7 +433,7 @@ void Renderer::create_persistent_resources()
                         daxa::ImageUsageFlagBits::SHADER_SAMPLED |
                         daxa::ImageUsageFlagBits::TRANSFER_DST,
                     .name = "vsm page table physical image"
-                })
+                }, ResidencyCategory::VSM_PAGE_TABLES)
             },
         },
         .name = "vsm page table"
@@ -273,7 +442,7 @@ void Renderer::create_persistent_resources()
     context.images.vsm_page_height_offset = daxa::TaskImage({
         .initial_images = {
             .images = std::array{
-                context.device.create_image(daxa::ImageInfo{
+                create_tracked_image(daxa::ImageInfo{
                     .format = daxa::Format::R32_SINT,
                     .size = { VSM_PAGE_TABLE_RESOLUTION, VSM_PAGE_TABLE_RESOLUTION, 1 },
                     .array_layer_count = VSM_CLIP_LEVELS,
@@ -282,7 +451,7 @@ void Renderer::create_persistent_resources()
                         daxa::ImageUsageFlagBits::SHADER_SAMPLED |
                         daxa::ImageUsageFlagBits::TRANSFER_DST,
                     .name = "vsm page table height offsets image"
-                })
+                }, ResidencyCategory::VSM_PAGE_TABLES)
             },
         },
         .name = "vsm page table height offsets"
@@ -291,7 +460,7 @@ void Renderer::create_persistent_resources()
     context.images.vsm_debug_page_table = daxa::TaskImage({
         .initial_images = {
             .images = std::array{
-                context.device.create_image(daxa::ImageInfo{
+                create_tracked_image(daxa::ImageInfo{
                     .format = daxa::Format::R8G8B8A8_UNORM,
                     .size = { vsm_debug_paging_table_resolution(), vsm_debug_paging_table_resolution(), 1 },
                     .usage = 
@@ -299,7 +468,7 @@ void Renderer::create_persistent_resources()
                         daxa::ImageUsageFlagBits::SHADER_STORAGE |
                         daxa::ImageUsageFlagBits::TRANSFER_DST,
                     .name = "vsm debug page table physical image"
-                })
+                }, ResidencyCategory::VSM_PAGE_TABLES)
             },
         },
         .name = "vsm debug page table"
@@ -307,6 +476,28 @@ void Renderer::create_persistent_resources()
 
     #pragma endregion
 
+    context.images.medium_lut = daxa::TaskImage({
+        .initial_images = {
+            .images = std::array{
+                create_tracked_image(daxa::ImageInfo{
+                    .format = daxa::Format::R32G32B32A32_SFLOAT,
+                    .size = { MEDIUM_LUT_RESOLUTION, 1, 1 },
+                    .usage = 
+                        daxa::ImageUsageFlagBits::SHADER_SAMPLED |
+                        daxa::ImageUsageFlagBits::TRANSFER_DST,
+                    .name = "medium lut physical image"
+                }, ResidencyCategory::TEXTURES)
+            },
+        },
+        .name = "medium lut"
+    });
+
+    context.images.transmittance_lut = daxa::TaskImage({ .name = "transmittance lut" });
+    context.images.multiscattering_lut = daxa::TaskImage({ .name = "multiscattering lut" });
+    context.images.skyview_lut = daxa::TaskImage({ .name = "skyview lut" });
+    context.images.skyview_cache = daxa::TaskImage({ .name = "skyview cache" });
+    update_atmosphere_lut_images();
+
     auto upload_task_list = daxa::TaskGraph({
         .device = context.device,
         .swapchain = context.swapchain,
@@ -394,6 +585,8 @@ void Renderer::create_persistent_resources()
 
     context.buffers.terrain_vertices = daxa::TaskBuffer({ .name = "terrain vertices task buffer" });
     context.buffers.terrain_indices = daxa::TaskBuffer({ .name = "terrain indices task buffer" });
+    context.buffers.terrain_patch_bounds = daxa::TaskBuffer({ .name = "terrain patch bounds task buffer" });
+    context.buffers.vsm_culled_terrain_indices = daxa::TaskBuffer({ .name = "vsm culled terrain indices task buffer" });
     context.images.swapchain = daxa::TaskImage({ .swapchain_image = true, .name = "swapchain task image" });
     context.images.diffuse_map = daxa::TaskImage({ .name = "diffuse map task image" });
     context.images.height_map = daxa::TaskImage({ .name = "height map task image" });
@@ -420,10 +613,13 @@ void Renderer::load_textures()
 
     manager->compress_hdr_texture({
         .raw_texture = tmp_raw_loaded_image,
-        .compressed_texture = context.images.diffuse_map
+        .compressed_texture = context.images.diffuse_map,
+        .asset_name = "assets/terrain/rugged_terrain_diffuse.exr"
     });
 
     context.device.destroy_image(tmp_raw_loaded_image.get_state().images[0]);
+    track_image(context.images.tonemapping_lut.get_state().images[0], ResidencyCategory::TEXTURES);
+    track_image(context.images.diffuse_map.get_state().images[0], ResidencyCategory::TEXTURES);
 
     manager->load_texture({
         .filepath = "assets/terrain/rugged_terrain_height.exr",
@@ -432,10 +628,164 @@ void Renderer::load_textures()
         .dest_image = context.images.height_map,
     });
 
+    track_image(context.images.height_map.get_state().images[0], ResidencyCategory::TEXTURES);
+
+    // Now that all of the fixed size textures are known pick the final tiers for the normal map
+    update_quality_tiers();
+    generate_normal_map();
+
+#ifdef __DEBUG__
+    auto const & load_profiler = manager->get_load_profiler();
+    load_profiler.write_summary("load_profile_summary.json");
+    load_profiler.write_chrome_trace("load_profile_trace.json");
+#endif
+}
+
+void Renderer::generate_normal_map()
+{
+    auto const normal_map_state = context.images.normal_map.get_state();
+    if(normal_map_state.images.size() > 0 && context.device.is_id_valid(normal_map_state.images[0]))
+    {
+        release_image(normal_map_state.images[0]);
+        context.device.destroy_image(normal_map_state.images[0]);
+    }
+
     manager->normals_from_heightmap({
         .height_texture = context.images.height_map,
-        .normals_texture = context.images.normal_map
+        .normals_texture = context.images.normal_map,
+        .normals_format = context.quality_tiers.normal_format == NormalMapFormat::RGBA32F ?
+            daxa::Format::R32G32B32A32_SFLOAT : daxa::Format::R16G16B16A16_SFLOAT,
+        .asset_name = "assets/terrain/rugged_terrain_height.exr"
+    });
+    track_image(context.images.normal_map.get_state().images[0], ResidencyCategory::NORMAL_MAP);
+}
+
+void Renderer::update_quality_tiers()
+{
+    auto const extent = context.swapchain.get_surface_extent();
+    auto const height_map_size = context.device.info_image(context.images.height_map.get_state().images[0]).value().size;
+    auto const previous_tiers = context.quality_tiers;
+
+    context.quality_tiers = context.residency.select_quality_tiers({
+        .framebuffer_extent = {extent.x, extent.y},
+        .normal_map_extent = {height_map_size.x, height_map_size.y},
+        .locked_vsm_memory_resolution = previous_tiers.vsm_memory_resolution
     });
+
+    if(previous_tiers.name != context.quality_tiers.name)
+    {
+        DEBUG_OUT("[Renderer::update_quality_tiers()] Switching quality tiers from " << previous_tiers.name << " to " << context.quality_tiers.name);
+    }
+
+    // Before the first normal map generation there is nothing to convert
+    auto const normal_map_state = context.images.normal_map.get_state();
+    const bool normal_map_generated = normal_map_state.images.size() > 0 && context.device.is_id_valid(normal_map_state.images[0]);
+    if(normal_map_generated && previous_tiers.normal_format != context.quality_tiers.normal_format)
+    {
+        generate_normal_map();
+    }
+}
+
+auto Renderer::create_tracked_image(daxa::ImageInfo const & info, ResidencyCategory category) -> daxa::ImageId
+{
+    auto image = context.device.create_image(info);
+    context.residency.track(residency_key(image), info.name, category, context.device.get_memory_requirements(info).size);
+    return image;
+}
+
+auto Renderer::create_tracked_buffer(daxa::BufferInfo const & info, ResidencyCategory category) -> daxa::BufferId
+{
+    auto buffer = context.device.create_buffer(info);
+    context.residency.track(residency_key(buffer), info.name, category, context.device.get_memory_requirements(info).size);
+    return buffer;
+}
+
+void Renderer::track_image(daxa::ImageId image, ResidencyCategory category)
+{
+    auto const info = context.device.info_image(image).value();
+    context.residency.track(residency_key(image), info.name, category, context.device.get_memory_requirements(info).size);
+}
+
+void Renderer::release_image(daxa::ImageId image)
+{
+    context.residency.release(residency_key(image));
+}
+
+void Renderer::release_buffer(daxa::BufferId buffer)
+{
+    context.residency.release(residency_key(buffer));
+}
+
+void Renderer::update_atmosphere_lut_images()
+{
+    auto update_lut = [&](daxa::TaskImage & lut, daxa_u32vec2 dimensions, char const * name, daxa_u32 array_layer_count = 1)
+    {
+        if(!lut.get_state().images.empty() && context.device.is_id_valid(lut.get_state().images[0]))
+        {
+            auto const old_image = lut.get_state().images[0];
+            auto const old_size = context.device.info_image(old_image).value().size;
+            if(old_size.x == dimensions.x && old_size.y == dimensions.y) { return; }
+            release_image(old_image);
+            context.device.destroy_image(old_image);
+        }
+        lut.set_images({
+            .images = std::array{
+                create_tracked_image({
+                    .format = daxa::Format::R16G16B16A16_SFLOAT,
+                    .size = {dimensions.x, dimensions.y, 1},
+                    .array_layer_count = array_layer_count,
+                    .usage =
+                        daxa::ImageUsageFlagBits::SHADER_SAMPLED |
+                        daxa::ImageUsageFlagBits::SHADER_STORAGE,
+                    .name = name
+                }, ResidencyCategory::TEXTURES)
+            }
+        });
+    };
+    // The new images have undefined contents, the dimensions are a part of the atmosphere LUT hash
+    // so the LUTs are rebaked the next frame. The skyview cache drops its layers when the skyview dimensions change
+    update_lut(context.images.transmittance_lut, globals->trans_lut_dim, "transmittance lut physical image");
+    update_lut(context.images.multiscattering_lut, globals->mult_lut_dim, "multiscattering lut physical image");
+    update_lut(context.images.skyview_lut, globals->sky_lut_dim, "skyview lut physical image");
+    update_lut(context.images.skyview_cache, globals->sky_lut_dim, "skyview cache physical image", SKYVIEW_CACHE_LAYERS);
+}
+
+auto Renderer::load_baked_atmosphere_luts() -> bool
+{
+    auto const files = get_atmosphere_lut_files(ATMOSPHERE_LUT_DIRECTORY, context.frame.atmosphere_lut_hash);
+    if(!atmosphere_lut_files_exist(files)) { return false; }
+
+    auto load_lut = [&](daxa::TaskImage & lut, daxa::TaskBuffer & staging, std::string const & path)
+    {
+        auto const loaded = manager->load_texture_staging(path);
+        // Destruction of the previous image and staging buffer is deferred by the device until the frames in flight using them finish
+        auto const old_image = lut.get_state().images[0];
+        auto const name = context.device.info_image(old_image).value().name;
+        release_image(old_image);
+        context.device.destroy_image(old_image);
+        context.device.destroy_buffer(staging.get_state().buffers[0]);
+
+        lut.set_images({
+            .images = std::array{
+                create_tracked_image({
+                    .format = loaded.format,
+                    .size = {static_cast<daxa_u32>(loaded.resolution.x), static_cast<daxa_u32>(loaded.resolution.y), 1},
+                    .usage =
+                        daxa::ImageUsageFlagBits::SHADER_SAMPLED |
+                        daxa::ImageUsageFlagBits::SHADER_STORAGE |
+                        daxa::ImageUsageFlagBits::TRANSFER_DST,
+                    .name = name
+                }, ResidencyCategory::TEXTURES)
+            }
+        });
+        staging.set_buffers({ .buffers = std::array{loaded.staging_buffer_id} });
+    };
+    // The LUT dimensions are a part of the hash so the loaded images always match the Globals,
+    // update_atmosphere_lut_images() keeps them until the dimensions change. The texels are copied
+    // by the upload baked atmosphere LUTs task of this frame
+    load_lut(context.images.transmittance_lut, context.buffers.transmittance_lut_staging, files.transmittance);
+    load_lut(context.images.multiscattering_lut, context.buffers.multiscattering_lut_staging, files.multiscattering);
+    return true;
 }
 
 void Renderer::initialize_main_tasklist()
@@ -443,17 +793,33 @@ void Renderer::initialize_main_tasklist()
     context.main_task_list.task_list.use_persistent_buffer(context.buffers.globals);
     context.main_task_list.task_list.use_persistent_buffer(context.buffers.terrain_indices);
     context.main_task_list.task_list.use_persistent_buffer(context.buffers.terrain_vertices);
+    context.main_task_list.task_list.use_persistent_buffer(context.buffers.terrain_patch_bounds);
+    context.main_task_list.task_list.use_persistent_buffer(context.buffers.vsm_culled_terrain_indices);
     context.main_task_list.task_list.use_persistent_buffer(context.buffers.frustum_indices);
+    context.main_task_list.task_list.use_persistent_buffer(context.buffers.debug_frustum_vertices);
+    context.main_task_list.task_list.use_persistent_buffer(context.buffers.debug_frustum_colors);
+    context.main_task_list.task_list.use_persistent_buffer(context.buffers.debug_line_vertices);
     context.main_task_list.task_list.use_persistent_buffer(context.buffers.average_luminance);
     context.main_task_list.task_list.use_persistent_buffer(context.buffers.histogram_readback);
+    context.main_task_list.task_list.use_persistent_buffer(context.buffers.vsm_statistics_readback);
+    context.main_task_list.task_list.use_persistent_buffer(context.buffers.vsm_sun_projections);
+    context.main_task_list.task_list.use_persistent_buffer(context.buffers.vsm_free_wrapped_pages_info);
+    context.main_task_list.task_list.use_persistent_buffer(context.buffers.transmittance_lut_staging);
+    context.main_task_list.task_list.use_persistent_buffer(context.buffers.multiscattering_lut_staging);
     context.main_task_list.task_list.use_persistent_image(context.images.swapchain);
     context.main_task_list.task_list.use_persistent_image(context.images.height_map);
     context.main_task_list.task_list.use_persistent_image(context.images.diffuse_map);
     context.main_task_list.task_list.use_persistent_image(context.images.normal_map);
     context.main_task_list.task_list.use_persistent_image(context.images.tonemapping_lut);
+    context.main_task_list.task_list.use_persistent_image(context.images.medium_lut);
+    context.main_task_list.task_list.use_persistent_image(context.images.transmittance_lut);
+    context.main_task_list.task_list.use_persistent_image(context.images.multiscattering_lut);
+    context.main_task_list.task_list.use_persistent_image(context.images.skyview_lut);
+    context.main_task_list.task_list.use_persistent_image(context.images.skyview_cache);
 
     context.main_task_list.task_list.use_persistent_image(context.images.vsm_memory);
     context.main_task_list.task_list.use_persistent_image(context.images.vsm_meta_memory_table);
+    context.main_task_list.task_list.use_persistent_image(context.images.vsm_meta_memory_last_used);
     context.main_task_list.task_list.use_persistent_image(context.images.vsm_debug_meta_memory_table);
     context.main_task_list.task_list.use_persistent_image(context.images.vsm_page_height_offset);
     context.main_task_list.task_list.use_persistent_image(context.images.vsm_page_table);
@@ -507,16 +873,6 @@ void Renderer::initialize_main_tasklist()
     #pragma endregion
 
     #pragma region debug_frustum_draw_resources
-    tl.buffers.frustum_vertices = tl.task_list.create_transient_buffer({
-        .size = static_cast<daxa_u32>(sizeof(FrustumVertex) * FRUSTUM_VERTEX_COUNT * MAX_FRUSTUM_COUNT),
-        .name = "debug frustum vertices"
-    });
-
-    tl.buffers.frustum_colors = tl.task_list.create_transient_buffer({
-        .size = static_cast<daxa_u32>(sizeof(FrustumColor) * MAX_FRUSTUM_COUNT),
-        .name = "debug frustum colors"
-    });
-
     tl.buffers.frustum_indirect = tl.task_list.create_transient_buffer({
         .size = static_cast<daxa_u32>(sizeof(DrawIndexedIndirectStruct)),
         .name = "debug frustum indirect struct"
@@ -530,9 +886,36 @@ void Renderer::initialize_main_tasklist()
         .name = "transient vsm debug image"
     });
 
-    tl.buffers.vsm_free_wrapped_pages_info = tl.task_list.create_transient_buffer({
-        .size = static_cast<daxa_u32>(sizeof(FreeWrappedPagesInfo) * VSM_CLIP_LEVELS),
-        .name = "vsm free wrapped pages info"
+    tl.images.vsm_page_request_coverage = tl.task_list.create_transient_image({
+        .format = daxa::Format::R32_UINT,
+        .size = {VSM_PAGE_TABLE_RESOLUTION, VSM_PAGE_TABLE_RESOLUTION, 1u},
+        .array_layer_count = VSM_CLIP_LEVELS,
+        .name = "transient vsm page request coverage"
+    });
+
+    tl.buffers.vsm_page_request_count = tl.task_list.create_transient_buffer({
+        .size = static_cast<daxa_u32>(sizeof(AllocationCount)),
+        .name = "vsm page request count"
+    });
+
+    tl.buffers.vsm_statistics = tl.task_list.create_transient_buffer({
+        .size = static_cast<daxa_u32>(sizeof(VSMStatistics)),
+        .name = "vsm statistics"
+    });
+
+    tl.buffers.vsm_dirty_pyramid = tl.task_list.create_transient_buffer({
+        .size = static_cast<daxa_u32>(sizeof(VSMDirtyPyramid) * VSM_CLIP_LEVELS),
+        .name = "vsm dirty pyramid"
+    });
+
+    tl.buffers.vsm_terrain_draw_commands = tl.task_list.create_transient_buffer({
+        .size = static_cast<daxa_u32>(sizeof(DrawIndexedIndirectStruct) * VSM_CLIP_LEVELS),
+        .name = "vsm terrain draw commands"
+    });
+
+    tl.buffers.vsm_page_requests = tl.task_list.create_transient_buffer({
+        .size = static_cast<daxa_u32>(sizeof(AllocationRequest) * MAX_NUM_VSM_PAGE_REQUEST),
+        .name = "vsm page request buffer"
     });
 
     tl.buffers.vsm_allocation_count = tl.task_list.create_transient_buffer({
@@ -566,7 +949,7 @@ void Renderer::initialize_main_tasklist()
     });
 
     tl.buffers.vsm_not_visited_page_buffer = tl.task_list.create_transient_buffer({
-        .size = static_cast<daxa_u32>(sizeof(PageCoordBuffer) * (MAX_NUM_VSM_ALLOC_REQUEST)),
+        .size = static_cast<daxa_u32>(sizeof(PageCoordBuffer) * (MAX_NUM_VSM_ALLOC_REQUEST) * VSM_EVICTION_BUCKETS),
         .name = "vsm not visited buffer"
     });
 
@@ -574,11 +957,6 @@ void Renderer::initialize_main_tasklist()
         .size = static_cast<daxa_u32>(sizeof(FindFreePagesHeader)),
         .name = "find free pages header"
     });
-
-    tl.buffers.vsm_sun_projection_matrices = tl.task_list.create_transient_buffer({
-        .size = static_cast<daxa_u32>(sizeof(VSMClipProjection) * VSM_CLIP_LEVELS),
-        .name = "sun projection matrices"
-    });
     #pragma endregion
 
     tl.buffers.luminance_histogram = tl.task_list.create_transient_buffer({
@@ -610,24 +988,6 @@ void Renderer::initialize_main_tasklist()
         .name = "offscreen"
     });
 
-    tl.images.transmittance_lut = tl.task_list.create_transient_image({
-        .format = daxa::Format::R16G16B16A16_SFLOAT,
-        .size = {globals->trans_lut_dim.x, globals->trans_lut_dim.y, 1},
-        .name = "transient transmittance lut"
-    });
-
-    tl.images.multiscattering_lut = tl.task_list.create_transient_image({
-        .format = daxa::Format::R16G16B16A16_SFLOAT,
-        .size = {globals->mult_lut_dim.x, globals->mult_lut_dim.y, 1},
-        .name = "transient multiscattering lut"
-    });
-
-    tl.images.skyview_lut = tl.task_list.create_transient_image({
-        .format = daxa::Format::R16G16B16A16_SFLOAT,
-        .size = {globals->sky_lut_dim.x, globals->sky_lut_dim.y, 1},
-        .name = "transient skyview lut"
-    });
-    
     /* ============================================================================================================ */
     /* ===============================================  TASKS  ==================================================== */
     /* ============================================================================================================ */
@@ -636,21 +996,27 @@ void Renderer::initialize_main_tasklist()
     tl.task_list.add_task({
         .uses = { 
             daxa::ImageTransferWrite<>{context.images.vsm_debug_page_table},
+            daxa::ImageTransferWrite<daxa::ImageViewType::REGULAR_2D_ARRAY>{
+                tl.images.vsm_page_request_coverage.view({.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS})},
+            daxa::ImageTransferWrite<>{context.images.medium_lut},
             daxa::BufferHostTransferWrite{context.buffers.globals},
-            daxa::BufferHostTransferWrite{tl.buffers.frustum_vertices},
+            daxa::BufferHostTransferWrite{context.buffers.debug_frustum_vertices},
             daxa::BufferHostTransferWrite{tl.buffers.frustum_indirect},
-            daxa::BufferHostTransferWrite{tl.buffers.frustum_colors},
+            daxa::BufferHostTransferWrite{context.buffers.debug_frustum_colors},
+            daxa::BufferHostTransferWrite{context.buffers.debug_line_vertices},
             daxa::BufferHostTransferWrite{tl.buffers.luminance_histogram},
-            daxa::BufferHostTransferWrite{tl.buffers.vsm_allocation_count},
+            daxa::BufferHostTransferWrite{tl.buffers.vsm_page_request_count},
+            daxa::BufferHostTransferWrite{tl.buffers.vsm_statistics},
             daxa::BufferHostTransferWrite{tl.buffers.vsm_find_free_pages_header},
-            daxa::BufferHostTransferWrite{tl.buffers.vsm_sun_projection_matrices},
-            daxa::BufferHostTransferWrite{tl.buffers.vsm_free_wrapped_pages_info},
+            daxa::BufferHostTransferWrite{context.buffers.vsm_sun_projections},
+            daxa::BufferHostTransferWrite{context.buffers.vsm_free_wrapped_pages_info},
         },
         .task = [&, this](daxa::TaskInterface ti)
         {
+            PROFILE_SCOPE("upload data");
             auto & cmd_list = ti.get_recorder();
             {
-                auto upload_cpu_to_gpu = [&](BufferId gpu_buffer, void* cpu_buffer, size_t size)
+                auto upload_cpu_to_gpu = [&](BufferId gpu_buffer, void const * cpu_buffer, size_t size, size_t dst_offset = 0)
                 {
                     if(size == 0) { return; }
                     auto staging_mem_result = ti.get_allocator().allocate(size);
@@ -664,6 +1030,7 @@ void Renderer::initialize_main_tasklist()
                         .src_buffer = ti.get_allocator().buffer(),
                         .dst_buffer = gpu_buffer,
                         .src_offset = staging_mem.buffer_offset,
+                        .dst_offset = dst_offset,
                         .size = size
                     });
                 };
@@ -672,116 +1039,156 @@ void Renderer::initialize_main_tasklist()
                     .clear_value = daxa::ClearValue{std::array{0.0f, 0.0f, 0.0f, 1.0f}},
                     .dst_image = ti.uses[context.images.vsm_debug_page_table].image()
                 });
-                // Globals
-                upload_cpu_to_gpu(ti.uses[context.buffers.globals].buffer(), globals, sizeof(Globals));
-                // Frustum vertices
-                upload_cpu_to_gpu(
-                    ti.uses[tl.buffers.frustum_vertices].buffer(),
-                    context.frustum_vertices.data(),
-                    sizeof(FrustumVertex) * 8 * context.debug_frustum_cpu_count
-                );
-                // Frustum colors
-                upload_cpu_to_gpu(
-                    ti.uses[tl.buffers.frustum_colors].buffer(),
-                    context.frustum_colors.data(),
-                    sizeof(FrustumColor) * context.debug_frustum_cpu_count
-                );
-                // Frustum indirect draw buffer
-                DrawIndexedIndirectStruct indexed_indirect{
-                    .index_count = 18,
-                    .instance_count = context.debug_frustum_cpu_count,
-                    .first_index = 0,
-                    .vertex_offset = 0,
-                    .first_instance = 0
-                };
-                upload_cpu_to_gpu(
-                    ti.uses[tl.buffers.frustum_indirect].buffer(),
-                    &indexed_indirect,
-                    sizeof(DrawIndexedIndirectStruct)
-                );
-                // Histogram
-                std::array<daxa_u32, HISTOGRAM_BIN_COUNT> reset_bin_values {};
-                upload_cpu_to_gpu(
-                    ti.uses[tl.buffers.luminance_histogram].buffer(),
-                    reset_bin_values.data(),
-                    sizeof(Histogram) * HISTOGRAM_BIN_COUNT
-                );
-                // Reset vsm allocation count to 0
-                AllocationCount allocation_count{ .count = 0};
-                upload_cpu_to_gpu(
-                    ti.uses[tl.buffers.vsm_allocation_count].buffer(),
-                    &allocation_count,
-                    sizeof(AllocationCount)
-                );
-                // Vsm find free pages header
-                FindFreePagesHeader header = FindFreePagesHeader{
-                    .free_buffer_counter = 0,
-                    .not_visited_buffer_counter = 0
+                // The first depth sample landing in an unallocated page adds it to the page requests
+                cmd_list.clear_image({
+                    .clear_value = std::array<daxa_u32, 4>{0u, 0u, 0u, 0u},
+                    .dst_image = ti.uses[tl.images.vsm_page_request_coverage].image(),
+                    .dst_slice = daxa::ImageMipArraySlice{
+                        .base_array_layer = 0,
+                        .layer_count = VSM_CLIP_LEVELS
+                    }
+                });
+                auto get_target_buffer = [&](FrameUploadTarget target) -> BufferId
+                {
+                    switch(target)
+                    {
+                        case FrameUploadTarget::GLOBALS: return ti.uses[context.buffers.globals].buffer();
+                        case FrameUploadTarget::FRUSTUM_VERTICES: return ti.uses[context.buffers.debug_frustum_vertices].buffer();
+                        case FrameUploadTarget::FRUSTUM_COLORS: return ti.uses[context.buffers.debug_frustum_colors].buffer();
+                        case FrameUploadTarget::FRUSTUM_INDIRECT: return ti.uses[tl.buffers.frustum_indirect].buffer();
+                        case FrameUploadTarget::DEBUG_LINE_VERTICES: return ti.uses[context.buffers.debug_line_vertices].buffer();
+                        case FrameUploadTarget::LUMINANCE_HISTOGRAM: return ti.uses[tl.buffers.luminance_histogram].buffer();
+                        case FrameUploadTarget::VSM_PAGE_REQUEST_COUNT: return ti.uses[tl.buffers.vsm_page_request_count].buffer();
+                        case FrameUploadTarget::VSM_STATISTICS: return ti.uses[tl.buffers.vsm_statistics].buffer();
+                        case FrameUploadTarget::VSM_FIND_FREE_PAGES_HEADER: return ti.uses[tl.buffers.vsm_find_free_pages_header].buffer();
+                        case FrameUploadTarget::VSM_SUN_PROJECTIONS: return ti.uses[context.buffers.vsm_sun_projections].buffer();
+                        case FrameUploadTarget::VSM_FREE_WRAPPED_PAGES_INFO: return ti.uses[context.buffers.vsm_free_wrapped_pages_info].buffer();
+                        default: break;
+                    }
+                    DBG_ASSERT_TRUE_M(false, "[Renderer::initialize_task_list()] Upload target is not a buffer");
+                    return {};
                 };
-                upload_cpu_to_gpu(
-                    ti.uses[tl.buffers.vsm_find_free_pages_header].buffer(),
-                    &header,
-                    sizeof(FindFreePagesHeader)
-                );
-                // VSM sun clip matrices
-                upload_cpu_to_gpu(
-                    ti.uses[tl.buffers.vsm_sun_projection_matrices].buffer(),
-                    context.vsm_sun_projections.data(),
-                    sizeof(VSMClipProjection) * VSM_CLIP_LEVELS
-                );
-                // VSM free wrapped apges info
-                upload_cpu_to_gpu(
-                    ti.uses[tl.buffers.vsm_free_wrapped_pages_info].buffer(),
-                    context.vsm_free_wrapped_pages_info.data(),
-                    sizeof(FreeWrappedPagesInfo) * VSM_CLIP_LEVELS
-                );
+                for(auto const & upload : context.frame.uploads)
+                {
+                    if(upload.target != FrameUploadTarget::MEDIUM_LUT)
+                    {
+                        upload_cpu_to_gpu(get_target_buffer(upload.target), upload.data, upload.size, upload.dst_offset);
+                        continue;
+                    }
+                    auto staging_mem_result = ti.get_allocator().allocate(upload.size);
+                    DBG_ASSERT_TRUE_M(
+                        staging_mem_result.has_value(),
+                        "[Renderer::initialize_task_list()] Failed to create medium LUT staging buffer"
+                    );
+                    auto staging_mem = staging_mem_result.value();
+                    memcpy(staging_mem.host_address, upload.data, upload.size);
+                    cmd_list.copy_buffer_to_image({
+                        .buffer = ti.get_allocator().buffer(),
+                        .buffer_offset = staging_mem.buffer_offset,
+                        .image = ti.uses[context.images.medium_lut].image(),
+                        .image_extent = { MEDIUM_LUT_RESOLUTION, 1, 1 }
+                    });
+                }
+                finish_frame_uploads(context.frame);
             }
         },
         .name = "upload data",
     });
-    #pragma endregion
 
-    #pragma region compute_transmittance
-    /* =========================================== COMPUTE TRANSMITTANCE ========================================== */
-    tl.task_list.add_task(ComputeTransmittanceTask{{
-        .uses = {
-            ._globals = context.buffers.globals.view(),
-            ._transmittance_LUT = tl.images.transmittance_lut,
-        }},
-        &context
+    // Only in the frames which loaded the offline baked LUTs, Renderer::draw() skips the GPU LUT bake in them
+    tl.task_list.conditional({
+        .condition_index = MainConditionals::UPLOAD_BAKED_ATMOSPHERE_LUTS,
+        .when_true = [&]()
+        {
+            tl.task_list.add_task({
+                .uses = {
+                    daxa::BufferTransferRead{context.buffers.transmittance_lut_staging},
+                    daxa::BufferTransferRead{context.buffers.multiscattering_lut_staging},
+                    daxa::ImageTransferWrite<>{context.images.transmittance_lut},
+                    daxa::ImageTransferWrite<>{context.images.multiscattering_lut},
+                },
+                .task = [&, this](daxa::TaskInterface ti)
+                {
+                    auto & cmd_list = ti.get_recorder();
+                    for(auto const & [staging, lut] : {
+                        std::pair{&context.buffers.transmittance_lut_staging, &context.images.transmittance_lut},
+                        std::pair{&context.buffers.multiscattering_lut_staging, &context.images.multiscattering_lut}})
+                    {
+                        auto const lut_image = ti.uses[*lut].image();
+                        auto const lut_size = context.device.info_image(lut_image).value().size;
+                        cmd_list.copy_buffer_to_image({
+                            .buffer = ti.uses[*staging].buffer(),
+                            .image = lut_image,
+                            .image_extent = { lut_size.x, lut_size.y, 1 }
+                        });
+                    }
+                },
+                .name = "upload baked atmosphere luts",
+            });
+        }
     });
     #pragma endregion
 
-    #pragma region compute_multiscattering
-    /* =========================================== COMPUTE MULTISCATTERING ======================================== */
-    tl.task_list.add_task(ComputeMultiscatteringTask{{
-        .uses = {
-            ._globals = context.buffers.globals.view(),
-            ._transmittance_LUT = tl.images.transmittance_lut,
-            ._multiscattering_LUT = tl.images.multiscattering_lut,
-        }},
-        &context
+    // Only depend on the atmosphere parameters, the skyview LUT below follows the camera and the sun through the skyview cache
+    tl.task_list.conditional({
+        .condition_index = MainConditionals::UPDATE_ATMOSPHERE_LUTS,
+        .when_true = [&]()
+        {
+            #pragma region compute_transmittance
+            /* =========================================== COMPUTE TRANSMITTANCE ========================================== */
+            tl.task_list.add_task(ComputeTransmittanceTask{{
+                .uses = {
+                    ._globals = context.buffers.globals.view(),
+                    ._medium_LUT = context.images.medium_lut.view(),
+                    ._transmittance_LUT = context.images.transmittance_lut.view(),
+                }},
+                &context
+            });
+            #pragma endregion
+
+            #pragma region compute_multiscattering
+            /* =========================================== COMPUTE MULTISCATTERING ======================================== */
+            tl.task_list.add_task(ComputeMultiscatteringTask{{
+                .uses = {
+                    ._globals = context.buffers.globals.view(),
+                    ._transmittance_LUT = context.images.transmittance_lut.view(),
+                    ._medium_LUT = context.images.medium_lut.view(),
+                    ._multiscattering_LUT = context.images.multiscattering_lut.view(),
+                }},
+                &context
+            });
+            #pragma endregion
+        }
     });
-    #pragma endregion
 
     #pragma region compute_skyview
     /* =========================================== COMPUTE SKYVIEW ================================================ */
-    tl.task_list.add_task(ComputeSkyViewTask{{
-        .uses = {
-            ._globals = context.buffers.globals.view(),
-            ._transmittance_LUT = tl.images.transmittance_lut,
-            ._multiscattering_LUT = tl.images.multiscattering_lut,
-            ._skyview_LUT = tl.images.skyview_lut
-        }},
-        &context
+    tl.task_list.conditional({
+        .condition_index = MainConditionals::UPDATE_SKYVIEW_LUT,
+        .when_true = [&]()
+        {
+            tl.task_list.add_task(ComputeSkyViewTask{{
+                .uses = {
+                    ._globals = context.buffers.globals.view(),
+                    ._transmittance_LUT = context.images.transmittance_lut.view(),
+                    ._medium_LUT = context.images.medium_lut.view(),
+                    ._multiscattering_LUT = context.images.multiscattering_lut.view(),
+                    ._skyview_cache = context.images.skyview_cache.view().view(
+                        {.base_array_layer = 0, .layer_count = SKYVIEW_CACHE_LAYERS}),
+                    ._skyview_LUT = context.images.skyview_lut.view()
+                }},
+                &context
+            });
+        }
     });
     #pragma endregion
 
     #pragma region vsm_free_wrapped_pages
     tl.task_list.add_task(VSMFreeWrappedPagesTask{{
         .uses = {
-            ._free_wrapped_pages_info = tl.buffers.vsm_free_wrapped_pages_info,
-            ._vsm_sun_projections = tl.buffers.vsm_sun_projection_matrices,
+            ._free_wrapped_pages_info = context.buffers.vsm_free_wrapped_pages_info.view(),
+            ._vsm_sun_projections = context.buffers.vsm_sun_projections.view(),
+            ._vsm_statistics = tl.buffers.vsm_statistics,
             ._vsm_page_table = context.images.vsm_page_table.view().view(
                 {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}),
             ._vsm_meta_memory_table = context.images.vsm_meta_memory_table.view()
@@ -808,7 +1215,7 @@ void Renderer::initialize_main_tasklist()
                     ._vertices = context.buffers.terrain_vertices.view(),
                     ._indices = context.buffers.terrain_indices.view(),
                     ._globals = context.buffers.globals.view(),
-                    ._vsm_sun_projections = tl.buffers.vsm_sun_projection_matrices,
+                    ._vsm_sun_projections = context.buffers.vsm_sun_projections.view(),
                     ._g_albedo = tl.images.g_albedo,
                     ._g_normals = tl.images.g_normals,
                     ._depth = secondary_camera_depth,
@@ -828,7 +1235,7 @@ void Renderer::initialize_main_tasklist()
                     ._vertices = context.buffers.terrain_vertices.view(),
                     ._indices = context.buffers.terrain_indices.view(),
                     ._globals = context.buffers.globals.view(),
-                    ._vsm_sun_projections = tl.buffers.vsm_sun_projection_matrices,
+                    ._vsm_sun_projections = context.buffers.vsm_sun_projections.view(),
                     ._g_albedo = tl.images.g_albedo,
                     ._g_normals = tl.images.g_normals,
                     ._depth = tl.images.depth,
@@ -847,17 +1254,17 @@ void Renderer::initialize_main_tasklist()
                 .uses = {
                     ._globals = context.buffers.globals.view(),
                     ._depth_limits = tl.buffers.depth_limits,
-                    ._vsm_allocation_count = tl.buffers.vsm_allocation_count,
-                    ._vsm_allocation_buffer = tl.buffers.vsm_allocation_requests,
-                    ._vsm_allocate_indirect = tl.buffers.vsm_allocate_indirect,
-                    ._vsm_clear_indirect = tl.buffers.vsm_clear_indirect,
-                    ._vsm_clear_dirty_bit_indirect = tl.buffers.vsm_clear_dirty_bit_indirect,
-                    ._vsm_sun_projections = tl.buffers.vsm_sun_projection_matrices,
+                    ._vsm_page_request_count = tl.buffers.vsm_page_request_count,
+                    ._vsm_page_requests = tl.buffers.vsm_page_requests,
+                    ._vsm_sun_projections = context.buffers.vsm_sun_projections.view(),
                     ._depth = secondary_camera_depth,
                     ._vsm_page_table = context.images.vsm_page_table.view().view(
                         {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}
                     ),
                     ._vsm_meta_memory_table = context.images.vsm_meta_memory_table.view(),
+                    ._vsm_page_request_coverage = tl.images.vsm_page_request_coverage.view(
+                        {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}
+                    ),
                 }},
                 &context
             });
@@ -871,7 +1278,7 @@ void Renderer::initialize_main_tasklist()
                     ._vertices = context.buffers.terrain_vertices.view(),
                     ._indices = context.buffers.terrain_indices.view(),
                     ._globals = context.buffers.globals.view(),
-                    ._vsm_sun_projections = tl.buffers.vsm_sun_projection_matrices,
+                    ._vsm_sun_projections = context.buffers.vsm_sun_projections.view(),
                     ._g_albedo = tl.images.g_albedo,
                     ._g_normals = tl.images.g_normals,
                     ._depth = tl.images.depth,
@@ -889,35 +1296,61 @@ void Renderer::initialize_main_tasklist()
                 .uses = {
                     ._globals = context.buffers.globals.view(),
                     ._depth_limits = tl.buffers.depth_limits,
-                    ._vsm_allocation_count = tl.buffers.vsm_allocation_count,
-                    ._vsm_allocation_buffer = tl.buffers.vsm_allocation_requests,
-                    ._vsm_allocate_indirect = tl.buffers.vsm_allocate_indirect,
-                    ._vsm_clear_indirect = tl.buffers.vsm_clear_indirect,
-                    ._vsm_clear_dirty_bit_indirect = tl.buffers.vsm_clear_dirty_bit_indirect,
-                    ._vsm_sun_projections = tl.buffers.vsm_sun_projection_matrices,
+                    ._vsm_page_request_count = tl.buffers.vsm_page_request_count,
+                    ._vsm_page_requests = tl.buffers.vsm_page_requests,
+                    ._vsm_sun_projections = context.buffers.vsm_sun_projections.view(),
                     ._depth = tl.images.depth,
                     ._vsm_page_table = context.images.vsm_page_table.view().view(
                         {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}
                     ),
                     ._vsm_meta_memory_table = context.images.vsm_meta_memory_table.view(),
+                    ._vsm_page_request_coverage = tl.images.vsm_page_request_coverage.view(
+                        {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}
+                    ),
                 }},
                 &context
             });
             #pragma endregion
         }
     });
+    #pragma region vsm_prioritize_requests
+    tl.task_list.add_task(VSMPrioritizeRequestsTask{{
+        .uses = {
+            ._globals = context.buffers.globals.view(),
+            ._vsm_page_request_count = tl.buffers.vsm_page_request_count,
+            ._vsm_page_requests = tl.buffers.vsm_page_requests,
+            ._vsm_allocation_count = tl.buffers.vsm_allocation_count,
+            ._vsm_allocation_buffer = tl.buffers.vsm_allocation_requests,
+            ._vsm_allocate_indirect = tl.buffers.vsm_allocate_indirect,
+            ._vsm_clear_indirect = tl.buffers.vsm_clear_indirect,
+            ._vsm_clear_dirty_bit_indirect = tl.buffers.vsm_clear_dirty_bit_indirect,
+            ._vsm_statistics = tl.buffers.vsm_statistics,
+            ._vsm_page_request_coverage = tl.images.vsm_page_request_coverage.view(
+                {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}
+            ),
+            ._vsm_page_table = context.images.vsm_page_table.view().view(
+                {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}
+            ),
+        }},
+        &context
+    });
+    #pragma endregion
+
     #pragma region vsm_find_free_pages
     tl.task_list.add_task(VSMFindFreePagesTask{{
         .uses = {
+            ._globals = context.buffers.globals.view(),
             ._vsm_allocation_buffer = tl.buffers.vsm_allocation_requests,
             ._vsm_allocate_indirect = tl.buffers.vsm_allocate_indirect,
             ._vsm_free_pages_buffer = tl.buffers.vsm_free_page_buffer,
             ._vsm_not_visited_pages_buffer = tl.buffers.vsm_not_visited_page_buffer,
             ._vsm_find_free_pages_header = tl.buffers.vsm_find_free_pages_header,
+            ._vsm_statistics = tl.buffers.vsm_statistics,
             ._vsm_page_table = context.images.vsm_page_table.view().view(
                 {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}
             ),
             ._vsm_meta_memory_table = context.images.vsm_meta_memory_table.view(),
+            ._vsm_meta_memory_last_used = context.images.vsm_meta_memory_last_used.view(),
         }},
         &context
     });
@@ -926,6 +1359,7 @@ void Renderer::initialize_main_tasklist()
     #pragma region allocate_vsm_pages
     tl.task_list.add_task(VSMAllocatePagesTask{{
         .uses = {
+            ._globals = context.buffers.globals.view(),
             ._vsm_allocation_count = tl.buffers.vsm_allocation_count,
             ._vsm_allocation_buffer = tl.buffers.vsm_allocation_requests,
             ._vsm_allocate_indirect = tl.buffers.vsm_allocate_indirect,
@@ -933,12 +1367,14 @@ void Renderer::initialize_main_tasklist()
             ._vsm_free_pages_buffer = tl.buffers.vsm_free_page_buffer,
             ._vsm_not_visited_pages_buffer = tl.buffers.vsm_not_visited_page_buffer,
             ._vsm_find_free_pages_header = tl.buffers.vsm_find_free_pages_header,
-            ._vsm_sun_projections = tl.buffers.vsm_sun_projection_matrices,
+            ._vsm_sun_projections = context.buffers.vsm_sun_projections.view(),
+            ._vsm_statistics = tl.buffers.vsm_statistics,
             ._vsm_page_table = context.images.vsm_page_table.view().view(
                 {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}),
             ._vsm_page_height_offset = context.images.vsm_page_height_offset.view().view(
                 {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}),
             ._vsm_meta_memory_table = context.images.vsm_meta_memory_table.view(),
+            ._vsm_meta_memory_last_used = context.images.vsm_meta_memory_last_used.view(),
         }},
         &context
     });
@@ -949,6 +1385,7 @@ void Renderer::initialize_main_tasklist()
         .uses = {
             ._vsm_allocation_buffer = tl.buffers.vsm_allocation_requests,
             ._vsm_clear_indirect = tl.buffers.vsm_clear_indirect,
+            ._vsm_statistics = tl.buffers.vsm_statistics,
             ._vsm_page_table = context.images.vsm_page_table.view().view(
                 {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}),
             ._vsm_memory = context.images.vsm_memory
@@ -957,13 +1394,45 @@ void Renderer::initialize_main_tasklist()
     });
     #pragma endregion
 
+    #pragma region vsm_build_dirty_pyramid
+    tl.task_list.add_task(VSMBuildDirtyPyramidTask{{
+        .uses = {
+            ._vsm_sun_projections = context.buffers.vsm_sun_projections.view(),
+            ._vsm_dirty_pyramid = tl.buffers.vsm_dirty_pyramid,
+            ._vsm_terrain_draw_commands = tl.buffers.vsm_terrain_draw_commands,
+            ._vsm_page_table = context.images.vsm_page_table.view().view(
+                {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}
+            ),
+        }},
+        &context
+    });
+    #pragma endregion
+
+    #pragma region vsm_cull_terrain_patches
+    tl.task_list.add_task(VSMCullTerrainPatchesTask{{
+        .uses = {
+            ._globals = context.buffers.globals.view(),
+            ._vertices = context.buffers.terrain_vertices.view(),
+            ._indices = context.buffers.terrain_indices.view(),
+            ._terrain_patch_bounds = context.buffers.terrain_patch_bounds.view(),
+            ._vsm_sun_projections = context.buffers.vsm_sun_projections.view(),
+            ._vsm_dirty_pyramid = tl.buffers.vsm_dirty_pyramid,
+            ._vsm_terrain_draw_commands = tl.buffers.vsm_terrain_draw_commands,
+            ._vsm_culled_terrain_indices = context.buffers.vsm_culled_terrain_indices.view(),
+            ._vsm_statistics = tl.buffers.vsm_statistics,
+        }},
+        &context
+    });
+    #pragma endregion
+
     #pragma region draw_vsm_pages
     tl.task_list.add_task(VSMDrawPagesTask{{
         .uses = {
             ._globals = context.buffers.globals.view(),
             ._vertices = context.buffers.terrain_vertices.view(),
-            ._indices = context.buffers.terrain_indices.view(),
-            ._vsm_sun_projections = tl.buffers.vsm_sun_projection_matrices,
+            ._indices = context.buffers.vsm_culled_terrain_indices.view(),
+            ._vsm_terrain_draw_commands = tl.buffers.vsm_terrain_draw_commands,
+            ._vsm_sun_projections = context.buffers.vsm_sun_projections.view(),
             ._height_map = context.images.height_map.view(),
             ._debug = tl.images.vsm_debug_image,
             ._vsm_page_table = context.images.vsm_page_table.view().view(
@@ -971,7 +1440,8 @@ void Renderer::initialize_main_tasklist()
             ),
             ._vsm_memory = context.images.vsm_memory.view()
         }},
-        &context
+        &context,
+        &globals->frame_index
     });
     #pragma endregion
 
@@ -981,6 +1451,7 @@ void Renderer::initialize_main_tasklist()
             ._vsm_allocation_count = tl.buffers.vsm_allocation_count,
             ._vsm_allocation_buffer = tl.buffers.vsm_allocation_requests,
             ._vsm_clear_dirty_bit_indirect = tl.buffers.vsm_clear_dirty_bit_indirect,
+            ._vsm_statistics = tl.buffers.vsm_statistics,
             ._vsm_page_table = context.images.vsm_page_table.view().view(
                 {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}
             ),
@@ -989,14 +1460,36 @@ void Renderer::initialize_main_tasklist()
     });
     #pragma endregion
 
+    #pragma region readback_vsm_statistics
+    tl.task_list.add_task({
+        .uses = {
+            daxa::BufferTransferRead{tl.buffers.vsm_statistics},
+            daxa::BufferTransferWrite{context.buffers.vsm_statistics_readback}
+        },
+        .task = [&, this](daxa::TaskInterface ti)
+        {
+            auto & cmd_list = ti.get_recorder();
+            const bool is_frame_even = globals->frame_index % 2 == 0;
+            cmd_list.copy_buffer_to_buffer({
+                .src_buffer = ti.uses[tl.buffers.vsm_statistics].buffer(),
+                .dst_buffer = ti.uses[context.buffers.vsm_statistics_readback].buffer(),
+                .src_offset = 0,
+                .dst_offset = is_frame_even ? 0u : sizeof(VSMStatistics),
+                .size = sizeof(VSMStatistics)
+            });
+        },
+        .name = "readback vsm statistics"
+    });
+    #pragma endregion
+
     #pragma region prepare_shadowmap_matrices
     tl.task_list.add_task(PrepareShadowmapMatricesTask{{
         .uses = {
             ._globals = context.buffers.globals.view(),
             ._depth_limits = tl.buffers.depth_limits,
             ._cascade_data = tl.buffers.shadowmap_data,
-            ._frustum_vertices = tl.buffers.frustum_vertices,
-            ._frustum_colors = tl.buffers.frustum_colors,
+            ._frustum_vertices = context.buffers.debug_frustum_vertices.view(),
+            ._frustum_colors = context.buffers.debug_frustum_colors.view(),
             ._frustum_indirect = tl.buffers.frustum_indirect,
         }},
         &context
@@ -1040,13 +1533,13 @@ void Renderer::initialize_main_tasklist()
         .uses = {
             ._globals = context.buffers.globals.view(),
             ._cascade_data = tl.buffers.shadowmap_data,
-            ._vsm_sun_projections = tl.buffers.vsm_sun_projection_matrices,
+            ._vsm_sun_projections = context.buffers.vsm_sun_projections.view(),
             ._offscreen = tl.images.offscreen,
             ._g_albedo = tl.images.g_albedo,
             ._g_normals = tl.images.g_normals,
-            ._transmittance = tl.images.transmittance_lut,
+            ._transmittance = context.images.transmittance_lut.view(),
             ._esm = tl.images.esm_cascades.view({.base_array_layer = 0, .layer_count = NUM_CASCADES}),
-            ._skyview = tl.images.skyview_lut,
+            ._skyview = context.images.skyview_lut.view(),
             ._depth = tl.images.depth,
             ._vsm_page_table = context.images.vsm_page_table.view().view(
                 {.base_array_layer = 0, .layer_count = VSM_CLIP_LEVELS}),
@@ -1121,9 +1614,10 @@ void Renderer::initialize_main_tasklist()
         .uses = {
             ._globals = context.buffers.globals.view(),
             ._frustum_indices = context.buffers.frustum_indices.view(),
-            ._frustum_vertices = tl.buffers.frustum_vertices,
-            ._frustum_colors = tl.buffers.frustum_colors,
+            ._frustum_vertices = context.buffers.debug_frustum_vertices.view(),
+            ._frustum_colors = context.buffers.debug_frustum_colors.view(),
             ._frustum_indirect = tl.buffers.frustum_indirect,
+            ._line_vertices = context.buffers.debug_line_vertices.view(),
             ._swapchain = context.images.swapchain.view(),
             ._depth = tl.images.depth
         }},
@@ -1177,6 +1671,8 @@ void Renderer::initialize_main_tasklist()
 void Renderer::resize()
 {
     context.swapchain.resize();
+    update_quality_tiers();
+    update_atmosphere_lut_images();
     
     context.main_task_list.task_list = daxa::TaskGraph({
         .device = context.device,
@@ -1197,34 +1693,59 @@ void Renderer::upload_planet_geometry(PlanetGeometry const & geometry)
     {
         if(buffer.get_state().buffers.size() > 0 && context.device.is_id_valid(buffer.get_state().buffers[0]))
         {
+            release_buffer(buffer.get_state().buffers[0]);
             context.device.destroy_buffer(buffer.get_state().buffers[0]);
         }
     };
 
     destroy_if_valid(context.buffers.terrain_vertices);
     destroy_if_valid(context.buffers.terrain_indices);
+    destroy_if_valid(context.buffers.terrain_patch_bounds);
+    destroy_if_valid(context.buffers.vsm_culled_terrain_indices);
+    DBG_ASSERT_TRUE_M(geometry.indices.size() % TERRAIN_PATCH_INDEX_COUNT == 0,
+        "[Renderer::upload_planet_geometry()] Terrain indices do not form whole patches");
     context.terrain_index_size = geometry.indices.size();
     daxa_u32 vertices_size = geometry.vertices.size() * sizeof(daxa_f32vec2);
     daxa_u32 indices_size = geometry.indices.size() * sizeof(daxa_u32);
+    daxa_u32 patch_count = geometry.indices.size() / TERRAIN_PATCH_INDEX_COUNT;
     daxa_u32 total_size = vertices_size + indices_size;
 
     context.buffers.terrain_vertices.set_buffers({
         .buffers = std::array{
-            context.device.create_buffer({
+            create_tracked_buffer({
                 .size = vertices_size,
                 .allocate_info = daxa::MemoryFlagBits::DEDICATED_MEMORY,
                 .name = "vertices buffer"
-            })
+            }, ResidencyCategory::BUFFERS)
         }
     });
 
     context.buffers.terrain_indices.set_buffers({
         .buffers = std::array{
-            context.device.create_buffer({
+            create_tracked_buffer({
                 .size = indices_size,
                 .allocate_info = daxa::MemoryFlagBits::DEDICATED_MEMORY,
                 .name = "indices buffer"
-            })
+            }, ResidencyCategory::BUFFERS)
+        }
+    });
+
+    context.buffers.terrain_patch_bounds.set_buffers({
+        .buffers = std::array{
+            create_tracked_buffer({
+                .size = static_cast<daxa_u32>(patch_count * sizeof(TerrainPatchBounds)),
+                .name = "terrain patch bounds buffer"
+            }, ResidencyCategory::BUFFERS)
+        }
+    });
+
+    // Every clip level gets a range large enough to hold all of the terrain patches
+    context.buffers.vsm_culled_terrain_indices.set_buffers({
+        .buffers = std::array{
+            create_tracked_buffer({
+                .size = indices_size * VSM_CLIP_LEVELS,
+                .name = "vsm culled terrain indices buffer"
+            }, ResidencyCategory::BUFFERS)
         }
     });
 
@@ -1235,6 +1756,8 @@ void Renderer::upload_planet_geometry(PlanetGeometry const & geometry)
     });
     upload_geom_tl.use_persistent_buffer(context.buffers.terrain_indices);
     upload_geom_tl.use_persistent_buffer(context.buffers.terrain_vertices);
+    upload_geom_tl.use_persistent_buffer(context.buffers.terrain_patch_bounds);
+    upload_geom_tl.use_persistent_image(context.images.height_map);
 
     upload_geom_tl.add_task({
         .uses = { 
@@ -1279,178 +1802,151 @@ void Renderer::upload_planet_geometry(PlanetGeometry const & geometry)
         .name = "transfer geometry",
     });
 
+    // There is no CPU copy of the height map, the patch height ranges are reduced on the GPU instead
+    upload_geom_tl.add_task(TerrainPatchBoundsTask{{
+        .uses = {
+            ._vertices = context.buffers.terrain_vertices.view(),
+            ._indices = context.buffers.terrain_indices.view(),
+            ._terrain_patch_bounds = context.buffers.terrain_patch_bounds.view(),
+            ._height_map = context.images.height_map.view(),
+        }},
+        &context
+    });
+
     upload_geom_tl.submit({});
     upload_geom_tl.complete({});
     upload_geom_tl.execute({});
 };
 
-void Renderer::draw(DrawInfo const & info) 
+void Renderer::reserve_debug_draw_buffers()
 {
-    context.debug_frustum_cpu_count = 0;
-    auto extent = context.swapchain.get_surface_extent();
-
-
-    Camera * primary_camera = globals->use_debug_camera ? &info.debug_camera : &info.main_camera;
-    Camera * secondary_camera = globals->use_debug_camera ? &info.main_camera : &info.debug_camera;
-
-    globals->camera_position     = primary_camera->get_camera_position();
-    globals->offset              = primary_camera->offset;
-    globals->view                = primary_camera->get_view_matrix();
-    globals->projection          = primary_camera->get_projection_matrix();
-    globals->inv_projection      = primary_camera->get_inv_projection_matrix();
-    globals->inv_view_projection = primary_camera->get_inv_view_proj_matrix(); 
+    auto const & debug_draw = context.frame.debug_draw;
+    auto grow_buffer = [&](daxa::TaskBuffer & buffer, size_t element_size, daxa_u32 required_count, daxa_u32 min_count)
+    {
+        auto const old_buffer = buffer.get_state().buffers[0];
+        if(context.device.info_buffer(old_buffer).value().size >= element_size * required_count) { return; }
+
+        // Powers of two so that a slowly growing stream only reallocates a handful of times
+        const daxa_u32 capacity = std::max(std::bit_ceil(required_count), min_count);
+        auto const name = context.device.info_buffer(old_buffer).value().name;
+        release_buffer(old_buffer);
+        // Destruction is deferred by the device until the frames in flight using the buffer finish
+        context.device.destroy_buffer(old_buffer);
+        buffer.set_buffers({
+            .buffers = std::array{
+                create_tracked_buffer({
+                    .size = static_cast<daxa_u32>(element_size * capacity),
+                    .allocate_info = daxa::MemoryFlagBits::DEDICATED_MEMORY,
+                    .name = name
+                }, ResidencyCategory::BUFFERS)
+            }
+        });
+    };
 
-    globals->secondary_camera_position     = secondary_camera->get_camera_position();
-    globals->secondary_offset              = secondary_camera->offset;
-    globals->secondary_view                = secondary_camera->get_view_matrix();
-    globals->secondary_projection          = secondary_camera->get_projection_matrix();
-    globals->secondary_inv_view_projection = secondary_camera->get_inv_view_proj_matrix(); 
+    // The shadowmap matrix pass appends its boxes after the CPU ones
+    const daxa_u32 box_count = debug_draw.get_box_count() + GPU_DEBUG_BOX_COUNT;
+    grow_buffer(context.buffers.debug_frustum_vertices, sizeof(FrustumVertex) * FRUSTUM_VERTEX_COUNT, box_count, MIN_DEBUG_BOX_CAPACITY);
+    grow_buffer(context.buffers.debug_frustum_colors, sizeof(FrustumColor), box_count, MIN_DEBUG_BOX_CAPACITY);
+    grow_buffer(context.buffers.debug_line_vertices, sizeof(DebugLineVertex) * 2, debug_draw.get_line_count(), MIN_DEBUG_LINE_CAPACITY);
+}
 
-    if(globals->use_debug_camera && globals->control_main_camera)
+void Renderer::draw(DrawInfo const & info) 
+{
     {
-        secondary_camera->write_frustum_vertices({
-            std::span<FrustumVertex, 8>{&context.frustum_vertices[8 * context.debug_frustum_cpu_count], 8 }
+        PROFILE_SCOPE("prepare frame");
+        prepare_frame(context.frame, {
+            .main_camera = info.main_camera,
+            .debug_camera = info.debug_camera,
+            .globals = *globals
         });
-        context.frustum_colors[context.debug_frustum_cpu_count].color = daxa_f32vec3{1.0, 1.0, 1.0};
-        context.debug_frustum_cpu_count += 1;
     }
-
-    // Setup VSM Clip projection matrices
-
-    // context.sun_camera.set_position( (globals->sun_direction * -1000.0f) + camera_fp_offset);
-    context.sun_camera.set_front(daxa_f32vec3{
-        -globals->sun_direction.x,
-        -globals->sun_direction.y,
-        -globals->sun_direction.z
-    });
-    // OrthographicInfo curr_clip_projection = OrthographicInfo {
-    //     .left   = -1000.0f,
-    //     .right  =  1000.0f,
-    //     .top    =  1000.0f,
-    //     .bottom = -1000.0f,
-    //     .near   =  10.00f,
-    //     .far    =  10'000.0f
-    // };
-    OrthographicInfo curr_clip_projection = OrthographicInfo {
-        .left   = -10.0f,
-        .right  =  10.0f,
-        .top    =  10.0f,
-        .bottom = -10.0f,
-        .near   =  1.0f,
-        .far    =  100.0f
-    };
-    daxa_i32 sun_offset_factor = 50; 
-    daxa_f32 curr_clip_texel_world_size = (curr_clip_projection.right - curr_clip_projection.left) / VSM_TEXTURE_RESOLUTION;
-    globals->vsm_sun_offset = context.sun_camera.offset;
-    globals->vsm_clip0_texel_world_size = curr_clip_texel_world_size;
     context.main_task_list.conditionals.at(MainConditionals::USE_DEBUG_CAMERA) = globals->use_debug_camera;
+    reserve_debug_draw_buffers();
 
-    for(daxa_i32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
     {
-        context.sun_camera.proj_info = curr_clip_projection;
-        context.sun_camera.update_front_vector(0.0f, 0.0f);
-        const daxa_f32vec3 to_sun_camera_offset = globals->sun_direction;
-        const daxa_f32 clip_page_world_size = curr_clip_texel_world_size * VSM_PAGE_SIZE;
-        const bool should_draw_debug_clip = 
-            (clip_level == globals->vsm_debug_clip_level) && globals->force_view_clip_level;
-
-        const auto align_page_info = context.sun_camera.align_clip_to_player(
-            &info.main_camera,
-            to_sun_camera_offset, 
-            std::span<FrustumVertex, VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION * 8>{
-                &context.frustum_vertices[8 * context.debug_frustum_cpu_count],
-                VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION * 8
-            },
-            should_draw_debug_clip,
-            sun_offset_factor
-        );
-
-        if(should_draw_debug_clip)
-        {
-            for(int i = 0; i < VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION; i++)
-            {
-                context.frustum_colors[context.debug_frustum_cpu_count + i].color = daxa_f32vec3{0.0, 0.0, 1.0};
-            }
-            if(globals->use_debug_camera)
-            {
-                context.debug_frustum_cpu_count += VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION;
-            }
-        }
-
-        const auto clear_offset = daxa_i32vec2(
-            align_page_info.page_offset.x - context.vsm_last_frame_offset.at(clip_level).x,
-            align_page_info.page_offset.y - context.vsm_last_frame_offset.at(clip_level).y
-        );
-        context.vsm_last_frame_offset.at(clip_level) = align_page_info.page_offset;
-        context.vsm_free_wrapped_pages_info.at(clip_level).clear_offset = clear_offset;
-
-        context.vsm_sun_projections.at(clip_level) = VSMClipProjection{
-            .camera_height_offset = align_page_info.sun_height_offset,
-            .depth_page_offset = align_page_info.per_page_depth_offset,
-            .page_offset = daxa_i32vec2{
-                align_page_info.page_offset.x % VSM_PAGE_TABLE_RESOLUTION,
-                align_page_info.page_offset.y % VSM_PAGE_TABLE_RESOLUTION
-            },
-            .offset = context.sun_camera.offset,
-            .view = context.sun_camera.get_view_matrix(),
-            .projection = context.sun_camera.get_projection_matrix(),
-            .projection_view = context.sun_camera.get_projection_view_matrix(),
-            .inv_projection_view = context.sun_camera.get_inv_view_proj_matrix()
-        };
-
-        if(clip_level == globals->vsm_debug_clip_level && globals->use_debug_camera)
-        {
-            context.sun_camera.write_frustum_vertices({
-                std::span<FrustumVertex, 8>{&context.frustum_vertices[8 * context.debug_frustum_cpu_count], 8 }
-            });
-            context.frustum_colors[context.debug_frustum_cpu_count].color = daxa_f32vec3{1.0, 1.0, 0.2};
-            context.debug_frustum_cpu_count += 1;
-        }
-
-        curr_clip_projection.left *= 2;
-        curr_clip_projection.right *= 2;
-        curr_clip_projection.top *= 2;
-        curr_clip_projection.bottom *= 2;
-        curr_clip_projection.near *= 2;
-        curr_clip_projection.far *= 2;
-        sun_offset_factor *= 2;
-        curr_clip_texel_world_size *= 2;
+        PROFILE_SCOPE("acquire swapchain image");
+        context.images.swapchain.set_images({std::array{context.swapchain.acquire_next_image()}});
     }
 
-    auto [front, top, right] = info.main_camera.get_frustum_info();
-    globals->camera_front = front;
-    globals->camera_frust_top_offset = top;
-    globals->camera_frust_right_offset = right;
-
-    context.images.swapchain.set_images({std::array{context.swapchain.acquire_next_image()}});
-
     if(!context.device.is_id_valid(context.images.swapchain.get_state().images[0]))
     {
         DEBUG_OUT("[Renderer::draw()] Got empty image from swapchain");
         return;
     }
 
-    context.main_task_list.task_list.execute({{
-        context.main_task_list.conditionals.data(),
-        context.main_task_list.conditionals.size()
-    }});
+    // Only once the frame is certain to execute, the swapped in images stay undefined until the upload task runs.
+    // The copy is recorded into this frame so nothing waits for the device
+    const bool loaded_baked_atmosphere_luts = context.frame.atmosphere_luts_dirty && load_baked_atmosphere_luts();
+    if(loaded_baked_atmosphere_luts)
+    {
+        context.frame.atmosphere_luts_dirty = false;
+        context.frame.atmosphere_lut_loads += 1;
+    }
+    context.main_task_list.conditionals.at(MainConditionals::UPLOAD_BAKED_ATMOSPHERE_LUTS) = loaded_baked_atmosphere_luts;
+    context.main_task_list.conditionals.at(MainConditionals::UPDATE_ATMOSPHERE_LUTS) = context.frame.atmosphere_luts_dirty;
+    context.main_task_list.conditionals.at(MainConditionals::UPDATE_SKYVIEW_LUT) =
+        context.frame.skyview_cache.get_plan().source != SkyviewSource::REUSE;
 
-    auto * histogram_host_pointer = context.device.get_host_address_as<Histogram>(context.buffers.histogram_readback.get_state().buffers[0]).value();
-    const bool was_last_frame_even = ((globals->frame_index - 1) % 2) == 0;
-    const daxa_u32 offset = was_last_frame_even ? 0 : HISTOGRAM_BIN_COUNT;
-    memcpy(context.cpu_histogram.data(), histogram_host_pointer + offset, sizeof(Histogram) * HISTOGRAM_BIN_COUNT);
+    {
+        PROFILE_SCOPE("task graph execute");
+        context.main_task_list.task_list.execute({{
+            context.main_task_list.conditionals.data(),
+            context.main_task_list.conditionals.size()
+        }});
+    }
+
+    {
+        PROFILE_SCOPE("histogram readback");
+        auto * histogram_host_pointer = context.device.get_host_address_as<Histogram>(context.buffers.histogram_readback.get_state().buffers[0]).value();
+        read_back_histogram(context.frame, histogram_host_pointer, globals->frame_index);
+    }
+
+    {
+        PROFILE_SCOPE("vsm statistics readback");
+        auto vsm_draw_ms = std::optional<daxa_f64>{};
+        if(globals->frame_index > 0)
+        {
+            // Pairs of timestamp and availability written by the page draw pass of the previous frame
+            const daxa_u32 query_offset = ((globals->frame_index - 1) % Context::frames_in_flight) * 2;
+            const auto timestamps = context.vsm_draw_timestamps.get_query_results(query_offset, 2);
+            if(timestamps.at(1) != 0 && timestamps.at(3) != 0)
+            {
+                const daxa_f64 elapsed_ticks = static_cast<daxa_f64>(timestamps.at(2) - timestamps.at(0));
+                vsm_draw_ms = elapsed_ticks * context.device.properties().limits.timestamp_period / 1'000'000.0;
+            }
+        }
+        auto * vsm_statistics_host_pointer = context.device.get_host_address_as<VSMStatistics>(context.buffers.vsm_statistics_readback.get_state().buffers[0]).value();
+        read_back_vsm_statistics(context.frame, vsm_statistics_host_pointer, globals->frame_index, vsm_draw_ms);
+
+        // The counters describe the GPU work of the previous frame, they land in the trace one frame late
+        auto const & vsm_statistics = context.frame.vsm_statistics;
+        PROFILE_COUNTER("vsm requested pages", vsm_statistics.requested_pages);
+        PROFILE_COUNTER("vsm allocated pages", vsm_statistics.allocated_pages);
+        PROFILE_COUNTER("vsm evicted pages", vsm_statistics.evicted_pages);
+        PROFILE_COUNTER("vsm failed allocations", vsm_statistics.failed_allocations);
+        PROFILE_COUNTER("vsm redrawn pages", vsm_statistics.redrawn_pages);
+        PROFILE_COUNTER("vsm drawn terrain patches", vsm_statistics.drawn_patches);
+        PROFILE_COUNTER("vsm invalidated pages", vsm_statistics.invalidated_pages);
+        PROFILE_COUNTER("vsm resident pages", get_vsm_resident_page_count(vsm_statistics));
+        PROFILE_COUNTER("vsm draw ms", context.frame.vsm_draw_ms);
+    }
 
     globals->frame_index++;
 
-    auto result = context.pipeline_manager.reload_all();
-    if(daxa::holds_alternative<daxa::PipelineReloadSuccess>(result)) 
+#if defined(TENEBRIS_SHADER_HOT_RELOAD)
     {
-        DEBUG_OUT("[Renderer::draw()] Shaders recompiled successfully");
-    } else if (daxa::holds_alternative<daxa::PipelineReloadError>(result)) 
+        PROFILE_SCOPE("pipeline reload");
+        // Pipelines recompiled by the reloader worker are swapped in at the frame boundary
+        if(const auto reloaded_count = shader_reloader->apply_reloaded_pipelines(); reloaded_count > 0)
+        {
+            DEBUG_OUT("[Renderer::draw()] Swapped in " << reloaded_count << " recompiled pipelines");
+        }
+    }
+#endif
     {
-        DEBUG_OUT(daxa::get<daxa::PipelineReloadError>(result).message);
+        PROFILE_SCOPE("collect garbage");
+        context.device.collect_garbage();
     }
-    context.device.collect_garbage();
 }
 
 Renderer::~Renderer()
@@ -1471,23 +1967,43 @@ Renderer::~Renderer()
         }
     };
 
+#if defined(TENEBRIS_SHADER_HOT_RELOAD)
+    // Joins the reloader threads, a pipeline still being compiled finishes first
+    shader_reloader.reset();
+#endif
     context.device.wait_idle();
     ImGui_ImplGlfw_Shutdown();
     destroy_buffer_if_valid(context.buffers.terrain_indices);
     destroy_buffer_if_valid(context.buffers.frustum_indices);
+    destroy_buffer_if_valid(context.buffers.debug_frustum_vertices);
+    destroy_buffer_if_valid(context.buffers.debug_frustum_colors);
+    destroy_buffer_if_valid(context.buffers.debug_line_vertices);
     destroy_buffer_if_valid(context.buffers.terrain_vertices);
+    destroy_buffer_if_valid(context.buffers.terrain_patch_bounds);
+    destroy_buffer_if_valid(context.buffers.vsm_culled_terrain_indices);
     destroy_buffer_if_valid(context.buffers.globals);
     destroy_buffer_if_valid(context.buffers.average_luminance);
     destroy_buffer_if_valid(context.buffers.histogram_readback);
+    destroy_buffer_if_valid(context.buffers.vsm_statistics_readback);
+    destroy_buffer_if_valid(context.buffers.vsm_sun_projections);
+    destroy_buffer_if_valid(context.buffers.vsm_free_wrapped_pages_info);
+    destroy_buffer_if_valid(context.buffers.transmittance_lut_staging);
+    destroy_buffer_if_valid(context.buffers.multiscattering_lut_staging);
     destroy_image_if_valid(context.images.diffuse_map);
     destroy_image_if_valid(context.images.height_map);
     destroy_image_if_valid(context.images.normal_map);
     destroy_image_if_valid(context.images.tonemapping_lut);
+    destroy_image_if_valid(context.images.medium_lut);
+    destroy_image_if_valid(context.images.transmittance_lut);
+    destroy_image_if_valid(context.images.multiscattering_lut);
+    destroy_image_if_valid(context.images.skyview_lut);
+    destroy_image_if_valid(context.images.skyview_cache);
     destroy_image_if_valid(context.images.vsm_debug_page_table);
     destroy_image_if_valid(context.images.vsm_page_table);
     destroy_image_if_valid(context.images.vsm_page_height_offset);
     destroy_image_if_valid(context.images.vsm_memory);
     destroy_image_if_valid(context.images.vsm_meta_memory_table);
+    destroy_image_if_valid(context.images.vsm_meta_memory_last_used);
     destroy_image_if_valid(context.images.vsm_debug_meta_memory_table);
     context.device.destroy_sampler(context.linear_sampler);
     context.device.destroy_sampler(context.nearest_sampler);
@@ -11,6 +11,9 @@
 #include "../camera.hpp"
 #include "shared/shared.inl"
 #include "context.hpp"
+#include "pipeline_batch.hpp"
+#include "shader_cache.hpp"
+#include "shader_hot_reloader.hpp"
 #include "texture_manager/texture_manager.hpp"
 
 #include "../terrain_gen/planet_generator.hpp"
@@ -29,10 +32,14 @@
 #include "tasks/imgui_task.inl"
 #include "tasks/shadowmap.inl"
 #include "tasks/ESM_pass.inl"
+#include "tasks/terrain_patch_bounds.inl"
 #include "tasks/vsm_free_wrapped_pages.inl"
+#include "tasks/vsm_prioritize_requests.inl"
 #include "tasks/vsm_find_free_pages.inl"
 #include "tasks/vsm_allocate_pages.inl"
 #include "tasks/vsm_clear_pages.inl"
+#include "tasks/vsm_build_dirty_pyramid.inl"
+#include "tasks/vsm_cull_terrain_patches.inl"
 #include "tasks/vsm_draw_pages.inl"
 #include "tasks/vsm_clear_dirty_bit.inl"
 #include "tasks/vsm_debug_pass.inl"
@@ -59,12 +66,33 @@ struct Renderer
     void resize();
     void draw(DrawInfo const & info);
     void upload_planet_geometry(PlanetGeometry const & geometry);
+    // Reselects the quality tiers against the current residency budget and applies
+    // the ones that can change at runtime (the normal map format)
+    void update_quality_tiers();
 
     private:
         Context context;
         std::unique_ptr<TextureManager> manager;
+        ShaderCache shader_cache;
+#if defined(TENEBRIS_SHADER_HOT_RELOAD)
+        std::unique_ptr<ShaderHotReloader> shader_reloader;
+#endif
 
         void initialize_main_tasklist();
         void create_persistent_resources();
+        // Recreates the atmosphere LUTs and the skyview cache when their dimensions in Globals changed
+        void update_atmosphere_lut_images();
+        // Reads the offline baked transmittance and multiscattering LUTs matching the current atmosphere LUT hash into
+        // staging buffers and swaps in images for them, returns false when there are none and the LUTs have to be baked on the GPU
+        auto load_baked_atmosphere_luts() -> bool;
         void load_textures();
+        void generate_normal_map();
+        // Grows the debug draw buffers to fit the geometry recorded for this frame
+        void reserve_debug_draw_buffers();
+
+        auto create_tracked_image(daxa::ImageInfo const & info, ResidencyCategory category) -> daxa::ImageId;
+        auto create_tracked_buffer(daxa::BufferInfo const & info, ResidencyCategory category) -> daxa::BufferId;
+        void track_image(daxa::ImageId image, ResidencyCategory category);
+        void release_image(daxa::ImageId image);
+        void release_buffer(daxa::BufferId buffer);
 };
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "residency_manager.hpp"
+
+#include <stdexcept>
+
+#include "../utils.hpp"
+
+// Depth + albedo + normals + offscreen
+static constexpr daxa_u64 FRAMEBUFFER_BYTES_PER_PIXEL = 4 + 8 + 8 + 8;
+
+static auto vsm_physical_bytes(daxa_u64 memory_resolution) -> daxa_u64
+{
+    const daxa_u64 meta_resolution = memory_resolution / VSM_PAGE_SIZE;
+    const daxa_u64 debug_meta_resolution = meta_resolution * VSM_DEBUG_META_MEMORY_SCALE;
+    // R32_SFLOAT memory, R32_UINT meta memory and last used frames and R8G8B8A8_UNORM debug meta memory
+    return memory_resolution * memory_resolution * 4 +
+           meta_resolution * meta_resolution * 4 * 2 +
+           debug_meta_resolution * debug_meta_resolution * 4;
+}
+
+static auto normal_map_bytes(daxa_u32vec2 extent, NormalMapFormat format) -> daxa_u64
+{
+    const daxa_u64 bytes_per_texel = format == NormalMapFormat::RGBA32F ? 16 : 8;
+    return static_cast<daxa_u64>(extent.x) * static_cast<daxa_u64>(extent.y) * bytes_per_texel;
+}
+
+void ResidencyManager::track(daxa_u64 key, std::string_view name, ResidencyCategory category, daxa_u64 size)
+{
+    if(allocations.contains(key))
+    {
+        throw std::runtime_error("[ResidencyManager::track()] Allocation " + std::string(name) + " is already tracked");
+    }
+    allocations.emplace(key, ResidencyAllocation{
+        .name = std::string(name),
+        .category = category,
+        .size = size
+    });
+    category_usage.at(static_cast<daxa_u32>(category)) += size;
+}
+
+void ResidencyManager::release(daxa_u64 key)
+{
+    auto allocation = allocations.find(key);
+    if(allocation == allocations.end())
+    {
+        DEBUG_OUT("[ResidencyManager::release()] Releasing untracked allocation " << key);
+        return;
+    }
+    category_usage.at(static_cast<daxa_u32>(allocation->second.category)) -= allocation->second.size;
+    allocations.erase(allocation);
+}
+
+void ResidencyManager::set_budget(daxa_u64 new_budget)
+{
+    budget = new_budget;
+}
+
+auto ResidencyManager::get_budget() const -> daxa_u64
+{
+    return budget;
+}
+
+auto ResidencyManager::get_total_usage() const -> daxa_u64
+{
+    daxa_u64 total = 0;
+    for(auto const usage : category_usage) { total += usage; }
+    return total;
+}
+
+auto ResidencyManager::get_category_usage(ResidencyCategory category) const -> daxa_u64
+{
+    return category_usage.at(static_cast<daxa_u32>(category));
+}
+
+auto ResidencyManager::get_allocations() const -> std::unordered_map<daxa_u64, ResidencyAllocation> const &
+{
+    return allocations;
+}
+
+auto ResidencyManager::estimate_usage(QualityTiers const & tiers, TierSelectionInfo const & info) const -> daxa_u64
+{
+    // Tier dependent categories are replaced by their predicted sizes
+    const daxa_u64 fixed_usage =
+        get_total_usage() -
+        get_category_usage(ResidencyCategory::VSM_PHYSICAL) -
+        get_category_usage(ResidencyCategory::NORMAL_MAP);
+
+    return fixed_usage +
+        vsm_physical_bytes(tiers.vsm_memory_resolution) +
+        normal_map_bytes(info.normal_map_extent, tiers.normal_format) +
+        static_cast<daxa_u64>(info.framebuffer_extent.x) * info.framebuffer_extent.y * FRAMEBUFFER_BYTES_PER_PIXEL;
+}
+
+auto ResidencyManager::select_quality_tiers(TierSelectionInfo const & info) const -> QualityTiers
+{
+    for(auto tiers : quality_tier_ladder)
+    {
+        if(info.locked_vsm_memory_resolution != 0) { tiers.vsm_memory_resolution = info.locked_vsm_memory_resolution; }
+        if(estimate_usage(tiers, info) <= budget) { return tiers; }
+    }
+    auto lowest = quality_tier_ladder.back();
+    if(info.locked_vsm_memory_resolution != 0) { lowest.vsm_memory_resolution = info.locked_vsm_memory_resolution; }
+    DEBUG_OUT("[ResidencyManager::select_quality_tiers()] Even the lowest tier does not fit into the budget of " << budget << " bytes");
+    return lowest;
+}
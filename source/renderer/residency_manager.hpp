@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+#include "shared/shared.inl"
+
+enum struct ResidencyCategory : daxa_u32
+{
+    // Sizes of these two depend on the selected quality tier
+    VSM_PHYSICAL,
+    NORMAL_MAP,
+
+    VSM_PAGE_TABLES,
+    TEXTURES,
+    BUFFERS,
+    COUNT
+};
+
+static constexpr std::array<std::string_view, static_cast<daxa_u32>(ResidencyCategory::COUNT)> residency_category_names = {
+    "vsm physical memory",
+    "normal map",
+    "vsm page tables",
+    "textures",
+    "buffers"
+};
+
+enum struct NormalMapFormat : daxa_u32
+{
+    RGBA32F,
+    RGBA16F
+};
+
+struct QualityTiers
+{
+    std::string_view name;
+    daxa_u32 vsm_memory_resolution;
+    NormalMapFormat normal_format;
+};
+
+// Ordered from the highest to the lowest quality, the first tier fitting into the budget is selected
+static constexpr std::array<QualityTiers, 4> quality_tier_ladder = {
+    QualityTiers{ .name = "high",    .vsm_memory_resolution = VSM_MEMORY_RESOLUTION,     .normal_format = NormalMapFormat::RGBA32F },
+    QualityTiers{ .name = "medium",  .vsm_memory_resolution = VSM_MEMORY_RESOLUTION,     .normal_format = NormalMapFormat::RGBA16F },
+    QualityTiers{ .name = "low",     .vsm_memory_resolution = VSM_MEMORY_RESOLUTION / 2, .normal_format = NormalMapFormat::RGBA16F },
+    QualityTiers{ .name = "minimum", .vsm_memory_resolution = VSM_MEMORY_RESOLUTION / 4, .normal_format = NormalMapFormat::RGBA16F },
+};
+
+inline auto vsm_meta_memory_resolution(QualityTiers const & tiers) -> daxa_u32
+{
+    return tiers.vsm_memory_resolution / VSM_PAGE_SIZE;
+}
+
+inline auto vsm_debug_meta_memory_resolution(QualityTiers const & tiers) -> daxa_u32
+{
+    return vsm_meta_memory_resolution(tiers) * VSM_DEBUG_META_MEMORY_SCALE;
+}
+
+struct TierSelectionInfo
+{
+    daxa_u32vec2 framebuffer_extent;
+    // Zero when the height map was not loaded yet
+    daxa_u32vec2 normal_map_extent = {0, 0};
+    // VSM memory resolution is baked into the compiled shaders, once chosen it can only be kept,
+    // zero means that any of the tiers can be selected
+    daxa_u32 locked_vsm_memory_resolution = 0;
+};
+
+struct ResidencyAllocation
+{
+    std::string name;
+    ResidencyCategory category;
+    daxa_u64 size;
+};
+
+// Pure bookkeeping, the sizes are supplied by the caller (from get_memory_requirements)
+// so that it does not need a device to work
+struct ResidencyManager
+{
+    static constexpr daxa_u64 default_budget = 2ull * 1024ull * 1024ull * 1024ull;
+
+    void track(daxa_u64 key, std::string_view name, ResidencyCategory category, daxa_u64 size);
+    void release(daxa_u64 key);
+
+    void set_budget(daxa_u64 new_budget);
+    [[nodiscard]] auto get_budget() const -> daxa_u64;
+    [[nodiscard]] auto get_total_usage() const -> daxa_u64;
+    [[nodiscard]] auto get_category_usage(ResidencyCategory category) const -> daxa_u64;
+    [[nodiscard]] auto get_allocations() const -> std::unordered_map<daxa_u64, ResidencyAllocation> const &;
+
+    // Predicted usage of the whole renderer if the tiers were applied, framebuffer sized transient images
+    // are not created through Context and are thus only estimated
+    [[nodiscard]] auto estimate_usage(QualityTiers const & tiers, TierSelectionInfo const & info) const -> daxa_u64;
+    [[nodiscard]] auto select_quality_tiers(TierSelectionInfo const & info) const -> QualityTiers;
+
+    private:
+        daxa_u64 budget = default_budget;
+        std::unordered_map<daxa_u64, ResidencyAllocation> allocations;
+        std::array<daxa_u64, static_cast<daxa_u32>(ResidencyCategory::COUNT)> category_usage = {};
+};
@@ -0,0 +1,175 @@
+#include "shader_cache.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+#include "../utils.hpp"
+#include "shader_dependencies.hpp"
+
+namespace fs = std::filesystem;
+
+static constexpr daxa_u64 FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+
+// FNV-1a, unlike std::hash the keys stay the same between runs and standard libraries
+static auto hash_bytes(std::string_view bytes, daxa_u64 hash = FNV_OFFSET_BASIS) -> daxa_u64
+{
+    for(auto const byte : bytes)
+    {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+ShaderCache::ShaderCache(ShaderCacheInfo const & info) : info{info}
+{
+    auto version_folder = info.compiler_version;
+    std::replace_if(version_folder.begin(), version_folder.end(),
+        [](char character) { return !std::isalnum(static_cast<unsigned char>(character)) && character != '.'; }, '_');
+    folder = info.root / version_folder;
+    index_path = folder / "stages.index";
+
+    std::error_code error;
+    fs::create_directories(folder, error);
+    if(error)
+    {
+        DEBUG_OUT("[ShaderCache::ShaderCache()] Unable to create cache folder " << folder << " " << error.message());
+    }
+    remove_stale_versions();
+    read_index();
+    trim();
+}
+
+auto ShaderCache::get_folder() const -> fs::path const &
+{
+    return folder;
+}
+
+auto ShaderCache::get_statistics() const -> ShaderCacheStatistics const &
+{
+    return statistics;
+}
+
+static auto hash_value(daxa_u64 value, daxa_u64 hash) -> daxa_u64
+{
+    return hash_bytes(std::string_view(reinterpret_cast<char const *>(&value), sizeof(value)), hash);
+}
+
+auto ShaderCache::lookup(std::span<ShaderCacheStage const> stages, std::span<fs::path const> root_paths) -> std::vector<StageHash>
+{
+    // Most stages share their includes, every file is only read once
+    std::unordered_map<std::string, daxa_u64> file_hashes;
+    auto hash_file = [&](std::string const & path) -> daxa_u64
+    {
+        auto [file_hash, inserted] = file_hashes.try_emplace(path, FNV_OFFSET_BASIS);
+        if(inserted)
+        {
+            auto file = std::ifstream(path, std::ios::binary);
+            auto const contents = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            file_hash->second = hash_bytes(contents, hash_bytes(path));
+        }
+        return file_hash->second;
+    };
+
+    std::vector<StageHash> stage_hashes;
+    stage_hashes.reserve(stages.size());
+    for(auto const & stage : stages)
+    {
+        std::vector<std::string> dependencies;
+        if(!stage.source_path.empty())
+        {
+            auto const scanned = scan_shader_dependencies(std::span(&stage.source_path, 1), root_paths);
+            dependencies.assign(scanned.begin(), scanned.end());
+            // The set iteration order is unspecified
+            std::sort(dependencies.begin(), dependencies.end());
+        }
+
+        const daxa_u64 stage_hash = hash_bytes(stage.key);
+        daxa_u64 sources_hash = stage_hash;
+        for(auto const & dependency : dependencies) { sources_hash = hash_value(hash_file(dependency), sources_hash); }
+        stage_hashes.push_back({ .stage = stage_hash, .sources = sources_hash });
+
+        if(auto const cached = index.find(stage_hash); cached != index.end() && cached->second == sources_hash)
+        {
+            statistics.stage_hits += 1;
+        } else {
+            statistics.stage_misses += 1;
+        }
+    }
+    return stage_hashes;
+}
+
+void ShaderCache::read_index()
+{
+    auto file = std::ifstream(index_path);
+    daxa_u64 stage_hash = 0;
+    daxa_u64 sources_hash = 0;
+    while(file >> std::hex >> stage_hash >> sources_hash) { index.insert_or_assign(stage_hash, sources_hash); }
+}
+
+void ShaderCache::write_index() const
+{
+    auto file = std::ofstream(index_path, std::ios::trunc);
+    if(!file.is_open())
+    {
+        DEBUG_OUT("[ShaderCache::write_index()] Unable to write " << index_path);
+        return;
+    }
+    for(auto const & [stage_hash, sources_hash] : index) { file << std::hex << stage_hash << " " << sources_hash << "\n"; }
+}
+
+void ShaderCache::remove_stale_versions()
+{
+    std::error_code error;
+    for(auto const & entry : fs::directory_iterator(info.root, error))
+    {
+        if(!entry.is_directory(error) || entry.path() == folder) { continue; }
+        DEBUG_OUT("[ShaderCache::remove_stale_versions()] Removing binaries of compiler version " << entry.path().filename());
+        fs::remove_all(entry.path(), error);
+    }
+}
+
+void ShaderCache::trim()
+{
+    struct CachedFile
+    {
+        fs::path path;
+        fs::file_time_type write_time;
+        daxa_u64 size;
+    };
+
+    std::error_code error;
+    std::vector<CachedFile> files;
+    daxa_u64 total_size = 0;
+    for(auto const & entry : fs::directory_iterator(folder, error))
+    {
+        if(!entry.is_regular_file(error) || entry.path() == index_path) { continue; }
+        files.push_back({ .path = entry.path(), .write_time = entry.last_write_time(error), .size = entry.file_size(error) });
+        total_size += files.back().size;
+    }
+
+    std::sort(files.begin(), files.end(), [](CachedFile const & first, CachedFile const & second)
+        { return first.write_time < second.write_time; });
+    const daxa_u32 evicted_before = statistics.evicted_files;
+    for(auto const & file : files)
+    {
+        if(total_size <= info.max_size_bytes) { break; }
+        if(fs::remove(file.path, error))
+        {
+            total_size -= file.size;
+            statistics.evicted_files += 1;
+        }
+    }
+    statistics.size_bytes = total_size;
+
+    // The binaries are named by the pipeline manager, it is not known which stages lost theirs
+    if(statistics.evicted_files != evicted_before)
+    {
+        index.clear();
+        write_index();
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+struct ShaderCacheStatistics
+{
+    // Counted per shader stage, a raster pipeline compiles up to four of them
+    daxa_u32 stage_hits;
+    daxa_u32 stage_misses;
+    daxa_u32 evicted_files;
+    daxa_u64 size_bytes;
+    // Time spent creating the pipelines wrapped by ShaderCache::track_compile()
+    daxa_f64 compile_ms;
+};
+
+struct ShaderCacheInfo
+{
+    std::filesystem::path root = ".shader_cache";
+    // Binaries produced by a different shader compiler are never reused, each version gets its own folder
+    std::string compiler_version = "unknown";
+    daxa_u64 max_size_bytes = 64ull * 1024ull * 1024ull;
+};
+
+// One shader stage compiled through the cache
+struct ShaderCacheStage
+{
+    // Names the stage, its source and its defines
+    std::string key;
+    // Shader file the stage is compiled from, empty for stages compiled from inline code
+    // whose key already contains the whole source
+    std::filesystem::path source_path;
+    // Index of the pipeline the stage belongs to, see ShaderCache::track_compile()
+    daxa_u32 pipeline_index;
+};
+
+// On-disk SPIR-V cache used by the pipeline manager. The pipeline manager keys the binaries by the hash
+// of the preprocessed source, which already reflects the defines, this adds the compiler version, the
+// size limit and the hit statistics on top
+struct ShaderCache
+{
+    explicit ShaderCache(ShaderCacheInfo const & info);
+
+    // Folder to be passed to the pipeline manager as the SPIR-V cache folder
+    [[nodiscard]] auto get_folder() const -> std::filesystem::path const &;
+
+    // Wraps the creation of pipelines, stages describe every shader stage compiled by it (see
+    // PipelineBatch::get_cache_stages()) and root_paths are the shader include folders. After compile
+    // returned pipeline_compiled(pipeline_index) tells whether a pipeline was created, only the stages of
+    // created pipelines are recorded so a stage that failed to compile misses again on the next start
+    auto track_compile(
+        std::span<ShaderCacheStage const> stages,
+        std::span<std::filesystem::path const> root_paths,
+        auto && compile,
+        auto && pipeline_compiled)
+    {
+        auto const stage_hashes = lookup(stages, root_paths);
+        const auto start = std::chrono::steady_clock::now();
+        auto result = compile();
+        statistics.compile_ms += std::chrono::duration<daxa_f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+        for(size_t stage_index = 0; stage_index < stages.size(); stage_index++)
+        {
+            if(!pipeline_compiled(stages[stage_index].pipeline_index)) { continue; }
+            auto const & stage_hash = stage_hashes.at(stage_index);
+            index.insert_or_assign(stage_hash.stage, stage_hash.sources);
+        }
+        write_index();
+        return result;
+    }
+
+    // Evicts the oldest binaries until the folder fits into the maximum size
+    void trim();
+    [[nodiscard]] auto get_statistics() const -> ShaderCacheStatistics const &;
+
+    private:
+        struct StageHash
+        {
+            // Hash of the stage key
+            daxa_u64 stage;
+            // Hash of the stage key and the contents of every file the stage includes
+            daxa_u64 sources;
+        };
+
+        // A stage hits when it was compiled with the same sources before, the pipeline manager then
+        // finds its binary. Editing a shader file only misses the stages including it
+        auto lookup(std::span<ShaderCacheStage const> stages, std::span<std::filesystem::path const> root_paths) -> std::vector<StageHash>;
+        void read_index();
+        void write_index() const;
+        void remove_stale_versions();
+
+        ShaderCacheInfo info;
+        std::filesystem::path folder;
+        std::filesystem::path index_path;
+        // Sources hash every stage was last compiled with, keyed by the stage hash. Holds one entry per
+        // stage key so it only grows with new stages or defines, cleared when trim() evicts any binary
+        std::unordered_map<daxa_u64, daxa_u64> index;
+        ShaderCacheStatistics statistics = {};
+};
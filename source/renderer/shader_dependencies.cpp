@@ -0,0 +1,65 @@
+#include "shader_dependencies.hpp"
+
+#include <fstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+auto get_canonical_shader_path(fs::path const & path) -> std::string
+{
+    std::error_code error;
+    auto canonical = fs::weakly_canonical(path, error);
+    return error ? path.lexically_normal().string() : canonical.string();
+}
+
+auto resolve_shader_include(fs::path const & include, fs::path const & including_directory, std::span<fs::path const> root_paths) -> fs::path
+{
+    std::error_code error;
+    if(!including_directory.empty() && fs::is_regular_file(including_directory / include, error))
+    {
+        return including_directory / include;
+    }
+    for(auto const & root_path : root_paths)
+    {
+        if(fs::is_regular_file(root_path / include, error)) { return root_path / include; }
+    }
+    return {};
+}
+
+auto scan_shader_dependencies(std::span<fs::path const> sources, std::span<fs::path const> root_paths) -> std::unordered_set<std::string>
+{
+    std::vector<fs::path> pending;
+    for(auto const & source : sources)
+    {
+        if(auto path = resolve_shader_include(source, {}, root_paths); !path.empty()) { pending.push_back(path); }
+    }
+
+    std::unordered_set<std::string> dependencies;
+    while(!pending.empty())
+    {
+        const auto path = pending.back();
+        pending.pop_back();
+        if(!dependencies.insert(get_canonical_shader_path(path)).second) { continue; }
+
+        auto file = std::ifstream(path);
+        std::string line;
+        while(std::getline(file, line))
+        {
+            const auto directive_start = line.find_first_not_of(" \t");
+            if(directive_start == std::string::npos || line[directive_start] != '#') { continue; }
+            const auto keyword_start = line.find_first_not_of(" \t", directive_start + 1);
+            if(keyword_start == std::string::npos || line.compare(keyword_start, 7, "include") != 0) { continue; }
+            const auto name_start = line.find_first_of("\"<", keyword_start + 7);
+            if(name_start == std::string::npos) { continue; }
+            const auto name_end = line.find_first_of("\">", name_start + 1);
+            if(name_end == std::string::npos) { continue; }
+
+            const auto include = fs::path(line.substr(name_start + 1, name_end - name_start - 1));
+            if(auto resolved = resolve_shader_include(include, path.parent_path(), root_paths); !resolved.empty())
+            {
+                pending.push_back(resolved);
+            }
+        }
+    }
+    return dependencies;
+}
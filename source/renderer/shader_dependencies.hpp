@@ -0,0 +1,22 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <unordered_set>
+
+// Canonical form of a shader path, shared by everything comparing shader files by path
+auto get_canonical_shader_path(std::filesystem::path const & path) -> std::string;
+
+// Resolves an include against the directory of the including file first and the root paths after
+// that, the same order the shader compiler uses. Returns an empty path when it is not found
+auto resolve_shader_include(
+    std::filesystem::path const & include,
+    std::filesystem::path const & including_directory,
+    std::span<std::filesystem::path const> root_paths) -> std::filesystem::path;
+
+// Canonical paths of the shader sources and everything they include. Only a textual scan for include
+// directives, includes disabled by the preprocessor are still counted as dependencies
+auto scan_shader_dependencies(
+    std::span<std::filesystem::path const> sources,
+    std::span<std::filesystem::path const> root_paths) -> std::unordered_set<std::string>;
@@ -0,0 +1,270 @@
+#include "shader_hot_reloader.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "../utils.hpp"
+#include "shader_dependencies.hpp"
+
+namespace fs = std::filesystem;
+
+// Directories and files are skipped silently, not every root path exists in every working directory
+static void for_each_root_directory(std::vector<fs::path> const & root_paths, auto && callback)
+{
+    for(auto const & root_path : root_paths)
+    {
+        std::error_code error;
+        if(!fs::is_directory(root_path, error)) { continue; }
+        callback(root_path);
+        for(auto it = fs::recursive_directory_iterator(root_path, error); !error && it != fs::recursive_directory_iterator(); it.increment(error))
+        {
+            if(it->is_directory(error)) { callback(it->path()); }
+        }
+    }
+}
+
+ShaderHotReloader::ShaderHotReloader(ShaderHotReloaderInfo const & info) : info{info}
+{
+}
+
+ShaderHotReloader::~ShaderHotReloader()
+{
+    {
+        auto lock = std::lock_guard(changed_mutex);
+        running = false;
+    }
+    changed_condition.notify_all();
+    if(watcher_thread.joinable()) { watcher_thread.join(); }
+    if(worker_thread.joinable()) { worker_thread.join(); }
+}
+
+void ShaderHotReloader::register_pipeline(daxa::ComputePipelineCompileInfo const & compile_info, std::shared_ptr<daxa::ComputePipeline> & target)
+{
+    DBG_ASSERT_TRUE_M(!running, "[ShaderHotReloader::register_pipeline()] Pipelines have to be registered before start()");
+    entries.push_back({
+        .compile_info = compile_info,
+        .target = &target,
+        .current = target,
+        .dependencies = scan_dependencies(compile_info)
+    });
+}
+
+void ShaderHotReloader::register_pipeline(daxa::RasterPipelineCompileInfo const & compile_info, std::shared_ptr<daxa::RasterPipeline> & target)
+{
+    DBG_ASSERT_TRUE_M(!running, "[ShaderHotReloader::register_pipeline()] Pipelines have to be registered before start()");
+    entries.push_back({
+        .compile_info = compile_info,
+        .target = &target,
+        .current = target,
+        .dependencies = scan_dependencies(compile_info)
+    });
+}
+
+void ShaderHotReloader::start()
+{
+    if(running) { return; }
+    running = true;
+    watcher_thread = std::thread([this] { watch_files(); });
+    worker_thread = std::thread([this] { recompile_changed(); });
+}
+
+auto ShaderHotReloader::apply_reloaded_pipelines() -> daxa_u32
+{
+    auto lock = std::lock_guard(reloaded_mutex);
+    for(auto & reloaded : reloaded_pipelines)
+    {
+        auto & entry = entries.at(reloaded.entry_index);
+        std::visit([&](auto * target)
+        {
+            *target = std::get<std::remove_reference_t<decltype(*target)>>(reloaded.pipeline);
+        }, entry.target);
+    }
+    const auto reloaded_count = static_cast<daxa_u32>(reloaded_pipelines.size());
+    reloaded_pipelines.clear();
+    return reloaded_count;
+}
+
+void ShaderHotReloader::queue_changed_file(fs::path const & path)
+{
+    {
+        auto lock = std::lock_guard(changed_mutex);
+        changed_files.insert(get_canonical_shader_path(path));
+    }
+    changed_condition.notify_one();
+}
+
+#if defined(__linux__)
+void ShaderHotReloader::watch_files()
+{
+    const int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(inotify_fd < 0)
+    {
+        DEBUG_OUT("[ShaderHotReloader::watch_files()] Failed to initialize inotify, shader hot reload is disabled");
+        return;
+    }
+
+    std::unordered_map<int, fs::path> watched_directories;
+    for_each_root_directory(info.root_paths, [&](fs::path const & directory)
+    {
+        // Editors commonly save by writing a temporary file and renaming it over the original
+        const int watch = inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if(watch >= 0) { watched_directories.emplace(watch, directory); }
+    });
+
+    alignas(inotify_event) char buffer[4096];
+    auto poll_info = pollfd{ .fd = inotify_fd, .events = POLLIN, .revents = 0 };
+    while(running)
+    {
+        // The timeout bounds how long the destructor waits for this thread
+        if(poll(&poll_info, 1, 100) <= 0) { continue; }
+        for(auto read_size = read(inotify_fd, buffer, sizeof(buffer)); read_size > 0; read_size = read(inotify_fd, buffer, sizeof(buffer)))
+        {
+            for(char * event_ptr = buffer; event_ptr < buffer + read_size;)
+            {
+                auto const * event = reinterpret_cast<inotify_event const *>(event_ptr);
+                event_ptr += sizeof(inotify_event) + event->len;
+                if(event->len == 0 || (event->mask & IN_ISDIR)) { continue; }
+                if(auto directory = watched_directories.find(event->wd); directory != watched_directories.end())
+                {
+                    queue_changed_file(directory->second / event->name);
+                }
+            }
+        }
+    }
+    close(inotify_fd);
+}
+#else
+void ShaderHotReloader::watch_files()
+{
+    std::unordered_map<std::string, fs::file_time_type> write_times;
+    bool first_scan = true;
+    while(running)
+    {
+        for_each_root_directory(info.root_paths, [&](fs::path const & directory)
+        {
+            std::error_code error;
+            for(auto const & file : fs::directory_iterator(directory, error))
+            {
+                if(!file.is_regular_file(error)) { continue; }
+                const auto write_time = file.last_write_time(error);
+                if(error) { continue; }
+                auto [it, inserted] = write_times.try_emplace(file.path().string(), write_time);
+                if(!inserted && it->second != write_time)
+                {
+                    it->second = write_time;
+                    queue_changed_file(file.path());
+                } else if(inserted && !first_scan) {
+                    queue_changed_file(file.path());
+                }
+            }
+        });
+        first_scan = false;
+        auto lock = std::unique_lock(changed_mutex);
+        changed_condition.wait_for(lock, info.poll_interval, [this] { return !running; });
+    }
+}
+#endif
+
+void ShaderHotReloader::recompile_changed()
+{
+    while(true)
+    {
+        std::unordered_set<std::string> changed;
+        {
+            auto lock = std::unique_lock(changed_mutex);
+            changed_condition.wait(lock, [this] { return !running || !changed_files.empty(); });
+            if(!running) { return; }
+            // Let the rest of a multi step save arrive before compiling
+            changed_condition.wait_for(lock, info.debounce, [this] { return !running; });
+            if(!running) { return; }
+            changed.swap(changed_files);
+        }
+
+        daxa_u32 recompiled_count = 0;
+        for(daxa_u32 entry_index = 0; entry_index < entries.size(); entry_index++)
+        {
+            auto & entry = entries.at(entry_index);
+            const bool affected = std::any_of(changed.begin(), changed.end(),
+                [&](auto const & changed_file) { return entry.dependencies.contains(changed_file); });
+            if(!affected || !recompile(entry)) { continue; }
+
+            auto lock = std::lock_guard(reloaded_mutex);
+            reloaded_pipelines.push_back({ .entry_index = entry_index, .pipeline = entry.current });
+            recompiled_count += 1;
+        }
+        if(recompiled_count > 0)
+        {
+            DEBUG_OUT("[ShaderHotReloader::recompile_changed()] Recompiled " << recompiled_count << " pipelines");
+        }
+    }
+}
+
+auto ShaderHotReloader::recompile(PipelineEntry & entry) -> bool
+{
+    return std::visit([&](auto const & compile_info) -> bool
+    {
+        using CompileInfoT = std::remove_cvref_t<decltype(compile_info)>;
+        auto result = [&]
+        {
+            if constexpr (std::is_same_v<CompileInfoT, daxa::ComputePipelineCompileInfo>)
+            {
+                return info.pipeline_manager.add_compute_pipeline(compile_info);
+            } else {
+                return info.pipeline_manager.add_raster_pipeline(compile_info);
+            }
+        }();
+        if(!result.is_ok())
+        {
+            // The previous pipeline stays in use until the shader compiles again
+            DEBUG_OUT(result.to_string());
+            return false;
+        }
+
+        using PipelineT = typename std::remove_cvref_t<decltype(result.value())>::element_type;
+        // Pipelines created by the startup batch live in their own pipeline managers, there is nothing to remove
+        if(auto const & previous = std::get<std::shared_ptr<PipelineT>>(entry.current); previous)
+        {
+            if constexpr (std::is_same_v<PipelineT, daxa::ComputePipeline>)
+            {
+                info.pipeline_manager.remove_compute_pipeline(previous);
+            } else {
+                info.pipeline_manager.remove_raster_pipeline(previous);
+            }
+        }
+        entry.current = result.value();
+        // The edit could have added or removed includes
+        entry.dependencies = scan_dependencies(entry.compile_info);
+        return true;
+    }, entry.compile_info);
+}
+
+auto ShaderHotReloader::scan_dependencies(CompileInfo const & compile_info) const -> std::unordered_set<std::string>
+{
+    std::vector<fs::path> sources;
+    auto add_source = [&](daxa::ShaderCompileInfo const & shader_info)
+    {
+        if(auto const * file = std::get_if<daxa::ShaderFile>(&shader_info.source)) { sources.push_back(file->path); }
+    };
+    if(auto const * compute_info = std::get_if<daxa::ComputePipelineCompileInfo>(&compile_info))
+    {
+        add_source(compute_info->shader_info);
+    } else {
+        auto const & raster_info = std::get<daxa::RasterPipelineCompileInfo>(compile_info);
+        for(auto const & shader_info : {
+            raster_info.vertex_shader_info,
+            raster_info.tesselation_control_shader_info,
+            raster_info.tesselation_evaluation_shader_info,
+            raster_info.fragment_shader_info})
+        {
+            if(shader_info.has_value()) { add_source(shader_info.value()); }
+        }
+    }
+    // Includes disabled by the preprocessor at worst cause a needless recompile
+    return scan_shader_dependencies(sources, info.root_paths);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+#include <daxa/daxa.hpp>
+#include <daxa/utils/pipeline_manager.hpp>
+using namespace daxa::types;
+
+struct ShaderHotReloaderInfo
+{
+    daxa::PipelineManager pipeline_manager;
+    // The same root paths the pipeline manager resolves includes against, all of them are watched
+    std::vector<std::filesystem::path> root_paths;
+    // Editors often save a file in several steps, changes are collected for this long before recompiling
+    std::chrono::milliseconds debounce = std::chrono::milliseconds(100);
+    // Only used where inotify is not available and the root paths are polled instead
+    std::chrono::milliseconds poll_interval = std::chrono::milliseconds(250);
+};
+
+// Recompiles only the pipelines depending on a changed shader file. A watcher thread collects the
+// changed paths (inotify on Linux, modification time polling elsewhere), a worker thread recompiles
+// the affected pipelines and the render thread swaps the results in at the frame boundary
+struct ShaderHotReloader
+{
+    ShaderHotReloader(ShaderHotReloader const &) = delete;
+    ShaderHotReloader & operator= (ShaderHotReloader const &) = delete;
+
+    explicit ShaderHotReloader(ShaderHotReloaderInfo const & info);
+    ~ShaderHotReloader();
+
+    // All pipelines have to be registered before start(), the target is overwritten
+    // with the recompiled pipeline by apply_reloaded_pipelines()
+    void register_pipeline(daxa::ComputePipelineCompileInfo const & compile_info, std::shared_ptr<daxa::ComputePipeline> & target);
+    void register_pipeline(daxa::RasterPipelineCompileInfo const & compile_info, std::shared_ptr<daxa::RasterPipeline> & target);
+    void start();
+
+    // Called by the render thread once per frame, returns the number of pipelines swapped in
+    auto apply_reloaded_pipelines() -> daxa_u32;
+
+    private:
+        using CompileInfo = std::variant<daxa::ComputePipelineCompileInfo, daxa::RasterPipelineCompileInfo>;
+        using Pipeline = std::variant<std::shared_ptr<daxa::ComputePipeline>, std::shared_ptr<daxa::RasterPipeline>>;
+        using PipelineTarget = std::variant<std::shared_ptr<daxa::ComputePipeline> *, std::shared_ptr<daxa::RasterPipeline> *>;
+
+        struct PipelineEntry
+        {
+            CompileInfo compile_info;
+            PipelineTarget target;
+            // Only touched by the worker after start(), the pipeline registered in the pipeline manager,
+            // empty until the first reload when the pipeline was created elsewhere
+            Pipeline current;
+            // Canonical paths of the source files and everything they include, as strings so they can be hashed
+            std::unordered_set<std::string> dependencies;
+        };
+
+        struct ReloadedPipeline
+        {
+            daxa_u32 entry_index;
+            Pipeline pipeline;
+        };
+
+        void watch_files();
+        void recompile_changed();
+        void queue_changed_file(std::filesystem::path const & path);
+        auto recompile(PipelineEntry & entry) -> bool;
+        auto scan_dependencies(CompileInfo const & compile_info) const -> std::unordered_set<std::string>;
+
+        ShaderHotReloaderInfo info;
+        std::vector<PipelineEntry> entries;
+
+        std::atomic<bool> running = false;
+        std::mutex changed_mutex;
+        std::condition_variable changed_condition;
+        std::unordered_set<std::string> changed_files;
+
+        std::mutex reloaded_mutex;
+        std::vector<ReloadedPipeline> reloaded_pipelines;
+
+        std::thread watcher_thread;
+        std::thread worker_thread;
+};
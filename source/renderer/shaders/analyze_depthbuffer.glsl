@@ -51,8 +51,21 @@ void workgroup_min_max_depth(daxa_f32vec2 thread_min_max_depth)
     }
 }
 
+#define NO_PAGE_KEY 0xFFFFFFFFu
+
+// Wrapped page coordinates packed into one word so lanes can be compared and reduced on them
+daxa_u32 page_key(daxa_i32vec3 wrapped_coords)
+{
+    return daxa_u32(wrapped_coords.x) | (daxa_u32(wrapped_coords.y) << 12) | (daxa_u32(wrapped_coords.z) << 24);
+}
+
+daxa_i32vec3 page_key_to_wrapped_coords(daxa_u32 key)
+{
+    return daxa_i32vec3(key & 0xFFFu, (key >> 12) & 0xFFFu, key >> 24);
+}
+
 // For each fragment check if the page that will be needed during the shadowmap test is allocated
-// if not mark page as needing allocation
+// if not mark page as needing allocation. Must be called from uniform control flow
 void request_vsm_pages(daxa_f32vec4 depths, daxa_u32vec2 scaled_pixel_coords)
 {
     // texel gather component mapping - (00,w);(01,x);(11,y);(10,z) 
@@ -64,6 +77,8 @@ void request_vsm_pages(daxa_f32vec4 depths, daxa_u32vec2 scaled_pixel_coords)
         daxa_f32vec2(0.5, 0.5)
     );
 
+    // Unallocated pages the samples of this thread land in, their coverage is added once per page per subgroup below
+    daxa_u32 requested_page_keys[4] = daxa_u32[](NO_PAGE_KEY, NO_PAGE_KEY, NO_PAGE_KEY, NO_PAGE_KEY);
     for(daxa_i32 idx = 0; idx < 4; idx++)
     {
         // Skip fragments into which no objects were rendered
@@ -90,37 +105,12 @@ void request_vsm_pages(daxa_f32vec4 depths, daxa_u32vec2 scaled_pixel_coords)
         const daxa_u32 page_entry = imageLoad(daxa_uimage2DArray(_vsm_page_table), vsm_page_wrapped_coords).r;
 
         const bool is_not_allocated = !get_is_allocated(page_entry);
-        const bool allocation_available = atomicAdd(deref(_vsm_allocation_count).count, 0) < MAX_NUM_VSM_ALLOC_REQUEST;
 
-        if(is_not_allocated && allocation_available)
+        if(is_not_allocated)
         {
-            const daxa_u32 prev_state = imageAtomicOr(
-                daxa_access(r32uiImageArray, _vsm_page_table),
-                vsm_page_wrapped_coords,
-                requests_allocation_mask()
-            );
-
-            if(!get_requests_allocation(prev_state))
-            {
-                // If this is the thread to mark this page as REQUESTS_ALLOCATION
-                //    -> create a new allocation request in the allocation buffer
-                daxa_u32 idx = atomicAdd(deref(_vsm_allocation_count).count, 1);
-                if(idx < MAX_NUM_VSM_ALLOC_REQUEST)
-                {
-                    deref(_vsm_allocation_buffer[idx]) = AllocationRequest(vsm_page_wrapped_coords);
-                } 
-                else 
-                {
-                    atomicAdd(deref(_vsm_allocation_count).count, -1);
-                    imageAtomicAnd(
-                        daxa_access(r32uiImageArray, _vsm_page_table),
-                        vsm_page_wrapped_coords,
-                        ~requests_allocation_mask()
-                    );
-                }
-            } 
+            requested_page_keys[idx] = page_key(vsm_page_wrapped_coords);
         } 
-        else if (!get_is_visited_marked(page_entry) && !is_not_allocated)
+        else if (!get_is_visited_marked(page_entry))
         {
             const daxa_u32 prev_state = imageAtomicOr(
                 daxa_access(r32uiImageArray, _vsm_page_table),
@@ -139,6 +129,55 @@ void request_vsm_pages(daxa_f32vec4 depths, daxa_u32vec2 scaled_pixel_coords)
             }
         }
     }
+
+    // Every sample landing in the page counts towards its screen coverage, the allocation order depends on it.
+    // Neighbouring samples mostly share a page, each iteration takes the smallest pending page of the subgroup,
+    // sums the samples of all lanes landing in it and adds them with a single atomic
+    while(true)
+    {
+        const daxa_u32 key = subgroupMin(min(
+            min(requested_page_keys[0], requested_page_keys[1]),
+            min(requested_page_keys[2], requested_page_keys[3])
+        ));
+        if(key == NO_PAGE_KEY) { break; }
+
+        daxa_u32 lane_samples = 0;
+        for(daxa_i32 idx = 0; idx < 4; idx++)
+        {
+            if(requested_page_keys[idx] == key)
+            {
+                lane_samples += 1;
+                requested_page_keys[idx] = NO_PAGE_KEY;
+            }
+        }
+        const daxa_u32 page_samples = subgroupAdd(lane_samples);
+
+        if(subgroupElect())
+        {
+            const daxa_i32vec3 vsm_page_wrapped_coords = page_key_to_wrapped_coords(key);
+            const daxa_u32 prev_coverage = imageAtomicAdd(
+                daxa_access(r32uiImageArray, _vsm_page_request_coverage),
+                vsm_page_wrapped_coords,
+                page_samples
+            );
+
+            // If this is the first subgroup to cover the page -> add it to the page requests, requests past the
+            // capacity are only counted and the page is requested again by the next frame
+            if(prev_coverage == 0)
+            {
+                daxa_u32 idx = atomicAdd(deref(_vsm_page_request_count).count, 1);
+                if(idx < MAX_NUM_VSM_PAGE_REQUEST)
+                {
+                    deref(_vsm_page_requests[idx]) = AllocationRequest(vsm_page_wrapped_coords);
+                    imageAtomicOr(
+                        daxa_access(r32uiImageArray, _vsm_page_table),
+                        vsm_page_wrapped_coords,
+                        requests_allocation_mask()
+                    );
+                }
+            }
+        }
+    }
 }
 
 #if defined(FIRST_PASS)
@@ -195,28 +234,6 @@ void main()
 #else
 void main()
 {
-    // Prepare indirect dispatches for further vsm passes
-    if(all(equal(gl_GlobalInvocationID, daxa_u32vec3(0, 0, 0))))
-    {
-        const daxa_u32 allocations_number = deref(_vsm_allocation_count).count;
-
-        const daxa_u32 allocate_dispach_count = 
-            (allocations_number + VSM_ALLOCATE_PAGES_LOCAL_SIZE_X - 1) / VSM_ALLOCATE_PAGES_LOCAL_SIZE_X;
-        deref(_vsm_allocate_indirect).x = 1;
-        deref(_vsm_allocate_indirect).y = 1;
-        deref(_vsm_allocate_indirect).z = allocate_dispach_count;
-
-        deref(_vsm_clear_indirect).x = VSM_PAGE_SIZE / VSM_CLEAR_PAGES_LOCAL_SIZE_XY;
-        deref(_vsm_clear_indirect).y = VSM_PAGE_SIZE / VSM_CLEAR_PAGES_LOCAL_SIZE_XY;
-        deref(_vsm_clear_indirect).z = deref(_vsm_allocation_count).count;
-
-        const daxa_u32 clear_dirty_bit_distpach_count = 
-            (allocations_number + VSM_CLEAR_DIRTY_BIT_LOCAL_SIZE_X - 1) / VSM_CLEAR_DIRTY_BIT_LOCAL_SIZE_X;
-        deref(_vsm_clear_dirty_bit_indirect).x = 1;
-        deref(_vsm_clear_dirty_bit_indirect).y = 1;
-        deref(_vsm_clear_dirty_bit_indirect).z = clear_dirty_bit_distpach_count;
-
-    }
     daxa_u32 work_group_threads = _tile_size * _tile_size;
     daxa_u32 workgroup_offset = gl_WorkGroupID.x * work_group_threads;
     daxa_u32 _subgroup_offset = gl_SubgroupID * gl_SubgroupSize;
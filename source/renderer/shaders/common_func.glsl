@@ -204,10 +204,72 @@ daxa_b32 move_to_top_atmosphere(inout daxa_f32vec3 world_position, daxa_f32vec3
     return true;
 }
 
+#if ATMOSPHERE_ANALYTIC_MEDIUM == 0
+/// @param params - buffer reference to the atmosphere parameters buffer
+/// @param medium_lut - baked medium density LUT, x - mie density, y - rayleigh density, z - ozone density
+/// @param medium_sampler - linear clamp to edge sampler
+/// @param position - position in the world where the sample is to be taken
+/// @return mie, rayleigh and ozone densities at the desired point
+daxa_f32vec3 sample_medium_density(daxa_BufferPtr(Globals) params, daxa_ImageViewId medium_lut,
+    daxa_SamplerId medium_sampler, daxa_f32vec3 position)
+{
+    const daxa_f32 height = length(position) - deref(params).atmosphere_bottom;
+    const daxa_f32 atmosphere_height = deref(params).atmosphere_top - deref(params).atmosphere_bottom;
+    /* Texel centers are placed at the bottom and the top of the atmosphere */
+    const daxa_f32 unit_height = clamp(height / atmosphere_height, 0.0, 1.0);
+    const daxa_f32 u = (unit_height * (MEDIUM_LUT_RESOLUTION - 1) + 0.5) / MEDIUM_LUT_RESOLUTION;
+    return texture(daxa_sampler2D(medium_lut, medium_sampler), daxa_f32vec2(u, 0.5)).xyz;
+}
+
+/// @param params - buffer reference to the atmosphere parameters buffer
+/// @param medium_lut - baked medium density LUT
+/// @param medium_sampler - linear clamp to edge sampler
+/// @param position - position in the world where the sample is to be taken
+/// @return atmosphere extinction at the desired point
+daxa_f32vec3 sample_medium_extinction(daxa_BufferPtr(Globals) params, daxa_ImageViewId medium_lut,
+    daxa_SamplerId medium_sampler, daxa_f32vec3 position)
+{
+    const daxa_f32vec3 density = sample_medium_density(params, medium_lut, medium_sampler, position);
+    return deref(params).mie_extinction * density.x +
+           deref(params).rayleigh_scattering * density.y +
+           deref(params).absorption_extinction * density.z;
+}
+
+/// @param params - buffer reference to the atmosphere parameters buffer
+/// @param medium_lut - baked medium density LUT
+/// @param medium_sampler - linear clamp to edge sampler
+/// @param position - position in the world where the sample is to be taken
+/// @return atmosphere scattering at the desired point
+daxa_f32vec3 sample_medium_scattering(daxa_BufferPtr(Globals) params, daxa_ImageViewId medium_lut,
+    daxa_SamplerId medium_sampler, daxa_f32vec3 position)
+{
+    const daxa_f32vec3 density = sample_medium_density(params, medium_lut, medium_sampler, position);
+    /* Not considering ozon scattering in current version of this model */
+    return deref(params).mie_scattering * density.x + deref(params).rayleigh_scattering * density.y;
+}
+
+struct ScatteringSample
+{
+    daxa_f32vec3 mie;
+    daxa_f32vec3 ray;
+};
+/// @param params - buffer reference to the atmosphere parameters buffer
+/// @param medium_lut - baked medium density LUT
+/// @param medium_sampler - linear clamp to edge sampler
+/// @param position - position in the world where the sample is to be taken
+/// @return Scattering sample struct
+ScatteringSample sample_medium_scattering_detailed(daxa_BufferPtr(Globals) params, daxa_ImageViewId medium_lut,
+    daxa_SamplerId medium_sampler, daxa_f32vec3 position)
+{
+    const daxa_f32vec3 density = sample_medium_density(params, medium_lut, medium_sampler, position);
+    return ScatteringSample(deref(params).mie_scattering * density.x, deref(params).rayleigh_scattering * density.y);
+}
+#else // ATMOSPHERE_ANALYTIC_MEDIUM
 /// @param params - buffer reference to the atmosphere parameters buffer
 /// @param position - position in the world where the sample is to be taken
 /// @return atmosphere extinction at the desired point
-daxa_f32vec3 sample_medium_extinction(daxa_BufferPtr(Globals) params, daxa_f32vec3 position)
+daxa_f32vec3 sample_medium_extinction(daxa_BufferPtr(Globals) params, daxa_ImageViewId medium_lut,
+    daxa_SamplerId medium_sampler, daxa_f32vec3 position)
 {
     const daxa_f32 height = length(position) - deref(params).atmosphere_bottom;
 
@@ -228,7 +290,8 @@ daxa_f32vec3 sample_medium_extinction(daxa_BufferPtr(Globals) params, daxa_f32ve
 /// @param params - buffer reference to the atmosphere parameters buffer
 /// @param position - position in the world where the sample is to be taken
 /// @return atmosphere scattering at the desired point
-daxa_f32vec3 sample_medium_scattering(daxa_BufferPtr(Globals) params, daxa_f32vec3 position)
+daxa_f32vec3 sample_medium_scattering(daxa_BufferPtr(Globals) params, daxa_ImageViewId medium_lut,
+    daxa_SamplerId medium_sampler, daxa_f32vec3 position)
 {
     const daxa_f32 height = length(position) - deref(params).atmosphere_bottom;
 
@@ -252,7 +315,8 @@ struct ScatteringSample
 /// @param position - position in the world where the sample is to be taken
 /// @return Scattering sample struct
 // TODO(msakmary) Fix this!!
-ScatteringSample sample_medium_scattering_detailed(daxa_BufferPtr(Globals) params, daxa_f32vec3 position)
+ScatteringSample sample_medium_scattering_detailed(daxa_BufferPtr(Globals) params, daxa_ImageViewId medium_lut,
+    daxa_SamplerId medium_sampler, daxa_f32vec3 position)
 {
     const daxa_f32 height = length(position) - deref(params).atmosphere_bottom;
 
@@ -270,4 +334,5 @@ ScatteringSample sample_medium_scattering_detailed(daxa_BufferPtr(Globals) param
     daxa_f32vec3 ozo_scattering = daxa_f32vec3(0.0, 0.0, 0.0);
     
     return ScatteringSample(mie_scattering, ray_scattering);
-}
\ No newline at end of file
+}
+#endif // ATMOSPHERE_ANALYTIC_MEDIUM
@@ -6,16 +6,22 @@
 layout (location = 0) out daxa_f32vec3 color;
 void main()
 {
+#if defined(DEBUG_DRAW_LINES)
+    const DebugLineVertex line_vertex = deref(_line_vertices[gl_VertexIndex]);
+    const daxa_f32vec3 position = line_vertex.position;
+    color = line_vertex.color;
+#else
     const daxa_u32 instance = gl_InstanceIndex; 
     const daxa_u32 offset = instance * FRUSTUM_VERTEX_COUNT;
     const daxa_u32 vertex_index = gl_VertexIndex + offset;
 
     const daxa_f32vec3 position = deref(_frustum_vertices[vertex_index]).vertex;
+    color = deref(_frustum_colors[instance]).color;
+#endif
     const daxa_f32vec4 offset_position = daxa_f32vec4(position.xyz + deref(_globals).offset.xyz, 1.0);
 
     const daxa_f32mat4x4 projection_view = deref(_globals).projection * deref(_globals).view;
 
-    color = deref(_frustum_colors[instance]).color;
     gl_Position = projection_view * offset_position;
 
 }
@@ -72,8 +72,8 @@ RaymarchResult integrate_scattered_luminance(daxa_f32vec3 world_position, daxa_f
 
         daxa_f32vec3 transmittance_to_sun = texture(daxa_sampler2D(_transmittance_LUT, pc.sampler_id), trans_texture_uv).rgb;
 
-        daxa_f32vec3 medium_scattering = sample_medium_scattering(_globals, new_position);
-        daxa_f32vec3 medium_extinction = sample_medium_extinction(_globals, new_position);
+        daxa_f32vec3 medium_scattering = sample_medium_scattering(_globals, _medium_LUT, pc.medium_sampler_id, new_position);
+        daxa_f32vec3 medium_extinction = sample_medium_extinction(_globals, _medium_LUT, pc.medium_sampler_id, new_position);
 
         /* TODO: This probably should be a texture lookup altho might be slow*/
         daxa_f32vec3 trans_increase_over_integration_step = exp(-(medium_extinction * integration_step));
@@ -107,8 +107,8 @@ daxa_f32vec3 integrate_scattered_luminance(daxa_f32vec3 world_position,
 
         /* Position shift */
         daxa_f32vec3 new_position = world_position + integration_step * world_direction;
-        ScatteringSample medium_scattering = sample_medium_scattering_detailed(_globals, new_position);
-        daxa_f32vec3 medium_extinction = sample_medium_extinction(_globals, new_position);
+        ScatteringSample medium_scattering = sample_medium_scattering_detailed(_globals, _medium_LUT, pc.medium_sampler_id, new_position);
+        daxa_f32vec3 medium_extinction = sample_medium_extinction(_globals, _medium_LUT, pc.medium_sampler_id, new_position);
 
         daxa_f32vec3 up_vector = normalize(new_position);
         TransmittanceParams transmittance_lut_params = TransmittanceParams(length(new_position), dot(sun_direction, up_vector));
@@ -146,14 +146,40 @@ daxa_f32vec3 integrate_scattered_luminance(daxa_f32vec3 world_position,
 }
 
 layout (local_size_x = 8, local_size_y = 4) in;
+#if defined(SKYVIEW_CACHE_BLEND)
 void main()
 {
     if( gl_GlobalInvocationID.x >= deref(_globals).sky_lut_dim.x ||
         gl_GlobalInvocationID.y >= deref(_globals).sky_lut_dim.y)
     { return; } 
 
-    daxa_f32vec3 world_position = (deref(_globals).camera_position - deref(_globals).offset) * UNIT_SCALE;
-    world_position.z += deref(_globals).atmosphere_bottom;
+    daxa_f32vec3 luminance = daxa_f32vec3(0.0, 0.0, 0.0);
+    for(daxa_i32 corner = 0; corner < 4; corner++)
+    {
+        const daxa_i32vec3 cache_coords = daxa_i32vec3(gl_GlobalInvocationID.xy, pc.blend_layers[corner]);
+        luminance += pc.blend_weights[corner] * imageLoad(daxa_image2DArray(_skyview_cache), cache_coords).rgb;
+    }
+    imageStore(daxa_image2D(_skyview_LUT), daxa_i32vec2(gl_GlobalInvocationID.xy), daxa_f32vec4(luminance, 1.0));
+}
+#else
+void store_luminance(daxa_f32vec3 luminance)
+{
+#if defined(SKYVIEW_CACHE_BAKE)
+    imageStore(daxa_image2DArray(_skyview_cache), daxa_i32vec3(gl_GlobalInvocationID.xy, pc.cache_layer), daxa_f32vec4(luminance, 1.0));
+#else
+    imageStore(daxa_image2D(_skyview_LUT), daxa_i32vec2(gl_GlobalInvocationID.xy), daxa_f32vec4(luminance, 1.0));
+#endif
+}
+
+void main()
+{
+    if( gl_GlobalInvocationID.x >= deref(_globals).sky_lut_dim.x ||
+        gl_GlobalInvocationID.y >= deref(_globals).sky_lut_dim.y)
+    { return; } 
+
+    // The camera height and the sun zenith are the only camera dependent inputs, they come from the skyview cache
+    // so that cache layers can be baked for other parameters than the current ones
+    daxa_f32vec3 world_position = daxa_f32vec3(0.0, 0.0, pc.camera_height);
 
     daxa_f32vec2 uv = daxa_f32vec2(gl_GlobalInvocationID.xy) / daxa_f32vec2(deref(_globals).sky_lut_dim.xy);
     SkyviewParams skyview_params = uv_to_skyview_lut_params(
@@ -164,7 +190,7 @@ void main()
         length(world_position)
     );
 
-    daxa_f32 sun_zenith_cos_angle = dot(normalize(world_position), deref(_globals).sun_direction);
+    daxa_f32 sun_zenith_cos_angle = pc.sun_zenith_cos_angle;
     // sin^2 + cos^2 = 1 -> sqrt(1 - cos^2) = sin
     // rotate the sun direction so that we are aligned with the y = 0 axis
     daxa_f32vec3 local_sun_direction = normalize(daxa_f32vec3(
@@ -176,15 +202,14 @@ void main()
         cos(skyview_params.light_view_angle) * sin(skyview_params.view_zenith_angle),
         sin(skyview_params.light_view_angle) * sin(skyview_params.view_zenith_angle),
         cos(skyview_params.view_zenith_angle));
-    
-    world_position = daxa_f32vec3(0, 0, length(world_position));
 
     if (!move_to_top_atmosphere(world_position, world_direction, deref(_globals).atmosphere_bottom, deref(_globals).atmosphere_top))
     {
         /* No intersection with the atmosphere */
-        imageStore(daxa_image2D(_skyview_LUT), daxa_i32vec2(gl_GlobalInvocationID.xy), daxa_f32vec4(0.0, 0.0, 0.0, 1.0));
+        store_luminance(daxa_f32vec3(0.0, 0.0, 0.0));
         return;
     }
     daxa_f32vec3 luminance = integrate_scattered_luminance(world_position, world_direction, local_sun_direction, 50);
-    imageStore(daxa_image2D(_skyview_LUT), daxa_i32vec2(gl_GlobalInvocationID.xy), daxa_f32vec4(luminance, 1.0));
-}
\ No newline at end of file
+    store_luminance(luminance);
+}
+#endif
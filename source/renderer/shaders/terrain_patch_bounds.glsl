@@ -0,0 +1,65 @@
+#define DAXA_ENABLE_IMAGE_OVERLOADS_BASIC 1
+#include <shared/shared.inl>
+#include "tasks/terrain_patch_bounds.inl"
+
+#extension GL_EXT_debug_printf : enable
+
+DAXA_DECL_PUSH_CONSTANT(TerrainPatchBoundsPC, pc)
+
+shared daxa_f32 min_heights[TERRAIN_PATCH_BOUNDS_LOCAL_SIZE_X];
+shared daxa_f32 max_heights[TERRAIN_PATCH_BOUNDS_LOCAL_SIZE_X];
+
+layout (local_size_x = TERRAIN_PATCH_BOUNDS_LOCAL_SIZE_X) in;
+void main()
+{
+    // One workgroup per patch, the threads stride over the height map texels under the patch
+    // and the per thread ranges are reduced in shared memory
+    const daxa_u32 patch_index = gl_WorkGroupID.x;
+    const daxa_u32 thread_index = gl_LocalInvocationID.x;
+
+    daxa_f32vec2 min_uv = daxa_f32vec2(1.0);
+    daxa_f32vec2 max_uv = daxa_f32vec2(0.0);
+    for(daxa_u32 corner = 0; corner < TERRAIN_PATCH_INDEX_COUNT; corner++)
+    {
+        const daxa_u32 vertex_index = deref(_indices[patch_index * TERRAIN_PATCH_INDEX_COUNT + corner]).index;
+        const daxa_f32vec2 uv = deref(_vertices[vertex_index]).position;
+        min_uv = min(min_uv, uv);
+        max_uv = max(max_uv, uv);
+    }
+
+    // The bilinear filter of the terrain draws reads one texel past the texel centers enclosing the patch
+    const daxa_i32vec2 height_map_size = daxa_i32vec2(pc.height_map_size);
+    const daxa_i32vec2 min_texel = clamp(daxa_i32vec2(floor(min_uv * daxa_f32vec2(height_map_size) - 0.5)), daxa_i32vec2(0), height_map_size - 1);
+    const daxa_i32vec2 max_texel = clamp(daxa_i32vec2(floor(max_uv * daxa_f32vec2(height_map_size) - 0.5)) + 1, daxa_i32vec2(0), height_map_size - 1);
+    const daxa_i32vec2 texel_extent = max_texel - min_texel + 1;
+
+    daxa_f32 thread_min_height = 1.0e30;
+    daxa_f32 thread_max_height = -1.0e30;
+    for(daxa_i32 texel = daxa_i32(thread_index); texel < texel_extent.x * texel_extent.y; texel += TERRAIN_PATCH_BOUNDS_LOCAL_SIZE_X)
+    {
+        const daxa_i32vec2 texel_coords = min_texel + daxa_i32vec2(texel % texel_extent.x, texel / texel_extent.x);
+        const daxa_f32 height = texelFetch(daxa_texture2D(_height_map), texel_coords, 0).r;
+        thread_min_height = min(thread_min_height, height);
+        thread_max_height = max(thread_max_height, height);
+    }
+    min_heights[thread_index] = thread_min_height;
+    max_heights[thread_index] = thread_max_height;
+    memoryBarrierShared();
+    barrier();
+
+    for(daxa_u32 stride = TERRAIN_PATCH_BOUNDS_LOCAL_SIZE_X / 2; stride > 0; stride /= 2)
+    {
+        if(thread_index < stride)
+        {
+            min_heights[thread_index] = min(min_heights[thread_index], min_heights[thread_index + stride]);
+            max_heights[thread_index] = max(max_heights[thread_index], max_heights[thread_index + stride]);
+        }
+        memoryBarrierShared();
+        barrier();
+    }
+
+    if(thread_index == 0)
+    {
+        deref(_terrain_patch_bounds[patch_index]) = TerrainPatchBounds(min_heights[0], max_heights[0]);
+    }
+}
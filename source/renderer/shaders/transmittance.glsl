@@ -3,6 +3,8 @@
 #include "common_func.glsl"
 #include "tasks/transmittance_LUT.inl"
 
+DAXA_DECL_PUSH_CONSTANT(TransmittancePC, pc)
+
 layout (local_size_x = 8, local_size_y = 4) in;
 
 daxa_f32vec3 integrate_transmittance(daxa_f32vec3 world_position, daxa_f32vec3 world_direction, daxa_u32 sample_count)
@@ -23,7 +25,7 @@ daxa_f32vec3 integrate_transmittance(daxa_f32vec3 world_position, daxa_f32vec3 w
     {
         /* Move along the world direction ray to new position */
         daxa_f32vec3 new_pos = world_position + i * integration_step * world_direction;
-        daxa_f32vec3 atmosphere_extinction = sample_medium_extinction(_globals, new_pos);
+        daxa_f32vec3 atmosphere_extinction = sample_medium_extinction(_globals, _medium_LUT, pc.medium_sampler_id, new_pos);
         optical_depth += atmosphere_extinction * integration_step;
     }
     return optical_depth;
@@ -13,8 +13,8 @@ void main()
     //     - Read the entry in FreePageBuffer[GlobalThreadID]
     //     - Read the entry in AllocationRequest[GlobalThreadID]
     //     - Assign new entries to the page_table_texel and meta_memory_texel
-    //   - If the (GlobalThreadID - free_buffer_counter) < not_visited_buffer_counter:
-    //     - Read the entry in NotVisitedPageBuffer[GlobalThreadID]
+    //   - If the (GlobalThreadID - free_buffer_counter) < sum of the not visited bucket counters:
+    //     - Walk the buckets in eviction order and read the entry in NotVisitedPageBuffer the id lands in
     //     - Read the meta memory entry
     //     - Reset (Deallocate) the entry that previously owned this memory in virtual page table 
     //     - Assign new entries to the page_table_texel and meta_memory_texel
@@ -24,6 +24,7 @@ void main()
     if(id >= deref(_vsm_allocation_count).count) { return; }
 
     const daxa_i32 free_shifted_id = id - daxa_i32(header.free_buffer_counter);
+    const daxa_u32 frame_index = deref(_globals).frame_index;
 
     const daxa_i32vec3 alloc_request_page_coords = deref(_vsm_allocation_buffer[id]).coords;
 
@@ -41,11 +42,29 @@ void main()
         daxa_u32 new_meta_memory_page_entry = pack_vsm_coords_to_meta_entry(alloc_request_page_coords);
         new_meta_memory_page_entry |= meta_memory_allocated_mask();
         imageStore(daxa_uimage2D(_vsm_meta_memory_table), free_memory_page_coords, daxa_u32vec4(new_meta_memory_page_entry));
+        imageStore(daxa_uimage2D(_vsm_meta_memory_last_used), free_memory_page_coords, daxa_u32vec4(frame_index));
+        atomicAdd(deref(_vsm_statistics).free_allocations, 1);
+        atomicAdd(deref(_vsm_statistics).allocated_pages, 1);
+        return;
     } 
-    // If there is not enough free pages free NOT VISITED pages to make space
-    else if (free_shifted_id < header.not_visited_buffer_counter)
+
+    // If there is not enough free pages free NOT VISITED pages to make space, oldest buckets first
+    daxa_i32 not_visited_index = -1;
+    daxa_i32 bucket_shifted_id = free_shifted_id;
+    for(daxa_i32 bucket = 0; bucket < VSM_EVICTION_BUCKETS; bucket++)
+    {
+        const daxa_i32 bucket_count = daxa_i32(min(header.not_visited_bucket_counters[bucket], MAX_NUM_VSM_ALLOC_REQUEST));
+        if(bucket_shifted_id < bucket_count)
+        {
+            not_visited_index = bucket * MAX_NUM_VSM_ALLOC_REQUEST + bucket_shifted_id;
+            break;
+        }
+        bucket_shifted_id -= bucket_count;
+    }
+
+    if (not_visited_index != -1)
     {
-        const daxa_i32vec2 not_visited_memory_page_coords = deref(_vsm_not_visited_pages_buffer[free_shifted_id]).coords;
+        const daxa_i32vec2 not_visited_memory_page_coords = deref(_vsm_not_visited_pages_buffer[not_visited_index]).coords;
         // Reset previously owning vsm page
         const daxa_u32 meta_entry = imageLoad(daxa_uimage2D(_vsm_meta_memory_table), not_visited_memory_page_coords).r;
         const daxa_i32vec3 owning_vsm_coords = get_vsm_coords_from_meta_entry(meta_entry);
@@ -61,11 +80,15 @@ void main()
         daxa_u32 new_meta_memory_page_entry = pack_vsm_coords_to_meta_entry(alloc_request_page_coords);
         new_meta_memory_page_entry |= meta_memory_allocated_mask();
         imageStore(daxa_uimage2D(_vsm_meta_memory_table), not_visited_memory_page_coords, daxa_u32vec4(new_meta_memory_page_entry));
+        imageStore(daxa_uimage2D(_vsm_meta_memory_last_used), not_visited_memory_page_coords, daxa_u32vec4(frame_index));
+        atomicAdd(deref(_vsm_statistics).evicted_pages, 1);
+        atomicAdd(deref(_vsm_statistics).allocated_pages, 1);
     } 
     // Else mark the page as allocation failed
     else 
     {
         imageStore(daxa_uimage2DArray(_vsm_page_table), alloc_request_page_coords, daxa_u32vec4(allocation_failed_mask()));
+        atomicAdd(deref(_vsm_statistics).failed_allocations, 1);
     }
 }
     
\ No newline at end of file
@@ -0,0 +1,89 @@
+#define DAXA_ENABLE_IMAGE_OVERLOADS_BASIC 1
+#include <shared/shared.inl>
+#define VSM_WRAPPING_FUNCTIONS 1
+#include "vsm_common.glsl"
+#include "tasks/vsm_build_dirty_pyramid.inl"
+
+#extension GL_EXT_debug_printf : enable
+
+DAXA_DECL_PUSH_CONSTANT(VSMBuildDirtyPyramidPC, pc)
+
+shared daxa_u32 pyramid_words[VSM_DIRTY_PYRAMID_WORDS];
+
+void mark_dirty(daxa_u32 texel_index)
+{
+    atomicOr(pyramid_words[texel_index / 32], 1u << (texel_index % 32));
+}
+
+bool get_is_texel_dirty(daxa_u32 texel_index)
+{
+    return (pyramid_words[texel_index / 32] & (1u << (texel_index % 32))) != 0;
+}
+
+layout (local_size_x = VSM_BUILD_DIRTY_PYRAMID_LOCAL_SIZE_X) in;
+void main()
+{
+    // One workgroup per clip level
+    // - Level 0 marks the allocated dirty pages, read from the page table in unwrapped page coordinates
+    //   so that neighbouring texels of the pyramid are neighbouring pages of the clip level
+    // - Every coarser level ORs the four children of each texel
+    // - The finished pyramid is written out and the draw command of the clip level is reset for the patch culling
+    const daxa_i32 clip_level = daxa_i32(gl_WorkGroupID.z);
+    const daxa_u32 thread_index = gl_LocalInvocationID.x;
+
+    for(daxa_u32 word = thread_index; word < VSM_DIRTY_PYRAMID_WORDS; word += VSM_BUILD_DIRTY_PYRAMID_LOCAL_SIZE_X)
+    {
+        pyramid_words[word] = 0;
+    }
+    memoryBarrierShared();
+    barrier();
+
+    for(daxa_u32 texel = thread_index; texel < VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION; texel += VSM_BUILD_DIRTY_PYRAMID_LOCAL_SIZE_X)
+    {
+        const daxa_i32vec2 page_coords = daxa_i32vec2(texel % VSM_PAGE_TABLE_RESOLUTION, texel / VSM_PAGE_TABLE_RESOLUTION);
+        const daxa_i32vec3 wrapped_coords = vsm_page_coords_to_wrapped_coords(daxa_i32vec3(page_coords, clip_level));
+        const daxa_u32 page_entry = imageLoad(daxa_uimage2DArray(_vsm_page_table), wrapped_coords).r;
+        if(get_is_allocated(page_entry) && get_is_dirty(page_entry))
+        {
+            mark_dirty(vsm_dirty_pyramid_texel_index(0, page_coords));
+        }
+    }
+    memoryBarrierShared();
+    barrier();
+
+    for(daxa_i32 level = 1; level < VSM_DIRTY_PYRAMID_LEVELS; level++)
+    {
+        const daxa_i32 level_resolution = VSM_PAGE_TABLE_RESOLUTION >> level;
+        for(daxa_i32 texel = daxa_i32(thread_index); texel < level_resolution * level_resolution; texel += VSM_BUILD_DIRTY_PYRAMID_LOCAL_SIZE_X)
+        {
+            const daxa_i32vec2 texel_coords = daxa_i32vec2(texel % level_resolution, texel / level_resolution);
+            const daxa_i32vec2 child_coords = texel_coords * 2;
+            const bool dirty =
+                get_is_texel_dirty(vsm_dirty_pyramid_texel_index(level - 1, child_coords)) ||
+                get_is_texel_dirty(vsm_dirty_pyramid_texel_index(level - 1, child_coords + daxa_i32vec2(1, 0))) ||
+                get_is_texel_dirty(vsm_dirty_pyramid_texel_index(level - 1, child_coords + daxa_i32vec2(0, 1))) ||
+                get_is_texel_dirty(vsm_dirty_pyramid_texel_index(level - 1, child_coords + daxa_i32vec2(1, 1)));
+            if(dirty) { mark_dirty(vsm_dirty_pyramid_texel_index(level, texel_coords)); }
+        }
+        memoryBarrierShared();
+        barrier();
+    }
+
+    for(daxa_u32 word = thread_index; word < VSM_DIRTY_PYRAMID_WORDS; word += VSM_BUILD_DIRTY_PYRAMID_LOCAL_SIZE_X)
+    {
+        deref(_vsm_dirty_pyramid[clip_level]).words[word] = pyramid_words[word];
+    }
+
+    if(thread_index == 0)
+    {
+        // Every clip level owns a range of the culled index buffer large enough to hold all the patches,
+        // the page draw pushes the clip level of each draw
+        deref(_vsm_terrain_draw_commands[clip_level]) = DrawIndexedIndirectStruct(
+            0u,                                                              // index_count
+            1u,                                                              // instance_count
+            daxa_u32(clip_level) * pc.patch_count * TERRAIN_PATCH_INDEX_COUNT, // first_index
+            0u,                                                              // vertex_offset
+            0u                                                               // first_instance
+        );
+    }
+}
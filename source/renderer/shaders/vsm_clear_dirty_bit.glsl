@@ -12,6 +12,11 @@ void main()
 
     const daxa_i32vec3 alloc_request_page_coords = deref(_vsm_allocation_buffer[id]).coords;
     const daxa_u32 vsm_page_entry = imageLoad(daxa_uimage2DArray(_vsm_page_table), alloc_request_page_coords).r;
-    const daxa_u32 dirty_bit_reset_page_entry = vsm_page_entry & ~(dirty_mask());
+    // The page draw pass marks the dirty pages it rendered at least one fragment into
+    if(get_is_drawn(vsm_page_entry))
+    {
+        atomicAdd(deref(_vsm_statistics).redrawn_pages, 1);
+    }
+    const daxa_u32 dirty_bit_reset_page_entry = vsm_page_entry & ~(dirty_mask() | drawn_mask());
     imageStore(daxa_uimage2DArray(_vsm_page_table), alloc_request_page_coords, daxa_u32vec4(dirty_bit_reset_page_entry));
 }
\ No newline at end of file
@@ -19,6 +19,11 @@ void main()
     }
     vsm_page_entry = subgroupBroadcast(vsm_page_entry, 0);
     if(!get_is_allocated(vsm_page_entry)) { return; }
+    // Every page is cleared by a grid of workgroups, only the first one counts it
+    if(gl_WorkGroupID.xy == daxa_u32vec2(0) && gl_LocalInvocationIndex == 0)
+    {
+        atomicAdd(deref(_vsm_statistics).cleared_pages, 1);
+    }
 
     const daxa_i32vec2 memory_page_coords = get_meta_coords_from_vsm_entry(vsm_page_entry);
     const daxa_i32vec2 in_memory_corner_coords = memory_page_coords * VSM_PAGE_SIZE;
@@ -135,6 +135,7 @@ daxa_u32 n_mask(daxa_u32 count) { return ((1 << count) - 1); }
 // BIT 29 -> 1 - ALLOCATION_FAILED
 // BIT 28 -> 1 - DIRTY
 // BIT 27 -> 1 - VISITED_MARKED
+// BIT 26 -> 1 - DRAWN
 
 // VSM PAGE TABLE MASKS AND FUNCTIONS
 daxa_u32 allocated_mask()           { return 1 << 31; }
@@ -142,12 +143,14 @@ daxa_u32 requests_allocation_mask() { return 1 << 30; }
 daxa_u32 allocation_failed_mask()   { return 1 << 29; }
 daxa_u32 dirty_mask()               { return 1 << 28; }
 daxa_u32 visited_marked_mask()      { return 1 << 27; }
+daxa_u32 drawn_mask()               { return 1 << 26; }
 
 bool get_is_allocated(daxa_u32 page_entry)        { return (page_entry & allocated_mask()) != 0; }
 bool get_requests_allocation(daxa_u32 page_entry) { return (page_entry & requests_allocation_mask()) != 0; }
 bool get_allocation_failed(daxa_u32 page_entry)   { return (page_entry & allocation_failed_mask()) != 0; }
 bool get_is_dirty(daxa_u32 page_entry)            { return (page_entry & dirty_mask()) != 0; }
 bool get_is_visited_marked(daxa_u32 page_entry)   { return (page_entry & visited_marked_mask()) != 0; }
+bool get_is_drawn(daxa_u32 page_entry)            { return (page_entry & drawn_mask()) != 0; }
 
 // BIT 0 - 7  page entry x coord
 // BIT 8 - 15 page entry y coord
@@ -193,6 +196,31 @@ daxa_i32vec3 get_vsm_coords_from_meta_entry(daxa_u32 page_entry)
     return physical_coordinates;
 }
 
+// Buckets with a lower index are evicted first, age is the number of frames since the page was last used
+daxa_u32 vsm_eviction_bucket(daxa_u32 age, daxa_i32 clip_level)
+{
+    const daxa_u32 age_bucket = min(daxa_u32(findMSB(max(age, 1))), VSM_EVICTION_AGE_BUCKETS - 1);
+    const daxa_u32 clip_group = (daxa_u32(clip_level) * VSM_EVICTION_CLIP_GROUPS) / VSM_CLIP_LEVELS;
+    return (VSM_EVICTION_AGE_BUCKETS - 1 - age_bucket) * VSM_EVICTION_CLIP_GROUPS + (VSM_EVICTION_CLIP_GROUPS - 1 - clip_group);
+}
+
+// Buckets with a lower index are allocated first, finer clip levels before coarser ones and within a clip level
+// the pages covering more of the screen first. Coverage is the number of depth samples which requested the page
+daxa_u32 vsm_request_priority_bucket(daxa_i32 clip_level, daxa_u32 coverage)
+{
+    const daxa_u32 coverage_bin = min(daxa_u32(findMSB(max(coverage, 1))) / 2, VSM_REQUEST_COVERAGE_BINS - 1);
+    return daxa_u32(clip_level) * VSM_REQUEST_COVERAGE_BINS + (VSM_REQUEST_COVERAGE_BINS - 1 - coverage_bin);
+}
+
+// Bit of the dirty pyramid of a clip level holding the texel, the texels of a level follow the texels of all the finer levels
+daxa_u32 vsm_dirty_pyramid_texel_index(daxa_i32 level, daxa_i32vec2 texel_coords)
+{
+    const daxa_u32 level_resolution = daxa_u32(VSM_PAGE_TABLE_RESOLUTION) >> level;
+    const daxa_u32 finest_texels = daxa_u32(VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION);
+    const daxa_u32 level_offset = (4u * (finest_texels - level_resolution * level_resolution)) / 3u;
+    return level_offset + daxa_u32(texel_coords.y) * level_resolution + daxa_u32(texel_coords.x);
+}
+
 daxa_u32 pack_vsm_coords_to_meta_entry(daxa_i32vec3 coords)
 {
     daxa_u32 packed_coords = 0;
@@ -0,0 +1,125 @@
+#define DAXA_ENABLE_IMAGE_OVERLOADS_BASIC 1
+#include <shared/shared.inl>
+#include "vsm_common.glsl"
+#include "tasks/vsm_cull_terrain_patches.inl"
+
+#extension GL_KHR_shader_subgroup_ballot : enable
+#extension GL_EXT_debug_printf : enable
+
+DAXA_DECL_PUSH_CONSTANT(VSMCullTerrainPatchesPC, pc)
+
+// Inclusive rect of the unwrapped pages of the clip level the world space box projects into,
+// returns false when the box misses the clip level. Mirrors get_vsm_page_rect() on the CPU
+bool get_page_rect(daxa_i32 clip_level, daxa_f32vec3 min_bounds, daxa_f32vec3 max_bounds, out daxa_i32vec2 min_page, out daxa_i32vec2 max_page)
+{
+    // Same transform as the tesselation evaluation shader of the page draw
+    const daxa_f32vec3 clip_offset = daxa_f32vec3(deref(_vsm_sun_projections[clip_level]).offset);
+    const daxa_f32mat4x4 projection_view = deref(_vsm_sun_projections[clip_level]).projection_view;
+
+    daxa_f32vec2 min_uv = daxa_f32vec2(1.0e30);
+    daxa_f32vec2 max_uv = daxa_f32vec2(-1.0e30);
+    for(daxa_u32 corner = 0; corner < 8; corner++)
+    {
+        const daxa_f32vec3 corner_position = daxa_f32vec3(
+            (corner & 1) != 0 ? max_bounds.x : min_bounds.x,
+            (corner & 2) != 0 ? max_bounds.y : min_bounds.y,
+            (corner & 4) != 0 ? max_bounds.z : min_bounds.z
+        );
+        const daxa_f32vec4 projected = projection_view * daxa_f32vec4(corner_position + clip_offset, 1.0);
+        const daxa_f32vec2 uv = (projected.xy / projected.w + 1.0) * 0.5;
+        min_uv = min(min_uv, uv);
+        max_uv = max(max_uv, uv);
+    }
+    // Depth is clamped by the page draw, only the page rect can cull
+    if(any(greaterThanEqual(min_uv, daxa_f32vec2(1.0))) || any(lessThan(max_uv, daxa_f32vec2(0.0)))) { return false; }
+
+    min_page = clamp(daxa_i32vec2(floor(min_uv * VSM_PAGE_TABLE_RESOLUTION)), daxa_i32vec2(0), daxa_i32vec2(VSM_PAGE_TABLE_RESOLUTION - 1));
+    max_page = clamp(daxa_i32vec2(floor(max_uv * VSM_PAGE_TABLE_RESOLUTION)), daxa_i32vec2(0), daxa_i32vec2(VSM_PAGE_TABLE_RESOLUTION - 1));
+    return true;
+}
+
+// Tests the rect on the finest pyramid level where it spans at most VSM_DIRTY_PYRAMID_QUERY_TEXELS texels per axis.
+// Conservative, the texels of the coarser levels also cover pages next to the rect
+bool get_is_page_rect_dirty(daxa_i32 clip_level, daxa_i32vec2 min_page, daxa_i32vec2 max_page)
+{
+    daxa_i32 level = 0;
+    while(level < VSM_DIRTY_PYRAMID_LEVELS - 1 &&
+          any(greaterThanEqual((max_page >> level) - (min_page >> level), daxa_i32vec2(VSM_DIRTY_PYRAMID_QUERY_TEXELS))))
+    {
+        level++;
+    }
+
+    const daxa_i32vec2 min_texel = min_page >> level;
+    const daxa_i32vec2 max_texel = max_page >> level;
+    for(daxa_i32 y = min_texel.y; y <= max_texel.y; y++)
+    {
+        for(daxa_i32 x = min_texel.x; x <= max_texel.x; x++)
+        {
+            const daxa_u32 texel_index = vsm_dirty_pyramid_texel_index(level, daxa_i32vec2(x, y));
+            if((deref(_vsm_dirty_pyramid[clip_level]).words[texel_index / 32] & (1u << (texel_index % 32))) != 0) { return true; }
+        }
+    }
+    return false;
+}
+
+layout (local_size_x = VSM_CULL_TERRAIN_PATCHES_LOCAL_SIZE_X) in;
+void main()
+{
+    // - Bound the patch by its uv rect and the height range of the height map under it
+    // - Project the bounds into the page rect of the clip level
+    // - Patches whose page rect contains a dirty page are appended into the index range of the clip level
+    const daxa_u32 patch_index = gl_GlobalInvocationID.x;
+    const daxa_i32 clip_level = daxa_i32(gl_GlobalInvocationID.y);
+
+    daxa_u32 patch_indices[TERRAIN_PATCH_INDEX_COUNT];
+    bool drawn = false;
+    if(patch_index < pc.patch_count)
+    {
+        daxa_f32vec2 min_uv = daxa_f32vec2(1.0);
+        daxa_f32vec2 max_uv = daxa_f32vec2(0.0);
+        for(daxa_u32 corner = 0; corner < TERRAIN_PATCH_INDEX_COUNT; corner++)
+        {
+            patch_indices[corner] = deref(_indices[patch_index * TERRAIN_PATCH_INDEX_COUNT + corner]).index;
+            const daxa_f32vec2 uv = deref(_vertices[patch_indices[corner]]).position;
+            min_uv = min(min_uv, uv);
+            max_uv = max(max_uv, uv);
+        }
+
+        const TerrainPatchBounds bounds = deref(_terrain_patch_bounds[patch_index]);
+        const daxa_f32 min_height = (bounds.min_height - deref(_globals).terrain_midpoint) * deref(_globals).terrain_height_scale;
+        const daxa_f32 max_height = (bounds.max_height - deref(_globals).terrain_midpoint) * deref(_globals).terrain_height_scale;
+        // Matches the border test of the page draw
+        const bool touches_border = min_uv.x < 0.001 || min_uv.y < 0.001 || max_uv.x > 0.999 || max_uv.y > 0.999;
+
+        const daxa_f32vec3 min_bounds = daxa_f32vec3(
+            min_uv * deref(_globals).terrain_scale,
+            touches_border ? TERRAIN_BORDER_HEIGHT : min(min_height, max_height));
+        const daxa_f32vec3 max_bounds = daxa_f32vec3(max_uv * deref(_globals).terrain_scale, max(min_height, max_height));
+
+        daxa_i32vec2 min_page;
+        daxa_i32vec2 max_page;
+        drawn = get_page_rect(clip_level, min_bounds, max_bounds, min_page, max_page) &&
+                get_is_page_rect_dirty(clip_level, min_page, max_page);
+    }
+
+    // A single atomic per subgroup reserves the slots of all its drawn patches, the whole workgroup shares the clip level
+    const daxa_u32vec4 drawn_mask = subgroupBallot(drawn);
+    const daxa_u32 drawn_count = subgroupBallotBitCount(drawn_mask);
+    const daxa_u32 order = subgroupBallotExclusiveBitCount(drawn_mask);
+    daxa_u32 first_slot = 0;
+    if(subgroupElect() && drawn_count > 0)
+    {
+        first_slot = atomicAdd(deref(_vsm_terrain_draw_commands[clip_level]).index_count, drawn_count * TERRAIN_PATCH_INDEX_COUNT);
+        atomicAdd(deref(_vsm_statistics).drawn_patches, drawn_count);
+    }
+    first_slot = subgroupBroadcastFirst(first_slot);
+    if(!drawn) { return; }
+
+    const daxa_u32 first_index = 
+        daxa_u32(clip_level) * pc.patch_count * TERRAIN_PATCH_INDEX_COUNT +
+        first_slot + order * TERRAIN_PATCH_INDEX_COUNT;
+    for(daxa_u32 corner = 0; corner < TERRAIN_PATCH_INDEX_COUNT; corner++)
+    {
+        deref(_vsm_culled_terrain_indices[first_index + corner]).index = patch_indices[corner];
+    }
+}
@@ -19,7 +19,7 @@ void main()
     const daxa_f32 adjusted_height = (sampled_height - deref(_globals).terrain_midpoint) * deref(_globals).terrain_height_scale;
 
     gl_Position = daxa_f32vec4(pre_scale_position.xy, adjusted_height, 1.0);
-    out_clip_level = gl_InstanceIndex;
+    out_clip_level = pc.clip_level;
 }
 #elif DAXA_SHADER_STAGE == DAXA_SHADER_STAGE_TESSELATION_CONTROL
 layout(location = 0) in daxa_u32 in_clip_level [];
@@ -114,7 +114,7 @@ void main()
 
     // Clamp the borders of the terrain so that the sun does not see under it when drawing at shallow angles
     const bool is_on_boundary = uv.x > 0.999 || uv.x < 0.001 || uv.y > 0.999 || uv.y < 0.001;
-    const daxa_f32 correct_height = is_on_boundary ? -100000.0 : adjusted_height;
+    const daxa_f32 correct_height = is_on_boundary ? TERRAIN_BORDER_HEIGHT : adjusted_height;
 
     const daxa_f32vec3 height_correct_position = daxa_f32vec3(scaled_position.xy, correct_height);
     // offset the terrain position by the current clip camera world offset
@@ -126,6 +126,7 @@ void main()
 }
 #elif DAXA_SHADER_STAGE == DAXA_SHADER_STAGE_FRAGMENT
 DAXA_DECL_IMAGE_ACCESSOR_WITH_FORMAT(uimage2D, r32ui, , r32uiImage)
+DAXA_DECL_IMAGE_ACCESSOR_WITH_FORMAT(uimage2DArray, r32ui, , r32uiImageArray)
 
 layout (location = 0) in flat daxa_u32 in_clip_level;
 layout (location = 0) out daxa_f32vec4 albedo_out;
@@ -148,6 +149,11 @@ void main()
             physical_texel_coords,
             floatBitsToUint(get_page_offset_depth(info, gl_FragCoord.z))
         );
+        // Marks the page as drawn for the redrawn pages statistic, the dirty bit clear pass counts and resets it
+        if(!get_is_drawn(vsm_page_entry))
+        {
+            imageAtomicOr(daxa_access(r32uiImageArray, _vsm_page_table), wrapped_coords, drawn_mask());
+        }
     } 
 }
 
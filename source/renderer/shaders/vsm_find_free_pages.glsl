@@ -14,15 +14,12 @@ struct BufferReserveInfo
     bool condition;
 };
 
-BufferReserveInfo count_pages_and_reserve_buffer_slots(
-    bool count_free_pages,
+BufferReserveInfo count_free_pages_and_reserve_buffer_slots(
     daxa_BufferPtr(FindFreePagesHeader) header,
     daxa_u32 meta_entry
 )
 {
-    bool condition;
-    if(count_free_pages) { condition = !get_meta_memory_is_allocated(meta_entry); }
-    else                 { condition =  get_meta_memory_is_allocated(meta_entry) && (!get_meta_memory_is_visited(meta_entry)); }
+    const bool condition = !get_meta_memory_is_allocated(meta_entry);
 
     const daxa_u32vec4 condition_mask = subgroupBallot(condition);
     const daxa_u32 order = subgroupBallotExclusiveBitCount(condition_mask);
@@ -35,9 +32,7 @@ BufferReserveInfo count_pages_and_reserve_buffer_slots(
         // as it was not included in the sum
         const daxa_u32 page_count = order + daxa_i32(condition);
 
-        daxa_u32 previous_counter_value;
-        if(count_free_pages) { previous_counter_value = atomicAdd(deref(header).free_buffer_counter, page_count); } 
-        else                 { previous_counter_value = atomicAdd(deref(header).not_visited_buffer_counter, page_count); }
+        const daxa_u32 previous_counter_value = atomicAdd(deref(header).free_buffer_counter, page_count);
 
         daxa_u32 reserve_count = 0;
         daxa_u32 counter_overflow = 0;
@@ -51,8 +46,7 @@ BufferReserveInfo count_pages_and_reserve_buffer_slots(
         }
 
         // fix the counter if it overflowed
-        if(count_free_pages) { atomicAdd(deref(header).free_buffer_counter, -counter_overflow); }
-        else                 { atomicAdd(deref(header).not_visited_buffer_counter, -counter_overflow); }
+        atomicAdd(deref(header).free_buffer_counter, -counter_overflow);
 
         // Pack reserve data into a single uint so we can use a single broadcast to distribute it
         // MSB 16 - reserved offset
@@ -81,26 +75,41 @@ void main()
 
     const daxa_u32 meta_entry = imageLoad(daxa_uimage2D(_vsm_meta_memory_table), thread_coords).r;
 
-    BufferReserveInfo info = count_pages_and_reserve_buffer_slots(true, _vsm_find_free_pages_header, meta_entry);
+    BufferReserveInfo info = count_free_pages_and_reserve_buffer_slots(_vsm_find_free_pages_header, meta_entry);
     bool fits_into_reserved_slots = info.order < info.reserved_count;
     if(info.condition && fits_into_reserved_slots) 
     {
         deref(_vsm_free_pages_buffer[info.reserved_offset + info.order]).coords = thread_coords;
     }
 
-    info = count_pages_and_reserve_buffer_slots(false, _vsm_find_free_pages_header, meta_entry);
-    fits_into_reserved_slots = info.order < info.reserved_count;
-    if(info.condition && fits_into_reserved_slots) 
+    if(get_meta_memory_is_allocated(meta_entry))
+    {
+        atomicAdd(deref(_vsm_statistics).resident_pages[get_vsm_coords_from_meta_entry(meta_entry).z], 1);
+    }
+
+    // Allocated and not visited pages are the eviction candidates, each goes into the bucket given by its age and clip level
+    const daxa_u32 frame_index = deref(_globals).frame_index;
+    const bool not_visited = get_meta_memory_is_allocated(meta_entry) && (!get_meta_memory_is_visited(meta_entry));
+    if(not_visited)
+    {
+        const daxa_u32 last_used_frame = imageLoad(daxa_uimage2D(_vsm_meta_memory_last_used), thread_coords).r;
+        const daxa_u32 bucket = vsm_eviction_bucket(frame_index - last_used_frame, get_vsm_coords_from_meta_entry(meta_entry).z);
+        const daxa_u32 bucket_order = atomicAdd(deref(_vsm_find_free_pages_header).not_visited_bucket_counters[bucket], 1);
+        if(bucket_order < MAX_NUM_VSM_ALLOC_REQUEST)
+        {
+            deref(_vsm_not_visited_pages_buffer[bucket * MAX_NUM_VSM_ALLOC_REQUEST + bucket_order]).coords = thread_coords;
+        }
+    }
+    else if(get_meta_memory_is_visited(meta_entry))
     {
-        deref(_vsm_not_visited_pages_buffer[info.reserved_offset + info.order]).coords = thread_coords;
+        imageStore(daxa_uimage2D(_vsm_meta_memory_last_used), thread_coords, daxa_u32vec4(frame_index));
     }
-    // Second invocation of count_pages_and_reserve_buffer_slots will attempt to find allocated and non-visited pages
     // We want to clear the visited condition from every single page for the next frame
 
     // If we are debug drawing vsm meta memory and paging texture we don't want to clear visited here
     // The debug pass will clear those flags in that case
 #if VSM_DEBUG_VIZ_PASS == 0
-    if(!info.condition)
+    if(!not_visited)
     {
         const daxa_i32vec3 vsm_coords = get_vsm_coords_from_meta_entry(meta_entry);
         imageStore(daxa_uimage2D(_vsm_meta_memory_table), thread_coords, daxa_u32vec4(meta_entry & (~meta_memory_visited_mask())));
@@ -10,10 +10,12 @@ layout (local_size_x = VSM_PAGE_TABLE_RESOLUTION) in;
 void main()
 {
     const daxa_i32vec2 clear_offset = deref(_free_wrapped_pages_info[gl_GlobalInvocationID.z]).clear_offset;
+    const bool clear_all = deref(_free_wrapped_pages_info[gl_GlobalInvocationID.z]).clear_all != 0;
     const daxa_i32vec3 vsm_page_coords = daxa_i32vec3(gl_LocalInvocationID.x, gl_GlobalInvocationID.y, gl_GlobalInvocationID.z);
     if(vsm_page_coords.x > VSM_PAGE_TABLE_RESOLUTION) { return; }
 
     const bool should_clear = 
+        clear_all ||
         (clear_offset.x > 0 && vsm_page_coords.x <  clear_offset.x) || 
         (clear_offset.x < 0 && vsm_page_coords.x >  VSM_PAGE_TABLE_RESOLUTION + (clear_offset.x - 1)) || 
         (clear_offset.y > 0 && vsm_page_coords.y <  clear_offset.y) || 
@@ -29,6 +31,7 @@ void main()
             const daxa_i32vec2 meta_memory_coords = get_meta_coords_from_vsm_entry(vsm_page_entry);
             imageStore(daxa_uimage2D(_vsm_meta_memory_table), meta_memory_coords, daxa_u32vec4(0));
             imageStore(daxa_uimage2DArray(_vsm_page_table), vsm_wrapped_page_coords, daxa_u32vec4(0));
+            if(clear_all) { atomicAdd(deref(_vsm_statistics).invalidated_pages, 1); }
         } 
     }
 }
\ No newline at end of file
@@ -0,0 +1,97 @@
+#define DAXA_ENABLE_IMAGE_OVERLOADS_BASIC 1
+#include <shared/shared.inl>
+#include "vsm_common.glsl"
+#include "tasks/vsm_prioritize_requests.inl"
+
+#extension GL_EXT_debug_printf : enable
+
+// Number of requests in each priority bucket, reused as the fill cursor of the bucket once the offsets are known
+shared daxa_u32 bucket_counts[VSM_REQUEST_PRIORITY_BUCKETS];
+shared daxa_u32 bucket_offsets[VSM_REQUEST_PRIORITY_BUCKETS];
+
+daxa_u32 request_priority_bucket(daxa_i32vec3 request_page_coords)
+{
+    const daxa_u32 coverage = imageLoad(daxa_uimage2DArray(_vsm_page_request_coverage), request_page_coords).r;
+    return vsm_request_priority_bucket(request_page_coords.z, coverage);
+}
+
+layout (local_size_x = VSM_PRIORITIZE_REQUESTS_LOCAL_SIZE_X) in;
+void main()
+{
+    // - Count the page requests falling into each priority bucket
+    // - Prefix sum the counts into the offset of the first slot of each bucket
+    // - Requests landing in a slot below the page budget become allocation requests, in bucket order
+    // - The remaining requests lose their REQUESTS_ALLOCATION bit, the depth analysis
+    //   of the next frame finds them unallocated and requests them again
+    const daxa_u32 thread_index = gl_LocalInvocationID.x;
+    const daxa_u32 request_count = min(deref(_vsm_page_request_count).count, MAX_NUM_VSM_PAGE_REQUEST);
+    const daxa_u32 page_budget = min(deref(_globals).vsm_page_budget, MAX_NUM_VSM_ALLOC_REQUEST);
+
+    for(daxa_u32 bucket = thread_index; bucket < VSM_REQUEST_PRIORITY_BUCKETS; bucket += VSM_PRIORITIZE_REQUESTS_LOCAL_SIZE_X)
+    {
+        bucket_counts[bucket] = 0;
+    }
+    memoryBarrierShared();
+    barrier();
+
+    for(daxa_u32 request = thread_index; request < request_count; request += VSM_PRIORITIZE_REQUESTS_LOCAL_SIZE_X)
+    {
+        const daxa_u32 bucket = request_priority_bucket(deref(_vsm_page_requests[request]).coords);
+        atomicAdd(bucket_counts[bucket], 1);
+    }
+    memoryBarrierShared();
+    barrier();
+
+    if(thread_index == 0)
+    {
+        daxa_u32 offset = 0;
+        for(daxa_u32 bucket = 0; bucket < VSM_REQUEST_PRIORITY_BUCKETS; bucket++)
+        {
+            bucket_offsets[bucket] = offset;
+            offset += bucket_counts[bucket];
+            bucket_counts[bucket] = 0;
+        }
+    }
+    memoryBarrierShared();
+    barrier();
+
+    for(daxa_u32 request = thread_index; request < request_count; request += VSM_PRIORITIZE_REQUESTS_LOCAL_SIZE_X)
+    {
+        const daxa_i32vec3 request_page_coords = deref(_vsm_page_requests[request]).coords;
+        const daxa_u32 bucket = request_priority_bucket(request_page_coords);
+        const daxa_u32 slot = bucket_offsets[bucket] + atomicAdd(bucket_counts[bucket], 1);
+        if(slot < page_budget)
+        {
+            deref(_vsm_allocation_buffer[slot]) = AllocationRequest(request_page_coords);
+        }
+        else
+        {
+            const daxa_u32 page_entry = imageLoad(daxa_uimage2DArray(_vsm_page_table), request_page_coords).r;
+            imageStore(daxa_uimage2DArray(_vsm_page_table), request_page_coords, daxa_u32vec4(page_entry & (~requests_allocation_mask())));
+        }
+    }
+
+    // Prepare indirect dispatches for further vsm passes
+    if(thread_index == 0)
+    {
+        const daxa_u32 allocations_number = min(request_count, page_budget);
+        deref(_vsm_allocation_count).count = allocations_number;
+        deref(_vsm_statistics).requested_pages = deref(_vsm_page_request_count).count;
+
+        const daxa_u32 allocate_dispach_count =
+            (allocations_number + VSM_ALLOCATE_PAGES_LOCAL_SIZE_X - 1) / VSM_ALLOCATE_PAGES_LOCAL_SIZE_X;
+        deref(_vsm_allocate_indirect).x = 1;
+        deref(_vsm_allocate_indirect).y = 1;
+        deref(_vsm_allocate_indirect).z = allocate_dispach_count;
+
+        deref(_vsm_clear_indirect).x = VSM_PAGE_SIZE / VSM_CLEAR_PAGES_LOCAL_SIZE_XY;
+        deref(_vsm_clear_indirect).y = VSM_PAGE_SIZE / VSM_CLEAR_PAGES_LOCAL_SIZE_XY;
+        deref(_vsm_clear_indirect).z = allocations_number;
+
+        const daxa_u32 clear_dirty_bit_distpach_count =
+            (allocations_number + VSM_CLEAR_DIRTY_BIT_LOCAL_SIZE_X - 1) / VSM_CLEAR_DIRTY_BIT_LOCAL_SIZE_X;
+        deref(_vsm_clear_dirty_bit_indirect).x = 1;
+        deref(_vsm_clear_dirty_bit_indirect).y = 1;
+        deref(_vsm_clear_dirty_bit_indirect).z = clear_dirty_bit_distpach_count;
+    }
+}
@@ -8,9 +8,20 @@
 #define SHADOWMAP_RESOLUTION 1024
 #define UNIT_SCALE 0.001
 #define HISTOGRAM_BIN_COUNT 256
+// Number of altitude samples in the baked atmosphere medium density LUT
+#define MEDIUM_LUT_RESOLUTION 512
+// When set the atmosphere LUT passes evaluate the medium density analytically instead of sampling the medium LUT,
+// can be overridden with a compile define to compare the two
+#if !defined(ATMOSPHERE_ANALYTIC_MEDIUM)
+#define ATMOSPHERE_ANALYTIC_MEDIUM 0
+#endif
 
 #define VSM_TEXTURE_RESOLUTION 8192//4096
+// Selected by the residency quality tier and passed to the shaders as a define,
+// the value here is the highest supported resolution
+#if !defined(VSM_MEMORY_RESOLUTION)
 #define VSM_MEMORY_RESOLUTION 4096
+#endif
 #define VSM_PAGE_SIZE 128
 #define VSM_CLIP_LEVELS 16
 #define VSM_PAGE_TABLE_RESOLUTION (VSM_TEXTURE_RESOLUTION / VSM_PAGE_SIZE)
@@ -47,12 +58,42 @@ static constexpr daxa_u32 vsm_debug_paging_table_resolution()
 
 #define MAX_NUM_VSM_ALLOC_REQUEST 256
 // #define MAX_NUM_VSM_ALLOC_REQUEST 1
+// Not visited pages are sorted into buckets by the frames since their last use and by their clip level,
+// the buckets are drained in order so the oldest pages of the coarsest clip levels are evicted first
+#define VSM_EVICTION_AGE_BUCKETS 8
+#define VSM_EVICTION_CLIP_GROUPS 4
+#define VSM_EVICTION_BUCKETS (VSM_EVICTION_AGE_BUCKETS * VSM_EVICTION_CLIP_GROUPS)
+// Every page the depth analysis finds unallocated is collected, up to this many per frame. At most
+// Globals::vsm_page_budget of them are allocated in the order of their clip level and screen coverage,
+// the rest stay unallocated and are requested again by the next frame
+#define MAX_NUM_VSM_PAGE_REQUEST 4096
+// Screen coverage is binned by powers of four, bin 7 holds pages covering 16384 samples and more
+#define VSM_REQUEST_COVERAGE_BINS 8
+#define VSM_REQUEST_PRIORITY_BUCKETS (VSM_CLIP_LEVELS * VSM_REQUEST_COVERAGE_BINS)
 
 #define VSM_FIND_FREE_PAGES_LOCAL_SIZE_X 32
 #define VSM_CLEAR_PAGES_LOCAL_SIZE_XY 16
 #define VSM_CLEAR_DIRTY_BIT_LOCAL_SIZE_X 32
 #define VSM_ALLOCATE_PAGES_LOCAL_SIZE_X 32
+#define VSM_PRIORITIZE_REQUESTS_LOCAL_SIZE_X 256
+// Per clip level mip pyramid of the dirty pages in unwrapped page coordinates, level 0 matches the page table and
+// every texel of a coarser level is dirty when any of its four children is. One bit per texel, the levels are
+// stored one after another with the texels of a level in row major order
+#define VSM_DIRTY_PYRAMID_LEVELS 7
+#define VSM_DIRTY_PYRAMID_TEXELS ((4 * VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION - 1) / 3)
+#define VSM_DIRTY_PYRAMID_WORDS ((VSM_DIRTY_PYRAMID_TEXELS + 31) / 32)
+// A terrain patch is tested against the finest pyramid level on which its page rect spans at most this many texels per axis
+#define VSM_DIRTY_PYRAMID_QUERY_TEXELS 4
+#define VSM_BUILD_DIRTY_PYRAMID_LOCAL_SIZE_X 256
+#define VSM_CULL_TERRAIN_PATCHES_LOCAL_SIZE_X 64
+#define TERRAIN_PATCH_BOUNDS_LOCAL_SIZE_X 64
+// Terrain patches are quads of four indices, the border vertices are pulled down to this height
+// by the page draw so that the sun can not see under the terrain at shallow angles
+#define TERRAIN_PATCH_INDEX_COUNT 4
+#define TERRAIN_BORDER_HEIGHT -100000.0
 #ifdef __cplusplus
+static_assert((1 << (VSM_DIRTY_PYRAMID_LEVELS - 1)) == VSM_PAGE_TABLE_RESOLUTION,
+    "The coarsest dirty pyramid level has to be a single texel");
 static_assert((VSM_PAGE_SIZE % VSM_CLEAR_PAGES_LOCAL_SIZE_XY) == 0,
     "Clear pages pass is written in a way that it requires the page size to be a multiple \
      of 16, either align the page size or change the code to account for this");
@@ -136,6 +177,8 @@ struct Globals
     daxa_i32vec3 vsm_sun_offset;
     daxa_f32 vsm_clip0_texel_world_size;
     daxa_i32 vsm_debug_clip_level;
+    // Upper bound of the pages allocated and drawn this frame, see VSMPageBudget
+    daxa_u32 vsm_page_budget;
 
     // ================ Post process =================
     daxa_f32 min_luminance_log2;
@@ -191,6 +234,13 @@ struct FrustumColor
 };
 DAXA_DECL_BUFFER_PTR(FrustumColor)
 
+struct DebugLineVertex
+{
+    daxa_f32vec3 position;
+    daxa_f32vec3 color;
+};
+DAXA_DECL_BUFFER_PTR(DebugLineVertex)
+
 struct DrawIndexedIndirectStruct
 {
     daxa_u32 index_count;
@@ -246,6 +296,31 @@ struct AllocationRequest
 };
 DAXA_DECL_BUFFER_PTR(AllocationRequest)
 
+// Counters of the VSM passes of one frame, copied into one of two slots of the readback buffer and read by the CPU in the next frame
+struct VSMStatistics
+{
+    // Unallocated pages the depth analysis found, may exceed MAX_NUM_VSM_PAGE_REQUEST
+    daxa_u32 requested_pages;
+    // Requests which got a physical page, free or evicted. Requests over the page budget are left for the following frames
+    daxa_u32 allocated_pages;
+    // Allocations served by a free physical page
+    daxa_u32 free_allocations;
+    // Allocations which evicted a not visited page from another virtual page
+    daxa_u32 evicted_pages;
+    // Allocations which found neither a free nor a not visited page
+    daxa_u32 failed_allocations;
+    daxa_u32 cleared_pages;
+    // Dirty pages the page draw pass rendered at least one fragment into, pages no terrain covers are not counted
+    daxa_u32 redrawn_pages;
+    // Terrain patches submitted to the page draw, summed over the clip levels
+    daxa_u32 drawn_patches;
+    // Allocated pages freed because the sun direction of their clip level changed
+    daxa_u32 invalidated_pages;
+    // Allocated physical pages per clip level before the allocations of the frame
+    daxa_u32 resident_pages[VSM_CLIP_LEVELS];
+};
+DAXA_DECL_BUFFER_PTR(VSMStatistics)
+
 struct PageCoordBuffer
 {
     daxa_i32vec2 coords;
@@ -255,12 +330,30 @@ DAXA_DECL_BUFFER_PTR(PageCoordBuffer)
 struct FindFreePagesHeader
 {
     daxa_u32 free_buffer_counter;
-    daxa_u32 not_visited_buffer_counter;
+    // Bucket b owns the entries [b * MAX_NUM_VSM_ALLOC_REQUEST, (b + 1) * MAX_NUM_VSM_ALLOC_REQUEST) of the
+    // not visited pages buffer, the counters keep counting past the bucket capacity
+    daxa_u32 not_visited_bucket_counters[VSM_EVICTION_BUCKETS];
 };
 DAXA_DECL_BUFFER_PTR(FindFreePagesHeader)
 
+struct VSMDirtyPyramid
+{
+    daxa_u32 words[VSM_DIRTY_PYRAMID_WORDS];
+};
+DAXA_DECL_BUFFER_PTR(VSMDirtyPyramid)
+
+// Range of the raw height map values under a terrain patch, including the texels the bilinear filter reaches
+struct TerrainPatchBounds
+{
+    daxa_f32 min_height;
+    daxa_f32 max_height;
+};
+DAXA_DECL_BUFFER_PTR(TerrainPatchBounds)
+
 struct FreeWrappedPagesInfo
 {
     daxa_i32vec2 clear_offset;
+    // Frees every page of the clip level, set when the sun direction of the level changed
+    daxa_u32 clear_all;
 };
 DAXA_DECL_BUFFER_PTR(FreeWrappedPagesInfo)
\ No newline at end of file
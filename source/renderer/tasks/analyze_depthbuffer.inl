@@ -15,15 +15,13 @@ struct AnalyzeDepthPC
 DAXA_DECL_TASK_USES_BEGIN(AnalyzeDepthbufferTaskBase, DAXA_UNIFORM_BUFFER_SLOT0)
 DAXA_TASK_USE_BUFFER(_globals, daxa_BufferPtr(Globals), COMPUTE_SHADER_READ)
 DAXA_TASK_USE_BUFFER(_depth_limits, daxa_BufferPtr(DepthLimits), COMPUTE_SHADER_READ_WRITE)
-DAXA_TASK_USE_BUFFER(_vsm_allocation_count, daxa_BufferPtr(AllocationCount), COMPUTE_SHADER_READ_WRITE)
-DAXA_TASK_USE_BUFFER(_vsm_allocation_buffer, daxa_BufferPtr(AllocationRequest), COMPUTE_SHADER_WRITE)
-DAXA_TASK_USE_BUFFER(_vsm_allocate_indirect, daxa_BufferPtr(DispatchIndirectStruct), COMPUTE_SHADER_WRITE)
-DAXA_TASK_USE_BUFFER(_vsm_clear_indirect, daxa_BufferPtr(DispatchIndirectStruct), COMPUTE_SHADER_WRITE)
-DAXA_TASK_USE_BUFFER(_vsm_clear_dirty_bit_indirect, daxa_BufferPtr(DispatchIndirectStruct), COMPUTE_SHADER_WRITE)
+DAXA_TASK_USE_BUFFER(_vsm_page_request_count, daxa_BufferPtr(AllocationCount), COMPUTE_SHADER_READ_WRITE)
+DAXA_TASK_USE_BUFFER(_vsm_page_requests, daxa_BufferPtr(AllocationRequest), COMPUTE_SHADER_WRITE)
 DAXA_TASK_USE_BUFFER(_vsm_sun_projections, daxa_BufferPtr(VSMClipProjection), COMPUTE_SHADER_READ)
 DAXA_TASK_USE_IMAGE(_depth, REGULAR_2D, COMPUTE_SHADER_SAMPLED)
 DAXA_TASK_USE_IMAGE(_vsm_page_table, REGULAR_2D_ARRAY, COMPUTE_SHADER_STORAGE_READ_WRITE)
 DAXA_TASK_USE_IMAGE(_vsm_meta_memory_table, REGULAR_2D, COMPUTE_SHADER_STORAGE_READ_WRITE)
+DAXA_TASK_USE_IMAGE(_vsm_page_request_coverage, REGULAR_2D_ARRAY, COMPUTE_SHADER_STORAGE_READ_WRITE)
 DAXA_DECL_TASK_USES_END()
 
 #if __cplusplus
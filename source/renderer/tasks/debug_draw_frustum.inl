@@ -11,6 +11,7 @@ DAXA_TASK_USE_BUFFER(_frustum_indices, daxa_BufferPtr(FrustumIndex), VERTEX_SHAD
 DAXA_TASK_USE_BUFFER(_frustum_vertices, daxa_BufferPtr(FrustumVertex), VERTEX_SHADER_READ)
 DAXA_TASK_USE_BUFFER(_frustum_colors, daxa_BufferPtr(FrustumColor), VERTEX_SHADER_READ)
 DAXA_TASK_USE_BUFFER(_frustum_indirect, daxa_BufferPtr(DrawIndexedIndirectStruct), DRAW_INDIRECT_INFO_READ)
+DAXA_TASK_USE_BUFFER(_line_vertices, daxa_BufferPtr(DebugLineVertex), VERTEX_SHADER_READ)
 DAXA_TASK_USE_IMAGE(_swapchain, REGULAR_2D, COLOR_ATTACHMENT)
 DAXA_TASK_USE_IMAGE(_depth, REGULAR_2D, DEPTH_ATTACHMENT)
 DAXA_DECL_TASK_USES_END()
@@ -37,6 +38,26 @@ inline auto get_debug_draw_frustum_pipeline(Context const & context) -> daxa::Ra
     };
 }
 
+// Same shader as the frusta, reads the vertices of the debug draw line list instead
+inline auto get_debug_draw_lines_pipeline(Context const & context) -> daxa::RasterPipelineCompileInfo{
+    daxa::ShaderCompileOptions options = { .defines = {{"DEBUG_DRAW_LINES", "1"}} };
+    return {
+        .vertex_shader_info = daxa::ShaderCompileInfo{ .source = daxa::ShaderFile{"debug_draw_frustum.glsl"}, .compile_options = options },
+        .fragment_shader_info = daxa::ShaderCompileInfo{ .source = daxa::ShaderFile{"debug_draw_frustum.glsl"}, .compile_options = options },
+        .color_attachments = { {.format = context.swapchain.get_format()},},
+        .depth_test = daxa::DepthTestInfo{ 
+            .depth_attachment_format = daxa::Format::D32_SFLOAT,
+            .enable_depth_write = true,
+            .depth_test_compare_op = daxa::CompareOp::GREATER_OR_EQUAL,
+        },
+        .raster = {
+            .primitive_topology = daxa::PrimitiveTopology::LINE_LIST,
+            .polygon_mode = daxa::PolygonMode::LINE
+        },
+        .name = "debug draw lines"
+    };
+}
+
 struct DebugDrawFrustumTask : DebugDrawFrustumTaskBase
 {
     static constexpr daxa_u32 index_count = 18u;
@@ -78,6 +99,13 @@ struct DebugDrawFrustumTask : DebugDrawFrustumTaskBase
             .draw_command_buffer = uses._frustum_indirect.buffer(),
             .is_indexed = true
         });
+
+        const daxa_u32 line_count = context->frame.debug_draw.get_line_count();
+        if(line_count > 0)
+        {
+            render_cmd_list.set_pipeline(*(context->pipelines.debug_draw_lines)); 
+            render_cmd_list.draw({.vertex_count = 2 * line_count});
+        }
         cmd_list = std::move(render_cmd_list).end_renderpass();
     }
 };
@@ -9,11 +9,13 @@ struct MultiscatteringPC
 {
     daxa_SamplerId sampler_id;
     daxa_SamplerId wrong_sampler_id;
+    daxa_SamplerId medium_sampler_id;
 };
 
 DAXA_DECL_TASK_USES_BEGIN(ComputeMultiscatteringTaskBase, DAXA_UNIFORM_BUFFER_SLOT0)
 DAXA_TASK_USE_BUFFER(_globals, daxa_BufferPtr(Globals), COMPUTE_SHADER_READ)
 DAXA_TASK_USE_IMAGE(_transmittance_LUT, REGULAR_2D, COMPUTE_SHADER_SAMPLED)
+DAXA_TASK_USE_IMAGE(_medium_LUT, REGULAR_2D, COMPUTE_SHADER_SAMPLED)
 DAXA_TASK_USE_IMAGE(_multiscattering_LUT, REGULAR_2D, COMPUTE_SHADER_STORAGE_WRITE_ONLY)
 DAXA_DECL_TASK_USES_END()
 
@@ -44,7 +46,8 @@ struct ComputeMultiscatteringTask : ComputeMultiscatteringTaskBase
         cmd_list.set_pipeline(*(context->pipelines.multiscattering));
         cmd_list.push_constant(MultiscatteringPC{
             .sampler_id = context->llce_sampler,
-            .wrong_sampler_id = context->linear_sampler
+            .wrong_sampler_id = context->linear_sampler,
+            .medium_sampler_id = context->llce_sampler
         });
         cmd_list.dispatch(multiscattering_dimensions.x, multiscattering_dimensions.y);
     }
@@ -9,29 +9,56 @@ struct SkyviewPC
 {
     daxa_SamplerId sampler_id;
     daxa_SamplerId wrong_sampler_id;
+    daxa_SamplerId medium_sampler_id;
+    // Parameters the LUT is raymarched for, see SkyviewParameters
+    daxa_f32 camera_height;
+    daxa_f32 sun_zenith_cos_angle;
+    // Layer written by the cache bake
+    daxa_u32 cache_layer;
+    // Layers and weights interpolated by the cache blend
+    daxa_u32vec4 blend_layers;
+    daxa_f32vec4 blend_weights;
 };
 
 DAXA_DECL_TASK_USES_BEGIN(ComputeSkyViewTaskBase, DAXA_UNIFORM_BUFFER_SLOT0)
 DAXA_TASK_USE_BUFFER(_globals, daxa_BufferPtr(Globals), COMPUTE_SHADER_READ)
 DAXA_TASK_USE_IMAGE(_transmittance_LUT, REGULAR_2D, COMPUTE_SHADER_SAMPLED)
+DAXA_TASK_USE_IMAGE(_medium_LUT, REGULAR_2D, COMPUTE_SHADER_SAMPLED)
 DAXA_TASK_USE_IMAGE(_multiscattering_LUT, REGULAR_2D, COMPUTE_SHADER_SAMPLED)
+DAXA_TASK_USE_IMAGE(_skyview_cache, REGULAR_2D_ARRAY, COMPUTE_SHADER_STORAGE_READ_WRITE)
 DAXA_TASK_USE_IMAGE(_skyview_LUT, REGULAR_2D, COMPUTE_SHADER_STORAGE_WRITE_ONLY)
 DAXA_DECL_TASK_USES_END()
 
 #if __cplusplus
 #include "../context.hpp"
-inline auto get_skyview_LUT_pipeline() -> daxa::ComputePipelineCompileInfo
+
+enum struct SkyviewPipeline
 {
+    // Raymarches the skyview LUT for the current parameters
+    EVALUATE,
+    // Raymarches a cache layer for the parameters of its grid point
+    CACHE_BAKE,
+    // Interpolates the skyview LUT from four cache layers
+    CACHE_BLEND
+};
+
+inline auto get_skyview_LUT_pipeline(SkyviewPipeline pipeline = SkyviewPipeline::EVALUATE) -> daxa::ComputePipelineCompileInfo
+{
+    daxa::ShaderCompileOptions options;
+    if(pipeline == SkyviewPipeline::CACHE_BAKE)  { options.defines = {{"SKYVIEW_CACHE_BAKE", "1"}}; }
+    if(pipeline == SkyviewPipeline::CACHE_BLEND) { options.defines = {{"SKYVIEW_CACHE_BLEND", "1"}}; }
     return {
         .shader_info = {
             .source = daxa::ShaderFile{"skyview.glsl"},
-            .compile_options = {}
+            .compile_options = options
         },
         .push_constant_size = sizeof(SkyviewPC),
-        .name = "compute skyview LUT pipeline"
+        .name = pipeline == SkyviewPipeline::EVALUATE   ? "compute skyview LUT pipeline" :
+                pipeline == SkyviewPipeline::CACHE_BAKE ? "bake skyview cache pipeline" : "blend skyview cache pipeline"
     };
 }
 
+// Records the plan of the skyview cache, the task is skipped in frames which reuse the LUT of the previous frame
 struct ComputeSkyViewTask : ComputeSkyViewTaskBase
 {
     Context * context = {};
@@ -39,16 +66,50 @@ struct ComputeSkyViewTask : ComputeSkyViewTaskBase
     void callback(daxa::TaskInterface ti)
     {
         auto & cmd_list = ti.get_recorder();
+        auto const & plan = context->frame.skyview_cache.get_plan();
 
         auto skyview_dimensions = context->device.info_image(uses._skyview_LUT.image()).value().size;
-
-        cmd_list.set_uniform_buffer(ti.uses.get_uniform_buffer_info());
-        cmd_list.set_pipeline(*(context->pipelines.skyview));
-        cmd_list.push_constant(SkyviewPC{
+        auto push_constant = SkyviewPC{
             .sampler_id = context->llce_sampler,
             .wrong_sampler_id = context->linear_sampler,
-        });
-        cmd_list.dispatch((skyview_dimensions.x + 7)/8, ((skyview_dimensions.y + 3)/4));
+            .medium_sampler_id = context->llce_sampler,
+            .camera_height = plan.parameters.camera_height,
+            .sun_zenith_cos_angle = plan.parameters.sun_zenith_cos_angle,
+            .cache_layer = 0,
+            .blend_layers = plan.blend_layers,
+            .blend_weights = plan.blend_weights
+        };
+        auto dispatch = [&]() { cmd_list.dispatch((skyview_dimensions.x + 7)/8, ((skyview_dimensions.y + 3)/4)); };
+
+        cmd_list.set_uniform_buffer(ti.uses.get_uniform_buffer_info());
+        if(plan.source == SkyviewSource::EVALUATE)
+        {
+            cmd_list.set_pipeline(*(context->pipelines.skyview));
+            cmd_list.push_constant(push_constant);
+            dispatch();
+            return;
+        }
+
+        if(plan.bake_count > 0)
+        {
+            cmd_list.set_pipeline(*(context->pipelines.skyview_cache_bake));
+            for(daxa_u32 bake = 0; bake < plan.bake_count; bake++)
+            {
+                push_constant.camera_height = plan.bakes.at(bake).parameters.camera_height;
+                push_constant.sun_zenith_cos_angle = plan.bakes.at(bake).parameters.sun_zenith_cos_angle;
+                push_constant.cache_layer = plan.bakes.at(bake).layer;
+                cmd_list.push_constant(push_constant);
+                dispatch();
+            }
+            // The blend reads the layers baked above
+            cmd_list.pipeline_barrier({
+                .src_access = daxa::AccessConsts::COMPUTE_SHADER_WRITE,
+                .dst_access = daxa::AccessConsts::COMPUTE_SHADER_READ,
+            });
+        }
+        cmd_list.set_pipeline(*(context->pipelines.skyview_cache_blend));
+        cmd_list.push_constant(push_constant);
+        dispatch();
     }
 };
-#endif
\ No newline at end of file
+#endif
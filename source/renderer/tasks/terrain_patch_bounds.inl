@@ -0,0 +1,47 @@
+#pragma once
+
+#include <daxa/daxa.inl>
+#include <daxa/utils/task_graph.inl>
+
+#include "../shared/shared.inl"
+
+struct TerrainPatchBoundsPC
+{
+    daxa_u32vec2 height_map_size;
+};
+
+DAXA_DECL_TASK_USES_BEGIN(TerrainPatchBoundsTaskBase, DAXA_UNIFORM_BUFFER_SLOT0)
+DAXA_TASK_USE_BUFFER(_vertices, daxa_BufferPtr(TerrainVertex), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_indices, daxa_BufferPtr(TerrainIndex), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_terrain_patch_bounds, daxa_BufferPtr(TerrainPatchBounds), COMPUTE_SHADER_WRITE)
+DAXA_TASK_USE_IMAGE(_height_map, REGULAR_2D, COMPUTE_SHADER_SAMPLED)
+DAXA_DECL_TASK_USES_END()
+
+#if __cplusplus
+#include "../context.hpp"
+
+inline auto get_terrain_patch_bounds_pipeline() -> daxa::ComputePipelineCompileInfo {
+    return {
+        .shader_info = { .source = daxa::ShaderFile{"terrain_patch_bounds.glsl"}, },
+        .push_constant_size = sizeof(TerrainPatchBoundsPC),
+        .name = "terrain_patch_bounds"
+    };
+}
+
+// Height range of every terrain patch, recomputed whenever the terrain geometry is uploaded
+struct TerrainPatchBoundsTask : TerrainPatchBoundsTaskBase
+{
+    Context * context = {};
+
+    void callback(daxa::TaskInterface ti)
+    {
+        auto const height_map_size = context->device.info_image(uses._height_map.image()).value().size;
+
+        auto & cmd_list = ti.get_recorder();
+        cmd_list.set_uniform_buffer(ti.uses.get_uniform_buffer_info());
+        cmd_list.set_pipeline(*(context->pipelines.terrain_patch_bounds));
+        cmd_list.push_constant(TerrainPatchBoundsPC{ .height_map_size = {height_map_size.x, height_map_size.y} });
+        cmd_list.dispatch(static_cast<daxa_u32>(context->terrain_index_size / TERRAIN_PATCH_INDEX_COUNT), 1, 1);
+    }
+};
+#endif //__cplusplus
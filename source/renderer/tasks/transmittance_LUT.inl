@@ -5,8 +5,14 @@
 
 #include "../shared/shared.inl"
 
+struct TransmittancePC
+{
+    daxa_SamplerId medium_sampler_id;
+};
+
 DAXA_DECL_TASK_USES_BEGIN(ComputeTransmittanceTaskBase, DAXA_UNIFORM_BUFFER_SLOT0)
 DAXA_TASK_USE_BUFFER(_globals, daxa_BufferPtr(Globals), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_IMAGE(_medium_LUT, REGULAR_2D, COMPUTE_SHADER_SAMPLED)
 DAXA_TASK_USE_IMAGE(_transmittance_LUT, REGULAR_2D, COMPUTE_SHADER_STORAGE_WRITE_ONLY)
 DAXA_DECL_TASK_USES_END()
 
@@ -17,6 +23,7 @@ inline auto get_transmittance_LUT_pipeline() -> daxa::ComputePipelineCompileInfo
 {
     return {
         .shader_info = { .source = daxa::ShaderFile{"transmittance.glsl"}, },
+        .push_constant_size = sizeof(TransmittancePC),
         .name = "compute transmittance LUT pipeline"
     };
 }
@@ -31,6 +38,7 @@ struct ComputeTransmittanceTask : ComputeTransmittanceTaskBase
         auto image_dimensions = context->device.info_image(uses._transmittance_LUT.image()).value().size;
         cmd_list.set_uniform_buffer(ti.uses.get_uniform_buffer_info());
         cmd_list.set_pipeline(*(context->pipelines.transmittance));
+        cmd_list.push_constant(TransmittancePC{ .medium_sampler_id = context->llce_sampler });
         cmd_list.dispatch(((image_dimensions.x + 7)/8), ((image_dimensions.y + 3)/4));
     }
 };
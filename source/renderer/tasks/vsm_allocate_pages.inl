@@ -6,6 +6,7 @@
 #include "../shared/shared.inl"
 
 DAXA_DECL_TASK_USES_BEGIN(VSMAllocatePagesTaskBase, DAXA_UNIFORM_BUFFER_SLOT0)
+DAXA_TASK_USE_BUFFER(_globals, daxa_BufferPtr(Globals), COMPUTE_SHADER_READ)
 DAXA_TASK_USE_BUFFER(_vsm_allocation_count, daxa_BufferPtr(AllocationCount), COMPUTE_SHADER_READ)
 DAXA_TASK_USE_BUFFER(_vsm_allocation_buffer, daxa_BufferPtr(AllocationRequest), COMPUTE_SHADER_READ)
 DAXA_TASK_USE_BUFFER(_vsm_allocate_indirect, daxa_BufferPtr(DispatchIndirectStruct), COMPUTE_SHADER_READ)
@@ -14,9 +15,11 @@ DAXA_TASK_USE_BUFFER(_vsm_free_pages_buffer, daxa_BufferPtr(PageCoordBuffer), CO
 DAXA_TASK_USE_BUFFER(_vsm_not_visited_pages_buffer, daxa_BufferPtr(PageCoordBuffer), COMPUTE_SHADER_READ)
 DAXA_TASK_USE_BUFFER(_vsm_find_free_pages_header, daxa_BufferPtr(FindFreePagesHeader), COMPUTE_SHADER_READ)
 DAXA_TASK_USE_BUFFER(_vsm_sun_projections, daxa_BufferPtr(VSMClipProjection), GRAPHICS_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_vsm_statistics, daxa_BufferPtr(VSMStatistics), COMPUTE_SHADER_READ_WRITE)
 DAXA_TASK_USE_IMAGE(_vsm_page_table, REGULAR_2D_ARRAY, COMPUTE_SHADER_STORAGE_READ_WRITE)
 DAXA_TASK_USE_IMAGE(_vsm_page_height_offset, REGULAR_2D_ARRAY, COMPUTE_SHADER_STORAGE_WRITE_ONLY)
 DAXA_TASK_USE_IMAGE(_vsm_meta_memory_table, REGULAR_2D, COMPUTE_SHADER_STORAGE_READ_WRITE)
+DAXA_TASK_USE_IMAGE(_vsm_meta_memory_last_used, REGULAR_2D, COMPUTE_SHADER_STORAGE_WRITE_ONLY)
 DAXA_DECL_TASK_USES_END()
 
 #if __cplusplus
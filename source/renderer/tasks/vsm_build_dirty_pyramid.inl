@@ -0,0 +1,47 @@
+#pragma once
+
+#include <daxa/daxa.inl>
+#include <daxa/utils/task_graph.inl>
+
+#include "../shared/shared.inl"
+
+struct VSMBuildDirtyPyramidPC
+{
+    daxa_u32 patch_count;
+};
+
+DAXA_DECL_TASK_USES_BEGIN(VSMBuildDirtyPyramidTaskBase, DAXA_UNIFORM_BUFFER_SLOT0)
+DAXA_TASK_USE_BUFFER(_vsm_sun_projections, daxa_BufferPtr(VSMClipProjection), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_vsm_dirty_pyramid, daxa_BufferPtr(VSMDirtyPyramid), COMPUTE_SHADER_WRITE)
+DAXA_TASK_USE_BUFFER(_vsm_terrain_draw_commands, daxa_BufferPtr(DrawIndexedIndirectStruct), COMPUTE_SHADER_WRITE)
+DAXA_TASK_USE_IMAGE(_vsm_page_table, REGULAR_2D_ARRAY, COMPUTE_SHADER_STORAGE_READ_ONLY)
+DAXA_DECL_TASK_USES_END()
+
+#if __cplusplus
+#include "../context.hpp"
+
+inline auto get_vsm_build_dirty_pyramid_pipeline() -> daxa::ComputePipelineCompileInfo {
+    return {
+        .shader_info = { .source = daxa::ShaderFile{"vsm_build_dirty_pyramid.glsl"}, },
+        .push_constant_size = sizeof(VSMBuildDirtyPyramidPC),
+        .name = "vsm_build_dirty_pyramid"
+    };
+}
+
+struct VSMBuildDirtyPyramidTask : VSMBuildDirtyPyramidTaskBase
+{
+    Context * context = {};
+
+    void callback(daxa::TaskInterface ti)
+    {
+        auto & cmd_list = ti.get_recorder();
+        cmd_list.set_uniform_buffer(ti.uses.get_uniform_buffer_info());
+        cmd_list.set_pipeline(*(context->pipelines.vsm_build_dirty_pyramid));
+        cmd_list.push_constant(VSMBuildDirtyPyramidPC{
+            .patch_count = static_cast<daxa_u32>(context->terrain_index_size / TERRAIN_PATCH_INDEX_COUNT)
+        });
+        // The whole pyramid of a clip level is built in shared memory by a single workgroup
+        cmd_list.dispatch(1, 1, VSM_CLIP_LEVELS);
+    }
+};
+#endif //__cplusplus
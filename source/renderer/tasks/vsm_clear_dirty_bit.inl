@@ -9,6 +9,7 @@ DAXA_DECL_TASK_USES_BEGIN(VSMClearDirtyBitTaskBase, DAXA_UNIFORM_BUFFER_SLOT0)
 DAXA_TASK_USE_BUFFER(_vsm_allocation_count, daxa_BufferPtr(AllocationCount), COMPUTE_SHADER_READ)
 DAXA_TASK_USE_BUFFER(_vsm_allocation_buffer, daxa_BufferPtr(AllocationRequest), COMPUTE_SHADER_READ)
 DAXA_TASK_USE_BUFFER(_vsm_clear_dirty_bit_indirect, daxa_BufferPtr(DispatchIndirectStruct), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_vsm_statistics, daxa_BufferPtr(VSMStatistics), COMPUTE_SHADER_READ_WRITE)
 DAXA_TASK_USE_IMAGE(_vsm_page_table, REGULAR_2D_ARRAY, COMPUTE_SHADER_STORAGE_READ_WRITE)
 DAXA_DECL_TASK_USES_END()
 
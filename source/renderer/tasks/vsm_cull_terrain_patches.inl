@@ -0,0 +1,53 @@
+#pragma once
+
+#include <daxa/daxa.inl>
+#include <daxa/utils/task_graph.inl>
+
+#include "../shared/shared.inl"
+
+struct VSMCullTerrainPatchesPC
+{
+    daxa_u32 patch_count;
+};
+
+DAXA_DECL_TASK_USES_BEGIN(VSMCullTerrainPatchesTaskBase, DAXA_UNIFORM_BUFFER_SLOT0)
+DAXA_TASK_USE_BUFFER(_globals, daxa_BufferPtr(Globals), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_vertices, daxa_BufferPtr(TerrainVertex), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_indices, daxa_BufferPtr(TerrainIndex), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_terrain_patch_bounds, daxa_BufferPtr(TerrainPatchBounds), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_vsm_sun_projections, daxa_BufferPtr(VSMClipProjection), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_vsm_dirty_pyramid, daxa_BufferPtr(VSMDirtyPyramid), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_vsm_terrain_draw_commands, daxa_BufferPtr(DrawIndexedIndirectStruct), COMPUTE_SHADER_READ_WRITE)
+DAXA_TASK_USE_BUFFER(_vsm_culled_terrain_indices, daxa_BufferPtr(TerrainIndex), COMPUTE_SHADER_WRITE)
+DAXA_TASK_USE_BUFFER(_vsm_statistics, daxa_BufferPtr(VSMStatistics), COMPUTE_SHADER_READ_WRITE)
+DAXA_DECL_TASK_USES_END()
+
+#if __cplusplus
+#include "../context.hpp"
+
+inline auto get_vsm_cull_terrain_patches_pipeline() -> daxa::ComputePipelineCompileInfo {
+    return {
+        .shader_info = { .source = daxa::ShaderFile{"vsm_cull_terrain_patches.glsl"}, },
+        .push_constant_size = sizeof(VSMCullTerrainPatchesPC),
+        .name = "vsm_cull_terrain_patches"
+    };
+}
+
+struct VSMCullTerrainPatchesTask : VSMCullTerrainPatchesTaskBase
+{
+    Context * context = {};
+
+    void callback(daxa::TaskInterface ti)
+    {
+        const daxa_u32 patch_count = static_cast<daxa_u32>(context->terrain_index_size / TERRAIN_PATCH_INDEX_COUNT);
+        const daxa_u32 dispatch_x_size = 
+            (patch_count + VSM_CULL_TERRAIN_PATCHES_LOCAL_SIZE_X - 1) / VSM_CULL_TERRAIN_PATCHES_LOCAL_SIZE_X;
+
+        auto & cmd_list = ti.get_recorder();
+        cmd_list.set_uniform_buffer(ti.uses.get_uniform_buffer_info());
+        cmd_list.set_pipeline(*(context->pipelines.vsm_cull_terrain_patches));
+        cmd_list.push_constant(VSMCullTerrainPatchesPC{ .patch_count = patch_count });
+        cmd_list.dispatch(dispatch_x_size, VSM_CLIP_LEVELS, 1);
+    }
+};
+#endif //__cplusplus
@@ -67,7 +67,8 @@ struct VSMDebugMetaTableTask : VSMDebugMetaTableTaskBase
 
         cmd_list.set_uniform_buffer(ti.uses.get_uniform_buffer_info());
         cmd_list.set_pipeline(*(context->pipelines.vsm_debug_meta_memory_table));
-        cmd_list.dispatch(VSM_DEBUG_META_MEMORY_RESOLUTION, VSM_DEBUG_META_MEMORY_RESOLUTION);
+        const daxa_u32 debug_meta_memory_resolution = vsm_debug_meta_memory_resolution(context->quality_tiers);
+        cmd_list.dispatch(debug_meta_memory_resolution, debug_meta_memory_resolution);
     }
 };
 
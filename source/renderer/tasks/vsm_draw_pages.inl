@@ -9,16 +9,19 @@ struct VSMDrawPagesPC
 {
     daxa_SamplerId llb_sampler;
     daxa_ImageViewId daxa_u32_vsm_memory_view;
+    daxa_u32 clip_level;
 };
 
 DAXA_DECL_TASK_USES_BEGIN(VSMDrawPagesTaskBase, DAXA_UNIFORM_BUFFER_SLOT0)
 DAXA_TASK_USE_BUFFER(_globals, daxa_BufferPtr(Globals), GRAPHICS_SHADER_READ)
 DAXA_TASK_USE_BUFFER(_vertices, daxa_BufferPtr(TerrainVertex), VERTEX_SHADER_READ)
-DAXA_TASK_USE_BUFFER(_indices, daxa_BufferPtr(TerrainIndex), VERTEX_SHADER_READ)
+// Patches the culling found touching a dirty page, one index range per clip level
+DAXA_TASK_USE_BUFFER(_indices, daxa_BufferPtr(TerrainIndex), INDEX_READ)
+DAXA_TASK_USE_BUFFER(_vsm_terrain_draw_commands, daxa_BufferPtr(DrawIndexedIndirectStruct), DRAW_INDIRECT_INFO_READ)
 DAXA_TASK_USE_BUFFER(_vsm_sun_projections, daxa_BufferPtr(VSMClipProjection), GRAPHICS_SHADER_READ)
 DAXA_TASK_USE_IMAGE(_height_map, REGULAR_2D, GRAPHICS_SHADER_SAMPLED)
 DAXA_TASK_USE_IMAGE(_debug, REGULAR_2D, COLOR_ATTACHMENT)
-DAXA_TASK_USE_IMAGE(_vsm_page_table, REGULAR_2D_ARRAY, GRAPHICS_SHADER_STORAGE_READ_ONLY)
+DAXA_TASK_USE_IMAGE(_vsm_page_table, REGULAR_2D_ARRAY, FRAGMENT_SHADER_STORAGE_READ_WRITE)
 DAXA_TASK_USE_IMAGE(_vsm_memory, REGULAR_2D, FRAGMENT_SHADER_STORAGE_READ_WRITE)
 DAXA_DECL_TASK_USES_END()
 
@@ -49,6 +52,7 @@ inline auto get_vsm_draw_pages_pipeline() -> daxa::RasterPipelineCompileInfo {
 struct VSMDrawPagesTask : VSMDrawPagesTaskBase
 {
     Context * context = {};
+    daxa_u32 * frame_index = {};
     void callback(daxa::TaskInterface ti)
     {
         const auto resolution = daxa_u32vec2{VSM_TEXTURE_RESOLUTION, VSM_TEXTURE_RESOLUTION};
@@ -62,6 +66,18 @@ struct VSMDrawPagesTask : VSMDrawPagesTaskBase
 
         auto & cmd_list = ti.get_recorder();
         cmd_list.destroy_image_view_deferred(daxa_u32_image_view);
+        // The measured draw time sizes the page budget of the following frames
+        const daxa_u32 query_offset = (*frame_index % Context::frames_in_flight) * 2;
+        cmd_list.reset_timestamps({
+            .query_pool = context->vsm_draw_timestamps,
+            .start_index = query_offset,
+            .count = 2
+        });
+        cmd_list.write_timestamp({
+            .query_pool = context->vsm_draw_timestamps,
+            .pipeline_stage = daxa::PipelineStageFlagBits::TOP_OF_PIPE,
+            .query_index = query_offset
+        });
         cmd_list.set_uniform_buffer(ti.uses.get_uniform_buffer_info());
         auto render_cmd_list = std::move(cmd_list).begin_renderpass({
             .color_attachments = 
@@ -75,20 +91,34 @@ struct VSMDrawPagesTask : VSMDrawPagesTaskBase
             .render_area = {.x = 0, .y = 0, .width = resolution.x, .height = resolution.y}
         });
         render_cmd_list.set_pipeline(*(context->pipelines.vsm_draw_pages));
-        render_cmd_list.push_constant(VSMDrawPagesPC{
-            .llb_sampler = context->linear_sampler,
-            .daxa_u32_vsm_memory_view = daxa_u32_image_view
-        });
         render_cmd_list.set_index_buffer({
             .id = uses._indices.buffer(),
             .offset = 0,
             .index_type = daxa::IndexType::uint32 
         });
-        render_cmd_list.draw_indexed({
-            .index_count = static_cast<daxa_u32>(context->terrain_index_size),
-            .instance_count = VSM_CLIP_LEVELS
-        });
+        // One draw per clip level, the clip level is pushed per draw so that a non zero first instance,
+        // which needs the drawIndirectFirstInstance feature, is never used
+        for(daxa_u32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
+        {
+            render_cmd_list.push_constant(VSMDrawPagesPC{
+                .llb_sampler = context->linear_sampler,
+                .daxa_u32_vsm_memory_view = daxa_u32_image_view,
+                .clip_level = clip_level
+            });
+            render_cmd_list.draw_indirect({
+                .draw_command_buffer = uses._vsm_terrain_draw_commands.buffer(),
+                .indirect_buffer_offset = clip_level * sizeof(DrawIndexedIndirectStruct),
+                .draw_count = 1,
+                .draw_command_stride = static_cast<daxa_u32>(sizeof(DrawIndexedIndirectStruct)),
+                .is_indexed = true
+            });
+        }
         cmd_list = std::move(render_cmd_list).end_renderpass();
+        cmd_list.write_timestamp({
+            .query_pool = context->vsm_draw_timestamps,
+            .pipeline_stage = daxa::PipelineStageFlagBits::BOTTOM_OF_PIPE,
+            .query_index = query_offset + 1
+        });
     }
 };
 #endif //__cplusplus
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <daxa/daxa.inl>
+#include <daxa/utils/task_graph.inl>
+
+#include "../shared/shared.inl"
+
+DAXA_DECL_TASK_USES_BEGIN(VSMPrioritizeRequestsTaskBase, DAXA_UNIFORM_BUFFER_SLOT0)
+DAXA_TASK_USE_BUFFER(_globals, daxa_BufferPtr(Globals), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_vsm_page_request_count, daxa_BufferPtr(AllocationCount), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_vsm_page_requests, daxa_BufferPtr(AllocationRequest), COMPUTE_SHADER_READ)
+DAXA_TASK_USE_BUFFER(_vsm_allocation_count, daxa_BufferPtr(AllocationCount), COMPUTE_SHADER_WRITE)
+DAXA_TASK_USE_BUFFER(_vsm_allocation_buffer, daxa_BufferPtr(AllocationRequest), COMPUTE_SHADER_WRITE)
+DAXA_TASK_USE_BUFFER(_vsm_allocate_indirect, daxa_BufferPtr(DispatchIndirectStruct), COMPUTE_SHADER_WRITE)
+DAXA_TASK_USE_BUFFER(_vsm_clear_indirect, daxa_BufferPtr(DispatchIndirectStruct), COMPUTE_SHADER_WRITE)
+DAXA_TASK_USE_BUFFER(_vsm_clear_dirty_bit_indirect, daxa_BufferPtr(DispatchIndirectStruct), COMPUTE_SHADER_WRITE)
+DAXA_TASK_USE_BUFFER(_vsm_statistics, daxa_BufferPtr(VSMStatistics), COMPUTE_SHADER_READ_WRITE)
+DAXA_TASK_USE_IMAGE(_vsm_page_request_coverage, REGULAR_2D_ARRAY, COMPUTE_SHADER_STORAGE_READ_ONLY)
+DAXA_TASK_USE_IMAGE(_vsm_page_table, REGULAR_2D_ARRAY, COMPUTE_SHADER_STORAGE_READ_WRITE)
+DAXA_DECL_TASK_USES_END()
+
+#if __cplusplus
+#include "../context.hpp"
+
+inline auto get_vsm_prioritize_requests_pipeline() -> daxa::ComputePipelineCompileInfo {
+    return {
+        .shader_info = { .source = daxa::ShaderFile{"vsm_prioritize_requests.glsl"}, },
+        .name = "vsm_prioritize_requests"
+    };
+}
+
+struct VSMPrioritizeRequestsTask : VSMPrioritizeRequestsTaskBase
+{
+    Context * context = {};
+
+    void callback(daxa::TaskInterface ti)
+    {
+        auto & cmd_list = ti.get_recorder();
+        cmd_list.set_uniform_buffer(ti.uses.get_uniform_buffer_info());
+        cmd_list.set_pipeline(*(context->pipelines.vsm_prioritize_requests));
+        // A single workgroup sorts all the requests so the bucket offsets can live in shared memory
+        cmd_list.dispatch(1);
+    }
+};
+#endif //__cplusplus
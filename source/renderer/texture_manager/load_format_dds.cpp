@@ -3,6 +3,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <optional>
 
 #include "dds_types.hpp"
 #include "../../utils.hpp"
@@ -10,10 +11,13 @@
 template <typename T>
 inline constexpr bool has_bit(T value, T bit) { return (value & bit) == bit; }
 
-auto load_dds_data(std::string const & filepath, daxa::Device device) -> LoadedImageInfo
+auto load_dds_data(std::string const & filepath, daxa::Device device, LoadProfiler & profiler) -> LoadedImageInfo
 {
     DBG_ASSERT_TRUE_M(sizeof(DDSHeader) == 124, "[load_format_dds.cpp] DDS Header size mismatch. Must be 124 bytes");
 
+    // Emplacing the next stage records the previous one
+    std::optional<LoadProfiler::ScopedStage> stage;
+    stage.emplace(profiler, filepath, LoadStage::OPEN);
     std::ifstream filestream(filepath, std::ios::binary | std::ios::in);
     if (!filestream.is_open()) 
     { 
@@ -22,6 +26,9 @@ auto load_dds_data(std::string const & filepath, daxa::Device device) -> LoadedI
 
     filestream.seekg(0, std::ios::end);
     auto file_size = filestream.tellg();
+    stage->set_bytes(static_cast<daxa_u64>(file_size));
+
+    stage.emplace(profiler, filepath, LoadStage::HEADER_PARSE);
 
     // Read the header
     if (file_size < sizeof(DDSHeader)) 
@@ -131,17 +138,20 @@ auto load_dds_data(std::string const & filepath, daxa::Device device) -> LoadedI
         .name = "dds mem req tmp image"
     };
     auto const memory_requirements = device.get_memory_requirements(tmp_info);
-    DBG_ASSERT_TRUE_M(memory_requirements.size == data_size, "TODO(msakmary) bug or compressed texture?");
+    // Small images (the atmosphere LUTs) are padded to the allocation alignment, the file only holds the tightly packed texels
+    DBG_ASSERT_TRUE_M(data_size <= memory_requirements.size, "TODO(msakmary) bug or compressed texture?");
 
+    stage.emplace(profiler, filepath, LoadStage::STAGING_COPY);
     auto staging_buffer_id = device.create_buffer({
-        .size = static_cast<daxa_u32>(memory_requirements.size),
+        .size = data_size,
         .allocate_info = daxa::MemoryFlagBits::HOST_ACCESS_RANDOM,
         .name = "dds image staging buffer"
     });
 
     auto staging_buffer_ptr = device.get_host_address_as<char>(staging_buffer_id).value();
-    filestream.read(staging_buffer_ptr, memory_requirements.size);
+    filestream.read(staging_buffer_ptr, data_size);
     filestream.close();
+    stage->set_bytes(data_size);
     return {
         .format = format,
         .staging_buffer_id = staging_buffer_id, 
@@ -151,4 +161,49 @@ auto load_dds_data(std::string const & filepath, daxa::Device device) -> LoadedI
             static_cast<daxa_i32>(header.depth)
         }
     };
-}
\ No newline at end of file
+}
+
+void write_dds_rgba32f(std::string const & filepath, daxa_u32vec2 resolution, std::span<daxa_f32vec4 const> texels)
+{
+    DBG_ASSERT_TRUE_M(texels.size() == size_t(resolution.x) * resolution.y, "[write_dds_rgba32f()] Texel count does not match the resolution");
+
+    std::ofstream filestream(filepath, std::ios::binary | std::ios::out);
+    if (!filestream.is_open())
+    {
+        throw std::runtime_error("[write_dds_rgba32f()] Error unable to open file: " + filepath);
+    }
+
+    const daxa_u32 dds_magic = DdsMagicNumber::DDS;
+    DDSHeader header = {};
+    header.size = sizeof(DDSHeader);
+    header.flags = static_cast<HeaderFlags>(HeaderFlags::Texture | HeaderFlags::Pitch);
+    header.height = resolution.y;
+    header.width = resolution.x;
+    header.pitch = resolution.x * static_cast<daxa_u32>(sizeof(daxa_f32vec4));
+    // The loader expects a depth of one for 2D images
+    header.depth = 1;
+    header.mipmapCount = 1;
+    header.pixelFormat.size = sizeof(FilePixelFormat);
+    header.pixelFormat.flags = PixelFormatFlags::FourCC;
+    header.pixelFormat.fourCC = DdsMagicNumber::DX10;
+    // DDSCAPS_TEXTURE
+    header.caps1 = 0x1000;
+
+    const Dx10Header additional_header = {
+        .dxgiFormat = DXGI_FORMAT_R32G32B32A32_FLOAT,
+        // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+        .resourceDimension = 3,
+        .miscFlags = 0,
+        .arraySize = 1,
+        .miscFlags2 = 0
+    };
+
+    filestream.write(reinterpret_cast<char const *>(&dds_magic), sizeof(dds_magic));
+    filestream.write(reinterpret_cast<char const *>(&header), sizeof(DDSHeader));
+    filestream.write(reinterpret_cast<char const *>(&additional_header), sizeof(Dx10Header));
+    filestream.write(reinterpret_cast<char const *>(texels.data()), static_cast<std::streamsize>(texels.size_bytes()));
+    if (!filestream.good())
+    {
+        throw std::runtime_error("[write_dds_rgba32f()] Error writing file: " + filepath);
+    }
+}
@@ -9,6 +9,8 @@
 #include <ImfRgbaFile.h>
 #include <OpenEXRConfig.h>
 
+#include <filesystem>
+
 using namespace OPENEXR_IMF_NAMESPACE;
 using namespace IMATH_NAMESPACE;
 
@@ -170,30 +172,39 @@ auto load_texture_data(CreateStagingBufferInfo & info) -> daxa::BufferId
     return new_buffer_id;
 }
 
-auto load_exr_data(std::string const & filepath, daxa::Device device) -> LoadedImageInfo
+auto load_exr_data(std::string const & filepath, daxa::Device device, LoadProfiler & profiler) -> LoadedImageInfo
 {
     setGlobalThreadCount(8);
     std::unique_ptr<InputFile> file;
-    try 
-    {
-        // Open the EXR file and read its header
-        file = std::make_unique<InputFile>(filepath.c_str());
-    } 
-    catch (const std::exception &e) 
     {
-        throw std::runtime_error("[load_exr_data()] Error when reading file: " + filepath + " " + e.what());
+        auto open_stage = profiler.scoped_stage(filepath, LoadStage::OPEN);
+        try 
+        {
+            // Open the EXR file and read its header
+            file = std::make_unique<InputFile>(filepath.c_str());
+        } 
+        catch (const std::exception &e) 
+        {
+            throw std::runtime_error("[load_exr_data()] Error when reading file: " + filepath + " " + e.what());
+        }
+        open_stage.set_bytes(std::filesystem::file_size(filepath));
     }
 
-    Box2i data_window = file->header().dataWindow();
-    daxa_i32vec2 resolution = {
-        data_window.max.x - data_window.min.x + 1,
-        data_window.max.y - data_window.min.y + 1
-    };
-    DBG_ASSERT_TRUE_M(data_window.min.x == 0 && data_window.min.y == 0, "TODO(msakmary) Allocate does not handle this case");
+    daxa_i32vec2 resolution;
+    ElemType texture_elem;
+    {
+        auto header_stage = profiler.scoped_stage(filepath, LoadStage::HEADER_PARSE);
+        Box2i data_window = file->header().dataWindow();
+        resolution = {
+            data_window.max.x - data_window.min.x + 1,
+            data_window.max.y - data_window.min.y + 1
+        };
+        DBG_ASSERT_TRUE_M(data_window.min.x == 0 && data_window.min.y == 0, "TODO(msakmary) Allocate does not handle this case");
 
-    DEBUG_OUT("=========== Loaded texture header: " << filepath << " ===========");
+        DEBUG_OUT("=========== Loaded texture header: " << filepath << " ===========");
 
-    auto texture_elem = get_texture_element(file);
+        texture_elem = get_texture_element(file);
+    }
 
     DEBUG_OUT("Size " << resolution.x << "x" << resolution.y);
     DEBUG_OUT("Format " << daxa::to_string(texture_elem.format));
@@ -207,6 +218,8 @@ auto load_exr_data(std::string const & filepath, daxa::Device device) -> LoadedI
         .file = file
     };
 
+    // OpenEXR decodes straight into the host visible staging buffer so there is no separate staging copy stage
+    auto decode_stage = profiler.scoped_stage(filepath, LoadStage::DECODE);
     daxa::BufferId staging_buffer_id;
     switch(texture_elem.elem_cnt)
     {
@@ -237,6 +250,7 @@ auto load_exr_data(std::string const & filepath, daxa::Device device) -> LoadedI
             break;
         }
     }
+    decode_stage.set_bytes(device.info_buffer(staging_buffer_id).value().size);
     return {
         .format = texture_elem.format,
         .staging_buffer_id = staging_buffer_id,
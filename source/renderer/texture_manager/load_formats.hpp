@@ -1,10 +1,13 @@
 #pragma once
 
+#include <span>
 #include <string>
 
 #include <daxa/daxa.hpp>
 using namespace daxa::types;
 
+#include "load_profiler.hpp"
+
 struct LoadedImageInfo
 {
     daxa::Format format;
@@ -12,5 +15,7 @@ struct LoadedImageInfo
     daxa_i32vec3 resolution = {-1, -1, -1};
 };
 
-auto load_exr_data(std::string const & filepath, daxa::Device device) -> LoadedImageInfo;
-auto load_dds_data(std::string const & filepath, daxa::Device device) -> LoadedImageInfo;
\ No newline at end of file
+auto load_exr_data(std::string const & filepath, daxa::Device device, LoadProfiler & profiler) -> LoadedImageInfo;
+auto load_dds_data(std::string const & filepath, daxa::Device device, LoadProfiler & profiler) -> LoadedImageInfo;
+// Writes an uncompressed R32G32B32A32_FLOAT 2D image with a DX10 header, the layout load_dds_data() reads back
+void write_dds_rgba32f(std::string const & filepath, daxa_u32vec2 resolution, std::span<daxa_f32vec4 const> texels);
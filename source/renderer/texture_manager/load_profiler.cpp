@@ -0,0 +1,163 @@
+#include "load_profiler.hpp"
+
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include "../../utils.hpp"
+
+LoadProfiler::ScopedStage::ScopedStage(LoadProfiler & profiler, std::string_view asset, LoadStage stage) :
+    profiler{profiler},
+    asset{asset},
+    stage{stage},
+    start{Clock::now()}
+{
+}
+
+void LoadProfiler::ScopedStage::set_bytes(daxa_u64 processed_bytes)
+{
+    bytes = processed_bytes;
+}
+
+LoadProfiler::ScopedStage::~ScopedStage()
+{
+    profiler.record(asset, stage, start, Clock::now(), bytes);
+}
+
+LoadProfiler::LoadProfiler() : epoch{Clock::now()}
+{
+}
+
+auto LoadProfiler::scoped_stage(std::string_view asset, LoadStage stage) -> ScopedStage
+{
+    return ScopedStage(*this, asset, stage);
+}
+
+void LoadProfiler::record(std::string_view asset, LoadStage stage, Clock::time_point start, Clock::time_point end, daxa_u64 bytes)
+{
+    using namespace std::chrono;
+    auto const start_us = duration_cast<microseconds>(start - epoch).count();
+    auto const duration_us = duration_cast<microseconds>(end - start).count();
+
+    auto lock = std::lock_guard(records_mutex);
+    records.push_back({
+        .asset = std::string(asset),
+        .stage = stage,
+        .start_us = static_cast<daxa_u64>(start_us),
+        .duration_us = static_cast<daxa_u64>(duration_us),
+        .bytes = bytes,
+        .thread_id = static_cast<daxa_u64>(std::hash<std::thread::id>{}(std::this_thread::get_id()))
+    });
+    DEBUG_OUT("[LoadProfiler::record()] " << asset << " " << load_stage_names.at(static_cast<daxa_u32>(stage)) <<
+              " took " << duration_us / 1000.0 << " ms (" << bytes << " bytes)");
+}
+
+auto LoadProfiler::get_records() const -> std::vector<LoadStageRecord>
+{
+    auto lock = std::lock_guard(records_mutex);
+    return records;
+}
+
+void LoadProfiler::clear()
+{
+    auto lock = std::lock_guard(records_mutex);
+    records.clear();
+}
+
+void LoadProfiler::write_summary(std::string const & path) const
+{
+    struct StageTotal
+    {
+        daxa_u64 duration_us = 0;
+        daxa_u64 bytes = 0;
+        daxa_u32 count = 0;
+    };
+
+    auto const local_records = get_records();
+    // Ordered maps so that the summary is stable between runs
+    std::map<std::string, std::map<std::string_view, StageTotal>> per_asset;
+    std::map<std::string_view, StageTotal> per_stage;
+    daxa_u64 total_duration_us = 0;
+
+    for(auto const & record : local_records)
+    {
+        auto const stage_name = load_stage_names.at(static_cast<daxa_u32>(record.stage));
+        for(auto * total : {&per_asset[record.asset][stage_name], &per_stage[stage_name]})
+        {
+            total->duration_us += record.duration_us;
+            total->bytes += record.bytes;
+            total->count += 1;
+        }
+        total_duration_us += record.duration_us;
+    }
+
+    auto total_to_json = [](StageTotal const & total) -> nlohmann::json
+    {
+        auto const seconds = static_cast<daxa_f64>(total.duration_us) / 1'000'000.0;
+        return {
+            {"count", total.count},
+            {"duration_ms", static_cast<daxa_f64>(total.duration_us) / 1000.0},
+            {"bytes", total.bytes},
+            {"throughput_mb_s", seconds > 0.0 ? (static_cast<daxa_f64>(total.bytes) / (1024.0 * 1024.0)) / seconds : 0.0}
+        };
+    };
+
+    auto json = nlohmann::json {};
+    json["total_duration_ms"] = static_cast<daxa_f64>(total_duration_us) / 1000.0;
+    for(auto const & [stage_name, total] : per_stage)
+    {
+        json["stages"][std::string(stage_name)] = total_to_json(total);
+    }
+    for(auto const & [asset, stages] : per_asset)
+    {
+        for(auto const & [stage_name, total] : stages)
+        {
+            json["assets"][asset][std::string(stage_name)] = total_to_json(total);
+        }
+    }
+
+    auto f = std::ofstream(path);
+    if(!f.is_open())
+    {
+        throw std::runtime_error("[LoadProfiler::write_summary()] Error unable to open file: " + path);
+    }
+    f << std::setw(4) << json;
+}
+
+void LoadProfiler::write_chrome_trace(std::string const & path) const
+{
+    auto const local_records = get_records();
+
+    auto events = nlohmann::json::array();
+    for(auto const & record : local_records)
+    {
+        events.push_back({
+            {"name", std::string(load_stage_names.at(static_cast<daxa_u32>(record.stage)))},
+            {"cat", "asset load"},
+            {"ph", "X"},
+            {"ts", record.start_us},
+            {"dur", record.duration_us},
+            {"pid", 0},
+            {"tid", record.thread_id},
+            {"args", {
+                {"asset", record.asset},
+                {"bytes", record.bytes}
+            }}
+        });
+    }
+
+    auto json = nlohmann::json {};
+    json["traceEvents"] = events;
+    json["displayTimeUnit"] = "ms";
+
+    auto f = std::ofstream(path);
+    if(!f.is_open())
+    {
+        throw std::runtime_error("[LoadProfiler::write_chrome_trace()] Error unable to open file: " + path);
+    }
+    f << json;
+}
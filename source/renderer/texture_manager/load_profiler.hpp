@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+enum struct LoadStage : daxa_u32
+{
+    OPEN,
+    HEADER_PARSE,
+    DECODE,
+    STAGING_COPY,
+    GPU_UPLOAD,
+    COMPRESS,
+    NORMALS,
+    COUNT
+};
+
+static constexpr std::array<std::string_view, static_cast<daxa_u32>(LoadStage::COUNT)> load_stage_names = {
+    "open",
+    "header parse",
+    "decode",
+    "staging copy",
+    "gpu upload",
+    "compress",
+    "normals"
+};
+
+struct LoadStageRecord
+{
+    std::string asset;
+    LoadStage stage;
+    // Both relative to the creation of the owning LoadProfiler
+    daxa_u64 start_us;
+    daxa_u64 duration_us;
+    daxa_u64 bytes;
+    daxa_u64 thread_id;
+};
+
+struct LoadProfiler
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Records the lifetime of the scope as one stage of the asset load,
+    // bytes can be filled in later once the amount of processed data is known
+    struct ScopedStage
+    {
+        ScopedStage(ScopedStage const &) = delete;
+        ScopedStage & operator= (ScopedStage const &) = delete;
+
+        ScopedStage(LoadProfiler & profiler, std::string_view asset, LoadStage stage);
+        ~ScopedStage();
+
+        void set_bytes(daxa_u64 processed_bytes);
+
+        private:
+            LoadProfiler & profiler;
+            std::string asset;
+            LoadStage stage;
+            daxa_u64 bytes = 0;
+            Clock::time_point start;
+    };
+
+    LoadProfiler();
+
+    [[nodiscard]] auto scoped_stage(std::string_view asset, LoadStage stage) -> ScopedStage;
+    void record(std::string_view asset, LoadStage stage, Clock::time_point start, Clock::time_point end, daxa_u64 bytes);
+    [[nodiscard]] auto get_records() const -> std::vector<LoadStageRecord>;
+    void clear();
+
+    // Per asset and per stage totals together with throughput
+    void write_summary(std::string const & path) const;
+    // Trace Event Format readable by chrome://tracing or https://ui.perfetto.dev
+    void write_chrome_trace(std::string const & path) const;
+
+    private:
+        Clock::time_point epoch;
+        mutable std::mutex records_mutex;
+        std::vector<LoadStageRecord> records;
+};
@@ -1,7 +1,9 @@
 #include "texture_manager.hpp"
 
 #include "../../utils.hpp"
+#include "../../frame_profiler.hpp"
 #include <array>
+#include <stdexcept>
 #include <variant>
 
 #include "load_formats.hpp"
@@ -131,45 +133,16 @@ TextureManager::TextureManager(TextureManagerInfo const & c_info) : info{c_info}
     compress_texture_task_graph.complete({});
 }
 
-#include <chrono>
-#include <atomic>
-
-namespace shino
-{
-    template <typename Clock = std::chrono::high_resolution_clock>
-    class stopwatch
-    {
-        const typename Clock::time_point start_point;
-    public:
-        stopwatch() : 
-            start_point(Clock::now())
-        {}
-
-        template <typename Rep = typename Clock::duration::rep, typename Units = typename Clock::duration>
-        Rep elapsed_time() const
-        {
-            std::atomic_thread_fence(std::memory_order_relaxed);
-            auto counted_time = std::chrono::duration_cast<Units>(Clock::now() - start_point).count();
-            std::atomic_thread_fence(std::memory_order_relaxed);
-            return static_cast<Rep>(counted_time);
-        }
-    };
-
-    using precise_stopwatch = stopwatch<>;
-    using system_stopwatch = stopwatch<std::chrono::system_clock>;
-    using monotonic_stopwatch = stopwatch<std::chrono::steady_clock>;
-};
-
 void TextureManager::load_texture(const LoadTextureInfo &load_info)
 {
+    PROFILE_SCOPE("load texture");
     LoadedImageInfo image_info;
-    shino::precise_stopwatch stopwatch;
 
-    if(load_info.filepath.ends_with(".exr"sv)) { image_info = load_exr_data(load_info.filepath, info.device); }
-    if(load_info.filepath.ends_with(".dds"sv)) { image_info = load_dds_data(load_info.filepath, info.device); }
+    if(load_info.filepath.ends_with(".exr"sv)) { image_info = load_exr_data(load_info.filepath, info.device, load_profiler); }
+    if(load_info.filepath.ends_with(".dds"sv)) { image_info = load_dds_data(load_info.filepath, info.device, load_profiler); }
 
-    auto actual_wait_time = stopwatch.elapsed_time<unsigned int, std::chrono::milliseconds>();
-    DEBUG_OUT("[TextureManager::loat_texture_data()] Load of " + load_info.filepath + " took " << actual_wait_time << " ms");
+    auto upload_stage = load_profiler.scoped_stage(load_info.filepath, LoadStage::GPU_UPLOAD);
+    upload_stage.set_bytes(info.device.info_buffer(image_info.staging_buffer_id).value().size);
 
     daxa_u32 const image_dimensions = 
         std::min(image_info.resolution.z - 1, 1) + 
@@ -209,16 +182,28 @@ void TextureManager::load_texture(const LoadTextureInfo &load_info)
     info.device.destroy_buffer(loaded_raw_data_buffer_id);
 }
 
+auto TextureManager::load_texture_staging(std::string const & filepath) -> LoadedImageInfo
+{
+    PROFILE_SCOPE("load texture staging");
+    if(filepath.ends_with(".exr"sv)) { return load_exr_data(filepath, info.device, load_profiler); }
+    if(filepath.ends_with(".dds"sv)) { return load_dds_data(filepath, info.device, load_profiler); }
+    throw std::runtime_error("[TextureManager::load_texture_staging()] Unsupported texture format " + filepath);
+}
+
 void TextureManager::normals_from_heightmap(const NormalsFromHeightInfo & normals_info)
 {
+    PROFILE_SCOPE("normals from heightmap");
+    auto normals_stage = load_profiler.scoped_stage(normals_info.asset_name, LoadStage::NORMALS);
     auto texture_dimensions = info.device.info_image(normals_info.height_texture.get_state().images[0]).value().size;
+    const daxa_u64 bytes_per_texel = normals_info.normals_format == daxa::Format::R32G32B32A32_SFLOAT ? 16 : 8;
+    normals_stage.set_bytes(static_cast<daxa_u64>(texture_dimensions.x) * texture_dimensions.y * bytes_per_texel);
     normals_info.height_texture.swap_images(normal_src_hdr_texture);
 
     normal_dst_hdr_texture.set_images({
         .images = {
             std::array{
                 info.device.create_image({
-                    .format = daxa::Format::R32G32B32A32_SFLOAT,
+                    .format = normals_info.normals_format,
                     .size = {static_cast<daxa_u32>(texture_dimensions.x), static_cast<daxa_u32>(texture_dimensions.y), 1},
                     .usage = daxa::ImageUsageFlagBits::SHADER_SAMPLED | daxa::ImageUsageFlagBits::SHADER_STORAGE,
                     .allocate_info = daxa::MemoryFlagBits::DEDICATED_MEMORY,
@@ -240,6 +225,8 @@ void TextureManager::normals_from_heightmap(const NormalsFromHeightInfo & normal
 
 void TextureManager::compress_hdr_texture(const CompressTextureInfo & compress_info)
 {
+    PROFILE_SCOPE("compress hdr texture");
+    auto compress_stage = load_profiler.scoped_stage(compress_info.asset_name, LoadStage::COMPRESS);
     auto texture_dimensions = info.device.info_image(compress_info.raw_texture.get_state().images[0]).value().size;
 
 	daxa_u32 width_round = (texture_dimensions.x + BC6HCompressTask::BC_BLOCK_SIZE - 1) / BC6HCompressTask::BC_BLOCK_SIZE;
@@ -275,6 +262,8 @@ void TextureManager::compress_hdr_texture(const CompressTextureInfo & compress_i
         },
     });
 
+    // Every BC6H block is 16 bytes
+    compress_stage.set_bytes(static_cast<daxa_u64>(width_round) * height_round * 16);
     compress_texture_task_graph.execute({});
     info.device.wait_idle();
 
@@ -287,6 +276,11 @@ void TextureManager::compress_hdr_texture(const CompressTextureInfo & compress_i
     compress_dst_bc6h_texture.set_images({});
 }
 
+auto TextureManager::get_load_profiler() const -> LoadProfiler const &
+{
+    return load_profiler;
+}
+
 TextureManager::~TextureManager()
 {
     info.device.destroy_sampler(nearest_sampler);
@@ -6,6 +6,9 @@
 #include <daxa/utils/task_graph.hpp>
 #include <daxa/utils/pipeline_manager.hpp>
 
+#include "load_formats.hpp"
+#include "load_profiler.hpp"
+
 struct LoadTextureInfo
 {
     std::string filepath;
@@ -16,12 +19,17 @@ struct CompressTextureInfo
 {
     daxa::TaskImage & raw_texture;
     daxa::TaskImage & compressed_texture;
+    // Only used to label the load profiler records
+    std::string asset_name = "unnamed";
 };
 
 struct NormalsFromHeightInfo
 {
     daxa::TaskImage & height_texture;
     daxa::TaskImage & normals_texture;
+    daxa::Format normals_format = daxa::Format::R32G32B32A32_SFLOAT;
+    // Only used to label the load profiler records
+    std::string asset_name = "unnamed";
 };
 
 struct TextureManagerInfo
@@ -37,8 +45,12 @@ struct TextureManager
 
     TextureManager(TextureManagerInfo const & info);
     void load_texture(const LoadTextureInfo & load_info);
+    // Only reads the texels into a host visible staging buffer owned by the caller, the copy into an image
+    // is left to the caller so it can be recorded into a frame instead of waiting for the device
+    [[nodiscard]] auto load_texture_staging(std::string const & filepath) -> LoadedImageInfo;
     void compress_hdr_texture(const CompressTextureInfo & compress_info);
     void normals_from_heightmap(const NormalsFromHeightInfo & normals_info);
+    [[nodiscard]] auto get_load_profiler() const -> LoadProfiler const &;
 
     ~TextureManager();
 
@@ -46,6 +58,7 @@ struct TextureManager
 
         bool should_compress = false;
         TextureManagerInfo info;
+        LoadProfiler load_profiler;
 
         // compress image resources
         std::shared_ptr<daxa::ComputePipeline> compress;
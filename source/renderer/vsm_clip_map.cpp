@@ -0,0 +1,152 @@
+#include "vsm_clip_map.hpp"
+
+#include <algorithm>
+
+#include "../utils.hpp"
+
+static auto directions_equal(daxa_f32vec3 const & first, daxa_f32vec3 const & second) -> bool
+{
+    return first.x == second.x && first.y == second.y && first.z == second.z;
+}
+
+static auto alignments_equal(ClipAlignment const & first, ClipAlignment const & second) -> bool
+{
+    return first.page_offset.x == second.page_offset.x &&
+           first.page_offset.y == second.page_offset.y &&
+           first.sun_height_offset == second.sun_height_offset;
+}
+
+void VSMClipMap::update(VSMClipMapUpdateInfo const & info)
+{
+    DBG_ASSERT_TRUE_M(
+        info.page_frusti_clip_level < 0 ||
+        info.page_frusti_dst.size() >= VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION * 8,
+        "[VSMClipMap::update()] Page frusti destination is too small"
+    );
+
+    auto curr_clip_projection = clip0_projection;
+    daxa_i32 sun_offset_factor = clip0_sun_offset_factor;
+    statistics.levels_updated = 0;
+
+    for(daxa_i32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
+    {
+        auto const & sun_direction = info.sun_directions[clip_level];
+        const bool sun_moved = !initialized || !directions_equal(sun_direction, last_sun_directions.at(clip_level));
+        if(!initialized || !directions_equal(sun_direction, sun_camera_direction))
+        {
+            info.sun_camera.set_front(daxa_f32vec3{ -sun_direction.x, -sun_direction.y, -sun_direction.z });
+            sun_camera_direction = sun_direction;
+        }
+        last_sun_directions.at(clip_level) = sun_direction;
+
+        info.sun_camera.set_projection_info(curr_clip_projection);
+        const auto alignment = info.sun_camera.get_clip_alignment(
+            &info.player_camera,
+            sun_direction,
+            curr_clip_projection,
+            sun_offset_factor
+        );
+
+        const bool level_moved = sun_moved || !alignments_equal(alignment, alignments.at(clip_level));
+        const bool write_page_frusti = clip_level == info.page_frusti_clip_level;
+        if(level_moved || write_page_frusti)
+        {
+            const auto align_page_info = info.sun_camera.align_clip_to_player(
+                &info.player_camera,
+                sun_direction,
+                info.page_frusti_dst,
+                write_page_frusti,
+                sun_offset_factor
+            );
+
+            if(level_moved)
+            {
+                clip_projections.at(clip_level) = VSMClipProjection{
+                    .camera_height_offset = align_page_info.sun_height_offset,
+                    .depth_page_offset = align_page_info.per_page_depth_offset,
+                    .page_offset = daxa_i32vec2{
+                        align_page_info.page_offset.x % VSM_PAGE_TABLE_RESOLUTION,
+                        align_page_info.page_offset.y % VSM_PAGE_TABLE_RESOLUTION
+                    },
+                    .offset = info.sun_camera.offset,
+                    .view = info.sun_camera.get_view_matrix(),
+                    .projection = info.sun_camera.get_projection_matrix(),
+                    .projection_view = info.sun_camera.get_projection_view_matrix(),
+                    .inv_projection_view = info.sun_camera.get_inv_view_proj_matrix()
+                };
+                info.sun_camera.write_frustum_vertices({ .vertices_dst = clip_frustum_vertices.at(clip_level) });
+
+                alignments.at(clip_level) = alignment;
+                dirty_levels.at(clip_level) = true;
+                statistics.levels_updated += 1;
+            }
+        }
+
+        // Pages which wrapped around the toroidal page table since the last frame need to be freed
+        free_wrapped_pages_info.at(clip_level).clear_offset = daxa_i32vec2(
+            alignment.page_offset.x - last_frame_offset.at(clip_level).x,
+            alignment.page_offset.y - last_frame_offset.at(clip_level).y
+        );
+        last_frame_offset.at(clip_level) = alignment.page_offset;
+        // Pages drawn with the previous sun direction no longer match the projection of the level
+        free_wrapped_pages_info.at(clip_level).clear_all = (initialized && sun_moved) ? 1u : 0u;
+
+        curr_clip_projection.left *= 2;
+        curr_clip_projection.right *= 2;
+        curr_clip_projection.top *= 2;
+        curr_clip_projection.bottom *= 2;
+        curr_clip_projection.near *= 2;
+        curr_clip_projection.far *= 2;
+        sun_offset_factor *= 2;
+    }
+
+    initialized = true;
+    statistics.total_levels_updated += statistics.levels_updated;
+    statistics.total_updates += 1;
+}
+
+auto VSMClipMap::get_clip0_texel_world_size() const -> daxa_f32
+{
+    return (clip0_projection.right - clip0_projection.left) / VSM_TEXTURE_RESOLUTION;
+}
+
+auto VSMClipMap::get_clip_projections() const -> std::array<VSMClipProjection, VSM_CLIP_LEVELS> const &
+{
+    return clip_projections;
+}
+
+auto VSMClipMap::get_free_wrapped_pages_info() const -> std::array<FreeWrappedPagesInfo, VSM_CLIP_LEVELS> const &
+{
+    return free_wrapped_pages_info;
+}
+
+auto VSMClipMap::get_clip_frustum_vertices(daxa_i32 clip_level) const -> std::array<FrustumVertex, 8> const &
+{
+    return clip_frustum_vertices.at(clip_level);
+}
+
+auto VSMClipMap::get_dirty_level_range() const -> std::pair<daxa_u32, daxa_u32>
+{
+    daxa_u32 first = VSM_CLIP_LEVELS;
+    daxa_u32 last = 0;
+    for(daxa_u32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
+    {
+        if(!dirty_levels.at(clip_level)) { continue; }
+        first = std::min(first, clip_level);
+        last = clip_level + 1;
+    }
+    if(first >= last) { return {0, 0}; }
+    return {first, last};
+}
+
+void VSMClipMap::clear_dirty_levels()
+{
+    const auto [first, last] = get_dirty_level_range();
+    statistics.levels_uploaded = last - first;
+    dirty_levels.fill(false);
+}
+
+auto VSMClipMap::get_statistics() const -> VSMClipMapStatistics const &
+{
+    return statistics;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <utility>
+
+#include "../camera.hpp"
+#include "shared/shared.inl"
+
+struct VSMClipMapUpdateInfo
+{
+    Camera const & player_camera;
+    Camera & sun_camera;
+    // Each clip level is aligned to its own sun direction, see VSMSunInvalidation
+    std::span<daxa_f32vec3 const, VSM_CLIP_LEVELS> sun_directions;
+    // Page frusti of this clip level are written into page_frusti_dst, -1 for none
+    daxa_i32 page_frusti_clip_level = -1;
+    std::span<FrustumVertex> page_frusti_dst = {};
+};
+
+struct VSMClipMapStatistics
+{
+    daxa_u32 levels_updated;
+    daxa_u32 levels_uploaded;
+    daxa_u64 total_levels_updated;
+    daxa_u64 total_updates;
+};
+
+// Clip levels are only realigned when the player crosses a page (or height) boundary of that level
+// or when the sun direction of the level changes, coarser levels thus stay untouched for most of the frames.
+// A level with a new sun direction has all its pages freed by the free wrapped pages pass
+struct VSMClipMap
+{
+    static constexpr OrthographicInfo clip0_projection = OrthographicInfo {
+        .left   = -10.0f,
+        .right  =  10.0f,
+        .top    =  10.0f,
+        .bottom = -10.0f,
+        .near   =  1.0f,
+        .far    =  100.0f
+    };
+    static constexpr daxa_i32 clip0_sun_offset_factor = 50;
+
+    void update(VSMClipMapUpdateInfo const & info);
+
+    [[nodiscard]] auto get_clip0_texel_world_size() const -> daxa_f32;
+    [[nodiscard]] auto get_clip_projections() const -> std::array<VSMClipProjection, VSM_CLIP_LEVELS> const &;
+    [[nodiscard]] auto get_free_wrapped_pages_info() const -> std::array<FreeWrappedPagesInfo, VSM_CLIP_LEVELS> const &;
+    [[nodiscard]] auto get_clip_frustum_vertices(daxa_i32 clip_level) const -> std::array<FrustumVertex, 8> const &;
+
+    // First and one past the last clip level changed since the last clear_dirty_levels(), empty when nothing changed
+    [[nodiscard]] auto get_dirty_level_range() const -> std::pair<daxa_u32, daxa_u32>;
+    void clear_dirty_levels();
+
+    [[nodiscard]] auto get_statistics() const -> VSMClipMapStatistics const &;
+
+    private:
+        bool initialized = false;
+        std::array<daxa_f32vec3, VSM_CLIP_LEVELS> last_sun_directions = {};
+        // Direction the sun camera currently faces against
+        daxa_f32vec3 sun_camera_direction = {0.0f, 0.0f, 0.0f};
+        std::array<ClipAlignment, VSM_CLIP_LEVELS> alignments = {};
+        std::array<bool, VSM_CLIP_LEVELS> dirty_levels = {};
+
+        std::array<VSMClipProjection, VSM_CLIP_LEVELS> clip_projections = {};
+        std::array<FreeWrappedPagesInfo, VSM_CLIP_LEVELS> free_wrapped_pages_info = {};
+        std::array<daxa_i32vec2, VSM_CLIP_LEVELS> last_frame_offset = {};
+        std::array<std::array<FrustumVertex, 8>, VSM_CLIP_LEVELS> clip_frustum_vertices = {};
+
+        VSMClipMapStatistics statistics = {};
+};
@@ -0,0 +1,155 @@
+#include "vsm_dirty_pyramid.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "../utils.hpp"
+#include "vsm_simulator.hpp"
+
+static constexpr daxa_i32 PAGE_TABLE_RESOLUTION = VSM_PAGE_TABLE_RESOLUTION;
+
+static auto transform(daxa_f32mat4x4 const & matrix, daxa_f32vec4 vector) -> daxa_f32vec4
+{
+    return {
+        matrix.x.x * vector.x + matrix.y.x * vector.y + matrix.z.x * vector.z + matrix.w.x * vector.w,
+        matrix.x.y * vector.x + matrix.y.y * vector.y + matrix.z.y * vector.z + matrix.w.y * vector.w,
+        matrix.x.z * vector.x + matrix.y.z * vector.y + matrix.z.z * vector.z + matrix.w.z * vector.w,
+        matrix.x.w * vector.x + matrix.y.w * vector.y + matrix.z.w * vector.z + matrix.w.w * vector.w
+    };
+}
+
+auto get_vsm_dirty_pyramid_texel_index(daxa_i32 level, daxa_i32vec2 texel_coords) -> daxa_u32
+{
+    const daxa_u32 level_resolution = static_cast<daxa_u32>(PAGE_TABLE_RESOLUTION) >> level;
+    const daxa_u32 finest_texels = static_cast<daxa_u32>(PAGE_TABLE_RESOLUTION * PAGE_TABLE_RESOLUTION);
+    const daxa_u32 level_offset = (4u * (finest_texels - level_resolution * level_resolution)) / 3u;
+    return level_offset + static_cast<daxa_u32>(texel_coords.y) * level_resolution + static_cast<daxa_u32>(texel_coords.x);
+}
+
+auto get_vsm_page_rect(VSMClipProjection const & clip_projection, daxa_f32vec3 min_bounds, daxa_f32vec3 max_bounds) -> std::optional<VSMPageRect>
+{
+    auto min_uv = daxa_f32vec2{1.0e30f, 1.0e30f};
+    auto max_uv = daxa_f32vec2{-1.0e30f, -1.0e30f};
+    for(daxa_u32 corner = 0; corner < 8; corner++)
+    {
+        const auto position = daxa_f32vec4{
+            ((corner & 1) != 0 ? max_bounds.x : min_bounds.x) + static_cast<daxa_f32>(clip_projection.offset.x),
+            ((corner & 2) != 0 ? max_bounds.y : min_bounds.y) + static_cast<daxa_f32>(clip_projection.offset.y),
+            ((corner & 4) != 0 ? max_bounds.z : min_bounds.z) + static_cast<daxa_f32>(clip_projection.offset.z),
+            1.0f
+        };
+        const auto projected = transform(clip_projection.projection_view, position);
+        const auto uv = daxa_f32vec2{
+            (projected.x / projected.w + 1.0f) * 0.5f,
+            (projected.y / projected.w + 1.0f) * 0.5f
+        };
+        min_uv = {std::min(min_uv.x, uv.x), std::min(min_uv.y, uv.y)};
+        max_uv = {std::max(max_uv.x, uv.x), std::max(max_uv.y, uv.y)};
+    }
+    if(min_uv.x >= 1.0f || min_uv.y >= 1.0f || max_uv.x < 0.0f || max_uv.y < 0.0f) { return std::nullopt; }
+
+    auto to_page = [](daxa_f32 uv) -> daxa_i32
+    {
+        return std::clamp(static_cast<daxa_i32>(std::floor(uv * PAGE_TABLE_RESOLUTION)), 0, PAGE_TABLE_RESOLUTION - 1);
+    };
+    return VSMPageRect{
+        .min_page = {to_page(min_uv.x), to_page(min_uv.y)},
+        .max_page = {to_page(max_uv.x), to_page(max_uv.y)}
+    };
+}
+
+void VSMDirtyPyramidReference::build(std::span<VSMClipProjection const, VSM_CLIP_LEVELS> clip_projections, PageEntryGetter const & get_page_entry)
+{
+    for(daxa_i32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
+    {
+        pyramids.at(clip_level) = {};
+        const auto page_offset = clip_projections[clip_level].page_offset;
+        for(daxa_i32 y = 0; y < PAGE_TABLE_RESOLUTION; y++)
+        {
+            for(daxa_i32 x = 0; x < PAGE_TABLE_RESOLUTION; x++)
+            {
+                // GLSL mod(), the result has the sign of the divisor
+                const auto wrapped_coords = daxa_i32vec3{
+                    (((x - page_offset.x) % PAGE_TABLE_RESOLUTION) + PAGE_TABLE_RESOLUTION) % PAGE_TABLE_RESOLUTION,
+                    (((y - page_offset.y) % PAGE_TABLE_RESOLUTION) + PAGE_TABLE_RESOLUTION) % PAGE_TABLE_RESOLUTION,
+                    clip_level
+                };
+                const daxa_u32 page_entry = get_page_entry(wrapped_coords);
+                if((page_entry & VSM_PAGE_ALLOCATED_BIT) != 0 && (page_entry & VSM_PAGE_DIRTY_BIT) != 0)
+                {
+                    mark_dirty(clip_level, get_vsm_dirty_pyramid_texel_index(0, {x, y}));
+                }
+            }
+        }
+
+        for(daxa_i32 level = 1; level < VSM_DIRTY_PYRAMID_LEVELS; level++)
+        {
+            const daxa_i32 level_resolution = PAGE_TABLE_RESOLUTION >> level;
+            for(daxa_i32 y = 0; y < level_resolution; y++)
+            {
+                for(daxa_i32 x = 0; x < level_resolution; x++)
+                {
+                    const bool dirty =
+                        is_texel_dirty(clip_level, level - 1, {2 * x,     2 * y    }) ||
+                        is_texel_dirty(clip_level, level - 1, {2 * x + 1, 2 * y    }) ||
+                        is_texel_dirty(clip_level, level - 1, {2 * x,     2 * y + 1}) ||
+                        is_texel_dirty(clip_level, level - 1, {2 * x + 1, 2 * y + 1});
+                    if(dirty) { mark_dirty(clip_level, get_vsm_dirty_pyramid_texel_index(level, {x, y})); }
+                }
+            }
+        }
+    }
+}
+
+void VSMDirtyPyramidReference::mark_dirty(daxa_i32 clip_level, daxa_u32 texel_index)
+{
+    pyramids.at(clip_level).words[texel_index / 32] |= 1u << (texel_index % 32);
+}
+
+auto VSMDirtyPyramidReference::query(daxa_i32 clip_level, VSMPageRect const & page_rect) const -> bool
+{
+    DBG_ASSERT_TRUE_M(
+        page_rect.min_page.x >= 0 && page_rect.min_page.y >= 0 &&
+        page_rect.max_page.x < PAGE_TABLE_RESOLUTION && page_rect.max_page.y < PAGE_TABLE_RESOLUTION,
+        "[VSMDirtyPyramidReference::query()] Page rect is outside of the page table");
+
+    daxa_i32 level = 0;
+    while(level < VSM_DIRTY_PYRAMID_LEVELS - 1 && (
+        (page_rect.max_page.x >> level) - (page_rect.min_page.x >> level) >= VSM_DIRTY_PYRAMID_QUERY_TEXELS ||
+        (page_rect.max_page.y >> level) - (page_rect.min_page.y >> level) >= VSM_DIRTY_PYRAMID_QUERY_TEXELS))
+    {
+        level++;
+    }
+
+    for(daxa_i32 y = page_rect.min_page.y >> level; y <= page_rect.max_page.y >> level; y++)
+    {
+        for(daxa_i32 x = page_rect.min_page.x >> level; x <= page_rect.max_page.x >> level; x++)
+        {
+            if(is_texel_dirty(clip_level, level, {x, y})) { return true; }
+        }
+    }
+    return false;
+}
+
+auto VSMDirtyPyramidReference::is_texel_dirty(daxa_i32 clip_level, daxa_i32 level, daxa_i32vec2 texel_coords) const -> bool
+{
+    const daxa_u32 texel_index = get_vsm_dirty_pyramid_texel_index(level, texel_coords);
+    return (pyramids.at(clip_level).words[texel_index / 32] & (1u << (texel_index % 32))) != 0;
+}
+
+auto VSMDirtyPyramidReference::get_dirty_page_count(daxa_i32 clip_level) const -> daxa_u32
+{
+    // Level 0 fills the first VSM_PAGE_TABLE_RESOLUTION^2 bits, which is a whole number of words
+    daxa_u32 dirty_pages = 0;
+    for(daxa_u32 word = 0; word < (PAGE_TABLE_RESOLUTION * PAGE_TABLE_RESOLUTION) / 32; word++)
+    {
+        dirty_pages += static_cast<daxa_u32>(std::popcount(pyramids.at(clip_level).words[word]));
+    }
+    return dirty_pages;
+}
+
+auto VSMDirtyPyramidReference::get_pyramid(daxa_i32 clip_level) const -> VSMDirtyPyramid const &
+{
+    return pyramids.at(clip_level);
+}
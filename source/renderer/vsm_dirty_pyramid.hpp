@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <optional>
+#include <span>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+#include "shared/shared.inl"
+
+// Inclusive rect of unwrapped page coordinates of one clip level
+struct VSMPageRect
+{
+    daxa_i32vec2 min_page;
+    daxa_i32vec2 max_page;
+};
+
+// Mirrors vsm_dirty_pyramid_texel_index() in vsm_common.glsl
+[[nodiscard]] auto get_vsm_dirty_pyramid_texel_index(daxa_i32 level, daxa_i32vec2 texel_coords) -> daxa_u32;
+// Mirrors get_page_rect() in vsm_cull_terrain_patches.glsl, the bounds are in the same space as the
+// terrain positions of the page draw. Empty when the bounds miss the clip level
+[[nodiscard]] auto get_vsm_page_rect(VSMClipProjection const & clip_projection, daxa_f32vec3 min_bounds, daxa_f32vec3 max_bounds) -> std::optional<VSMPageRect>;
+
+// CPU port of vsm_build_dirty_pyramid.glsl and of the pyramid query of vsm_cull_terrain_patches.glsl.
+// Level 0 of the pyramid of a clip level holds one bit per page in unwrapped page coordinates which is set
+// for allocated dirty pages, every coarser level halves the resolution and ORs the four children
+struct VSMDirtyPyramidReference
+{
+    // Returns the page table entry of a wrapped page coordinate, the clip level is in z
+    using PageEntryGetter = std::function<daxa_u32(daxa_i32vec3)>;
+
+    void build(std::span<VSMClipProjection const, VSM_CLIP_LEVELS> clip_projections, PageEntryGetter const & get_page_entry);
+
+    // Tests the rect on the finest level where it spans at most VSM_DIRTY_PYRAMID_QUERY_TEXELS texels per axis
+    [[nodiscard]] auto query(daxa_i32 clip_level, VSMPageRect const & page_rect) const -> bool;
+    [[nodiscard]] auto is_texel_dirty(daxa_i32 clip_level, daxa_i32 level, daxa_i32vec2 texel_coords) const -> bool;
+    [[nodiscard]] auto get_dirty_page_count(daxa_i32 clip_level) const -> daxa_u32;
+    [[nodiscard]] auto get_pyramid(daxa_i32 clip_level) const -> VSMDirtyPyramid const &;
+
+    private:
+        void mark_dirty(daxa_i32 clip_level, daxa_u32 texel_index);
+
+        std::array<VSMDirtyPyramid, VSM_CLIP_LEVELS> pyramids = {};
+};
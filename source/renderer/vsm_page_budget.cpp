@@ -0,0 +1,70 @@
+#include "vsm_page_budget.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../utils.hpp"
+
+VSMPageBudget::VSMPageBudget(VSMPageBudgetInfo const & info) :
+    info{info},
+    budget{info.max_pages}
+{
+    DBG_ASSERT_TRUE_M(info.min_pages <= info.max_pages, "[VSMPageBudget::VSMPageBudget()] Min pages exceed max pages");
+    DBG_ASSERT_TRUE_M(info.max_pages <= MAX_NUM_VSM_ALLOC_REQUEST, "[VSMPageBudget::VSMPageBudget()] Allocation buffer is too small for max pages");
+}
+
+void VSMPageBudget::record_frame(daxa_u32 drawn_pages, daxa_f64 draw_ms)
+{
+    if(drawn_pages == 0)
+    {
+        fixed_draw_ms = fixed_cost_measured ? std::lerp(fixed_draw_ms, draw_ms, info.smoothing) : draw_ms;
+        fixed_cost_measured = true;
+    }
+    else
+    {
+        const daxa_f64 frame_page_draw_ms = std::max(draw_ms - fixed_draw_ms, 0.0) / static_cast<daxa_f64>(drawn_pages);
+        page_draw_ms = page_cost_measured ? std::lerp(page_draw_ms, frame_page_draw_ms, info.smoothing) : frame_page_draw_ms;
+        page_cost_measured = true;
+    }
+    update_budget();
+}
+
+void VSMPageBudget::set_info(VSMPageBudgetInfo const & new_info)
+{
+    DBG_ASSERT_TRUE_M(new_info.min_pages <= new_info.max_pages, "[VSMPageBudget::set_info()] Min pages exceed max pages");
+    DBG_ASSERT_TRUE_M(new_info.max_pages <= MAX_NUM_VSM_ALLOC_REQUEST, "[VSMPageBudget::set_info()] Allocation buffer is too small for max pages");
+    info = new_info;
+    update_budget();
+}
+
+void VSMPageBudget::update_budget()
+{
+    if(!page_cost_measured || page_draw_ms <= 0.0)
+    {
+        budget = info.max_pages;
+        return;
+    }
+    const daxa_f64 page_draw_time = std::max(info.target_draw_ms - fixed_draw_ms, 0.0);
+    const daxa_f64 fitting_pages = std::floor(page_draw_time / page_draw_ms);
+    budget = static_cast<daxa_u32>(std::clamp(fitting_pages, static_cast<daxa_f64>(info.min_pages), static_cast<daxa_f64>(info.max_pages)));
+}
+
+auto VSMPageBudget::get_budget() const -> daxa_u32
+{
+    return budget;
+}
+
+auto VSMPageBudget::get_fixed_draw_ms() const -> daxa_f64
+{
+    return fixed_draw_ms;
+}
+
+auto VSMPageBudget::get_page_draw_ms() const -> daxa_f64
+{
+    return page_draw_ms;
+}
+
+auto VSMPageBudget::get_info() const -> VSMPageBudgetInfo const &
+{
+    return info;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+#include "shared/shared.inl"
+
+struct VSMPageBudgetInfo
+{
+    // GPU time the page draw pass may take, the budget is the page count predicted to fit into it
+    daxa_f64 target_draw_ms = 1.0;
+    daxa_u32 min_pages = 16;
+    daxa_u32 max_pages = MAX_NUM_VSM_ALLOC_REQUEST;
+    // Weight of the newest measurement in the running averages of the draw cost
+    daxa_f64 smoothing = 0.1;
+};
+
+// Sizes the number of VSM pages allocated and drawn per frame from the measured cost of the page draw pass.
+// The pass only submits the terrain patches touching a dirty page, so the cost is modelled as a fixed part,
+// measured in frames which draw no pages, plus a part per drawn page. Until a frame
+// without pages was measured the fixed part is zero and the per page cost is overestimated, which only makes
+// the budget more conservative. Requests past the budget are serviced by the following frames
+struct VSMPageBudget
+{
+    explicit VSMPageBudget(VSMPageBudgetInfo const & info = {});
+
+    // Page count and GPU time of the page draw pass of a finished frame
+    void record_frame(daxa_u32 drawn_pages, daxa_f64 draw_ms);
+    void set_info(VSMPageBudgetInfo const & info);
+
+    // Pages the next frame may allocate, max_pages until the draw cost is known
+    [[nodiscard]] auto get_budget() const -> daxa_u32;
+    [[nodiscard]] auto get_fixed_draw_ms() const -> daxa_f64;
+    [[nodiscard]] auto get_page_draw_ms() const -> daxa_f64;
+    [[nodiscard]] auto get_info() const -> VSMPageBudgetInfo const &;
+
+    private:
+        void update_budget();
+
+        VSMPageBudgetInfo info;
+        daxa_f64 fixed_draw_ms = 0.0;
+        daxa_f64 page_draw_ms = 0.0;
+        bool fixed_cost_measured = false;
+        bool page_cost_measured = false;
+        daxa_u32 budget;
+};
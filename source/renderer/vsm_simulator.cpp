@@ -0,0 +1,481 @@
+#include "vsm_simulator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "../utils.hpp"
+
+static constexpr daxa_i32 PAGE_TABLE_RESOLUTION = VSM_PAGE_TABLE_RESOLUTION;
+
+// BIT 0 - 7 meta memory x coord, BIT 8 - 15 meta memory y coord
+static auto pack_meta_coords_to_page_entry(daxa_i32vec2 coords) -> daxa_u32
+{
+    return (static_cast<daxa_u32>(coords.y & 0xFF) << 8) | static_cast<daxa_u32>(coords.x & 0xFF);
+}
+
+static auto get_meta_coords_from_page_entry(daxa_u32 page_entry) -> daxa_i32vec2
+{
+    return { static_cast<daxa_i32>(page_entry & 0xFF), static_cast<daxa_i32>((page_entry >> 8) & 0xFF) };
+}
+
+// BIT 0 - 7 page x coord, BIT 8 - 15 page y coord, BIT 16 - 19 clip level
+static auto pack_page_coords_to_meta_entry(daxa_i32vec3 coords) -> daxa_u32
+{
+    return (static_cast<daxa_u32>(coords.z & 0xF) << 16) |
+           (static_cast<daxa_u32>(coords.y & 0xFF) << 8) |
+            static_cast<daxa_u32>(coords.x & 0xFF);
+}
+
+static auto get_page_coords_from_meta_entry(daxa_u32 meta_entry) -> daxa_i32vec3
+{
+    return {
+        static_cast<daxa_i32>(meta_entry & 0xFF),
+        static_cast<daxa_i32>((meta_entry >> 8) & 0xFF),
+        static_cast<daxa_i32>((meta_entry >> 16) & 0xF)
+    };
+}
+
+// GLSL mod(), the result has the sign of the divisor
+static auto wrap_page_coord(daxa_i32 coord) -> daxa_i32
+{
+    return ((coord % PAGE_TABLE_RESOLUTION) + PAGE_TABLE_RESOLUTION) % PAGE_TABLE_RESOLUTION;
+}
+
+auto get_vsm_eviction_bucket(daxa_u32 age, daxa_i32 clip_level) -> daxa_u32
+{
+    const daxa_u32 age_bucket = std::min(static_cast<daxa_u32>(std::bit_width(std::max(age, 1u))) - 1u, daxa_u32(VSM_EVICTION_AGE_BUCKETS - 1));
+    const daxa_u32 clip_group = (static_cast<daxa_u32>(clip_level) * VSM_EVICTION_CLIP_GROUPS) / VSM_CLIP_LEVELS;
+    return (VSM_EVICTION_AGE_BUCKETS - 1 - age_bucket) * VSM_EVICTION_CLIP_GROUPS + (VSM_EVICTION_CLIP_GROUPS - 1 - clip_group);
+}
+
+auto get_vsm_request_priority_bucket(daxa_i32 clip_level, daxa_u32 coverage) -> daxa_u32
+{
+    const daxa_u32 coverage_bin = std::min((static_cast<daxa_u32>(std::bit_width(std::max(coverage, 1u))) - 1u) / 2u, daxa_u32(VSM_REQUEST_COVERAGE_BINS - 1));
+    return static_cast<daxa_u32>(clip_level) * VSM_REQUEST_COVERAGE_BINS + (VSM_REQUEST_COVERAGE_BINS - 1 - coverage_bin);
+}
+
+auto VSMClipLevelStatistics::get_hit_rate() const -> daxa_f64
+{
+    if(requested_pages == 0) { return 1.0; }
+    return static_cast<daxa_f64>(hits) / static_cast<daxa_f64>(requested_pages);
+}
+
+auto VSMClipLevelStatistics::get_churn() const -> daxa_u64
+{
+    return allocations + evictions + wrapped_frees + invalidations;
+}
+
+auto VSMSimulatorStatistics::get_total() const -> VSMClipLevelStatistics
+{
+    auto total = VSMClipLevelStatistics{};
+    for(auto const & level : levels)
+    {
+        total.requested_pages += level.requested_pages;
+        total.hits += level.hits;
+        total.allocations += level.allocations;
+        total.allocation_failures += level.allocation_failures;
+        total.dropped_requests += level.dropped_requests;
+        total.deferred_requests += level.deferred_requests;
+        total.evictions += level.evictions;
+        total.wrapped_frees += level.wrapped_frees;
+        total.invalidations += level.invalidations;
+    }
+    return total;
+}
+
+VSMSimulator::VSMSimulator(VSMSimulatorInfo const & info) :
+    info{info},
+    page_table(PAGE_TABLE_RESOLUTION * PAGE_TABLE_RESOLUTION * VSM_CLIP_LEVELS, 0u),
+    meta_memory_table(info.meta_memory_resolution * info.meta_memory_resolution, 0u),
+    meta_memory_last_used(meta_memory_table.size(), 0u),
+    requested_frame(page_table.size(), 0ull),
+    request_coverage(page_table.size(), 0u)
+{
+    DBG_ASSERT_TRUE_M(info.meta_memory_resolution <= 256, "[VSMSimulator::VSMSimulator()] Meta memory coords are packed into 8 bits");
+    page_requests.reserve(info.max_page_requests);
+    allocation_requests.reserve(info.max_allocation_requests);
+    free_pages.reserve(info.max_allocation_requests);
+    for(auto & bucket : not_visited_buckets) { bucket.reserve(info.max_allocation_requests); }
+}
+
+void VSMSimulator::simulate_frame(VSMSimulatorFrameInfo const & frame_info)
+{
+    frame_statistics = VSMSimulatorStatistics{ .frames = 1, .levels = {} };
+
+    free_wrapped_pages(frame_info);
+    request_pages(frame_info);
+    prioritize_requests(frame_info.page_budget);
+    find_free_pages();
+    allocate_pages();
+    clear_pages();
+    dirty_pyramid.build(frame_info.clip_projections, [this](daxa_i32vec3 wrapped_page_coords) { return get_page_entry(wrapped_page_coords); });
+    clear_dirty_bits();
+    if(info.clear_visited_in_debug_pass) { clear_visited_flags(); }
+
+    frame_index += 1;
+    statistics.frames += 1;
+    for(daxa_u32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
+    {
+        auto & level = statistics.levels.at(clip_level);
+        auto const & frame_level = frame_statistics.levels.at(clip_level);
+        level.requested_pages += frame_level.requested_pages;
+        level.hits += frame_level.hits;
+        level.allocations += frame_level.allocations;
+        level.allocation_failures += frame_level.allocation_failures;
+        level.dropped_requests += frame_level.dropped_requests;
+        level.deferred_requests += frame_level.deferred_requests;
+        level.evictions += frame_level.evictions;
+        level.wrapped_frees += frame_level.wrapped_frees;
+        level.invalidations += frame_level.invalidations;
+    }
+}
+
+void VSMSimulator::reset()
+{
+    std::fill(page_table.begin(), page_table.end(), 0u);
+    std::fill(meta_memory_table.begin(), meta_memory_table.end(), 0u);
+    std::fill(meta_memory_last_used.begin(), meta_memory_last_used.end(), 0u);
+}
+
+// vsm_free_wrapped_pages.glsl
+void VSMSimulator::free_wrapped_pages(VSMSimulatorFrameInfo const & frame_info)
+{
+    for(daxa_i32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
+    {
+        const auto clear_offset = frame_info.free_wrapped_pages_info[clip_level].clear_offset;
+        const bool clear_all = frame_info.free_wrapped_pages_info[clip_level].clear_all != 0;
+        if(!clear_all && clear_offset.x == 0 && clear_offset.y == 0) { continue; }
+        const auto page_offset = frame_info.clip_projections[clip_level].page_offset;
+
+        for(daxa_i32 y = 0; y < PAGE_TABLE_RESOLUTION; y++)
+        {
+            for(daxa_i32 x = 0; x < PAGE_TABLE_RESOLUTION; x++)
+            {
+                const bool should_clear =
+                    clear_all ||
+                    (clear_offset.x > 0 && x < clear_offset.x) ||
+                    (clear_offset.x < 0 && x > PAGE_TABLE_RESOLUTION + (clear_offset.x - 1)) ||
+                    (clear_offset.y > 0 && y < clear_offset.y) ||
+                    (clear_offset.y < 0 && y > PAGE_TABLE_RESOLUTION + (clear_offset.y - 1));
+                if(!should_clear) { continue; }
+
+                auto & entry = page_entry({wrap_page_coord(x - page_offset.x), wrap_page_coord(y - page_offset.y), clip_level});
+                if((entry & VSM_PAGE_ALLOCATED_BIT) == 0) { continue; }
+                meta_entry(get_meta_coords_from_page_entry(entry)) = 0u;
+                entry = 0u;
+                auto & level_statistics = frame_statistics.levels.at(clip_level);
+                (clear_all ? level_statistics.invalidations : level_statistics.wrapped_frees) += 1;
+            }
+        }
+    }
+}
+
+// request_vsm_pages() in analyze_depthbuffer.glsl
+void VSMSimulator::request_pages(VSMSimulatorFrameInfo const & frame_info)
+{
+    page_requests.clear();
+    // Cleared by the upload task
+    std::fill(request_coverage.begin(), request_coverage.end(), 0u);
+    daxa_u32 page_request_count = 0;
+    for(auto const & request : frame_info.page_requests)
+    {
+        if(request.z < 0 || request.z >= VSM_CLIP_LEVELS) { continue; }
+        if(request.x < 0 || request.x > PAGE_TABLE_RESOLUTION - 1 || request.y < 0 || request.y > PAGE_TABLE_RESOLUTION - 1) { continue; }
+
+        const auto page_offset = frame_info.clip_projections[request.z].page_offset;
+        const auto wrapped_coords = daxa_i32vec3{
+            wrap_page_coord(request.x - page_offset.x),
+            wrap_page_coord(request.y - page_offset.y),
+            request.z
+        };
+        const auto page_index = (wrapped_coords.z * PAGE_TABLE_RESOLUTION + wrapped_coords.y) * PAGE_TABLE_RESOLUTION + wrapped_coords.x;
+        auto & entry = page_entry(wrapped_coords);
+        const bool is_allocated = (entry & VSM_PAGE_ALLOCATED_BIT) != 0;
+
+        auto & level_statistics = frame_statistics.levels.at(request.z);
+        auto & last_requested_frame = requested_frame.at(page_index);
+        if(last_requested_frame != statistics.frames + 1)
+        {
+            last_requested_frame = statistics.frames + 1;
+            level_statistics.requested_pages += 1;
+            if(is_allocated) { level_statistics.hits += 1; }
+        }
+
+        if(!is_allocated)
+        {
+            const daxa_u32 prev_coverage = request_coverage.at(page_index)++;
+            if(prev_coverage != 0) { continue; }
+            if(page_request_count++ < info.max_page_requests)
+            {
+                page_requests.push_back(wrapped_coords);
+                entry |= VSM_PAGE_REQUESTS_ALLOCATION_BIT;
+            }
+            else
+            {
+                level_statistics.dropped_requests += 1;
+            }
+        }
+        else if((entry & VSM_PAGE_VISITED_MARKED_BIT) == 0)
+        {
+            entry |= VSM_PAGE_VISITED_MARKED_BIT;
+            meta_entry(get_meta_coords_from_page_entry(entry)) |= VSM_META_VISITED_BIT;
+        }
+    }
+}
+
+// vsm_prioritize_requests.glsl, requests within a bucket keep the order in which they were made
+void VSMSimulator::prioritize_requests(daxa_u32 page_budget)
+{
+    auto priority_bucket = [&](daxa_i32vec3 coords)
+    {
+        const auto page_index = (coords.z * PAGE_TABLE_RESOLUTION + coords.y) * PAGE_TABLE_RESOLUTION + coords.x;
+        return get_vsm_request_priority_bucket(coords.z, request_coverage.at(page_index));
+    };
+    std::stable_sort(page_requests.begin(), page_requests.end(), [&](daxa_i32vec3 const & first, daxa_i32vec3 const & second)
+    {
+        return priority_bucket(first) < priority_bucket(second);
+    });
+
+    const size_t allocation_count = std::min({page_requests.size(), static_cast<size_t>(page_budget), static_cast<size_t>(info.max_allocation_requests)});
+    allocation_requests.assign(page_requests.begin(), page_requests.begin() + allocation_count);
+    for(size_t request = allocation_count; request < page_requests.size(); request++)
+    {
+        const auto request_coords = page_requests.at(request);
+        page_entry(request_coords) &= ~VSM_PAGE_REQUESTS_ALLOCATION_BIT;
+        frame_statistics.levels.at(request_coords.z).deferred_requests += 1;
+    }
+}
+
+// vsm_find_free_pages.glsl
+void VSMSimulator::find_free_pages()
+{
+    free_pages.clear();
+    for(auto & bucket : not_visited_buckets) { bucket.clear(); }
+    const auto resolution = static_cast<daxa_i32>(info.meta_memory_resolution);
+    for(daxa_i32 linear_index = 0; linear_index < resolution * resolution; linear_index++)
+    {
+        const auto meta_coords = daxa_i32vec2{linear_index % resolution, linear_index / resolution};
+        auto & entry = meta_entry(meta_coords);
+        const bool is_allocated = (entry & VSM_META_ALLOCATED_BIT) != 0;
+        const bool is_visited = (entry & VSM_META_VISITED_BIT) != 0;
+
+        if(!is_allocated)
+        {
+            if(free_pages.size() < info.max_allocation_requests) { free_pages.push_back(meta_coords); }
+        }
+        else if(!is_visited)
+        {
+            const daxa_u32 bucket = info.eviction_policy == VSMEvictionPolicy::LRU ?
+                get_vsm_eviction_bucket(frame_index - meta_memory_last_used.at(linear_index), get_page_coords_from_meta_entry(entry).z) : 0u;
+            auto & bucket_pages = not_visited_buckets.at(bucket);
+            if(bucket_pages.size() < info.max_allocation_requests) { bucket_pages.push_back(meta_coords); }
+            continue;
+        }
+        else
+        {
+            meta_memory_last_used.at(linear_index) = frame_index;
+        }
+
+        if(info.clear_visited_in_debug_pass) { continue; }
+        // Free entries decode to page (0, 0, 0), the shader resets its visited mark as well
+        const auto owner_coords = get_page_coords_from_meta_entry(entry);
+        entry &= ~VSM_META_VISITED_BIT;
+        page_entry(owner_coords) &= ~VSM_PAGE_VISITED_MARKED_BIT;
+    }
+}
+
+// vsm_allocate_pages.glsl
+void VSMSimulator::allocate_pages()
+{
+    for(size_t id = 0; id < allocation_requests.size(); id++)
+    {
+        const auto request_coords = allocation_requests.at(id);
+        auto & level_statistics = frame_statistics.levels.at(request_coords.z);
+
+        daxa_i32vec2 memory_coords;
+        if(id < free_pages.size())
+        {
+            memory_coords = free_pages.at(id);
+        }
+        // Not enough free pages, take the memory of pages which were not visited this frame
+        else if(!take_not_visited_page(id - free_pages.size(), memory_coords))
+        {
+            page_entry(request_coords) = VSM_PAGE_ALLOCATION_FAILED_BIT;
+            level_statistics.allocation_failures += 1;
+            continue;
+        }
+
+        page_entry(request_coords) = pack_meta_coords_to_page_entry(memory_coords) | VSM_PAGE_ALLOCATED_BIT;
+        meta_entry(memory_coords) = pack_page_coords_to_meta_entry(request_coords) | VSM_META_ALLOCATED_BIT;
+        meta_memory_last_used.at(memory_coords.y * info.meta_memory_resolution + memory_coords.x) = frame_index;
+        level_statistics.allocations += 1;
+    }
+}
+
+auto VSMSimulator::take_not_visited_page(size_t free_shifted_id, daxa_i32vec2 & memory_coords) -> bool
+{
+    for(auto const & bucket_pages : not_visited_buckets)
+    {
+        if(free_shifted_id >= bucket_pages.size())
+        {
+            free_shifted_id -= bucket_pages.size();
+            continue;
+        }
+        memory_coords = bucket_pages.at(free_shifted_id);
+        const auto owner_coords = get_page_coords_from_meta_entry(meta_entry(memory_coords));
+        page_entry(owner_coords) = 0u;
+        frame_statistics.levels.at(owner_coords.z).evictions += 1;
+        return true;
+    }
+    return false;
+}
+
+// vsm_clear_pages.glsl, the pages marked dirty are the ones vsm_draw_pages renders into
+void VSMSimulator::clear_pages()
+{
+    for(auto const & request_coords : allocation_requests) { page_entry(request_coords) |= VSM_PAGE_DIRTY_BIT; }
+}
+
+// vsm_clear_dirty_bit.glsl
+void VSMSimulator::clear_dirty_bits()
+{
+    for(auto const & request_coords : allocation_requests) { page_entry(request_coords) &= ~VSM_PAGE_DIRTY_BIT; }
+}
+
+// Meta memory part of vsm_debug_pass.glsl
+void VSMSimulator::clear_visited_flags()
+{
+    for(auto & entry : meta_memory_table)
+    {
+        if((entry & VSM_META_VISITED_BIT) == 0) { continue; }
+        entry &= ~VSM_META_VISITED_BIT;
+        page_entry(get_page_coords_from_meta_entry(entry)) &= ~VSM_PAGE_VISITED_MARKED_BIT;
+    }
+}
+
+auto VSMSimulator::page_entry(daxa_i32vec3 wrapped_page_coords) -> daxa_u32 &
+{
+    return page_table.at((wrapped_page_coords.z * PAGE_TABLE_RESOLUTION + wrapped_page_coords.y) * PAGE_TABLE_RESOLUTION + wrapped_page_coords.x);
+}
+
+auto VSMSimulator::meta_entry(daxa_i32vec2 meta_coords) -> daxa_u32 &
+{
+    return meta_memory_table.at(meta_coords.y * info.meta_memory_resolution + meta_coords.x);
+}
+
+auto VSMSimulator::get_page_entry(daxa_i32vec3 wrapped_page_coords) const -> daxa_u32
+{
+    return page_table.at((wrapped_page_coords.z * PAGE_TABLE_RESOLUTION + wrapped_page_coords.y) * PAGE_TABLE_RESOLUTION + wrapped_page_coords.x);
+}
+
+auto VSMSimulator::get_meta_entry(daxa_i32vec2 meta_coords) const -> daxa_u32
+{
+    return meta_memory_table.at(meta_coords.y * info.meta_memory_resolution + meta_coords.x);
+}
+
+auto VSMSimulator::get_allocated_page_count() const -> daxa_u32
+{
+    return static_cast<daxa_u32>(std::count_if(meta_memory_table.begin(), meta_memory_table.end(),
+        [](daxa_u32 entry) { return (entry & VSM_META_ALLOCATED_BIT) != 0; }));
+}
+
+auto VSMSimulator::get_resident_page_counts() const -> std::array<daxa_u32, VSM_CLIP_LEVELS>
+{
+    auto resident_pages = std::array<daxa_u32, VSM_CLIP_LEVELS>{};
+    for(daxa_u32 page_index = 0; page_index < page_table.size(); page_index++)
+    {
+        if((page_table.at(page_index) & VSM_PAGE_ALLOCATED_BIT) == 0) { continue; }
+        resident_pages.at(page_index / (PAGE_TABLE_RESOLUTION * PAGE_TABLE_RESOLUTION)) += 1;
+    }
+    return resident_pages;
+}
+
+auto VSMSimulator::get_statistics() const -> VSMSimulatorStatistics const & { return statistics; }
+auto VSMSimulator::get_frame_statistics() const -> VSMSimulatorStatistics const & { return frame_statistics; }
+auto VSMSimulator::get_info() const -> VSMSimulatorInfo const & { return info; }
+auto VSMSimulator::get_dirty_pyramid() const -> VSMDirtyPyramidReference const & { return dirty_pyramid; }
+
+static auto transform(daxa_f32mat4x4 const & matrix, daxa_f32vec4 vector) -> daxa_f32vec4
+{
+    return {
+        matrix.x.x * vector.x + matrix.y.x * vector.y + matrix.z.x * vector.z + matrix.w.x * vector.w,
+        matrix.x.y * vector.x + matrix.y.y * vector.y + matrix.z.y * vector.z + matrix.w.y * vector.w,
+        matrix.x.z * vector.x + matrix.y.z * vector.y + matrix.z.z * vector.z + matrix.w.z * vector.w,
+        matrix.x.w * vector.x + matrix.y.w * vector.y + matrix.z.w * vector.z + matrix.w.w * vector.w
+    };
+}
+
+// camera_offset_world_space_from_uv() in vsm_common.glsl
+static auto unproject(daxa_f32mat4x4 const & inv_projection_view, daxa_f32vec2 uv, daxa_f32 depth) -> daxa_f32vec3
+{
+    const auto position = transform(inv_projection_view, {uv.x * 2.0f - 1.0f, uv.y * 2.0f - 1.0f, depth, 1.0f});
+    return { position.x / position.w, position.y / position.w, position.z / position.w };
+}
+
+void generate_vsm_page_requests(VSMPageRequestInfo const & info, std::vector<daxa_i32vec3> & dst)
+{
+    const auto inv_projection_view = info.main_camera.get_inv_view_proj_matrix();
+    const auto projection_view = info.main_camera.get_projection_view_matrix();
+    const auto camera_offset = info.main_camera.offset;
+    // Matrices are relative to the camera offset, world space position p is at p + offset
+    const daxa_f32 ground_height = info.ground_height + static_cast<daxa_f32>(camera_offset.z);
+    const auto screen_resolution = daxa_f32vec2{
+        static_cast<daxa_f32>(info.screen_resolution.x),
+        static_cast<daxa_f32>(info.screen_resolution.y)
+    };
+
+    for(daxa_u32 y = 0; y < info.sample_resolution.y; y++)
+    {
+        for(daxa_u32 x = 0; x < info.sample_resolution.x; x++)
+        {
+            const auto uv = daxa_f32vec2{
+                (static_cast<daxa_f32>(x) + 0.5f) / static_cast<daxa_f32>(info.sample_resolution.x),
+                (static_cast<daxa_f32>(y) + 0.5f) / static_cast<daxa_f32>(info.sample_resolution.y)
+            };
+            // Reverse depth, the near plane is at depth one
+            const auto near_position = unproject(inv_projection_view, uv, 1.0f);
+            const auto far_position = unproject(inv_projection_view, uv, 0.5f);
+            const daxa_f32 ray_z = far_position.z - near_position.z;
+            if(std::abs(ray_z) < 1e-6f) { continue; }
+            const daxa_f32 t = (ground_height - near_position.z) / ray_z;
+            if(t <= 0.0f) { continue; }
+            const auto position = daxa_f32vec3{
+                near_position.x + t * (far_position.x - near_position.x),
+                near_position.y + t * (far_position.y - near_position.y),
+                ground_height
+            };
+            const auto projected = transform(projection_view, {position.x, position.y, position.z, 1.0f});
+            const daxa_f32 depth = projected.z / projected.w;
+
+            // Clip level from the world space footprint of a screen texel
+            const auto center_texel = daxa_f32vec2{uv.x * screen_resolution.x, uv.y * screen_resolution.y};
+            const auto left = unproject(inv_projection_view, {(center_texel.x - 0.5f) / screen_resolution.x, uv.y}, depth);
+            const auto right = unproject(inv_projection_view, {(center_texel.x + 0.5f) / screen_resolution.x, uv.y}, depth);
+            const daxa_f32 texel_world_size = std::sqrt(
+                (left.x - right.x) * (left.x - right.x) +
+                (left.y - right.y) * (left.y - right.y) +
+                (left.z - right.z) * (left.z - right.z));
+            const daxa_i32 clip_level = std::clamp(
+                static_cast<daxa_i32>(std::ceil(std::log2(texel_world_size / info.clip0_texel_world_size))), 0, VSM_CLIP_LEVELS - 1);
+
+            auto const & clip_projection = info.clip_projections[clip_level];
+            const auto sun_position = daxa_f32vec4{
+                position.x + static_cast<daxa_f32>(clip_projection.offset.x - camera_offset.x),
+                position.y + static_cast<daxa_f32>(clip_projection.offset.y - camera_offset.y),
+                position.z + static_cast<daxa_f32>(clip_projection.offset.z - camera_offset.z),
+                1.0f
+            };
+            const auto sun_projected = transform(clip_projection.projection_view, sun_position);
+            const auto sun_uv = daxa_f32vec2{
+                (sun_projected.x / sun_projected.w + 1.0f) * 0.5f,
+                (sun_projected.y / sun_projected.w + 1.0f) * 0.5f
+            };
+            dst.push_back({
+                static_cast<daxa_i32>(std::floor(sun_uv.x * VSM_PAGE_TABLE_RESOLUTION)),
+                static_cast<daxa_i32>(std::floor(sun_uv.y * VSM_PAGE_TABLE_RESOLUTION)),
+                clip_level
+            });
+        }
+    }
+}
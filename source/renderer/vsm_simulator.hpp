@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+#include "../camera.hpp"
+#include "shared/shared.inl"
+#include "vsm_dirty_pyramid.hpp"
+
+// Page table and meta memory bit layout, mirrors vsm_common.glsl
+static constexpr daxa_u32 VSM_PAGE_ALLOCATED_BIT           = 1u << 31;
+static constexpr daxa_u32 VSM_PAGE_REQUESTS_ALLOCATION_BIT = 1u << 30;
+static constexpr daxa_u32 VSM_PAGE_ALLOCATION_FAILED_BIT   = 1u << 29;
+static constexpr daxa_u32 VSM_PAGE_DIRTY_BIT               = 1u << 28;
+static constexpr daxa_u32 VSM_PAGE_VISITED_MARKED_BIT      = 1u << 27;
+static constexpr daxa_u32 VSM_META_ALLOCATED_BIT           = 1u << 31;
+static constexpr daxa_u32 VSM_META_NEEDS_CLEAR_BIT         = 1u << 30;
+static constexpr daxa_u32 VSM_META_VISITED_BIT             = 1u << 29;
+
+enum struct VSMEvictionPolicy
+{
+    // Not visited pages are evicted in the raster order of the meta memory table
+    VISITED_BIT,
+    // Not visited pages are evicted by the eviction buckets of vsm_find_free_pages.glsl
+    LRU
+};
+
+struct VSMSimulatorInfo
+{
+    daxa_u32 meta_memory_resolution = VSM_META_MEMORY_RESOLUTION;
+    daxa_u32 max_allocation_requests = MAX_NUM_VSM_ALLOC_REQUEST;
+    daxa_u32 max_page_requests = MAX_NUM_VSM_PAGE_REQUEST;
+    // Mirrors VSM_DEBUG_VIZ_PASS, the visited flags are then cleared by the debug pass at the end of the
+    // frame instead of by the find free pages pass
+    bool clear_visited_in_debug_pass = VSM_DEBUG_VIZ_PASS != 0;
+    // LRU is what the shaders do, VISITED_BIT is the previous policy kept for comparisons
+    VSMEvictionPolicy eviction_policy = VSMEvictionPolicy::LRU;
+};
+
+// Mirrors vsm_eviction_bucket() in vsm_common.glsl
+[[nodiscard]] auto get_vsm_eviction_bucket(daxa_u32 age, daxa_i32 clip_level) -> daxa_u32;
+// Mirrors vsm_request_priority_bucket() in vsm_common.glsl
+[[nodiscard]] auto get_vsm_request_priority_bucket(daxa_i32 clip_level, daxa_u32 coverage) -> daxa_u32;
+
+struct VSMSimulatorFrameInfo
+{
+    // Same contents as the vsm sun projections and free wrapped pages info buffers of the frame
+    std::span<VSMClipProjection const, VSM_CLIP_LEVELS> clip_projections;
+    std::span<FreeWrappedPagesInfo const, VSM_CLIP_LEVELS> free_wrapped_pages_info;
+    // Page coordinates before wrapping with the clip level in z, one entry per depth sample in the order
+    // the depth analysis visits them. Duplicates are expected, samples outside the clip level are skipped
+    std::span<daxa_i32vec3 const> page_requests;
+    // Globals::vsm_page_budget of the frame
+    daxa_u32 page_budget = MAX_NUM_VSM_ALLOC_REQUEST;
+};
+
+struct VSMClipLevelStatistics
+{
+    // Distinct pages the depth samples landed in
+    daxa_u64 requested_pages;
+    // Requested pages which were already allocated
+    daxa_u64 hits;
+    daxa_u64 allocations;
+    // Requests which found neither a free nor a not visited page
+    daxa_u64 allocation_failures;
+    // Requests which did not fit into the page request buffer
+    daxa_u64 dropped_requests;
+    // Requests left unallocated by the page budget, the following frames request them again
+    daxa_u64 deferred_requests;
+    // Pages which lost their memory to an allocation of a page which was needed this frame
+    daxa_u64 evictions;
+    // Pages freed because the page table wrapped over them
+    daxa_u64 wrapped_frees;
+    // Pages freed because the sun direction of the clip level changed
+    daxa_u64 invalidations;
+
+    [[nodiscard]] auto get_hit_rate() const -> daxa_f64;
+    // Every allocation and every freed page changes the contents of the physical memory
+    [[nodiscard]] auto get_churn() const -> daxa_u64;
+};
+
+struct VSMSimulatorStatistics
+{
+    daxa_u64 frames;
+    std::array<VSMClipLevelStatistics, VSM_CLIP_LEVELS> levels;
+
+    [[nodiscard]] auto get_total() const -> VSMClipLevelStatistics;
+};
+
+// CPU port of the VSM page allocator, the passes run in the order of the task graph:
+// free wrapped pages, page requests of the depth analysis, prioritize requests, find free pages, allocate pages, clear pages,
+// build dirty pyramid, clear dirty bit and optionally the debug pass. Every pass runs as if its invocations executed one after
+// another in the order of their global invocation index, so the results are deterministic and match one of
+// the orders the GPU is allowed to execute them in. Page contents and the page height offsets are not simulated
+struct VSMSimulator
+{
+    explicit VSMSimulator(VSMSimulatorInfo const & info = {});
+
+    void simulate_frame(VSMSimulatorFrameInfo const & info);
+    // Frees all the pages, keeps the accumulated statistics
+    void reset();
+
+    [[nodiscard]] auto get_page_entry(daxa_i32vec3 wrapped_page_coords) const -> daxa_u32;
+    [[nodiscard]] auto get_meta_entry(daxa_i32vec2 meta_coords) const -> daxa_u32;
+    // Dirty pages of the last simulated frame, the ones the page draw renders into
+    [[nodiscard]] auto get_dirty_pyramid() const -> VSMDirtyPyramidReference const &;
+    [[nodiscard]] auto get_allocated_page_count() const -> daxa_u32;
+    // Same as VSMStatistics::resident_pages
+    [[nodiscard]] auto get_resident_page_counts() const -> std::array<daxa_u32, VSM_CLIP_LEVELS>;
+    [[nodiscard]] auto get_statistics() const -> VSMSimulatorStatistics const &;
+    [[nodiscard]] auto get_frame_statistics() const -> VSMSimulatorStatistics const &;
+    [[nodiscard]] auto get_info() const -> VSMSimulatorInfo const &;
+
+    private:
+        void free_wrapped_pages(VSMSimulatorFrameInfo const & info);
+        void request_pages(VSMSimulatorFrameInfo const & info);
+        void prioritize_requests(daxa_u32 page_budget);
+        void find_free_pages();
+        void allocate_pages();
+        void clear_pages();
+        void clear_dirty_bits();
+        void clear_visited_flags();
+        // Evicts the owner of a not visited page, returns false when all the buckets are drained
+        auto take_not_visited_page(size_t free_shifted_id, daxa_i32vec2 & memory_coords) -> bool;
+
+        auto page_entry(daxa_i32vec3 wrapped_page_coords) -> daxa_u32 &;
+        auto meta_entry(daxa_i32vec2 meta_coords) -> daxa_u32 &;
+
+        VSMSimulatorInfo info;
+        std::vector<daxa_u32> page_table = {};
+        std::vector<daxa_u32> meta_memory_table = {};
+        std::vector<daxa_u32> meta_memory_last_used = {};
+        // Globals::frame_index of the simulated frame
+        daxa_u32 frame_index = 0;
+        // Last frame a page table entry was requested in, counts every requested page once per frame
+        std::vector<daxa_u64> requested_frame = {};
+        // Depth samples which requested each unallocated page this frame
+        std::vector<daxa_u32> request_coverage = {};
+
+        // Contents of the transient buffers of a frame
+        std::vector<daxa_i32vec3> page_requests = {};
+        std::vector<daxa_i32vec3> allocation_requests = {};
+        std::vector<daxa_i32vec2> free_pages = {};
+        std::array<std::vector<daxa_i32vec2>, VSM_EVICTION_BUCKETS> not_visited_buckets = {};
+        VSMDirtyPyramidReference dirty_pyramid = {};
+
+        VSMSimulatorStatistics statistics = {};
+        VSMSimulatorStatistics frame_statistics = {};
+};
+
+struct VSMPageRequestInfo
+{
+    Camera & main_camera;
+    std::span<VSMClipProjection const, VSM_CLIP_LEVELS> clip_projections;
+    daxa_f32 clip0_texel_world_size;
+    // Resolution the depth buffer would have, the clip level of a sample depends on its footprint
+    daxa_u32vec2 screen_resolution;
+    // The view is sampled by a grid of this many rays instead of every pixel
+    daxa_u32vec2 sample_resolution = {320, 180};
+    // The scene is replaced by a plane at this world space height, rays missing it request nothing
+    daxa_f32 ground_height = 0.0f;
+};
+
+// Synthetic depth analysis, appends the page request of every ray which hits the ground plane into dst.
+// Applies the same clip level selection and sun projection as clip_info_from_uvs() in vsm_common.glsl
+void generate_vsm_page_requests(VSMPageRequestInfo const & info, std::vector<daxa_i32vec3> & dst);
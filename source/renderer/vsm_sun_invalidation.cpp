@@ -0,0 +1,106 @@
+#include "vsm_sun_invalidation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "../utils.hpp"
+
+static auto get_angle_degrees(daxa_f32vec3 first, daxa_f32vec3 second) -> daxa_f32
+{
+    const daxa_f32 first_length = std::sqrt(first.x * first.x + first.y * first.y + first.z * first.z);
+    const daxa_f32 second_length = std::sqrt(second.x * second.x + second.y * second.y + second.z * second.z);
+    if(first_length == 0.0f || second_length == 0.0f) { return 180.0f; }
+    const daxa_f32 cos_angle = (first.x * second.x + first.y * second.y + first.z * second.z) / (first_length * second_length);
+    return std::acos(std::clamp(cos_angle, -1.0f, 1.0f)) * 180.0f / std::numbers::pi_v<daxa_f32>;
+}
+
+VSMSunInvalidation::VSMSunInvalidation(VSMSunInvalidationInfo const & info) :
+    info{info}
+{
+    DBG_ASSERT_TRUE_M(info.max_levels_per_frame > 0, "[VSMSunInvalidation::VSMSunInvalidation()] No clip level could ever be switched");
+}
+
+void VSMSunInvalidation::update(daxa_f32vec3 sun_direction, std::span<daxa_u32 const, VSM_CLIP_LEVELS> resident_pages)
+{
+    statistics.frames += 1;
+    statistics.invalidated_levels = 0;
+    statistics.invalidated_pages = 0;
+    // The cache is empty before the first frame, there is nothing to invalidate
+    if(!initialized)
+    {
+        target_sun_direction = sun_direction;
+        level_sun_directions.fill(sun_direction);
+        initialized = true;
+        return;
+    }
+
+    if(get_angle_degrees(sun_direction, target_sun_direction) > info.quantization_degrees)
+    {
+        for(daxa_u32 clip_level = 0; clip_level < VSM_CLIP_LEVELS; clip_level++)
+        {
+            if(!is_level_stale(clip_level)) { stale_since.at(clip_level) = statistics.frames; }
+        }
+        target_sun_direction = sun_direction;
+        statistics.direction_updates += 1;
+    }
+
+    std::array<daxa_u32, VSM_CLIP_LEVELS> stale_levels = {};
+    daxa_u32 stale_level_count = 0;
+    for(daxa_u32 level = 0; level < VSM_CLIP_LEVELS; level++)
+    {
+        const daxa_u32 clip_level = info.order == VSMInvalidationOrder::FINE_FIRST ? level : VSM_CLIP_LEVELS - 1 - level;
+        if(is_level_stale(clip_level)) { stale_levels.at(stale_level_count++) = clip_level; }
+    }
+    // Stable so the levels which became stale in the same frame keep the configured order
+    std::stable_sort(stale_levels.begin(), stale_levels.begin() + stale_level_count,
+        [this](daxa_u32 first, daxa_u32 second) { return stale_since.at(first) < stale_since.at(second); });
+
+    for(daxa_u32 stale_level = 0; stale_level < stale_level_count; stale_level++)
+    {
+        const daxa_u32 clip_level = stale_levels.at(stale_level);
+        if(statistics.invalidated_levels == info.max_levels_per_frame) { break; }
+        if(statistics.invalidated_levels > 0 && statistics.invalidated_pages + resident_pages[clip_level] > info.max_pages_per_frame) { break; }
+
+        level_sun_directions.at(clip_level) = target_sun_direction;
+        statistics.invalidated_levels += 1;
+        statistics.invalidated_pages += resident_pages[clip_level];
+    }
+    statistics.stale_levels = stale_level_count - statistics.invalidated_levels;
+    statistics.total_invalidated_levels += statistics.invalidated_levels;
+    statistics.total_invalidated_pages += statistics.invalidated_pages;
+}
+
+void VSMSunInvalidation::set_info(VSMSunInvalidationInfo const & new_info)
+{
+    DBG_ASSERT_TRUE_M(new_info.max_levels_per_frame > 0, "[VSMSunInvalidation::set_info()] No clip level could ever be switched");
+    info = new_info;
+}
+
+auto VSMSunInvalidation::is_level_stale(daxa_u32 clip_level) const -> bool
+{
+    auto const & level_sun_direction = level_sun_directions.at(clip_level);
+    return level_sun_direction.x != target_sun_direction.x ||
+           level_sun_direction.y != target_sun_direction.y ||
+           level_sun_direction.z != target_sun_direction.z;
+}
+
+auto VSMSunInvalidation::get_level_sun_directions() const -> std::array<daxa_f32vec3, VSM_CLIP_LEVELS> const &
+{
+    return level_sun_directions;
+}
+
+auto VSMSunInvalidation::get_target_sun_direction() const -> daxa_f32vec3
+{
+    return target_sun_direction;
+}
+
+auto VSMSunInvalidation::get_statistics() const -> VSMSunInvalidationStatistics const &
+{
+    return statistics;
+}
+
+auto VSMSunInvalidation::get_info() const -> VSMSunInvalidationInfo const &
+{
+    return info;
+}
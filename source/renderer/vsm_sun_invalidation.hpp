@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <span>
+
+#include <daxa/types.hpp>
+using namespace daxa::types;
+
+#include "shared/shared.inl"
+
+enum struct VSMInvalidationOrder
+{
+    // Shadows close to the player are corrected first
+    FINE_FIRST,
+    // The fewest pages are lost first, the coarse levels cover the most area with the fewest pages
+    COARSE_FIRST
+};
+
+struct VSMSunInvalidationInfo
+{
+    // Sun direction changes smaller than this angle from the last applied direction are ignored by the shadows
+    daxa_f32 quantization_degrees = 0.5f;
+    // Clip levels switched to the new sun direction per frame
+    daxa_u32 max_levels_per_frame = 2;
+    // Resident pages the levels switched in one frame may lose together, at least one level is switched every frame
+    daxa_u32 max_pages_per_frame = MAX_NUM_VSM_ALLOC_REQUEST;
+    // Order of the levels which became stale in the same frame, levels which are stale for longer always go first
+    VSMInvalidationOrder order = VSMInvalidationOrder::FINE_FIRST;
+};
+
+struct VSMSunInvalidationStatistics
+{
+    daxa_u32 invalidated_levels;
+    // Resident pages of the invalidated levels as last read back, the pages the following frames redraw at most
+    daxa_u32 invalidated_pages;
+    // Levels still shadowed with an older sun direction
+    daxa_u32 stale_levels;
+    daxa_u64 total_invalidated_levels;
+    daxa_u64 total_invalidated_pages;
+    daxa_u64 direction_updates;
+    daxa_u64 frames;
+};
+
+// Every page of a clip level is drawn with the sun direction of the level, a new direction invalidates all of them.
+// Instead of dropping the whole cache whenever the sun moves the direction is quantized and the clip levels are
+// switched to it a few at a time, the rest keep shadowing with the direction they were drawn with until their turn.
+// The switched levels lose all their pages through the free wrapped pages pass
+struct VSMSunInvalidation
+{
+    explicit VSMSunInvalidation(VSMSunInvalidationInfo const & info = {});
+
+    // resident_pages are the allocated pages of each clip level, the cost of switching it
+    void update(daxa_f32vec3 sun_direction, std::span<daxa_u32 const, VSM_CLIP_LEVELS> resident_pages);
+    void set_info(VSMSunInvalidationInfo const & info);
+
+    [[nodiscard]] auto get_level_sun_directions() const -> std::array<daxa_f32vec3, VSM_CLIP_LEVELS> const &;
+    [[nodiscard]] auto get_target_sun_direction() const -> daxa_f32vec3;
+    [[nodiscard]] auto get_statistics() const -> VSMSunInvalidationStatistics const &;
+    [[nodiscard]] auto get_info() const -> VSMSunInvalidationInfo const &;
+
+    private:
+        [[nodiscard]] auto is_level_stale(daxa_u32 clip_level) const -> bool;
+
+        VSMSunInvalidationInfo info;
+        bool initialized = false;
+        daxa_f32vec3 target_sun_direction = {0.0f, 0.0f, 0.0f};
+        std::array<daxa_f32vec3, VSM_CLIP_LEVELS> level_sun_directions = {};
+        // Frame in which each stale level stopped matching the target direction
+        std::array<daxa_u64, VSM_CLIP_LEVELS> stale_since = {};
+        VSMSunInvalidationStatistics statistics = {};
+};
@@ -109,6 +109,7 @@ struct AppWindow
 
         [[nodiscard]] daxa_i32 get_key_state(daxa_i32 key) { return glfwGetKey(window, key); }
         [[nodiscard]] auto get_window_should_close() const -> bool { return glfwWindowShouldClose(window); }
+        void set_window_should_close(bool should_close) { glfwSetWindowShouldClose(window, should_close); }
         [[nodiscard]] auto get_glfw_window_handle() const -> GLFWwindow* { return window; }
         [[nodiscard]] auto get_native_handle() const -> daxa::NativeWindowHandle
         {